@@ -814,7 +814,7 @@ bool AstDumpToNode::enterFnSym(FnSymbol* node)
   }
 
   newline();
-  fprintf(mFP, "FileName: %s", node->astloc.filename);
+  fprintf(mFP, "FileName: %s", node->astloc.filename());
 
   newline();
   fprintf(mFP, "LineNum:  %5d", node->astloc.lineno);
@@ -32,7 +32,7 @@ TryStmt::TryStmt(bool tryBang, BlockStmt* body) : Stmt(E_TryStmt) {
   _tryBang = tryBang;
   _body    = body;
 
-  gTryStmts.add(this);
+  registerAST(gTryStmts, this);
 }
 
 TryStmt::~TryStmt() {
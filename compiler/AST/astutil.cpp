@@ -36,6 +36,7 @@
 // files, the corresponding collector functions can be removed from this
 // implementation file, then this #include, and finally the .h file itself.
 
+#include <algorithm>
 #include <vector>
 
 static void pruneUnusedAggregateTypes(Vec<TypeSymbol*>& types);
@@ -540,8 +541,11 @@ void remove_help(BaseAST* ast, int trace_flag) {
     expr->parentSymbol = NULL;
     expr->parentExpr = NULL;
   } else if (LabelSymbol* labsym = toLabelSymbol(ast)) {
-    if (labsym->iterResumeGoto)
+    if (labsym->iterResumeGoto) {
+      lockAST();
       removedIterResumeLabels.add(labsym);
+      unlockAST();
+    }
   }
 }
 
@@ -920,6 +924,20 @@ static void addToUsedFnSymbols(std::set<FnSymbol*>& fnSymbols,
   }
 }
 
+static bool compareIds(BaseAST* a, BaseAST* b) {
+  return a->id < b->id;
+}
+
+void sortedSymbolMapKeys(SymbolMap& map, std::vector<Symbol*>& keys) {
+  form_Map(SymbolMapElem, e, map) {
+    if (e->key != NULL) {
+      keys.push_back(e->key);
+    }
+  }
+
+  std::sort(keys.begin(), keys.end(), compareIds);
+}
+
 /*
 * Collect all of the functions in the call graph at and below the function
 * call.
@@ -17,9 +17,11 @@
  * limitations under the License.
  */
 
+#include <map>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "baseAST.h"
 
@@ -28,6 +30,7 @@
 #include "expr.h"
 #include "ForLoop.h"
 #include "log.h"
+#include "parallelPasses.h"
 #include "ParamForLoop.h"
 #include "parser.h"
 #include "passes.h"
@@ -47,6 +50,8 @@ foreach_ast(decl_gvecs);
 
 static int uid = 1;
 
+static void freeAstArena();
+
 #define decl_counters(type)                                             \
   int n##type = g##type##s.n, k##type = n##type*sizeof(type)/1024
 
@@ -223,6 +228,105 @@ void destroyAst() {
       delete ast;                               \
     }
   foreach_ast(destroy_gvec);
+
+  freeAstArena();
+}
+
+
+/************************************* | **************************************
+*                                                                             *
+* The AST arena.  Nodes are carved out of large chunks, with a free list for  *
+* each node size, instead of each being a separate malloc.  This saves the    *
+* malloc overhead of every node and keeps nodes made together close together. *
+* A node deleted by cleanAst() goes on the free list for its size, to be      *
+* reused by a later pass.  destroyAst() frees the chunks all at once.         *
+*                                                                             *
+************************************** | *************************************/
+
+static const size_t astChunkSize   = 1 << 20;
+static const size_t astAlignment   = 8;
+static const size_t astMaxNodeSize = 1024;  // larger nodes use ::operator new
+
+struct AstFreeNode {
+  AstFreeNode* next;
+};
+
+static std::vector<char*> astChunks;
+static char*              astChunkNext = NULL;
+static char*              astChunkEnd  = NULL;
+static AstFreeNode*       astFreeLists[astMaxNodeSize / astAlignment + 1];
+
+static size_t astArenaSize(size_t size) {
+  return (size + astAlignment - 1) & ~(astAlignment - 1);
+}
+
+void* BaseAST::operator new(size_t size) {
+  void* retval = NULL;
+
+  size = astArenaSize(size);
+
+  if (size > astMaxNodeSize)
+    return ::operator new(size);
+
+  if (parallelPassRunning)
+    lockAST();
+
+  AstFreeNode*& freeList = astFreeLists[size / astAlignment];
+
+  if (freeList != NULL) {
+    retval   = freeList;
+    freeList = freeList->next;
+
+  } else {
+    if (astChunkNext + size > astChunkEnd) {
+      astChunkNext = new char[astChunkSize];
+      astChunkEnd  = astChunkNext + astChunkSize;
+
+      astChunks.push_back(astChunkNext);
+    }
+
+    retval        = astChunkNext;
+    astChunkNext += size;
+  }
+
+  if (parallelPassRunning)
+    unlockAST();
+
+  return retval;
+}
+
+void BaseAST::operator delete(void* ptr, size_t size) {
+  size = astArenaSize(size);
+
+  if (size > astMaxNodeSize) {
+    ::operator delete(ptr);
+
+  } else {
+    AstFreeNode* node = static_cast<AstFreeNode*>(ptr);
+
+    if (parallelPassRunning)
+      lockAST();
+
+    node->next                        = astFreeLists[size / astAlignment];
+    astFreeLists[size / astAlignment] = node;
+
+    if (parallelPassRunning)
+      unlockAST();
+  }
+}
+
+// Free the memory of every node in the arena.
+static void freeAstArena() {
+  for (size_t i = 0; i < astChunks.size(); i++)
+    delete [] astChunks[i];
+
+  astChunks.clear();
+
+  astChunkNext = NULL;
+  astChunkEnd  = NULL;
+
+  for (size_t i = 0; i < astMaxNodeSize / astAlignment + 1; i++)
+    astFreeLists[i] = NULL;
 }
 
 
@@ -251,6 +355,18 @@ int lastNodeIDUsed() {
   return uid - 1;
 }
 
+int reserveNodeIDs(int n) {
+  int first = uid;
+
+  uid += n;
+
+  return first;
+}
+
+void resetNodeIDs(int next) {
+  uid = next;
+}
+
 
 // This is here so that we can break on the creation of a particular
 // BaseAST instance in gdb.
@@ -260,17 +376,28 @@ static void checkid(int id) {
   }
 }
 
+void renumberNodeID(BaseAST* ast) {
+  ast->id = uid++;
+  checkid(ast->id);
+}
+
 
 BaseAST::BaseAST(AstTag type) :
   astTag(type),
-  id(uid++),
+  id(parallelPassRunning ? workerAstId() : uid++),
   astloc(yystartlineno, yyfilename)
 {
-  checkid(id);
-  if (astloc.filename) {
+  // a node created by a parallel pass is checked when it is renumbered
+  if (!parallelPassRunning)
+    checkid(id);
+  if (astloc.filename()) {
     // OK, set from yyfilename
+  } else if (parallelPassRunning) {
+    astloc = astlocT(threadAstLocLineno, threadAstLocFilename);
+    if (!astloc.filename())
+      INT_FATAL("no line number available");
   } else {
-    if (currentAstLoc.filename) {
+    if (currentAstLoc.filename()) {
       astloc = currentAstLoc;
     } else {
       // neither yy* nor currentAstLoc are set
@@ -291,7 +418,7 @@ int BaseAST::linenum() const {
 }
 
 const char* BaseAST::fname() const {
-  return astloc.filename;
+  return astloc.filename();
 }
 
 const char* BaseAST::stringLoc(void) const {
@@ -536,6 +663,49 @@ void BaseAST::printDocsDescription(const char *doc, std::ostream *file, unsigned
 
 astlocT currentAstLoc(0,NULL);
 
+Vec<const char*> astlocFilenames;
+
+__thread const char* astlocLastFilename  = NULL;
+__thread int         astlocLastFileIndex = 0;
+
+static std::map<const char*, int> astlocFileIndices;
+
+//
+// Return the index of filename for astlocT, adding it to astlocFilenames
+// if it is new.  Filenames are compared by address; nearly all of them
+// come from astr().  Filenames may be looked up during a parallel pass,
+// but not added: astlocFilenames is read without the lock and may move
+// when it grows.
+//
+int astlocAddFilename(const char* filename) {
+  int index = 0;
+
+  if (parallelPassRunning)
+    lockAST();
+
+  std::map<const char*, int>::iterator it = astlocFileIndices.find(filename);
+
+  if (it != astlocFileIndices.end()) {
+    index = it->second;
+  } else {
+    INT_ASSERT(!parallelPassRunning);
+    astlocFilenames.add(filename);
+    index = astlocFilenames.n;
+    astlocFileIndices[filename] = index;
+  }
+
+  if (parallelPassRunning)
+    unlockAST();
+
+  astlocLastFilename  = filename;
+  astlocLastFileIndex = index;
+
+  return index;
+}
+
+__thread const char* threadAstLocFilename = NULL;
+__thread int         threadAstLocLineno   = 0;
+
 Vec<ModuleSymbol*> userModules; // Contains user + main modules
 Vec<ModuleSymbol*> allModules;  // Contains all modules
 
@@ -695,23 +865,39 @@ bool isCForLoop(const BaseAST* a)
 *                                                                             *
 ************************************** | *************************************/
 
+// The threads of a parallel pass each keep their own location in
+// threadAstLocFilename/threadAstLocLineno instead of currentAstLoc.
+static void setAstLoc(astlocT astLoc) {
+  if (parallelPassRunning) {
+    threadAstLocFilename = astLoc.filename();
+    threadAstLocLineno   = astLoc.lineno;
+  } else {
+    currentAstLoc = astLoc;
+  }
+}
+
+static astlocT getAstLoc() {
+  if (parallelPassRunning)
+    return astlocT(threadAstLocLineno, threadAstLocFilename);
+  else
+    return currentAstLoc;
+}
+
 // constructor, invoked upon SET_LINENO
 astlocMarker::astlocMarker(astlocT newAstLoc)
-  : previousAstLoc(currentAstLoc)
+  : previousAstLoc(getAstLoc())
 {
-  //previousAstLoc = currentAstLoc;
-  currentAstLoc = newAstLoc;
+  setAstLoc(newAstLoc);
 }
 
 // constructor, for special occasions
 astlocMarker::astlocMarker(int lineno, const char* filename)
-  : previousAstLoc(currentAstLoc)
+  : previousAstLoc(getAstLoc())
 {
-  currentAstLoc.lineno   = lineno;
-  currentAstLoc.filename = astr(filename);
+  setAstLoc(astlocT(lineno, astr(filename)));
 }
 
 // destructor, invoked upon leaving SET_LINENO's scope
 astlocMarker::~astlocMarker() {
-  currentAstLoc = previousAstLoc;
+  setAstLoc(previousAstLoc);
 }
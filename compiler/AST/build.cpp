@@ -1154,6 +1154,53 @@ Expr* buildForallLoopExprFromArrayType(CallExpr* buildArrRTTypeCall,
   }
 }
 
+//
+// --instrument-loops support.  The forall and coforall statements in
+// user modules count the iterations in each chunk of work handed to a
+// task and time the task's work on it, by calling the procedures in
+// modules/internal/ChapelLoopStats.chpl.  Loops built after parsing,
+// such as those in promotion wrappers, are not instrumented.
+//
+enum LoopStatsKind {
+  LOOP_STATS_FORALL,
+  LOOP_STATS_COFORALL,
+  LOOP_STATS_STANDALONE
+};
+
+// The variable for the statistics of a loop being built, or NULL if
+// the loop is not to be instrumented.
+static VarSymbol* newLoopStats() {
+  if (fInstrumentLoops             &&
+      yyfilename        != NULL    &&
+      chplParseString   == false   &&
+      currentModuleType == MOD_USER)
+    return newTemp("chpl__loopStats");
+  else
+    return NULL;
+}
+
+// Collect the statistics for each execution of the loop in block.
+static void loopStatsBegin(BlockStmt* block, VarSymbol* stats,
+                           LoopStatsKind kind) {
+  block->insertAtHead(new CallExpr(PRIM_MOVE, stats,
+                                   new CallExpr("chpl_loopStatsBegin")));
+  block->insertAtHead(new DefExpr(stats));
+  block->insertAtTail(new CallExpr("chpl_loopStatsEnd", stats,
+                                   new_IntSymbol(kind)));
+}
+
+// Time the chunk of work done by block.  If count is NULL, the chunk
+// is one iteration.
+static void loopStatsChunk(BlockStmt* block, VarSymbol* stats,
+                           VarSymbol* count) {
+  VarSymbol* start = new VarSymbol("chpl__loopStatsStart");
+  VarSymbol* iters = count ? count : new_IntSymbol(1);
+
+  block->insertAtHead(new DefExpr(start, new CallExpr("chpl_loopStatsNow")));
+  block->insertAtTail(new CallExpr("chpl_loopStatsChunk", stats, iters,
+                                   start));
+}
+
 static BlockStmt*
 buildFollowLoop(VarSymbol* iter,
                 VarSymbol* leadIdxCopy,
@@ -1162,7 +1209,8 @@ buildFollowLoop(VarSymbol* iter,
                 Expr*      indices,
                 BlockStmt* loopBody,
                 bool       fast,
-                bool       zippered) {
+                bool       zippered,
+                VarSymbol* stats) {
   BlockStmt* followBlock = new BlockStmt();
   ForLoop*   followBody  = new ForLoop(followIdx, followIter, loopBody, zippered);
 
@@ -1192,6 +1240,17 @@ buildFollowLoop(VarSymbol* iter,
   followBlock->insertAtTail(followBody);
   followBlock->insertAtTail(new CallExpr("_freeIterator", followIter));
 
+  if (stats) {
+    VarSymbol* count = new VarSymbol("chpl__loopStatsIters");
+
+    followBody->insertAtHead(new CallExpr("+=", count, new_IntSymbol(1)));
+    loopStatsChunk(followBlock, stats, count);
+    followBlock->insertAtHead(new DefExpr(count, new_IntSymbol(0)));
+
+    // implementForallIntents expects the block to start with followIter
+    followBlock->insertAtHead(followIter->defPoint->remove());
+  }
+
   return followBlock;
 }
 
@@ -1400,6 +1459,8 @@ buildForallLoopStmt(Expr*      indices,
   VarSymbol* followIter      = newTemp("chpl__followIter");
   BlockStmt* followBlock     = NULL;
 
+  VarSymbol* stats           = newLoopStats();
+
   iterRec->addFlag(FLAG_EXPR_TEMP);
   iterRec->addFlag(FLAG_CHPL__ITER);
 
@@ -1430,7 +1491,8 @@ buildForallLoopStmt(Expr*      indices,
                                 indices,
                                 loopBody,
                                 false,
-                                zippered);
+                                zippered,
+                                stats);
 
   if (fNoFastFollowers == false) {
     Symbol* T1 = newTemp();
@@ -1469,7 +1531,8 @@ buildForallLoopStmt(Expr*      indices,
                                       indices,
                                       loopBodyForFast,
                                       true,
-                                      zippered);
+                                      zippered,
+                                      stats);
 
     leadForLoop->insertAtTail(new CondStmt(new SymExpr(T2), fastFollowBlock, followBlock));
   } else {
@@ -1483,11 +1546,30 @@ buildForallLoopStmt(Expr*      indices,
                      iterRec, leadIdx, leadIdxCopy, leadForLoop,
                      useThisGlobalOp);
 
+  if (stats)
+    loopStatsBegin(resultBlock, stats, LOOP_STATS_FORALL);
+
   if (!zippered) {
+    // A standalone iterator does not show how it divides the work, so
+    // each thread counts the iterations it runs, and the threads that
+    // ran some are reported as the chunks.
+    VarSymbol* saStats = stats ? newTemp("chpl__loopStats")   : NULL;
+    VarSymbol* saId    = stats ? newTemp("chpl__loopStatsId") : NULL;
+
+    if (saStats)
+      loopBodyForStandalone->insertAtHead(
+        new CallExpr("chpl_loopStatsIter", saStats, saId));
+
     BlockStmt* SALoop = buildStandaloneForallLoopStmt(indices, iterExpr,
                                                       loopBodyForStandalone,
                                                       useThisGlobalOp);
     BlockStmt* result = new BlockStmt();
+
+    if (saStats) {
+      SALoop->insertAtHead(new DefExpr(saId, buildDotExpr(saStats, "id")));
+      loopStatsBegin(SALoop, saStats, LOOP_STATS_STANDALONE);
+    }
+
     result->insertAtTail(
       new CondStmt(new SymExpr(gTryToken), SALoop, resultBlock));
     return result;
@@ -1555,6 +1637,8 @@ BlockStmt* buildCoforallLoopStmt(Expr* indices,
 
   SET_LINENO(body);
 
+  VarSymbol* stats = newLoopStats();
+
   if (onBlock) {
     //
     // optimization of on-statements directly inside coforall-loops
@@ -1579,11 +1663,18 @@ BlockStmt* buildCoforallLoopStmt(Expr* indices,
     }
     onBlock->insertAtHead(innerOnBlock);
     onBlock->insertAtTail(new CallExpr("_downEndCount", coforallCount));
+    if (stats) {
+      loopStatsChunk(innerOnBlock, stats, NULL);
+      loopStatsBegin(block, stats, LOOP_STATS_COFORALL);
+    }
     return block;
   } else {
 
     BlockStmt* coforallBlk = new BlockStmt();
 
+    if (stats)
+      loopStatsChunk(body, stats, NULL);
+
     BlockStmt* vectorCoforallBlk = new BlockStmt();
     BlockStmt* nonVectorCoforallBlk = new BlockStmt();
 
@@ -1637,6 +1728,9 @@ BlockStmt* buildCoforallLoopStmt(Expr* indices,
                                            vectorCoforallBlk->copy(),
                                            nonVectorCoforallBlk->copy()));
 
+    if (stats)
+      loopStatsBegin(coforallBlk, stats, LOOP_STATS_COFORALL);
+
     return coforallBlk;
   }
 }
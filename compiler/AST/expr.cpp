@@ -498,7 +498,7 @@ SymExpr::SymExpr(Symbol* init_var) :
 {
   if (!init_var)
     INT_FATAL(this, "Bad call to SymExpr");
-  gSymExprs.add(this);
+  registerAST(gSymExprs, this);
 
   // No need to call var->addSymExpr here since it will be called
   // when the SymExpr is added to the tree.
@@ -627,7 +627,7 @@ UnresolvedSymExpr::UnresolvedSymExpr(const char* i_unresolved) :
 {
   if (!i_unresolved)
     INT_FATAL(this, "bad call to UnresolvedSymExpr");
-  gUnresolvedSymExprs.add(this);
+  registerAST(gUnresolvedSymExprs, this);
 }
 
 void
@@ -710,7 +710,7 @@ DefExpr::DefExpr(Symbol* initSym, BaseAST* initInit, BaseAST* initExprType) :
   if (isArgSymbol(sym) && (exprType || init))
     INT_FATAL(this, "DefExpr of ArgSymbol cannot have either exprType or init");
 
-  gDefExprs.add(this);
+  registerAST(gDefExprs, this);
 }
 
 Expr* DefExpr::getFirstChild() {
@@ -837,7 +837,7 @@ CallExpr::CallExpr(BaseAST* base,
 
   argList.parent = this;
 
-  gCallExprs.add(this);
+  registerAST(gCallExprs, this);
 }
 
 
@@ -862,7 +862,7 @@ CallExpr::CallExpr(PrimitiveOp* prim,
 
   argList.parent = this;
 
-  gCallExprs.add(this);
+  registerAST(gCallExprs, this);
 }
 
 CallExpr::CallExpr(PrimitiveTag prim,
@@ -886,7 +886,7 @@ CallExpr::CallExpr(PrimitiveTag prim,
 
   argList.parent = this;
 
-  gCallExprs.add(this);
+  registerAST(gCallExprs, this);
 }
 
 
@@ -911,7 +911,7 @@ CallExpr::CallExpr(const char* name,
 
   argList.parent = this;
 
-  gCallExprs.add(this);
+  registerAST(gCallExprs, this);
 }
 
 
@@ -1334,7 +1334,7 @@ ContextCallExpr::ContextCallExpr() :
   options()
 {
   options.parent = this;
-  gContextCallExprs.add(this);
+  registerAST(gContextCallExprs, this);
 }
 
 ContextCallExpr*
@@ -1453,7 +1453,7 @@ ForallExpr::ForallExpr(Expr* indices,
   maybeArrayType(maybeArrayType),
   zippered(zippered)
 {
-  gForallExprs.add(this);
+  registerAST(gForallExprs, this);
 }
 
 ForallExpr* ForallExpr::copyInner(SymbolMap* map) {
@@ -1511,7 +1511,7 @@ NamedExpr::NamedExpr(const char* init_name, Expr* init_actual) :
   name(init_name),
   actual(init_actual)
 {
-  gNamedExprs.add(this);
+  registerAST(gNamedExprs, this);
 }
 
 
@@ -77,7 +77,7 @@ UseStmt::UseStmt(BaseAST* source):
     INT_FATAL(this, "Bad mod in UseStmt constructor");
   }
 
-  gUseStmts.add(this);
+  registerAST(gUseStmts, this);
 }
 
 //
@@ -117,7 +117,7 @@ UseStmt::UseStmt(BaseAST*                            source,
     }
   }
 
-  gUseStmts.add(this);
+  registerAST(gUseStmts, this);
 }
 
 
@@ -297,7 +297,7 @@ BlockStmt::BlockStmt(Expr* initBody, BlockTag initBlockTag) :
   if (initBody)
     body.insertAtTail(initBody);
 
-  gBlockStmts.add(this);
+  registerAST(gBlockStmts, this);
 }
 
 
@@ -784,7 +784,7 @@ CondStmt::CondStmt(Expr* iCondExpr, BaseAST* iThenStmt, BaseAST* iElseStmt) :
     }
   }
 
-  gCondStmts.add(this);
+  registerAST(gCondStmts, this);
 }
 
 Expr*
@@ -941,7 +941,7 @@ GotoStmt::GotoStmt(GotoTag init_gotoTag, const char* init_label) :
   label(init_label ? (Expr*)new UnresolvedSymExpr(init_label)
                    : (Expr*)new SymExpr(gNil))
 {
-  gGotoStmts.add(this);
+  registerAST(gGotoStmts, this);
 }
 
 
@@ -950,7 +950,7 @@ GotoStmt::GotoStmt(GotoTag init_gotoTag, Symbol* init_label) :
   gotoTag(init_gotoTag),
   label(new SymExpr(init_label))
 {
-  gGotoStmts.add(this);
+  registerAST(gGotoStmts, this);
 }
 
 
@@ -965,7 +965,7 @@ GotoStmt::GotoStmt(GotoTag init_gotoTag, Expr* init_label) :
   if (init_label->parentSymbol)
     INT_FATAL(this, "GotoStmt initialized with label already in tree");
 
-  gGotoStmts.add(this);
+  registerAST(gGotoStmts, this);
 }
 
 
@@ -1135,7 +1135,7 @@ ExternBlockStmt::ExternBlockStmt(const char* init_c_code) :
   Stmt(E_ExternBlockStmt),
   c_code(init_c_code)
 {
-  gExternBlockStmts.add(this);
+  registerAST(gExternBlockStmts, this);
 }
 
 void ExternBlockStmt::verify() {
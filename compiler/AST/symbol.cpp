@@ -297,6 +297,7 @@ bool Symbol::noDocGen() const {
 
 
 void Symbol::addSymExpr(SymExpr* se) {
+  lockAST();
 
   // MPF 2016-11-08: Consider not tracking SymExprs
   // that refer to Symbols that have an immediate.
@@ -317,9 +318,13 @@ void Symbol::addSymExpr(SymExpr* se) {
     symExprsTail = se;
     oldTail->symbolSymExprsNext = se;
   }
+
+  unlockAST();
 }
 
 void Symbol::removeSymExpr(SymExpr* se) {
+  lockAST();
+
   SymExpr*& prev = se->symbolSymExprsPrev;
   SymExpr*& next = se->symbolSymExprsNext;
   if (next)
@@ -334,6 +339,8 @@ void Symbol::removeSymExpr(SymExpr* se) {
 
   next = NULL;
   prev = NULL;
+
+  unlockAST();
 }
 
 
@@ -455,7 +462,7 @@ VarSymbol::VarSymbol(const char *init_name,
   llvmDIGlobalVariable(NULL),
   llvmDIVariable(NULL)
 {
-  gVarSymbols.add(this);
+  registerAST(gVarSymbols, this);
   if (type == dtUnknown || type->symbol == NULL) {
     this->qual = QUAL_UNKNOWN;
   } else if (type->symbol->hasFlag(FLAG_REF)) {
@@ -635,7 +642,7 @@ ArgSymbol::ArgSymbol(IntentTag iIntent, const char* iName,
     variableExpr = block;
   else
     variableExpr = new BlockStmt(iVariableExpr, BLOCK_SCOPELESS);
-  gArgSymbols.add(this);
+  registerAST(gArgSymbols, this);
 }
 
 
@@ -828,7 +835,7 @@ TypeSymbol::TypeSymbol(const char* init_name, Type* init_type) :
   if (!type)
     INT_FATAL(this, "TypeSymbol constructor called without type");
   type->addSymbol(this);
-  gTypeSymbols.add(this);
+  registerAST(gTypeSymbols, this);
 }
 
 
@@ -896,7 +903,7 @@ FnSymbol::FnSymbol(const char* initName) : Symbol(E_FnSymbol, initName) {
 
   substitutions.clear();
 
-  gFnSymbols.add(this);
+  registerAST(gFnSymbols, this);
 
   formals.parent = this;
 }
@@ -1735,7 +1742,7 @@ bool FnSymbol::throwsError() const {
 EnumSymbol::EnumSymbol(const char* init_name) :
   Symbol(E_EnumSymbol, init_name)
 {
-  gEnumSymbols.add(this);
+  registerAST(gEnumSymbols, this);
 }
 
 
@@ -1792,7 +1799,7 @@ ModuleSymbol::ModuleSymbol(const char* iName,
 {
   block->parentSymbol = this;
   registerModule(this);
-  gModuleSymbols.add(this);
+  registerAST(gModuleSymbols, this);
 }
 
 
@@ -2210,7 +2217,7 @@ LabelSymbol::LabelSymbol(const char* init_name) :
   Symbol(E_LabelSymbol, init_name, NULL),
   iterResumeGoto(NULL)
 {
-  gLabelSymbols.add(this);
+  registerAST(gLabelSymbols, this);
 }
 
 
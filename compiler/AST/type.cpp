@@ -102,7 +102,7 @@ PrimitiveType::PrimitiveType(Symbol *init, bool internalType) :
   Type(E_PrimitiveType, init)
 {
   isInternalType = internalType;
-  gPrimitiveTypes.add(this);
+  registerAST(gPrimitiveTypes, this);
 }
 
 
@@ -193,7 +193,7 @@ EnumType::EnumType() :
   constants(), integerType(NULL),
   doc(NULL)
 {
-  gEnumTypes.add(this);
+  registerAST(gEnumTypes, this);
   constants.parent = this;
 }
 
@@ -501,7 +501,7 @@ AggregateType::AggregateType(AggregateTag initTag) :
   methods.clear();
   fields.parent = this;
   inherits.parent = this;
-  gAggregateTypes.add(this);
+  registerAST(gAggregateTypes, this);
 }
 
 
@@ -318,7 +318,7 @@ genFinfo(std::vector<FnSymbol*> & fSymbols, bool isHeader) {
       if (!first)
         fprintf(hdrfile, ",\n");
       fprintf(hdrfile, "{\"%s\", %d, %d}", fn->cname,
-              getFilenameLookupPosition(fn->astloc.filename),
+              getFilenameLookupPosition(fn->astloc.filename()),
               fn->astloc.lineno);
       first = false;
     }
@@ -346,7 +346,7 @@ genFinfo(std::vector<FnSymbol*> & fSymbols, bool isHeader) {
       fields[0] = llvm::cast<llvm::GlobalVariable>
         (new_CStringSymbol(fn->cname)->codegen().val)->getInitializer();
       fields[1] = llvm::ConstantInt::get(int32Ty,
-                                         getFilenameLookupPosition(fn->astloc.filename));
+                                         getFilenameLookupPosition(fn->astloc.filename()));
       fields[2] = llvm::ConstantInt::get(int32Ty, fn->astloc.lineno);
       table[fID++] = llvm::ConstantStruct::get(structType, fields);
     }
@@ -527,6 +527,21 @@ static void genFilenameTable() {
   genGlobalInt32(sizeName, gFilenameLookup.size());
 }
 
+//
+// The functions in the unwind symbol tables, in table order.
+//
+static void getUnwindSymbols(std::vector<FnSymbol*>& symbols) {
+  //If CHPL_UNWIND is none we don't want any symbols in our tables
+  if(strcmp(CHPL_UNWIND, "none") != 0){
+    // Gets only user symbols
+    forv_Vec(FnSymbol, fn, gFnSymbols) {
+      if(strncmp(fn->cname, "chpl_", 5)) {
+        symbols.push_back(fn);
+      }
+    }
+  }
+}
+
 //
 // This adds the Chapel symbol table to the config file
 // Our symbol table is formed by two 1-D arrays with 2 elements
@@ -539,15 +554,7 @@ static void genUnwindSymbolTable(){
   GenInfo *info = gGenInfo;
   std::vector<FnSymbol*> symbols;
 
-  //If CHPL_UNWIND is none we don't want any symbols in our tables
-  if(strcmp(CHPL_UNWIND, "none") != 0){
-    // Gets only user symbols
-    forv_Vec(FnSymbol, fn, gFnSymbols) {
-      if(strncmp(fn->cname, "chpl_", 5)) {
-        symbols.push_back(fn);
-      }
-    }
-  }
+  getUnwindSymbols(symbols);
 
   //TODO: Could have a native LLVM version, instead of relying on C to LLVM
   if( info->cfile ) {
@@ -572,6 +579,107 @@ static void genUnwindSymbolTable(){
   genGlobalInt32("chpl_sizeSymTable", symbols.size() * 2);
 }
 
+//
+// The addresses of the functions in the unwind symbol table, one per
+// entry, so that the sampling profiler can map the instruction
+// pointers it collects to Chapel functions without looking up their
+// names.  This has to go with the function definitions rather than
+// in the config file, which is also compiled into the launcher.
+// Extern functions and ones we generate no code for get a null
+// entry, since their addresses cannot always be taken.
+//
+static bool hasUnwindAddr(FnSymbol* fn) {
+  return !fn->hasFlag(FLAG_EXTERN) && !fn->hasFlag(FLAG_NO_CODEGEN);
+}
+
+static void genUnwindAddrTable(bool isHeader) {
+  GenInfo *info = gGenInfo;
+  const char* table_name = "chpl_funAddrTable";
+
+  std::vector<FnSymbol*> symbols;
+
+  if( info->cfile ) {
+    FILE* hdrfile = info->cfile;
+    if(isHeader) {
+      fprintf(hdrfile, "extern chpl_fn_p %s[];\n", table_name);
+      return;
+    }
+
+    getUnwindSymbols(symbols);
+    fprintf(hdrfile, "chpl_fn_p %s[] = {\n", table_name);
+    for_vector(FnSymbol, fn, symbols) {
+      if (hasUnwindAddr(fn))
+        fprintf(hdrfile, "(chpl_fn_p)%s,\n", fn->cname);
+      else
+        fprintf(hdrfile, "(chpl_fn_p)0,\n");
+    }
+    fprintf(hdrfile, "(chpl_fn_p)0\n};\n");
+  } else {
+#ifdef HAVE_LLVM
+    if (!isHeader)
+      return;
+
+    getUnwindSymbols(symbols);
+
+    llvm::Type *funcPtrType = info->lvt->getType("chpl_fn_p");
+    std::vector<llvm::Constant *> table;
+
+    for_vector(FnSymbol, fn, symbols) {
+      if (hasUnwindAddr(fn)) {
+        llvm::Function *func = getFunctionLLVM(fn->cname);
+        table.push_back(llvm::cast<llvm::Constant>(
+            info->builder->CreatePointerCast(func, funcPtrType)));
+      } else {
+        table.push_back(llvm::Constant::getNullValue(funcPtrType));
+      }
+    }
+    table.push_back(llvm::Constant::getNullValue(funcPtrType));
+
+    llvm::ArrayType *tableType =
+      llvm::ArrayType::get(funcPtrType, table.size());
+
+    if(llvm::GlobalVariable *addrTable =
+        info->module->getNamedGlobal(table_name)) {
+      addrTable->eraseFromParent();
+    }
+
+    llvm::GlobalVariable *addrTable = llvm::cast<llvm::GlobalVariable>(
+        info->module->getOrInsertGlobal(table_name, tableType));
+    addrTable->setInitializer(llvm::ConstantArray::get(tableType, table));
+    addrTable->setConstant(true);
+    info->lvt->addGlobalValue(table_name, addrTable, GEN_PTR, true);
+#endif
+  }
+}
+
+//
+// Order two instantiations of the same function by the types of their
+// formals, so that the numbers uniquifyName() gives them do not depend on
+// the order in which function resolution happened to create them.  That
+// keeps the C for a module the same when an edit elsewhere adds or
+// removes an instantiation.
+//
+static int
+compareFormalTypes(Symbol* s1, Symbol* s2) {
+  FnSymbol* fn1 = toFnSymbol(s1);
+  FnSymbol* fn2 = toFnSymbol(s2);
+
+  if (fn1 == NULL || fn2 == NULL)
+    return 0;
+
+  if (fn1->numFormals() != fn2->numFormals())
+    return fn1->numFormals() < fn2->numFormals() ? -1 : 1;
+
+  for (int i = 1; i <= fn1->numFormals(); i++) {
+    int result = strcmp(fn1->getFormal(i)->type->symbol->cname,
+                        fn2->getFormal(i)->type->symbol->cname);
+    if (result)
+      return result;
+  }
+
+  return 0;
+}
+
 static bool
 compareSymbol(void* v1, void* v2) {
   Symbol* s1 = (Symbol*)v1;
@@ -592,6 +700,10 @@ compareSymbol(void* v1, void* v2) {
   int result = strcmp(s1->type->symbol->cname, s2->type->symbol->cname);
   if (!result)
     result = strcmp(s1->cname, s2->cname);
+  if (!result)
+    result = compareFormalTypes(s1, s2);
+  if (!result)
+    return s1->id < s2->id;
 
   return result < 0;
 }
@@ -892,10 +1004,13 @@ static void codegen_defn(std::set<const char*> & cnames, std::vector<TypeSymbol*
   genFtable(ftableVec, false);
   genFinfo(ftableVec, false);
 
+  genComment("Unwind address table");
+  genUnwindAddrTable(false);
+
   genComment("Virtual Method Table");
   genVirtualMethodTable(types, false);
 
-  if(fIncrementalCompilation) {
+  if(codegenSeparateCFiles()) {
     genComment("Global Variables");
     forv_Vec(VarSymbol, varSymbol, globals) {
       varSymbol->codegenGlobalDef(false);
@@ -1244,6 +1359,9 @@ static void codegen_header(std::set<const char*> & cnames, std::vector<TypeSymbo
   genFtable(ftableVec,true);
   genFinfo(ftableVec,true);
 
+  genComment("Unwind address table");
+  genUnwindAddrTable(true);
+
   genComment("Virtual Method Table");
   genVirtualMethodTable(types,true);
 
@@ -1538,6 +1656,110 @@ static const char* generateFileName(ChainHashMap<char*, StringHashFns, int>& fil
   return name;
 }
 
+bool codegenSeparateCFiles() {
+  return fIncrementalCompilation ||
+         ((fSplitCFiles > 0 || ccacheDir[0]) && !llvmCodegen);
+}
+
+//
+// Is the code for this module compiled on its own rather than being
+// #included into _main.c?  With --incremental, user modules are; with
+// --ccache-dir, every module is, so that the object files for modules
+// that have not changed can be reused.
+//
+static bool isSeparateModuleCFile(ModuleSymbol* mod) {
+  return (fIncrementalCompilation && mod->modTag == MOD_USER) ||
+         (ccacheDir[0] && fSplitCFiles == 0);
+}
+
+//
+// --split-c support.  The functions of all the modules are spread over
+// fSplitCFiles files of roughly the same size so that the back-end
+// compiler can compile them in parallel.  The size of a function is
+// estimated by the number of AST nodes in it.  Each function, biggest
+// first, goes to the file with the smallest total so far; within a
+// file, the functions keep the order they would have in one file.
+//
+struct SplitCost {
+  int cost;
+  int index;
+
+  bool operator<(const SplitCost& other) const {
+    if (cost != other.cost)
+      return cost > other.cost;
+    return index < other.index;
+  }
+};
+
+static int codegenCost(FnSymbol* fn) {
+  std::vector<BaseAST*> asts;
+
+  collect_asts(fn, asts);
+
+  return (int) asts.size();
+}
+
+static void codegenSplitCFiles(std::vector<fileinfo>& splitfiles) {
+  GenInfo*                info     = gGenInfo;
+  int                     numFiles = (int) splitfiles.size();
+  std::vector<FnSymbol*>  fns;
+  std::vector<SplitCost>  costs;
+  std::vector<int>        fileOf;
+  std::vector<long long>  fileCost(numFiles, 0);
+
+  forv_Vec(ModuleSymbol, currentModule, allModules) {
+    std::vector<FnSymbol*> modFns = currentModule->getFunctionsToCodegen();
+
+    fns.insert(fns.end(), modFns.begin(), modFns.end());
+  }
+
+  for (size_t i = 0; i < fns.size(); i++) {
+    SplitCost c = { codegenCost(fns[i]), (int) i };
+
+    costs.push_back(c);
+  }
+
+  std::sort(costs.begin(), costs.end());
+
+  fileOf.resize(fns.size());
+
+  for (size_t i = 0; i < costs.size(); i++) {
+    int smallest = 0;
+
+    for (int f = 1; f < numFiles; f++)
+      if (fileCost[f] < fileCost[smallest])
+        smallest = f;
+
+    fileOf[costs[i].index] = smallest;
+    fileCost[smallest]    += costs[i].cost;
+  }
+
+  for (int f = 0; f < numFiles; f++) {
+    mysystem(astr("# codegen-ing split file ", istr(f)),
+             "generating comment for --print-commands option");
+
+    info->cfile = splitfiles[f].fptr;
+    info->cStatements.clear();
+    info->cLocalDecls.clear();
+
+    fprintf(info->cfile, "#include \"chpl__header.h\"\n");
+
+    for (size_t i = 0; i < fns.size(); i++) {
+      if (fileOf[i] == f) {
+        ModuleSymbol* mod = fns[i]->getModule();
+
+        info->filename = mod->fname();
+        info->lineno   = mod->linenum();
+
+        fns[i]->codegenDef();
+      }
+    }
+
+    flushStatements();
+    closeCFile(&splitfiles[f]);
+  }
+}
+
 
 static bool
 shouldChangeArgumentTypeToRef(ArgSymbol* arg) {
@@ -1628,6 +1850,7 @@ void codegen(void) {
   fileinfo mainfile = { NULL, NULL, NULL };
   fileinfo defnfile = { NULL, NULL, NULL };
   fileinfo strconfig = { NULL, NULL, NULL };
+  std::vector<fileinfo> splitfiles;
 
   GenInfo* info     = gGenInfo;
 
@@ -1697,7 +1920,7 @@ void codegen(void) {
           // and no compile flags, since I can't figure out how to get that either.
           const char *current_dir = "./";
           const char *empty_string = "";
-          debug_info->create_compile_unit(currentModule->astloc.filename, current_dir, false, empty_string);
+          debug_info->create_compile_unit(currentModule->astloc.filename(), current_dir, false, empty_string);
           break;
         }
       }
@@ -1718,12 +1941,12 @@ void codegen(void) {
     fprintf(mainfile.fptr, "#include \"chpl__defn.c\"\n");
 
     std::vector<const char*> userFileName;
-    if(fIncrementalCompilation) {
+    if(fSplitCFiles == 0 && codegenSeparateCFiles()) {
       ChainHashMap<char*, StringHashFns, int> fileNameHashMap;
       forv_Vec(ModuleSymbol, currentModule, allModules) {
         const char* filename = NULL;
         filename = generateFileName(fileNameHashMap, filename, currentModule->name);
-        if(currentModule->modTag == MOD_USER) {
+        if(isSeparateModuleCFile(currentModule)) {
           fileinfo modulefile;
           openCFile(&modulefile, filename, "c");
           int modulePathLen = strlen(astr(modulefile.pathname));
@@ -1734,6 +1957,14 @@ void codegen(void) {
           closeCFile(&modulefile);
         }
       }
+    } else if (fSplitCFiles > 0) {
+      splitfiles.resize(fSplitCFiles);
+      for (int i = 0; i < fSplitCFiles; i++) {
+        const char* filename = astr("chpl__split", istr(i));
+
+        openCFile(&splitfiles[i], filename, "c");
+        userFileName.push_back(genIntermediateFilename(filename));
+      }
     }
 
     codegen_makefile(&mainfile, NULL, false, userFileName);
@@ -1779,24 +2010,28 @@ void codegen(void) {
       }
     }
 
-    ChainHashMap<char*, StringHashFns, int> fileNameHashMap;
-    forv_Vec(ModuleSymbol, currentModule, allModules) {
-      mysystem(astr("# codegen-ing module", currentModule->name),
-               "generating comment for --print-commands option");
-
-      const char* filename = NULL;
-      filename = generateFileName(fileNameHashMap, filename,currentModule->name);
-
-      fileinfo modulefile;
-      openCFile(&modulefile, filename, "c");
-      info->cfile = modulefile.fptr;
-      if(fIncrementalCompilation && (currentModule->modTag == MOD_USER))
-        fprintf(modulefile.fptr, "#include \"chpl__header.h\"\n");
-      currentModule->codegenDef();
-      closeCFile(&modulefile);
+    if (fSplitCFiles > 0) {
+      codegenSplitCFiles(splitfiles);
+    } else {
+      ChainHashMap<char*, StringHashFns, int> fileNameHashMap;
+      forv_Vec(ModuleSymbol, currentModule, allModules) {
+        mysystem(astr("# codegen-ing module", currentModule->name),
+                 "generating comment for --print-commands option");
 
-      if(!(fIncrementalCompilation && (currentModule->modTag == MOD_USER)))
-        fprintf(mainfile.fptr, "#include \"%s%s\"\n", filename, ".c");
+        const char* filename = NULL;
+        filename = generateFileName(fileNameHashMap, filename,currentModule->name);
+
+        fileinfo modulefile;
+        openCFile(&modulefile, filename, "c");
+        info->cfile = modulefile.fptr;
+        if(isSeparateModuleCFile(currentModule))
+          fprintf(modulefile.fptr, "#include \"chpl__header.h\"\n");
+        currentModule->codegenDef();
+        closeCFile(&modulefile);
+
+        if(!isSeparateModuleCFile(currentModule))
+          fprintf(mainfile.fptr, "#include \"%s%s\"\n", filename, ".c");
+      }
     }
 
     fprintf(strconfig.fptr, "#include \"chpl-string.h\"\n");
@@ -1830,6 +2065,11 @@ void makeBinary(void) {
 #endif
   } else {
     const char* makeflags = printSystemCommands ? "-f " : "-s -f ";
+
+    // Compile the files from --split-c at the same time.
+    if (fSplitCFiles > 0)
+      makeflags = astr("-j", istr(fSplitCFiles), " ", makeflags);
+
     const char* command = astr(astr(CHPL_MAKE, " "),
                                makeflags,
                                getIntermediateDirName(), "/Makefile");
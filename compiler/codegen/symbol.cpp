@@ -502,7 +502,7 @@ void VarSymbol::codegenDefC(bool global, bool isHeader) {
   //
   std::string str;
 
-  if(fIncrementalCompilation) {
+  if(codegenSeparateCFiles()) {
     bool addExtern =  global && isHeader;
     str = (addExtern ? "extern " : "") + typestr + " " + cname;
   } else {
@@ -1058,7 +1058,7 @@ void FnSymbol::codegenHeaderC(void) {
   if (fGenIDS)
     fprintf(outfile, "%s", idCommentTemp(this));
 
-  if (!fIncrementalCompilation && !hasFlag(FLAG_EXPORT) && !hasFlag(FLAG_EXTERN)) {
+  if (!codegenSeparateCFiles() && !hasFlag(FLAG_EXPORT) && !hasFlag(FLAG_EXTERN)) {
     fprintf(outfile, "static ");
   }
   fprintf(outfile, "%s", codegenFunctionType(true).c.c_str());
@@ -1335,15 +1335,8 @@ static int compareLineno(void* v1, void* v2) {
   return fn1->linenum() < fn2->linenum();
 }
 
-void ModuleSymbol::codegenDef() {
-  GenInfo* info = gGenInfo;
-
-  info->filename = fname();
-  info->lineno   = linenum();
-
-  info->cStatements.clear();
-  info->cLocalDecls.clear();
-
+// The functions defined in this module, in the order they are generated.
+std::vector<FnSymbol*> ModuleSymbol::getFunctionsToCodegen() {
   std::vector<FnSymbol*> fns;
 
   for_alist(expr, block->body) {
@@ -1359,6 +1352,20 @@ void ModuleSymbol::codegenDef() {
 
   std::sort(fns.begin(), fns.end(), compareLineno);
 
+  return fns;
+}
+
+void ModuleSymbol::codegenDef() {
+  GenInfo* info = gGenInfo;
+
+  info->filename = fname();
+  info->lineno   = linenum();
+
+  info->cStatements.clear();
+  info->cLocalDecls.clear();
+
+  std::vector<FnSymbol*> fns = getFunctionsToCodegen();
+
 #ifdef HAVE_LLVM
   if(debug_info && info->filename) {
     debug_info->get_module_scope(this);
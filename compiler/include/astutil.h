@@ -181,6 +181,11 @@ Expr* formal_to_actual(CallExpr* call, Symbol* formal);
 bool isTypeExpr(Expr* expr);
 
 Symbol* getSvecSymbol(CallExpr* call);
+
+// the keys of a SymbolMap in order of their ids, for iterating over the
+// map in an order that does not depend on where the symbols are in memory
+void sortedSymbolMapKeys(SymbolMap& map, std::vector<Symbol*>& keys);
+
 void collectUsedFnSymbols(BaseAST* ast, std::set<FnSymbol*>& fnSymbols);
 
 // move to resolve when scope resolution is put in resolution directory
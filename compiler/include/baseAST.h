@@ -37,6 +37,7 @@
 #include <string>
 
 #include "map.h"
+#include "parallelPasses.h"
 #include "vec.h"
 
 //
@@ -113,6 +114,18 @@ foreach_ast(proto_classes);
 foreach_ast(decl_gvecs);
 #undef decl_gvecs
 
+//
+// add a new node to its global vector, e.g. registerAST(gCallExprs, this);
+// during a parallel pass this waits until the threads are done
+//
+template <typename T>
+inline void registerAST(Vec<T*>& gvec, T* ast) {
+  if (parallelPassRunning)
+    deferAstRegistration(ast);
+  else
+    gvec.add(ast);
+}
+
 //
 // type definitions for common maps
 //
@@ -121,16 +134,53 @@ typedef MapElem<Symbol*,Symbol*> SymbolMapElem;
 
 // how an AST node knows its location in the source code
 // (assumed to get copied upon assignment and parameter passing)
+//
+// The filename is kept as an index into astlocFilenames so that an
+// astlocT, which every AST node carries, is only 8 bytes.
 class astlocT {
 public:
   astlocT(int linenoArg, const char* filenameArg) :
-    filename(filenameArg), lineno(linenoArg)
+    lineno(linenoArg), fileIndex(astlocFileIndex(filenameArg))
     {}
 
-  const char* filename;  // filename of location
+  const char* filename() const;
+  void        setFilename(const char* filenameArg);
+
   int         lineno;    // line number of location
+
+private:
+  static int  astlocFileIndex(const char* filename);
+
+  int         fileIndex; // index of the filename in astlocFilenames
 };
 
+// the filenames of all locations; index 0, for no filename, stands for
+// NULL and is not stored
+extern Vec<const char*> astlocFilenames;
+
+// the last filename looked up by astlocFileIndex() on this thread
+extern __thread const char* astlocLastFilename;
+extern __thread int         astlocLastFileIndex;
+
+int astlocAddFilename(const char* filename);
+
+inline int astlocT::astlocFileIndex(const char* filename) {
+  if (filename == NULL)
+    return 0;
+  else if (filename == astlocLastFilename)
+    return astlocLastFileIndex;
+  else
+    return astlocAddFilename(filename);
+}
+
+inline const char* astlocT::filename() const {
+  return fileIndex == 0 ? NULL : astlocFilenames.v[fileIndex - 1];
+}
+
+inline void astlocT::setFilename(const char* filenameArg) {
+  fileIndex = astlocFileIndex(filenameArg);
+}
+
 //
 // enumerated type of all AST node types
 //
@@ -250,6 +300,10 @@ public:
 
   static  const       std::string tabText;
 
+  // AST nodes are allocated from an arena, see baseAST.cpp
+  static  void*       operator new(size_t size);
+  static  void        operator delete(void* ptr, size_t size);
+
 protected:
                     BaseAST(AstTag type);
   virtual          ~BaseAST();
@@ -267,6 +321,14 @@ GenRet baseASTCodegenString(const char* str);
 // get the current AST node id
 int    lastNodeIDUsed();
 
+// reserve n consecutive AST node ids and return the first
+int    reserveNodeIDs(int n);
+
+// make next the id of the next node created, and give ast the next id
+// (used to renumber the nodes created by a parallel pass)
+void   resetNodeIDs(int next);
+void   renumberNodeID(BaseAST* ast);
+
 // trace various AST node removals
 void   trace_remove(BaseAST* ast, char flag);
 
@@ -287,6 +349,10 @@ void   trace_remove(BaseAST* ast, char flag);
 
 extern astlocT currentAstLoc;
 
+// the location set by SET_LINENO on a thread of a parallel pass
+extern __thread const char* threadAstLocFilename;
+extern __thread int         threadAstLocLineno;
+
 class astlocMarker {
 public:
   astlocMarker(astlocT newAstLoc);
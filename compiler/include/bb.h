@@ -34,7 +34,9 @@ class SymExpr;
 #include <set>
 
 // Each basic block contains a list of expressions, in and out edges and an index.
-// The goto and label maps persist only between calls to buildBasicBlocks.
+// The goto and label maps live only during a call to buildBasicBlocks.
+// The builder state is kept per thread so that passes run by
+// forallFunctions() can build basic blocks concurrently.
 class BasicBlock
 {
   //
@@ -89,9 +91,9 @@ public:
   static void        printBitVectorSets(BitVecVector& sets);
 
 
-  static BasicBlock*                          basicBlock;
-  static Map<LabelSymbol*, BasicBlock*>       labelMaps;
-  static Map<LabelSymbol*, BasicBlockVector*> gotoMaps;
+  static __thread BasicBlock*                          basicBlock;
+  static __thread Map<LabelSymbol*, BasicBlock*>*      labelMaps;
+  static __thread Map<LabelSymbol*, BasicBlockVector*>* gotoMaps;
 
 private:
   static void        buildBasicBlocks(FnSymbol* fn,
@@ -108,7 +110,7 @@ private:
   static void        removeEmptyBlocks(FnSymbol* fn);
   static bool        verifyBasicBlocks(FnSymbol* fn);
 
-  static int         nextID;
+  static __thread int nextID;
 
   //
   // Instance methods/variables
@@ -156,6 +156,10 @@ void setupClang(GenInfo* info, std::string rtmain);
 
 bool isBuiltinExternCFunction(const char* cname);
 
+// True if the generated C code is compiled as more than one translation
+// unit, so module-level functions and variables need external linkage.
+bool codegenSeparateCFiles();
+
 std::string numToString(int64_t num);
 std::string int64_to_string(int64_t i);
 std::string uint64_to_string(uint64_t i);
@@ -104,6 +104,7 @@ extern const char* CHPL_UNWIND;
 
 extern bool  printPasses;
 extern FILE* printPassesFile;
+extern FILE* printPassStatsFile;
 
 // Set true if CHPL_WIDE_POINTERS==struct.
 // In that case, the code generator emits structures
@@ -139,6 +140,9 @@ extern bool llvmCodegen;
 // Is the cache for remote data enabled?
 extern bool fCacheRemote;
 
+// Should forall and coforall loops in user code be instrumented?
+extern bool fInstrumentLoops;
+
 // externC allows blocks like extern { } to be parsed
 // with clang and then added to the enclosing module's scope
 extern bool externC;
@@ -200,6 +204,13 @@ extern bool fMinimalModules;
 // Set to true if we want to enable incremental compilation.
 extern bool fIncrementalCompilation;
 
+// If not 0, the number of C files to split the generated functions into
+// so they can be compiled in parallel.
+extern int fSplitCFiles;
+
+// The number of threads to run function-local optimizations on.
+extern int fCompilerThreads;
+
 // Set to true if we want to use the experimental
 // Interactive Programming Environment (IPE) mode.
 extern bool fUseIPE;
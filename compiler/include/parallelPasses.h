@@ -0,0 +1,59 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _PARALLEL_PASSES_H_
+#define _PARALLEL_PASSES_H_
+
+class BaseAST;
+class FnSymbol;
+
+//
+// Support for running the per-function part of a pass on several
+// threads.
+//
+// forallFunctions(body) calls body(fn) for each function in gFnSymbols,
+// spread over --compiler-threads threads.  With a single thread it is a
+// plain loop.  A body may change its own function
+// freely; the shared structures it may touch in passing are protected:
+//
+//   - astr() and the lists of SymExprs kept by each Symbol are locked,
+//   - new AST nodes take temporary ids from a block reserved per
+//     thread.  When all the threads are done they are renumbered and
+//     added to gSymExprs, gCallExprs, ... function by function in
+//     gFnSymbols order, so the result is the same as with one thread.
+//     The bodies must not walk those vectors, nor keep the id of a new
+//     node after the pass,
+//   - SET_LINENO sets a location for the current thread only.
+//
+// Anything else that is shared, e.g. a Vec owned by the pass, must be
+// updated between lockAST() and unlockAST().
+//
+void forallFunctions(void (*body)(FnSymbol* fn));
+
+// true while forallFunctions() is running the bodies
+extern bool parallelPassRunning;
+
+void lockAST();
+void unlockAST();
+
+// Used by BaseAST while parallelPassRunning is true.
+int  workerAstId();
+void deferAstRegistration(BaseAST* ast);
+
+#endif
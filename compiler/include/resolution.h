@@ -39,6 +39,10 @@ extern std::map<CallExpr*,CallExpr*> eflopiMap;
 
 FnSymbol* expandVarArgs(FnSymbol* origFn, int numActuals);
 
+// counts of the work done by function resolution, for --print-pass-stats
+extern int resolveNumInstantiations; // generic functions instantiated
+extern int resolveNumCandidates;     // candidate functions considered
+
 // explain call stuff
 extern int explainCallLine;
 bool explainCallMatch(CallExpr* call);
@@ -100,12 +104,10 @@ class VisibleFunctionBlock {
 extern Map<BlockStmt*,VisibleFunctionBlock*> visibleFunctionMap;
 extern int nVisibleFunctions; // for incremental build
 void buildVisibleFunctionMap();
-BlockStmt*
-getVisibleFunctions(BlockStmt* block,
-                    const char* name,
-                    Vec<FnSymbol*>& visibleFns,
-                    Vec<BlockStmt*>& visited,
-                    CallExpr* callOrigin);
+void findVisibleFunctions(BlockStmt* block,
+                          const char* name,
+                          CallExpr* callOrigin,
+                          Vec<FnSymbol*>& visibleFns);
 
 // disambiguation
 /** A wrapper for candidates for function call resolution.
@@ -577,6 +577,8 @@ public:
   Vec<FnSymbol*>       getTopLevelFunctions(bool includeExterns);
   Vec<ModuleSymbol*>   getTopLevelModules();
 
+  std::vector<FnSymbol*> getFunctionsToCodegen();
+
   void                 addDefaultUses();
   void                 moduleUseAdd(ModuleSymbol* module);
   void                 moduleUseRemove(ModuleSymbol* module);
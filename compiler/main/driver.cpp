@@ -93,6 +93,7 @@ bool ignore_warnings = false;
 int fcg = 0;
 static bool fBaseline = false;
 bool fCacheRemote = false;
+bool fInstrumentLoops = false;
 bool fFastFlag = false;
 int fConditionalDynamicDispatchLimit = 0;
 bool fUseNoinit = true;
@@ -120,8 +121,9 @@ bool fNoCastChecks = false;
 bool fMungeUserIdents = true;
 bool fEnableTaskTracking = false;
 
-bool  printPasses     = false;
-FILE* printPassesFile = NULL;
+bool  printPasses        = false;
+FILE* printPassesFile    = NULL;
+FILE* printPassStatsFile = NULL;
 
 // flag for llvmWideOpt
 bool fLLVMWideOpt = false;
@@ -141,6 +143,8 @@ bool fNoRemoveEmptyRecords = true;
 bool fRemoveUnreachableBlocks = true;
 bool fMinimalModules = false;
 bool fIncrementalCompilation = false;
+int  fSplitCFiles = 0;
+int  fCompilerThreads = 1;
 bool fUseIPE         = false;
 
 int optimize_on_clause_limit = 20;
@@ -562,6 +566,11 @@ static void setCacheEnable(const ArgumentDescription* desc, const char* unused)
   parseCmdLineConfig("CHPL_CACHE_REMOTE", val);
 }
 
+static void setInstrumentLoops(const ArgumentDescription* desc, const char* unused) {
+  const char *val = fInstrumentLoops ? "true" : "false";
+  parseCmdLineConfig("CHPL_INSTRUMENT_LOOPS", val);
+}
+
 static void setHtmlUser(const ArgumentDescription* desc, const char* unused) {
   fdump_html = true;
   fdump_html_include_system_modules = false;
@@ -595,6 +604,14 @@ static void setPrintPassesFile(const ArgumentDescription* desc, const char* file
   }
 }
 
+static void setPrintPassStatsFile(const ArgumentDescription* desc, const char* fileName) {
+  printPassStatsFile = fopen(fileName, "w");
+
+  if (printPassStatsFile == NULL) {
+    USR_WARN("Error opening printPassStatsFile: %s.", fileName);
+  }
+}
+
 static void setLocal (const ArgumentDescription* desc, const char* unused) {
   // Used in postLocal() to set fLocal if user threw flag
   fUserSetLocal = true;
@@ -683,8 +700,10 @@ static ArgumentDescription arg_desc[] = {
  {"max-c-ident-len", ' ', NULL, "Maximum length of identifiers in generated code, 0 for unlimited", "I", &fMaxCIdentLen, "CHPL_MAX_C_IDENT_LEN", NULL},
  {"munge-user-idents", ' ', NULL, "[Don't] Munge user identifiers to avoid naming conflicts with external code", "N", &fMungeUserIdents, "CHPL_MUNGE_USER_IDENTS"},
  {"savec", ' ', "<directory>", "Save generated C code in directory", "P", saveCDir, "CHPL_SAVEC_DIR", verifySaveCDir},
+ {"split-c", ' ', "<n>", "Split generated C code into <n> files compiled in parallel, 0 for one file", "I", &fSplitCFiles, "CHPL_SPLIT_C", NULL},
 
  {"", ' ', NULL, "C Code Compilation Options", NULL, NULL, NULL, NULL},
+ {"ccache-dir", ' ', "<directory>", "Reuse object files for unchanged generated code from directory", "P", ccacheDir, "CHPL_CCACHE_DIR", NULL},
  {"ccflags", ' ', "<flags>", "Back-end C compiler flags (can be specified multiple times)", "S", NULL, "CHPL_CC_FLAGS", setCCFlags},
  {"debug", 'g', NULL, "[Don't] Support debugging of generated C code", "N", &debugCCode, "CHPL_DEBUG", setChapelDebug},
  {"dynamic", ' ', NULL, "Generate a dynamically linked binary", "F", &fLinkStyle, NULL, setDynamicLink},
@@ -705,6 +724,7 @@ static ArgumentDescription arg_desc[] = {
  {"print-commands", ' ', NULL, "[Don't] print system commands", "N", &printSystemCommands, "CHPL_PRINT_COMMANDS", NULL},
  {"print-passes", ' ', NULL, "[Don't] print compiler passes", "N", &printPasses, "CHPL_PRINT_PASSES", NULL},
  {"print-passes-file", ' ', "<filename>", "Print compiler passes to <filename>", "S", NULL, "CHPL_PRINT_PASSES_FILE", setPrintPassesFile},
+ {"print-pass-stats", ' ', "<filename>", "Print per-pass time, memory and AST statistics to <filename> as CSV", "S", NULL, "CHPL_PRINT_PASS_STATS", setPrintPassStatsFile},
 
  {"", ' ', NULL, "Miscellaneous Options", NULL, NULL, NULL, NULL},
 // Support for extern { c-code-here } blocks could be toggled with this
@@ -715,6 +735,7 @@ static ArgumentDescription arg_desc[] = {
  {"explain-instantiation", ' ', "<function|type>[:<module>][:<line>]", "Explain instantiation of type", "S256", fExplainInstantiation, NULL, NULL},
  {"explain-verbose", ' ', NULL, "Enable [disable] tracing of disambiguation with 'explain' options", "N", &fExplainVerbose, "CHPL_EXPLAIN_VERBOSE", NULL},
  {"instantiate-max", ' ', "<max>", "Limit number of instantiations", "I", &instantiation_limit, "CHPL_INSTANTIATION_LIMIT", NULL},
+ {"instrument-loops", ' ', NULL, "Count iterations and time tasks of forall and coforall loops", "F", &fInstrumentLoops, "CHPL_INSTRUMENT_LOOPS", setInstrumentLoops},
  {"print-callgraph", ' ', NULL, "Print a representation of the callgraph for the program", "N", &fPrintCallGraph, "CHPL_PRINT_CALLGRAPH", NULL},
  {"print-callstack-on-error", ' ', NULL, "print the Chapel call stack leading to each error or warning", "N", &fPrintCallStackOnError, "CHPL_PRINT_CALLSTACK_ON_ERROR", NULL},
  {"set", 's', "<name>[=<value>]", "Set config param value", "S", NULL, NULL, readConfig},
@@ -794,6 +815,7 @@ static ArgumentDescription arg_desc[] = {
  {"default-dist", ' ', "<distribution>", "Change the default distribution", "S256", defaultDist, "CHPL_DEFAULT_DIST", NULL},
  {"explain-call-id", ' ', "<call-id>", "Explain resolution of call by ID", "I", &explainCallID, NULL, NULL},
  {"break-on-resolve-id", ' ', NULL, "Break when function call with AST id is resolved", "I", &breakOnResolveID, "CHPL_BREAK_ON_RESOLVE_ID", NULL},
+ {"compiler-threads", ' ', "<n>", "Run function-local optimizations on <n> threads", "I", &fCompilerThreads, "CHPL_COMPILER_THREADS", NULL},
  {"denormalize", ' ', NULL, "Enable [disable] denormalization", "N", &fDenormalize, "CHPL_DENORMALIZE", NULL},
  DRIVER_ARG_DEBUGGERS,
  {"heterogeneous", ' ', NULL, "Compile for heterogeneous nodes", "F", &fHeterogeneous, "", NULL},
@@ -1059,6 +1081,21 @@ static void checkIncrementalAndOptimized() {
               " using -O optimizations directly.");
 }
 
+static void checkSplitCFiles() {
+  if (fSplitCFiles < 0)
+    USR_FATAL("--split-c must be given a non-negative number of files");
+
+  if (fSplitCFiles > 0 && fIncrementalCompilation) {
+    USR_WARN("--split-c is ignored when compiling with --incremental");
+    fSplitCFiles = 0;
+  }
+}
+
+static void checkCompilerThreads() {
+  if (fCompilerThreads < 1)
+    USR_FATAL("--compiler-threads must be given a positive number of threads");
+}
+
 static void postprocess_args() {
   // Processes that depend on results of passed arguments or values of CHPL_vars
 
@@ -1081,6 +1118,10 @@ static void postprocess_args() {
   checkTargetArch();
 
   checkIncrementalAndOptimized();
+
+  checkSplitCFiles();
+
+  checkCompilerThreads();
 }
 
 int main(int argc, char* argv[]) {
@@ -1164,6 +1205,10 @@ int main(int argc, char* argv[]) {
     fclose(printPassesFile);
   }
 
+  if (printPassStatsFile != NULL) {
+    fclose(printPassStatsFile);
+  }
+
   clean_exit(0);
 
   return 0;
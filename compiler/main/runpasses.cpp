@@ -23,9 +23,12 @@
 #include "log.h"           // For LOG_<passname> #defines.
 #include "passes.h"        // For pass function prototypes.
 #include "PhaseTracker.h"
+#include "resolution.h"    // For the counts in --print-pass-stats.
 
 #include <cstdio>
+#include <sys/resource.h>
 #include <sys/time.h>
+#include <unistd.h>
 
 int   currentPassNo   = 1;
 
@@ -159,6 +162,8 @@ static PassInfo sPassList[] = {
 
 static void runPass(PhaseTracker& tracker, size_t passIndex, bool isChpldoc);
 
+static void printPassStatsHeader();
+
 void runPasses(PhaseTracker& tracker, bool isChpldoc) {
   size_t passListSize = sizeof(sPassList) / sizeof(sPassList[0]);
 
@@ -168,6 +173,10 @@ void runPasses(PhaseTracker& tracker, bool isChpldoc) {
     tracker.ReportPass();
   }
 
+  if (printPassStatsFile != NULL) {
+    printPassStatsHeader();
+  }
+
   for (size_t i = 0; i < passListSize; i++) {
     runPass(tracker, i, isChpldoc);
 
@@ -190,8 +199,114 @@ void runPasses(PhaseTracker& tracker, bool isChpldoc) {
   teardownLogfiles();
 }
 
+/************************************* | **************************************
+*                                                                             *
+* --print-pass-stats writes a CSV line for each pass with                     *
+*   - the wall time of the pass, including its check and cleanAst(),          *
+*   - the resident set size after the pass, its change over the pass and     *
+*     the peak so far, in KiB,                                                *
+*   - the number of generic instantiations and of candidate functions         *
+*     considered by function resolution during the pass, and                  *
+*   - the number of live AST nodes of each type after the pass.               *
+*                                                                             *
+************************************** | *************************************/
+
+struct PassStats {
+  double seconds;
+  long   rssKB;
+  int    numInstantiations;
+  int    numCandidates;
+};
+
+static double wallSeconds() {
+  struct timeval now;
+
+  gettimeofday(&now, NULL);
+
+  return now.tv_sec + now.tv_usec / 1e6;
+}
+
+// The current resident set size in KiB, or 0 if it is not known.
+static long residentSetKB() {
+  long  retval = 0;
+  FILE* statm  = fopen("/proc/self/statm", "r");
+
+  if (statm != NULL) {
+    long size     = 0;
+    long resident = 0;
+
+    if (fscanf(statm, "%ld %ld", &size, &resident) == 2) {
+      retval = resident * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+
+    fclose(statm);
+  }
+
+  return retval;
+}
+
+// The peak resident set size in KiB.
+static long maxResidentSetKB() {
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+static void startPassStats(PassStats& stats) {
+  stats.seconds           = wallSeconds();
+  stats.rssKB             = residentSetKB();
+  stats.numInstantiations = resolveNumInstantiations;
+  stats.numCandidates     = resolveNumCandidates;
+}
+
+static void printPassStatsHeader() {
+  fprintf(printPassStatsFile,
+          "pass,seconds,rss_kb,rss_delta_kb,max_rss_kb,"
+          "instantiations,candidates");
+
+#define print_pass_stats_name(type)                     \
+  fprintf(printPassStatsFile, ",%s", #type)
+
+  foreach_ast(print_pass_stats_name);
+
+  fprintf(printPassStatsFile, "\n");
+}
+
+static void printPassStats(const char* name, PassStats& start) {
+  long rssKB = residentSetKB();
+
+  fprintf(printPassStatsFile,
+          "%s,%.3f,%ld,%ld,%ld,%d,%d",
+          name,
+          wallSeconds() - start.seconds,
+          rssKB,
+          rssKB - start.rssKB,
+          maxResidentSetKB(),
+          resolveNumInstantiations - start.numInstantiations,
+          resolveNumCandidates     - start.numCandidates);
+
+#define print_pass_stats_count(type)                    \
+  fprintf(printPassStatsFile, ",%d", g##type##s.n)
+
+  foreach_ast(print_pass_stats_count);
+
+  fprintf(printPassStatsFile, "\n");
+  fflush(printPassStatsFile);
+}
+
 static void runPass(PhaseTracker& tracker, size_t passIndex, bool isChpldoc) {
   PassInfo* info = &sPassList[passIndex];
+  PassStats stats = PassStats();
+
+  if (printPassStatsFile != NULL) {
+    startPassStats(stats);
+  }
 
   //
   // The primary work for this pass
@@ -232,6 +347,10 @@ static void runPass(PhaseTracker& tracker, size_t passIndex, bool isChpldoc) {
     cleanAst();
   }
 
+  if (printPassStatsFile != NULL) {
+    printPassStats(info->name, stats);
+  }
+
   if (printPasses == true || printPassesFile != 0) {
     tracker.ReportPass();
   }
@@ -25,6 +25,7 @@
 #include "bb.h"
 #include "bitVec.h"
 #include "expr.h"
+#include "parallelPasses.h"
 #include "passes.h"
 #include "stlUtil.h"
 #include "stmt.h"
@@ -126,8 +127,10 @@
 //#############################################################################
 
 
-static size_t s_repl_count; ///< The number of pairs replaced by GCP this pass.
-static size_t s_ref_repl_count; ///< The number of references replaced this pass.
+// These are per thread, since copyPropagation() works on several
+// functions at once.
+static __thread size_t s_repl_count; ///< The number of pairs replaced by GCP this pass.
+static __thread size_t s_ref_repl_count; ///< The number of references replaced this pass.
 
 
 //#############################################################################
@@ -1450,26 +1453,29 @@ size_t singleAssignmentRefPropagation(FnSymbol* fn) {
 }
 
 
-void copyPropagation(void) {
-  if (!fNoCopyPropagation) {
-    forv_Vec(FnSymbol, fn, gFnSymbols)
-    {
-      // This test is necessary because extern function stubs may contain
-      // _construct_tuple calls that are unresolved.
-      if (fn->hasFlag(FLAG_EXTERN))
-        continue;
+static void copyPropagationFn(FnSymbol* fn) {
+  // This test is necessary because extern function stubs may contain
+  // _construct_tuple calls that are unresolved.
+  if (fn->hasFlag(FLAG_EXTERN))
+    return;
 
-      localCopyPropagation(fn);
-      if (!fNoDeadCodeElimination)
-        deadVariableElimination(fn);
+  localCopyPropagation(fn);
+  if (!fNoDeadCodeElimination)
+    deadVariableElimination(fn);
 
-      // Iterate GCP with dead code elimination.
-      while (globalCopyPropagation(fn) > 0)
-      {
-        if (!fNoDeadCodeElimination)
-          deadVariableElimination(fn);
-      }
-    }
+  // Iterate GCP with dead code elimination.
+  while (globalCopyPropagation(fn) > 0)
+  {
+    if (!fNoDeadCodeElimination)
+      deadVariableElimination(fn);
+  }
+}
+
+void copyPropagation(void) {
+  if (!fNoCopyPropagation) {
+    // Each function only refers to the symbols it declares, or (without
+    // looking at their other uses) to global ones.
+    forallFunctions(copyPropagationFn);
   }
 }
 
@@ -78,12 +78,20 @@ static bool isDeadVariable(Symbol* var) {
   }
 }
 
+//
+// The variables are visited from the last declared to the first, so
+// that removing a dead temporary's definition also lets the temporaries
+// it read be removed.  Visiting them in a fixed order keeps the result
+// from depending on where the symbols are in memory.
+//
 void deadVariableElimination(FnSymbol* fn) {
-  Vec<Symbol*> symSet;
-  collectSymbolSet(fn, symSet);
+  std::vector<DefExpr*> defExprs;
+  collectDefExprs(fn, defExprs);
 
-  forv_Vec(Symbol, sym, symSet)
+  for (size_t i = defExprs.size(); i-- > 0; )
   {
+    Symbol* sym = defExprs[i]->sym;
+
     // We're interested only in VarSymbols.
     if (!isVarSymbol(sym))
       continue;
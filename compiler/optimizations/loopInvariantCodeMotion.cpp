@@ -26,6 +26,7 @@
 #include "dominator.h"
 #include "expr.h"
 #include "ForLoop.h"
+#include "parallelPasses.h"
 #include "ParamForLoop.h"
 #include "stlUtil.h"
 #include "stmt.h"
@@ -109,23 +110,22 @@ public:
       delete bitExits;
     }
 
-    // This function exists to place an expr in the
-    // "preheader" of the loop,
-    void insertBefore(Expr* expr) {
+    // This function finds the statement to place an expr before to put
+    // it in the "preheader" of the loop, or returns NULL
+    Expr* preheader() {
       if (header->exprs.size() != 0) {
         // find the first expr in the header, and get it's parent expr (for
         // most cases it will be the surrounding block statement of the loop)
         if (BlockStmt* blockStmt = toBlockStmt(header->exprs.at(0)->parentExpr)) {
           if (blockStmt->isLoopStmt()) {
-            blockStmt->insertBefore(expr->remove());
+            return blockStmt;
 
           } else if (blockStmt->blockTag == BLOCK_C_FOR_LOOP) {
-            CForLoop* cforLoop = CForLoop::loopForClause(blockStmt);
-
-            cforLoop->insertBefore(expr->remove());
+            return CForLoop::loopForClause(blockStmt);
           }
         }
       }
+      return NULL;
     }
 
     //Set the header, and insert the header into the loop blocks
@@ -206,6 +206,15 @@ public:
 typedef std::vector<BasicBlock*> BasicBlocks;
 typedef std::map<Symbol*,std::vector<SymExpr*>*> symToVecSymExprMap;
 
+//An invariant and the statement to hoist it in front of
+typedef std::pair<CallExpr*, Expr*> Hoist;
+
+//The invariants found in each function. They are only moved once all of the
+//functions have been looked at, since looking at a function can mean looking
+//into the functions it calls, which may be done on another thread.
+static std::map<FnSymbol*, std::vector<Hoist> > hoistsByFn;
+static long numLoops = 0;
+
 //These two functions are used to collect all natural loops from a bunch of basic blocks and ensure the loops are stored 
 //from most nested to least nested for any give loop nest 
 void collectNaturalLoops(std::vector<Loop*>& loops, BasicBlocks& basicBlocks, BasicBlock* entryBlock, std::vector<BitVec*>& dominators);
@@ -1107,6 +1116,95 @@ static bool canPerformCodeMotion(Loop* loop) {
  * hoisted before the loop(into a preheader of sorts) so long as they definition dominates
  * all uses in the loop, and the block that the definition is located in dominates all exits. 
  */
+static void findLoopInvariants(FnSymbol* fn) {
+  std::vector<Hoist> hoists;
+
+  //build the basic blocks, where the first bb is the entry block 
+  startTimer(buildBBTimer);
+
+  BasicBlock::buildBasicBlocks(fn);
+
+  std::vector<BasicBlock*> basicBlocks = *fn->basicBlocks;
+
+  BasicBlock* entryBlock = basicBlocks[0];
+
+  unsigned nBlocks = basicBlocks.size();
+
+  stopTimer(buildBBTimer);
+  
+  //compute the dominators 
+  startTimer(computeDominatorTimer);
+  std::vector<BitVec*> dominators;
+  for(unsigned i = 0; i < nBlocks; i++) {
+    dominators.push_back(new BitVec(nBlocks));
+  }    
+  computeDominators(dominators, basicBlocks);
+  stopTimer(computeDominatorTimer);
+
+  //Collect all of the loops 
+  startTimer(collectNaturalLoopsTimer);
+  std::vector<Loop*> loops;
+  collectNaturalLoops(loops, basicBlocks, entryBlock, dominators);
+  stopTimer(collectNaturalLoopsTimer);
+  
+  //For each loop found 
+  for_vector(Loop, curLoop, loops) {
+
+    //check that this loop doesn't have anything that 
+    //would prevent code motion from occurring
+    startTimer(canPerformCodeMotionTimer);
+    bool performCodeMotion = canPerformCodeMotion(curLoop);
+    stopTimer(canPerformCodeMotionTimer);
+    if(performCodeMotion == false) {
+      continue;
+    }
+    
+    //build the defUseMaps 
+    startTimer(buildLocalDefMapsTimer);
+    symToVecSymExprMap localDefMap;
+    symToVecSymExprMap localUseMap;
+    std::map<SymExpr*, int> localMap;
+    buildLocalDefUseMaps(curLoop, localDefMap, localUseMap, localMap);
+    stopTimer(buildLocalDefMapsTimer);
+
+    //and use the defUseMaps to compute loop invariants 
+    startTimer(computeLoopInvariantsTimer);
+    std::vector<SymExpr*> loopInvariants;
+    computeLoopInvariants(loopInvariants, curLoop, localDefMap, fn);
+    stopTimer(computeLoopInvariantsTimer);
+
+    //For each invariant, only move it if its def, dominates all uses and all exits 
+    for_vector(SymExpr, symExpr, loopInvariants) {
+      if(CallExpr* call = toCallExpr(symExpr->parentExpr)) {
+        if(defDominatesAllUses(curLoop, symExpr, dominators, localMap, localUseMap)) {
+          if(defDominatesAllExits(curLoop, symExpr, dominators, localMap)) {
+            if (Expr* preheader = curLoop->preheader()) {
+              hoists.push_back(Hoist(call, preheader));
+            }
+          }
+        }   
+      }
+    }
+              
+    freeLocalDefUseMaps(localDefMap, localUseMap);
+  }
+
+  lockAST();
+  numLoops += loops.size();
+  hoistsByFn[fn].swap(hoists);
+  unlockAST();
+  
+  for_vector(Loop, loop, loops) {
+    delete loop;
+    loop = 0;
+  }
+  
+  for_vector(BitVec, bitVec, dominators) {
+    delete bitVec;
+    bitVec = 0;
+  }
+}
+
 void loopInvariantCodeMotion(void) {
 
   if(fNoloopInvariantCodeMotion) {
@@ -1114,91 +1212,25 @@ void loopInvariantCodeMotion(void) {
   }
   
   startTimer(overallTimer);
-  long numLoops = 0;
-    
-  //TODO use stl routine here
-  forv_Vec(FnSymbol, fn, gFnSymbols) {
+  numLoops = 0;
 
-    //build the basic blocks, where the first bb is the entry block 
-    startTimer(buildBBTimer);
+  forallFunctions(findLoopInvariants);
 
-    BasicBlock::buildBasicBlocks(fn);
-
-    std::vector<BasicBlock*> basicBlocks = *fn->basicBlocks;
-
-    BasicBlock* entryBlock = basicBlocks[0];
+  //Move the invariants, in the order they were found
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    std::map<FnSymbol*, std::vector<Hoist> >::iterator it = hoistsByFn.find(fn);
 
-    unsigned nBlocks = basicBlocks.size();
+    if (it != hoistsByFn.end()) {
+      std::vector<Hoist>& hoists = it->second;
 
-    stopTimer(buildBBTimer);
-    
-    //compute the dominators 
-    startTimer(computeDominatorTimer);
-    std::vector<BitVec*> dominators;
-    for(unsigned i = 0; i < nBlocks; i++) {
-      dominators.push_back(new BitVec(nBlocks));
-    }    
-    computeDominators(dominators, basicBlocks);
-    stopTimer(computeDominatorTimer);
-
-    //Collect all of the loops 
-    startTimer(collectNaturalLoopsTimer);
-    std::vector<Loop*> loops;
-    collectNaturalLoops(loops, basicBlocks, entryBlock, dominators);
-    stopTimer(collectNaturalLoopsTimer);
-    
-    //For each loop found 
-    for_vector(Loop, curLoop, loops) {
-
-      //check that this loop doesn't have anything that 
-      //would prevent code motion from occurring
-      startTimer(canPerformCodeMotionTimer);
-      bool performCodeMotion = canPerformCodeMotion(curLoop);
-      stopTimer(canPerformCodeMotionTimer);
-      if(performCodeMotion == false) {
-        continue;
-      }
-      
-      //build the defUseMaps 
-      startTimer(buildLocalDefMapsTimer);
-      symToVecSymExprMap localDefMap;
-      symToVecSymExprMap localUseMap;
-      std::map<SymExpr*, int> localMap;
-      buildLocalDefUseMaps(curLoop, localDefMap, localUseMap, localMap);
-      stopTimer(buildLocalDefMapsTimer);
-
-      //and use the defUseMaps to compute loop invariants 
-      startTimer(computeLoopInvariantsTimer);
-      std::vector<SymExpr*> loopInvariants;
-      computeLoopInvariants(loopInvariants, curLoop, localDefMap, fn);
-      stopTimer(computeLoopInvariantsTimer);
-
-      //For each invariant, only move it if its def, dominates all uses and all exits 
-      for_vector(SymExpr, symExpr, loopInvariants) {
-        if(CallExpr* call = toCallExpr(symExpr->parentExpr)) {
-          if(defDominatesAllUses(curLoop, symExpr, dominators, localMap, localUseMap)) {
-            if(defDominatesAllExits(curLoop, symExpr, dominators, localMap)) {
-              curLoop->insertBefore(call);
-            }
-          }   
-        }
+      for (size_t i = 0; i < hoists.size(); i++) {
+        hoists[i].second->insertBefore(hoists[i].first->remove());
       }
-                
-      freeLocalDefUseMaps(localDefMap, localUseMap);
-    }
-    numLoops += loops.size();
-    
-    for_vector(Loop, loop, loops) {
-      delete loop;
-      loop = 0;
-    }
-    
-    for_vector(BitVec, bitVec, dominators) {
-      delete bitVec;
-      bitVec = 0;
     }
   }
 
+  hoistsByFn.clear();
+
   stopTimer(overallTimer);
     
 #ifdef detailedTiming  
@@ -26,12 +26,15 @@
 #include "astutil.h"
 #include "expr.h"
 #include "optimizations.h"
+#include "parallelPasses.h"
 #include "passes.h"
 #include "stmt.h"
 #include "stringutil.h"
 #include "symbol.h"
 #include "view.h"
 
+#include <map>
+
 static const bool debugScalarReplacement = false;
 
 // statistics
@@ -42,23 +45,58 @@ static int srRecordReplaced = 0;
 
 //
 // typeVec - a vector of candidate types for scalar replacement
-// varSet - a set of candidate variables for scalar replacement
+// typeSet - the candidate types and their reference types
 // typeOrder - topological ordering of candidate types
 //              e.g. (int, (int, int)) before (int, int)
-// typeVarMap - map from types to vectors of variables
-// defMap - defMap for varSet
-// useMap - useMap for varSet
 //
 static Vec<AggregateType*> typeVec;
-static Vec<Symbol*> varSet;
+static Vec<AggregateType*> typeSet;
 static Map<AggregateType*,int> typeOrder;
-static Map<AggregateType*,Vec<Symbol*>*> typeVarMap;
-static Map<Symbol*,Vec<SymExpr*>*> defMap;
-static Map<Symbol*,Vec<SymExpr*>*> useMap;
 
 typedef Map<AggregateType*,Vec<Symbol*>*> AggregateTypeToVecSymbolMap;
 typedef MapElem<AggregateType*,Vec<Symbol*>*> AggregateTypeToVecSymbolMapElem;
 
+//
+// The candidate variables of one function.  A variable's defs and uses
+// are all in the function that declares it, so each function can be
+// scalar replaced on its own.
+//
+// typeVarMap - map from types to vectors of variables
+// varSet - a set of candidate variables for scalar replacement
+// defMap - defMap for varSet
+// useMap - useMap for varSet
+//
+struct ScalarReplaceFn {
+  AggregateTypeToVecSymbolMap typeVarMap;
+  Vec<Symbol*> varSet;
+  Map<Symbol*,Vec<SymExpr*>*> defMap;
+  Map<Symbol*,Vec<SymExpr*>*> useMap;
+};
+
+static std::map<FnSymbol*, ScalarReplaceFn*> fnVarMap;
+
+//
+// add var to the candidates of its type in sr, if the type is a candidate
+//
+static void
+addCandidate(ScalarReplaceFn& sr, AggregateType* ct, Symbol* var) {
+  if (typeSet.set_in(ct)) {
+    Vec<Symbol*>* varVec = sr.typeVarMap.get(ct);
+    if (!varVec) {
+      varVec = new Vec<Symbol*>();
+      sr.typeVarMap.put(ct, varVec);
+    }
+    varVec->add(var);
+  }
+}
+
+static void
+countScalarReplace(int& counter) {
+  lockAST();
+  counter++;
+  unlockAST();
+}
+
 //
 // compute topological order for types; this functions assumes that
 // there are no cycles and that the typeOrder map is initialized to -1
@@ -100,10 +138,10 @@ compareTypesByOrder(const void* v1, const void* v2) {
 }
 
 static bool
-removeIdentityDefs(Symbol* sym) {
+removeIdentityDefs(ScalarReplaceFn& sr, Symbol* sym) {
   bool change = false;
 
-  for_defs(def, defMap, sym) {
+  for_defs(def, sr.defMap, sym) {
     CallExpr* move = toCallExpr(def->parentExpr);
     if (move && isMoveOrAssign(move)) {
       SymExpr* rhs = toSymExpr(move->get(2));
@@ -117,20 +155,20 @@ removeIdentityDefs(Symbol* sym) {
 }
 
 static bool
-removeUnusedClassInstance(Symbol* sym) {
+removeUnusedClassInstance(ScalarReplaceFn& sr, Symbol* sym) {
   bool change = false;
-  bool unused = !useMap.get(sym) || useMap.get(sym)->n == 0;
+  bool unused = !sr.useMap.get(sym) || sr.useMap.get(sym)->n == 0;
 
   if (!unused) {
     unused = true;
-    for_uses(use, useMap, sym) {
+    for_uses(use, sr.useMap, sym) {
       if (use->parentSymbol)
         unused = false;
     }
   }
 
   if (unused) {
-    for_defs(def, defMap, sym) {
+    for_defs(def, sr.defMap, sym) {
       if (def->parentSymbol) {
         CallExpr* move = toCallExpr(def->parentExpr);
         if (move && isMoveOrAssign(move)) {
@@ -144,13 +182,13 @@ removeUnusedClassInstance(Symbol* sym) {
 }
 
 static bool
-unifyClassInstances(Symbol* sym) {
-  if (!defMap.get(sym))
+unifyClassInstances(ScalarReplaceFn& sr, Symbol* sym) {
+  if (!sr.defMap.get(sym))
     return false;
 
   SymExpr* rhs = NULL;
 
-  for_defs(def, defMap, sym) {
+  for_defs(def, sr.defMap, sym) {
     if (def->parentSymbol) {
       CallExpr* move = toCallExpr(def->parentExpr);
       if (!move || !isMoveOrAssign(move))
@@ -168,12 +206,12 @@ unifyClassInstances(Symbol* sym) {
   if (!rhs)
     return false;
 
-  for_uses(se, useMap, sym) {
+  for_uses(se, sr.useMap, sym) {
     se->setSymbol(rhs->symbol());
-    addUse(useMap, se);
+    addUse(sr.useMap, se);
   }
 
-  for_defs(def, defMap, sym) {
+  for_defs(def, sr.defMap, sym) {
     def->parentExpr->remove();
   }
 
@@ -182,14 +220,14 @@ unifyClassInstances(Symbol* sym) {
 }
 
 static bool
-scalarReplaceClass(AggregateType* ct, Symbol* sym) {
+scalarReplaceClass(ScalarReplaceFn& sr, AggregateType* ct, Symbol* sym) {
 
-  if (fReportScalarReplace) srClass++;
+  if (fReportScalarReplace) countScalarReplace(srClass);
   //
   // only scalar replace sym if it has exactly one def and that def is
   // an allocation primitive
   //
-  Vec<SymExpr*>* defs = defMap.get(sym);
+  Vec<SymExpr*>* defs = sr.defMap.get(sym);
   if (!defs || defs->n != 1)
     return false;
   // As of r21945, if this variable is allocated in this scope, the
@@ -215,7 +253,7 @@ scalarReplaceClass(AggregateType* ct, Symbol* sym) {
   //
   // only scalar replace sym if all of the uses are handled primitives
   //
-  for_uses(se, useMap, sym) {
+  for_uses(se, sr.useMap, sym) {
     if (se->parentSymbol) {
       CallExpr* call = toCallExpr(se->parentExpr);
       if (!call)
@@ -243,7 +281,7 @@ scalarReplaceClass(AggregateType* ct, Symbol* sym) {
     }
   }
 
-  if (fReportScalarReplace) srClassReplaced++;
+  if (fReportScalarReplace) countScalarReplace(srClassReplaced);
   //
   // okay, let's scalar replace sym; first, create vars for every
   // field in sym and compute fieldMap to map the fields to these new
@@ -258,8 +296,7 @@ scalarReplaceClass(AggregateType* ct, Symbol* sym) {
     if (sym->hasFlag(FLAG_TEMP))
       var->addFlag(FLAG_TEMP);
     if (AggregateType* fct = toAggregateType(field->type))
-      if (Vec<Symbol*>* varVec = typeVarMap.get(fct))
-        varVec->add(var);
+      addCandidate(sr, fct, var);
   }
   sym->defPoint->remove();
 
@@ -272,19 +309,19 @@ scalarReplaceClass(AggregateType* ct, Symbol* sym) {
   //
   // replace uses of sym with new vars
   //
-  for_uses(se, useMap, sym) {
+  for_uses(se, sr.useMap, sym) {
     if (CallExpr* call = toCallExpr(se->parentExpr)) {
       SET_LINENO(call);
       if (call->isPrimitive(PRIM_GET_MEMBER)) {
         SymExpr* member = toSymExpr(call->get(2));
         SymExpr* use = new SymExpr(fieldMap.get(member->symbol()));
         call->replace(new CallExpr(PRIM_ADDR_OF, use));
-        addUse(useMap, use);
+        addUse(sr.useMap, use);
       } else if (call->isPrimitive(PRIM_GET_MEMBER_VALUE)) {
         SymExpr* member = toSymExpr(call->get(2));
         SymExpr* use = new SymExpr(fieldMap.get(member->symbol()));
         call->replace(use);
-        addUse(useMap, use);
+        addUse(sr.useMap, use);
       } else if (call->isPrimitive(PRIM_SETCID) ||
                  // TODO: don't know if this is still needed.  The
                  // PRIM_CAST_TO_VOID_STAR case may take care of it.
@@ -313,7 +350,7 @@ scalarReplaceClass(AggregateType* ct, Symbol* sym) {
         call->get(1)->remove();
         SymExpr* def = new SymExpr(fieldMap.get(member->symbol()));
         call->insertAtHead(def);
-        addDef(defMap, def);
+        addDef(sr.defMap, def);
         if (call->get(1)->typeInfo() == call->get(2)->typeInfo()->refType)
           call->insertAtTail(new CallExpr(PRIM_ADDR_OF, call->get(2)->remove()));
       } else {
@@ -335,13 +372,13 @@ scalarReplaceClass(AggregateType* ct, Symbol* sym) {
 }
 
 static bool
-scalarReplaceRecord(AggregateType* ct, Symbol* sym) {
+scalarReplaceRecord(ScalarReplaceFn& sr, AggregateType* ct, Symbol* sym) {
 
-  if (fReportScalarReplace) srRecord++;
+  if (fReportScalarReplace) countScalarReplace(srRecord);
   //
   // only scalar replace sym if all of the defs are handled primitives
   //
-  for_defs(se, defMap, sym) {
+  for_defs(se, sr.defMap, sym) {
     if (se->parentSymbol) {
       CallExpr* call = toCallExpr(se->parentExpr);
       if (!call ||
@@ -357,7 +394,7 @@ scalarReplaceRecord(AggregateType* ct, Symbol* sym) {
   //
   // only scalar replace sym if all of the uses are handled primitives
   //
-  for_uses(se, useMap, sym) {
+  for_uses(se, sr.useMap, sym) {
     if (se->parentSymbol) {
       CallExpr* call = toCallExpr(se->parentExpr);
       if (!call ||
@@ -370,7 +407,7 @@ scalarReplaceRecord(AggregateType* ct, Symbol* sym) {
     }
   }
 
-  if (fReportScalarReplace) srRecordReplaced++;
+  if (fReportScalarReplace) countScalarReplace(srRecordReplaced);
   //
   // okay, let's scalar replace sym; first, create vars for every
   // field in sym and compute fieldMap to map the fields to these new
@@ -385,14 +422,13 @@ scalarReplaceRecord(AggregateType* ct, Symbol* sym) {
     if (sym->hasFlag(FLAG_TEMP))
       var->addFlag(FLAG_TEMP);
     if (AggregateType* fct = toAggregateType(field->type))
-      if (Vec<Symbol*>* varVec = typeVarMap.get(fct))
-        varVec->add(var);
+      addCandidate(sr, fct, var);
   }
 
   //
   // replace defs of sym with new vars
   //
-  for_defs(se, defMap, sym) {
+  for_defs(se, sr.defMap, sym) {
     if (CallExpr* call = toCallExpr(se->parentExpr)) {
       if (call) {
         SET_LINENO(sym);
@@ -422,9 +458,9 @@ scalarReplaceRecord(AggregateType* ct, Symbol* sym) {
           }
           call->insertBefore(new CallExpr(PRIM_MOVE, a3,
                                new CallExpr(op, a1, a2)));
-          addUse(useMap, a1);
-          addUse(useMap, a2);
-          addDef(defMap, a3);
+          addUse(sr.useMap, a1);
+          addUse(sr.useMap, a2);
+          addDef(sr.defMap, a3);
         } else {
           rhs = NULL; // to silence compiler warnings
           INT_ASSERT(false);
@@ -435,8 +471,8 @@ scalarReplaceRecord(AggregateType* ct, Symbol* sym) {
           call->insertBefore(
             new CallExpr(PRIM_MOVE, use,
               new CallExpr(PRIM_GET_MEMBER_VALUE, rhsCopy, field)));
-          addDef(defMap, use);
-          addUse(useMap, rhsCopy);
+          addDef(sr.defMap, use);
+          addUse(sr.useMap, rhsCopy);
         }
         call->remove();
       }
@@ -454,7 +490,7 @@ scalarReplaceRecord(AggregateType* ct, Symbol* sym) {
   //
   // replace uses of sym with new vars
   //
-  for_uses(se, useMap, sym) {
+  for_uses(se, sr.useMap, sym) {
     if (CallExpr* call = toCallExpr(se->parentExpr)) {
       SET_LINENO(sym);
       // Do we need to add a case for PRIM_ASSIGN?
@@ -466,20 +502,20 @@ scalarReplaceRecord(AggregateType* ct, Symbol* sym) {
           SymExpr* use = new SymExpr(fieldMap.get(field));
           call->insertBefore(
             new CallExpr(PRIM_SET_MEMBER, lhsCopy, field, use));
-          addUse(useMap, use);
-          addUse(useMap, lhsCopy);
+          addUse(sr.useMap, use);
+          addUse(sr.useMap, lhsCopy);
         }
         call->remove();
       } else if (call->isPrimitive(PRIM_GET_MEMBER)) {
         SymExpr* member = toSymExpr(call->get(2));
         SymExpr* use = new SymExpr(fieldMap.get(member->symbol()));
         call->replace(new CallExpr(PRIM_ADDR_OF, use));
-        addUse(useMap, use);
+        addUse(sr.useMap, use);
       } else if (call->isPrimitive(PRIM_GET_MEMBER_VALUE)) {
         SymExpr* member = toSymExpr(call->get(2));
         SymExpr* use = new SymExpr(fieldMap.get(member->symbol()));
         call->replace(use);
-        addUse(useMap, use);
+        addUse(sr.useMap, use);
       } else if (call->isPrimitive(PRIM_SET_MEMBER)) {
         SymExpr* member = toSymExpr(call->get(2));
         call->primitive = primitives[PRIM_MOVE];
@@ -487,7 +523,7 @@ scalarReplaceRecord(AggregateType* ct, Symbol* sym) {
         call->get(1)->remove();
         SymExpr* def = new SymExpr(fieldMap.get(member->symbol()));
         call->insertAtHead(def);
-        addDef(defMap, def);
+        addDef(sr.defMap, def);
         if (call->get(1)->typeInfo() == call->get(2)->typeInfo()->refType)
           call->insertAtTail(new CallExpr(PRIM_ADDR_OF, call->get(2)->remove()));
       } else {
@@ -510,21 +546,81 @@ scalarReplaceRecord(AggregateType* ct, Symbol* sym) {
 
 
 static void
-debugScalarReplacementFailure(Symbol* var) {
+debugScalarReplacementFailure(ScalarReplaceFn& sr, Symbol* var) {
   printf("failed to scalar replace %s[%d]\n", var->cname, var->id);
   printf("defs:\n");
-  for_defs(def, defMap, var) {
+  for_defs(def, sr.defMap, var) {
     if (def->parentSymbol)
       nprint_view(def->getStmtExpr());
   }
   printf("uses:\n");
-  for_uses(use, useMap, var) {
+  for_uses(use, sr.useMap, var) {
     if (use->parentSymbol)
       nprint_view(use->getStmtExpr());
   }
 }
 
 
+//
+// scalar replace the candidate variables of fn, in topological order
+// of their types
+//
+static void
+scalarReplaceFn(FnSymbol* fn) {
+  std::map<FnSymbol*, ScalarReplaceFn*>::iterator it = fnVarMap.find(fn);
+  if (it == fnVarMap.end())
+    return;
+
+  ScalarReplaceFn& sr = *it->second;
+
+  //
+  // build def/use maps for candidate variables
+  //
+  buildDefUseMaps(sr.varSet, sr.defMap, sr.useMap);
+
+  forv_Vec(AggregateType, ct, typeVec) {
+    if (debugScalarReplacement)
+      printf("%d: %s:\n", typeOrder.get(ct), ct->symbol->cname);
+    if (AggregateType* rct = toAggregateType(ct->refType)) {
+      if (Vec<Symbol*>* refVec = sr.typeVarMap.get(rct)) {
+        forv_Vec(Symbol, var, *refVec) {
+          eliminateSingleAssignmentReference(sr.defMap, sr.useMap, var);
+        }
+      }
+    }
+    Vec<Symbol*>* varVec = sr.typeVarMap.get(ct);
+    if (!varVec)
+      continue;
+    if (isRecord(ct)) {
+      forv_Vec(Symbol, var, *varVec) {
+        if (var->defPoint->parentSymbol) {
+          bool result = scalarReplaceRecord(sr, ct, var);
+          if (debugScalarReplacement && !result)
+            debugScalarReplacementFailure(sr, var);
+        }
+      }
+    } else {
+      bool change;
+      do {
+        change = false;
+        forv_Vec(Symbol, var, *varVec) {
+          change |= removeIdentityDefs(sr, var);
+          change |= removeUnusedClassInstance(sr, var);
+          change |= unifyClassInstances(sr, var);
+        }
+      } while (change);
+      forv_Vec(Symbol, var, *varVec) {
+        if (var->defPoint->parentSymbol) {
+          bool result = scalarReplaceClass(sr, ct, var);
+          if (debugScalarReplacement && !result)
+            debugScalarReplacementFailure(sr, var);
+        }
+      }
+    }
+  }
+}
+
+
 void
 scalarReplace() {
   if (!fNoScalarReplacement) {
@@ -542,9 +638,9 @@ scalarReplace() {
             (ts->hasFlag(FLAG_TUPLE) &&
              (ct->fields.length<=scalar_replace_limit))) {
           typeVec.add(ct);
-          typeVarMap.put(ct, new Vec<Symbol*>());
+          typeSet.set_add(ct);
           if (AggregateType* rct = toAggregateType(ct->refType))
-            typeVarMap.put(rct, new Vec<Symbol*>());
+            typeSet.set_add(rct);
         }
       }
     }
@@ -562,7 +658,7 @@ scalarReplace() {
     qsort(typeVec.v, typeVec.n, sizeof(typeVec.v[0]), compareTypesByOrder);
 
     //
-    // compute typeVarMap and varSet
+    // find the candidate variables of each function
     //
     forv_Vec(VarSymbol, var, gVarSymbols) {
       if (AggregateType* ct = toAggregateType(var->type)) {
@@ -571,22 +667,20 @@ scalarReplace() {
           ct = var->type->refType;
         }
         INT_ASSERT(ct);
-        if (Vec<Symbol*>* varVec = typeVarMap.get(ct)) {
-          if (isFnSymbol(var->defPoint->parentSymbol)) {
-            varSet.set_add(var);
-            varVec->add(var);
+        if (typeSet.set_in(ct)) {
+          if (FnSymbol* fn = toFnSymbol(var->defPoint->parentSymbol)) {
+            ScalarReplaceFn*& sr = fnVarMap[fn];
+            if (!sr)
+              sr = new ScalarReplaceFn();
+            sr->varSet.set_add(var);
+            addCandidate(*sr, ct, var);
           }
         }
       }
     }
 
     //
-    // build def/use maps for candidate variables
-    //
-    buildDefUseMaps(varSet, defMap, useMap);
-
-    //
-    // scalar replace vars as possible and in topological order
+    // scalar replace vars as possible, one function at a time
     //
     if (debugScalarReplacement)
       printf("\n");
@@ -594,55 +688,24 @@ scalarReplace() {
       printf("SCALAR REPLACEMENT (limit=%d): %d types\n",
              scalar_replace_limit, typeVec.n);
     }
-    forv_Vec(AggregateType, ct, typeVec) {
-      if (debugScalarReplacement)
-        printf("%d: %s:\n", typeOrder.get(ct), ct->symbol->cname);
-      if (AggregateType* rct = toAggregateType(ct->refType)) {
-        Vec<Symbol*>* refVec = typeVarMap.get(rct);
-        forv_Vec(Symbol, var, *refVec) {
-          eliminateSingleAssignmentReference(defMap, useMap, var);
-        }
-      }
-      Vec<Symbol*>* varVec = typeVarMap.get(ct);
-      if (isRecord(ct)) {
-        forv_Vec(Symbol, var, *varVec) {
-          if (var->defPoint->parentSymbol) {
-            bool result = scalarReplaceRecord(ct, var);
-            if (debugScalarReplacement && !result)
-              debugScalarReplacementFailure(var);
-          }
-        }
-      } else {
-        bool change;
-        do {
-          change = false;
-          forv_Vec(Symbol, var, *varVec) {
-            change |= removeIdentityDefs(var);
-            change |= removeUnusedClassInstance(var);
-            change |= unifyClassInstances(var);
-          }
-        } while (change);
-        forv_Vec(Symbol, var, *varVec) {
-          if (var->defPoint->parentSymbol) {
-            bool result = scalarReplaceClass(ct, var);
-            if (debugScalarReplacement && !result)
-              debugScalarReplacementFailure(var);
-          }
-        }
-      }
-    }
+    forallFunctions(scalarReplaceFn);
 
     //
     // cleanup
     //
     typeVec.clear();
-    varSet.clear();
+    typeSet.clear();
     typeOrder.clear();
-    form_Map(AggregateTypeToVecSymbolMapElem, e, typeVarMap) {
-      delete e->value;
+    for (std::map<FnSymbol*, ScalarReplaceFn*>::iterator it = fnVarMap.begin();
+         it != fnVarMap.end(); ++it) {
+      ScalarReplaceFn* sr = it->second;
+      form_Map(AggregateTypeToVecSymbolMapElem, e, sr->typeVarMap) {
+        delete e->value;
+      }
+      freeDefUseMaps(sr->defMap, sr->useMap);
+      delete sr;
     }
-    typeVarMap.clear();
-    freeDefUseMaps(defMap, useMap);
+    fnVarMap.clear();
 
     if (fReportScalarReplace) {
       printf("\tReplaced %d of %d records\n", srRecordReplaced, srRecord);
@@ -3030,10 +3030,13 @@ void yyfree (void * ptr , yyscan_t yyscanner)
 
 static void  newString();
 static void  addString(const char* str);
+static void  addChars(const char* str, int len);
 static void  addChar(char c);
 static void  addCharString(char c);
 
 static int   getNextYYChar(yyscan_t scanner);
+static int   addCharsUntil(yyscan_t scanner, const char* stops, int c);
+static void  skipChars(yyscan_t scanner, const char* chars);
 
 static int   stringBuffLen = 0;
 static int   stringLen     = 0;
@@ -3072,7 +3075,9 @@ static int  processIdentifier(yyscan_t scanner) {
   YYSTYPE* yyLval = yyget_lval(scanner);
   int      retval = processToken(scanner, TIDENT);
 
-  yyLval->pch = astr(yyget_text(scanner));
+  // flex knows the length, so there is no need for astr() to find it
+  yyLval->pch = asubstr(yyget_text(scanner),
+                        yyget_text(scanner) + yyget_leng(scanner));
 
   return retval;
 }
@@ -3137,7 +3142,10 @@ static int processStringLiteral(yyscan_t scanner, const char* q, int type) {
 
   yyLval->pch = astr(eatStringLiteral(scanner, q));
 
-  countToken(astr(q, yyLval->pch, q));
+  // Only put the quotes back when the tokens are being counted
+  if (countTokens == true) {
+    countToken(astr(q, yyLval->pch, q));
+  }
 
   if (captureTokens) {
     size_t remain = sizeof(captureString) - 1;
@@ -3413,6 +3421,10 @@ static char* eatExternCode(yyscan_t scanner) {
 static void processWhitespace(yyscan_t scanner) {
   // might eventually want to keep track of column numbers and do
   // something here
+
+  // Skip the rest of the run here rather than matching each character
+  // of an indentation with this rule
+  skipChars(scanner, " \t\r\f");
 }
 
 /************************************ | *************************************
@@ -3431,6 +3443,7 @@ static int processSingleLineComment(yyscan_t scanner) {
   // Read until the end of the line
   while ((c = getNextYYChar(scanner)) != '\n' && c != 0) {
     addChar(c);
+    addCharsUntil(scanner, "\n", c);
   }
 
   countSingleLineComment(stringBuffer);
@@ -3439,7 +3452,8 @@ static int processSingleLineComment(yyscan_t scanner) {
     processNewline(scanner);
   }
 
-  yyLval->pch = astr(stringBuffer);
+  // The parser never looks at the text of a single-line comment
+  yyLval->pch = NULL;
 
   return YYLEX_SINGLE_LINE_COMMENT;
 }
@@ -3516,6 +3530,13 @@ static int processBlockComment(yyscan_t scanner) {
       }
       yyerror(yyLloc, &context, "EOF in comment");
     }
+
+    // Once the label has been matched or ruled out, take everything up
+    // to the next character that could end a line or a comment, or
+    // start a nested one, in one step
+    if (depth > 0 && c != 0 && (labelIndex == -1 || labelIndex == len)) {
+      c = addCharsUntil(scanner, "\n*/", c);
+    }
   }
 
   // back up two to not print */ again.
@@ -3597,6 +3618,19 @@ static void addString(const char* str) {
     addChar(str[i]);
 }
 
+static void addChars(const char* str, int len) {
+  if (stringLen + len + 1 > stringBuffLen) {
+    stringBuffLen = 2 * (stringBuffLen + len);
+    stringBuffer  = (char*) realloc(stringBuffer,
+                                    stringBuffLen * sizeof(char));
+  }
+
+  memcpy(stringBuffer + stringLen, str, len);
+
+  stringLen               += len;
+  stringBuffer[stringLen]  = '\0';
+}
+
 static void addChar(char c) {
   addCharMaybeEscape(c, false);
 }
@@ -3642,6 +3676,63 @@ static int getNextYYChar(yyscan_t scanner) {
   return retval;
 }
 
+//
+// Add the characters that follow to stringBuffer, up to but not
+// including the first one in 'stops', a NUL, or the end of flex's
+// buffer, and consume them.  Returns the last character added, or 'c'
+// if there were none.
+//
+// This is the same as a loop over getNextYYChar() and addChar(), but
+// strcspn() looks for the stopping characters a word or more at a time
+// instead of going through yyinput() for each one.  Whatever is left
+// at the end of the buffer is read by the next call to getNextYYChar().
+//
+static int addCharsUntil(yyscan_t yyscanner, const char* stops, int c) {
+  struct yyguts_t * yyg   = (struct yyguts_t*) yyscanner;
+  char*             start = yyg->yy_c_buf_p;
+  int               len   = 0;
+
+  // Put back the character that flex saved, as yyinput() does
+  *start = yyg->yy_hold_char;
+
+  // flex keeps a NUL after the last character in the buffer
+  len    = strcspn(start, stops);
+
+  if (len > 0) {
+    addChars(start, len);
+
+    c                 = (unsigned char) start[len - 1];
+
+    yyg->yy_c_buf_p   = start + len;
+    yyg->yy_hold_char = start[len];
+  }
+
+  // Leave a NUL behind, as yyinput() does; the character that was here
+  // has been consumed or is in yy_hold_char
+  *start = '\0';
+
+  return c;
+}
+
+//
+// Consume the characters that follow as long as they are in 'chars',
+// stopping at a NUL or the end of flex's buffer, as addCharsUntil()
+// does.  Only for rules whose actions would ignore those characters.
+//
+static void skipChars(yyscan_t yyscanner, const char* chars) {
+  struct yyguts_t * yyg   = (struct yyguts_t*) yyscanner;
+  char*             start = yyg->yy_c_buf_p;
+  int               len   = 0;
+
+  *start = yyg->yy_hold_char;
+  len    = strspn(start, chars);
+
+  yyg->yy_c_buf_p   = start + len;
+  yyg->yy_hold_char = start[len];
+
+  *start = '\0';
+}
+
 /************************************ | *************************************
 *                                                                           *
 *                                                                           *
@@ -409,8 +409,11 @@ addVarsToFormalsActuals(FnSymbol* fn, SymbolMap& vars,
                         CallExpr* call, bool isCoforall)
 {
   Expr *redRef1 = NULL, *redRef2 = NULL;
-  form_Map(SymbolMapElem, e, vars) {
-      Symbol* sym = e->key;
+  std::vector<Symbol*> syms;
+  // add the formals in id order, so they do not depend on memory layout
+  sortedSymbolMapKeys(vars, syms);
+  for_vector(Symbol, sym, syms) {
+      SymbolMapElem* e = vars.get_record(sym);
       if (e->value != markPruned) {
         SET_LINENO(sym);
         ArgSymbol* newFormal = NULL;
@@ -32,7 +32,13 @@
 
 //helper datastructures/types
 typedef std::pair<Expr*, Type*> DefCastPair;
-typedef std::map<SymExpr*, DefCastPair> UseDefCastMap;
+
+// candidates are denormalized in the order of their uses' ids, so that
+// the result does not depend on where the SymExprs are in memory
+struct SymExprIdLess {
+  bool operator()(SymExpr* a, SymExpr* b) const { return a->id < b->id; }
+};
+typedef std::map<SymExpr*, DefCastPair, SymExprIdLess> UseDefCastMap;
 
 //prototypes
 bool primMoveGeneratesCommCall(CallExpr* ce);
@@ -175,67 +175,69 @@ passByRef(Symbol* sym) {
 
 static void
 addVarsToFormals(FnSymbol* fn, SymbolMap* vars) {
-  form_Map(SymbolMapElem, e, *vars) {
-    if (Symbol* sym = e->key) {
-      Type* type = sym->type;
-      IntentTag intent = INTENT_BLANK;
-
-        /* NOTE: This is still conservative.  This avoids passing
-           coforall index vars by reference for non-var iterators.
-           David came up with an example with nested functions and no
-           iterators that would unnecessarily pass coforall index vars
-           by reference.  With further analysis, we could figure out
-           whether this variable is actually going to be returned as
-           an LHS expr. */
-      //
-      // BHARSH: TODO: The arg intent set here can have a large impact on
-      // RVF later on. For RVF to be more effective, this might be a good
-      // place to do some analysis and mark arguments as 'const in' and 
-      // 'const ref', even if the actual is not marked with FLAG_CONST.
-      //
-      // Prior to the QualifiedType changes this section would make the type
-      // something like _ref_int, but the intent would be INTENT_CONST_IN and
-      // RVF would fire in some situations.
-      //
-      if (passByRef(sym)) {
-        IntentTag temp = INTENT_REF;
-        if (sym->hasFlag(FLAG_CONST)) {
-          temp = INTENT_CONST_REF;
-        }
-        intent = concreteIntent(temp, type);
-        type = type->getValType()->refType;
-      } else {
-        IntentTag temp = INTENT_BLANK;
-        if (sym->hasFlag(FLAG_CONST) && sym->isRef()) {
-          // Allows for RVF later
-          temp = INTENT_CONST_REF;
-        }
-        intent = concreteIntent(temp, type);
+  std::vector<Symbol*> syms;
+
+  sortedSymbolMapKeys(*vars, syms);
+
+  for_vector(Symbol, sym, syms) {
+    Type* type = sym->type;
+    IntentTag intent = INTENT_BLANK;
+
+      /* NOTE: This is still conservative.  This avoids passing
+         coforall index vars by reference for non-var iterators.
+         David came up with an example with nested functions and no
+         iterators that would unnecessarily pass coforall index vars
+         by reference.  With further analysis, we could figure out
+         whether this variable is actually going to be returned as
+         an LHS expr. */
+    //
+    // BHARSH: TODO: The arg intent set here can have a large impact on
+    // RVF later on. For RVF to be more effective, this might be a good
+    // place to do some analysis and mark arguments as 'const in' and 
+    // 'const ref', even if the actual is not marked with FLAG_CONST.
+    //
+    // Prior to the QualifiedType changes this section would make the type
+    // something like _ref_int, but the intent would be INTENT_CONST_IN and
+    // RVF would fire in some situations.
+    //
+    if (passByRef(sym)) {
+      IntentTag temp = INTENT_REF;
+      if (sym->hasFlag(FLAG_CONST)) {
+        temp = INTENT_CONST_REF;
       }
-
-      SET_LINENO(sym);
-      //
-      // BLC: TODO: This routine is part of the reason that we aren't
-      // consistent in representing 'ref' argument intents in the AST.
-      // In particular, the code above uses a certain test to decide
-      // to pass something by reference and changes the formal's type
-      // to the corresponding reference type if it believes it should.
-      // But the blankIntentForType() call below (and the INTENT_BLANK
-      // that was used before it) may pass the argument by 'const in'
-      // which seems inconsistent (because most 'ref' formals reflect
-      // INTENT_REF in the current compiler).  My current thought is
-      // to only indicate ref-ness through intents for most of the
-      // compilation (at a Chapel level) and only worry about ref
-      // types very close to code generation, primarily to avoid
-      // inconsistencies like this and keep things more
-      // uniform/simple; but we haven't made this switch yet.
-      //
-      ArgSymbol* arg = new ArgSymbol(intent, sym->name, type);
-      if (sym->hasFlag(FLAG_ARG_THIS))
-        arg->addFlag(FLAG_ARG_THIS);
-      fn->insertFormalAtTail(new DefExpr(arg));
-      vars->put(sym, arg);
+      intent = concreteIntent(temp, type);
+      type = type->getValType()->refType;
+    } else {
+      IntentTag temp = INTENT_BLANK;
+      if (sym->hasFlag(FLAG_CONST) && sym->isRef()) {
+        // Allows for RVF later
+        temp = INTENT_CONST_REF;
+      }
+      intent = concreteIntent(temp, type);
     }
+
+    SET_LINENO(sym);
+    //
+    // BLC: TODO: This routine is part of the reason that we aren't
+    // consistent in representing 'ref' argument intents in the AST.
+    // In particular, the code above uses a certain test to decide
+    // to pass something by reference and changes the formal's type
+    // to the corresponding reference type if it believes it should.
+    // But the blankIntentForType() call below (and the INTENT_BLANK
+    // that was used before it) may pass the argument by 'const in'
+    // which seems inconsistent (because most 'ref' formals reflect
+    // INTENT_REF in the current compiler).  My current thought is
+    // to only indicate ref-ness through intents for most of the
+    // compilation (at a Chapel level) and only worry about ref
+    // types very close to code generation, primarily to avoid
+    // inconsistencies like this and keep things more
+    // uniform/simple; but we haven't made this switch yet.
+    //
+    ArgSymbol* arg = new ArgSymbol(intent, sym->name, type);
+    if (sym->hasFlag(FLAG_ARG_THIS))
+      arg->addFlag(FLAG_ARG_THIS);
+    fn->insertFormalAtTail(new DefExpr(arg));
+    vars->put(sym, arg);
   }
 }
 
@@ -244,57 +246,57 @@ replaceVarUsesWithFormals(FnSymbol* fn, SymbolMap* vars) {
   if (vars->n == 0) return;
   std::vector<SymExpr*> symExprs;
   collectSymExprs(fn->body, symExprs);
-  form_Map(SymbolMapElem, e, *vars) {
-    if (Symbol* sym = e->key) {
-      ArgSymbol* arg = toArgSymbol(e->value);
-      Type* type = arg->type;
-      for_vector(SymExpr, se, symExprs) {
-          if (se->symbol() == sym) {
-            if (type == sym->type) {
-              se->setSymbol(arg);
-            } else {
-              CallExpr* call = toCallExpr(se->parentExpr);
-              INT_ASSERT(call);
-              FnSymbol* fnc = call->isResolved();
-              bool canPassToFn = false;
-              if (fnc) {
-                ArgSymbol* form = actual_to_formal(se);
-                if (arg->isRef() && form->isRef() &&
-                    arg->getValType() == form->getValType() &&
-                    // BHARSH TODO: Can we remove that now that removeWrapRecords is gone?
-                    // I observed some increase comm-counts with stream, but
-                    // maybe we shouldn't have deref'd before
-                    !isRecordWrappedType(form->getValType())) {
-                  // removeWrapRecords can modify the formal to have the
-                  // 'const in' intent. For now it's easier to insert the
-                  // DEREF here.
-                  canPassToFn = true;
-                } else if (arg->type == form->type) {
-                  canPassToFn = true;
-                }
-              }
-
-              if ((call->isPrimitive(PRIM_MOVE) && call->get(1) == se) ||
-                  (call->isPrimitive(PRIM_ASSIGN) && call->get(1) == se) ||
-                  (call->isPrimitive(PRIM_SET_MEMBER) && call->get(1) == se) ||
-                  (call->isPrimitive(PRIM_GET_MEMBER)) ||
-                  (call->isPrimitive(PRIM_GET_MEMBER_VALUE)) ||
-                  (call->isPrimitive(PRIM_WIDE_GET_LOCALE)) ||
-                  (call->isPrimitive(PRIM_WIDE_GET_NODE)) ||
-                  canPassToFn) {
-                se->setSymbol(arg); // do not dereference argument in these cases
-              } else if (call->isPrimitive(PRIM_ADDR_OF)) {
-                SET_LINENO(se);
-                call->replace(new SymExpr(arg));
-              } else {
-                SET_LINENO(se);
-                VarSymbol* tmp = newTemp(sym->type);
-                se->getStmtExpr()->insertBefore(new DefExpr(tmp));
-                se->getStmtExpr()->insertBefore(new CallExpr(PRIM_MOVE, tmp, new CallExpr(PRIM_DEREF, arg)));
-                se->setSymbol(tmp);
-              }
+  std::vector<Symbol*> syms;
+  sortedSymbolMapKeys(*vars, syms);
+  for_vector(Symbol, sym, syms) {
+    ArgSymbol* arg = toArgSymbol(vars->get(sym));
+    Type* type = arg->type;
+    for_vector(SymExpr, se, symExprs) {
+      if (se->symbol() == sym) {
+        if (type == sym->type) {
+          se->setSymbol(arg);
+        } else {
+          CallExpr* call = toCallExpr(se->parentExpr);
+          INT_ASSERT(call);
+          FnSymbol* fnc = call->isResolved();
+          bool canPassToFn = false;
+          if (fnc) {
+            ArgSymbol* form = actual_to_formal(se);
+            if (arg->isRef() && form->isRef() &&
+                arg->getValType() == form->getValType() &&
+                // BHARSH TODO: Can we remove that now that removeWrapRecords is gone?
+                // I observed some increase comm-counts with stream, but
+                // maybe we shouldn't have deref'd before
+                !isRecordWrappedType(form->getValType())) {
+              // removeWrapRecords can modify the formal to have the
+              // 'const in' intent. For now it's easier to insert the
+              // DEREF here.
+              canPassToFn = true;
+            } else if (arg->type == form->type) {
+              canPassToFn = true;
             }
           }
+
+          if ((call->isPrimitive(PRIM_MOVE) && call->get(1) == se) ||
+              (call->isPrimitive(PRIM_ASSIGN) && call->get(1) == se) ||
+              (call->isPrimitive(PRIM_SET_MEMBER) && call->get(1) == se) ||
+              (call->isPrimitive(PRIM_GET_MEMBER)) ||
+              (call->isPrimitive(PRIM_GET_MEMBER_VALUE)) ||
+              (call->isPrimitive(PRIM_WIDE_GET_LOCALE)) ||
+              (call->isPrimitive(PRIM_WIDE_GET_NODE)) ||
+              canPassToFn) {
+            se->setSymbol(arg); // do not dereference argument in these cases
+          } else if (call->isPrimitive(PRIM_ADDR_OF)) {
+            SET_LINENO(se);
+            call->replace(new SymExpr(arg));
+          } else {
+            SET_LINENO(se);
+            VarSymbol* tmp = newTemp(sym->type);
+            se->getStmtExpr()->insertBefore(new DefExpr(tmp));
+            se->getStmtExpr()->insertBefore(new CallExpr(PRIM_MOVE, tmp, new CallExpr(PRIM_DEREF, arg)));
+            se->setSymbol(tmp);
+          }
+        }
       }
     }
   }
@@ -303,20 +305,22 @@ replaceVarUsesWithFormals(FnSymbol* fn, SymbolMap* vars) {
 
 static void
 addVarsToActuals(CallExpr* call, SymbolMap* vars, bool outerCall) {
-  form_Map(SymbolMapElem, e, *vars) {
-    if (Symbol* sym = e->key) {
-      SET_LINENO(sym);
-      if (!outerCall && passByRef(sym)) {
-        // This is only a performance issue.
-        INT_ASSERT(!sym->hasFlag(FLAG_SHOULD_NOT_PASS_BY_REF));
-        /* NOTE: See note above in addVarsToFormals() */
-        VarSymbol* tmp = newTemp(sym->type->getValType()->refType);
-        call->getStmtExpr()->insertBefore(new DefExpr(tmp));
-        call->getStmtExpr()->insertBefore(new CallExpr(PRIM_MOVE, tmp, new CallExpr(PRIM_ADDR_OF, sym)));
-        call->insertAtTail(tmp);
-      } else {
-        call->insertAtTail(sym);
-      }
+  std::vector<Symbol*> syms;
+
+  sortedSymbolMapKeys(*vars, syms);
+
+  for_vector(Symbol, sym, syms) {
+    SET_LINENO(sym);
+    if (!outerCall && passByRef(sym)) {
+      // This is only a performance issue.
+      INT_ASSERT(!sym->hasFlag(FLAG_SHOULD_NOT_PASS_BY_REF));
+      /* NOTE: See note above in addVarsToFormals() */
+      VarSymbol* tmp = newTemp(sym->type->getValType()->refType);
+      call->getStmtExpr()->insertBefore(new DefExpr(tmp));
+      call->getStmtExpr()->insertBefore(new CallExpr(PRIM_MOVE, tmp, new CallExpr(PRIM_ADDR_OF, sym)));
+      call->insertAtTail(tmp);
+    } else {
+      call->insertAtTail(sym);
     }
   }
 }
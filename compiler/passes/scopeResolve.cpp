@@ -1773,7 +1773,7 @@ static void errorDotInsideWithClause(UnresolvedSymExpr* origUSE,
   // As of this writing, a with-clause can be duplicated in the AST.
   // This code avoids multiple error messages for the same symbol.
 
-  std::pair<const char*,int> markLoc(origUSE->astloc.filename,
+  std::pair<const char*,int> markLoc(origUSE->astloc.filename(),
                                      origUSE->astloc.lineno);
   WFDIWmark mark(markLoc, origUSE->unresolved);
 
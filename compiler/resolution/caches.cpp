@@ -145,8 +145,47 @@ freeCache(SymbolVecCache& cache) {
 }
 
 
+void
+addCache(CallSignatureCache& cache, const char* name, const CallSignature& sig, FnSymbol* fn) {
+  cache[name][sig] = fn;
+}
+
+
+FnSymbol*
+checkCache(CallSignatureCache& cache, const char* name, const CallSignature& sig) {
+  CallSignatureCache::iterator entries = cache.find(name);
+  if (entries != cache.end()) {
+    CallSignatureMap::iterator entry = entries->second.find(sig);
+    if (entry != entries->second.end())
+      return entry->second;
+  }
+  return NULL;
+}
+
+
+void
+removeCache(CallSignatureCache& cache, const char* name, const CallSignature& sig) {
+  CallSignatureCache::iterator entries = cache.find(name);
+  if (entries != cache.end())
+    entries->second.erase(sig);
+}
+
+
+void
+clearCache(CallSignatureCache& cache, const char* name) {
+  cache.erase(name);
+}
+
+
+void
+freeCache(CallSignatureCache& cache) {
+  cache.clear();
+}
+
+
 SymbolMapCache ordersCache;
 SymbolMapCache genericsCache;
 SymbolMapCache coercionsCache;
 SymbolMapCache promotionsCache;
 SymbolVecCache defaultsCache;
+CallSignatureCache resolvedCallsCache;
@@ -22,6 +22,9 @@
 
 #include "baseAST.h"
 
+#include <map>
+#include <vector>
+
 //
 // SymbolMapCache: FnSymbol -> FnSymbol cache based on a SymbolMap
 //
@@ -71,6 +74,38 @@ void addCache(SymbolVecCache& cache, FnSymbol* newFn, FnSymbol* oldFn, Vec<Symbo
 FnSymbol* checkCache(SymbolVecCache& cache, FnSymbol* fn, Vec<Symbol*>* vec);
 void freeCache(SymbolVecCache& cache);
 
+//
+// CallSignatureCache: call signature -> FnSymbol cache
+//
+//   A CallSignature is a sequence of pointers that together decide how
+//   a call resolves, e.g. the block it is resolved from and the types
+//   of its actuals; resolveNormalCall() builds them.  The entries are
+//   grouped by the name of the called function so that they can be
+//   dropped when a function by that name is added.
+//
+//   addCache(cache, name, sig, fn): adds an entry to cache from the
+//                                   call signature sig to fn
+//
+//   checkCache(cache, name, sig): returns a function previously added
+//                                 via addCache if the signatures are
+//                                 equal, or NULL
+//
+//   removeCache(cache, name, sig): removes the entry for sig
+//
+//   clearCache(cache, name): removes the entries for name
+//
+//   freeCache(cache): frees memory associated with cache
+//
+typedef std::vector<const void*>                 CallSignature;
+typedef std::map<CallSignature, FnSymbol*>       CallSignatureMap;
+typedef std::map<const char*, CallSignatureMap>  CallSignatureCache;
+
+void addCache(CallSignatureCache& cache, const char* name, const CallSignature& sig, FnSymbol* fn);
+FnSymbol* checkCache(CallSignatureCache& cache, const char* name, const CallSignature& sig);
+void removeCache(CallSignatureCache& cache, const char* name, const CallSignature& sig);
+void clearCache(CallSignatureCache& cache, const char* name);
+void freeCache(CallSignatureCache& cache);
+
 //
 // Caches to avoid creating multiple identical wrappers and
 // instantiating the same functions in the same ways
@@ -86,4 +121,12 @@ extern SymbolMapCache coercionsCache;
 extern SymbolMapCache promotionsCache;
 extern SymbolVecCache defaultsCache;
 
+//
+// Cache of the functions chosen for calls, to avoid gathering and
+// disambiguating the candidates again for a call that looks the same.
+// The functions it holds are the ones found in genericsCache for
+// generic candidates, before any wrappers are added for the call.
+//
+extern CallSignatureCache resolvedCallsCache;
+
 #endif
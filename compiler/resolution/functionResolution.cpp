@@ -50,6 +50,7 @@
 
 #include "../ifa/prim_data.h"
 
+#include <algorithm>
 #include <inttypes.h>
 #include <map>
 #include <sstream>
@@ -117,6 +118,8 @@ bool inDynamicDispatchResolution = false;
 SymbolMap paramMap;
 
 int explainCallLine;
+int resolveNumInstantiations = 0;
+int resolveNumCandidates     = 0;
 bool tryFailure = false;
 
 //#
@@ -2585,6 +2588,8 @@ filterCandidate(Vec<ResolutionCandidate*>& candidates,
                 ResolutionCandidate* currCandidate,
                 CallInfo& info) {
 
+  resolveNumCandidates++;
+
   if (currCandidate->fn->hasFlag(FLAG_GENERIC)) {
     filterGenericCandidate(candidates, currCandidate, info);
 
@@ -3428,6 +3433,25 @@ int nVisibleFunctions = 0; // for incremental build
 static Map<BlockStmt*,BlockStmt*> visibilityBlockCache;
 static Vec<BlockStmt*> standardModuleSet;
 
+//
+// 'visibleFunctionsCache' remembers, for a name and a block, the
+// functions that getVisibleFunctions() collected, so that the many calls
+// to the same function from one block walk the visibility chain only
+// once.  An entry stays good until a function by that name is added to
+// visibleFunctionMap; buildVisibleFunctionMap() drops it then.
+//
+typedef std::map<BlockStmt*, std::vector<FnSymbol*> > VisibleFunctionsByBlock;
+
+static std::map<const char*, VisibleFunctionsByBlock> visibleFunctionsCache;
+
+static void clearVisibleFunctionsCache(const char* name) {
+  std::map<const char*, VisibleFunctionsByBlock>::iterator it =
+    visibleFunctionsCache.find(name);
+
+  if (it != visibleFunctionsCache.end())
+    visibleFunctionsCache.erase(it);
+}
+
 //
 // return true if expr is a CondStmt with chpl__tryToken as its condition
 //
@@ -3507,6 +3531,8 @@ void buildVisibleFunctionMap() {
         vfb->visibleFunctions.put(fn->name, fns);
       }
       fns->add(fn);
+      clearVisibleFunctionsCache(fn->name);
+      clearCache(resolvedCallsCache, fn->name);
     }
   }
   nVisibleFunctions = gFnSymbols.n;
@@ -3524,15 +3550,21 @@ void buildVisibleFunctionMap() {
 // Todo: some blocks only define if-functions (i.e. _if_fnNNN); such blocks
 // probably should not be present in visibleFunctionMap.
 //
+// The functions are collected whether or not they are private; see
+// findVisibleFunctions().  'cacheable' is cleared if the result depends on
+// more than 'block' and 'name', i.e. if a private module or a renaming
+// 'use' was seen on the way.
+//
 // getVisibleFunctions returns the block appropriate for visibilityBlockCache
 // or NULL if there is none, e.g. when the next block up is the rootModule.
 //
-BlockStmt*
+static BlockStmt*
 getVisibleFunctions(BlockStmt* block,
                     const char* name,
                     Vec<FnSymbol*>& visibleFns,
                     Vec<BlockStmt*>& visited,
-                    CallExpr* callOrigin) {
+                    CallExpr* callOrigin,
+                    bool& cacheable) {
   //
   // all functions in standard modules are stored in a single block
   //
@@ -3562,15 +3594,7 @@ getVisibleFunctions(BlockStmt* block,
     canSkipThisBlock = false; // cannot skip if this block defines functions
     Vec<FnSymbol*>* fns = vfb->visibleFunctions.get(name);
     if (fns) {
-      forv_Vec(FnSymbol, fn, *fns) {
-        if (fn->isVisible(callOrigin)) {
-          // isVisible checks if the function is private to its defining
-          // module (and in that case, if we are under its defining module)
-          // This ensures that private functions will not be used outside
-          // of their proper scope.
-          visibleFns.add(fn);
-        }
-      }
+      visibleFns.append(*fns);
     }
   }
 
@@ -3587,11 +3611,14 @@ getVisibleFunctions(BlockStmt* block,
         // The use statement could be of an enum instead of a module, but only
         // modules can define functions.
         canSkipThisBlock = false; // cannot skip if this block uses modules
+        if (mod->hasFlag(FLAG_PRIVATE))
+          cacheable = false;
         if (mod->isVisible(callOrigin)) {
           if (use->isARename(name)) {
-            getVisibleFunctions(mod->block, use->getRename(name), visibleFns, visited, callOrigin);
+            cacheable = false;
+            getVisibleFunctions(mod->block, use->getRename(name), visibleFns, visited, callOrigin, cacheable);
           } else {
-            getVisibleFunctions(mod->block, name, visibleFns, visited, callOrigin);
+            getVisibleFunctions(mod->block, name, visibleFns, visited, callOrigin, cacheable);
           }
         }
       }
@@ -3602,13 +3629,13 @@ getVisibleFunctions(BlockStmt* block,
   // visibilityBlockCache contains blocks that can be skipped
   //
   if (BlockStmt* next = visibilityBlockCache.get(block)) {
-    getVisibleFunctions(next, name, visibleFns, visited, callOrigin);
+    getVisibleFunctions(next, name, visibleFns, visited, callOrigin, cacheable);
     return (canSkipThisBlock) ? next : block;
   }
 
   if (block != rootModule->block) {
     BlockStmt* next = getVisibilityBlock(block);
-    BlockStmt* cache = getVisibleFunctions(next, name, visibleFns, visited, callOrigin);
+    BlockStmt* cache = getVisibleFunctions(next, name, visibleFns, visited, callOrigin, cacheable);
     if (cache)
       visibilityBlockCache.put(block, cache);
     return (canSkipThisBlock) ? cache : block;
@@ -3617,6 +3644,111 @@ getVisibleFunctions(BlockStmt* block,
   return NULL;
 }
 
+//
+// Collects the functions called 'name' visible to 'callOrigin' from
+// 'block'.  Private functions are checked against 'callOrigin' here
+// rather than cached, since that is the only part of the answer that
+// depends on where the call is.
+//
+void
+findVisibleFunctions(BlockStmt* block,
+                     const char* name,
+                     CallExpr* callOrigin,
+                     Vec<FnSymbol*>& visibleFns) {
+  VisibleFunctionsByBlock&          byBlock = visibleFunctionsCache[name];
+  VisibleFunctionsByBlock::iterator it      = byBlock.find(block);
+  Vec<FnSymbol*>                    fns;
+
+  if (it != byBlock.end()) {
+    for_vector(FnSymbol, fn, it->second)
+      fns.add(fn);
+
+  } else {
+    Vec<BlockStmt*> visited;
+    bool            cacheable = true;
+
+    getVisibleFunctions(block, name, fns, visited, callOrigin, cacheable);
+
+    if (cacheable) {
+      std::vector<FnSymbol*>& cached = byBlock[block];
+
+      forv_Vec(FnSymbol, fn, fns)
+        cached.push_back(fn);
+    }
+  }
+
+  forv_Vec(FnSymbol, fn, fns) {
+    if (fn->isVisible(callOrigin)) {
+      // isVisible checks if the function is private to its defining
+      // module (and in that case, if we are under its defining module)
+      // This ensures that private functions will not be used outside
+      // of their proper scope.
+      visibleFns.add(fn);
+    }
+  }
+}
+
+//
+// Returns the block that decides which functions are visible from
+// 'block' and how visible they are: the first block up the visibility
+// chain that defines functions, uses modules or belongs to a module.
+// The blocks skipped on the way cannot change how a call resolves.
+// The walk also stops at a block that is no longer in the tree, which
+// can be the instantiation point of a function.
+//
+static BlockStmt* getVisibilityRoot(BlockStmt* block) {
+  while (block->modUses                       == NULL  &&
+         visibleFunctionMap.get(block)        == NULL  &&
+         block->parentSymbol                  != NULL  &&
+         isModuleSymbol(block->parentSymbol)  == false) {
+    block = getVisibilityBlock(block);
+  }
+
+  return block;
+}
+
+// marks the signature of a call with an explicit module scope, e.g. M.f()
+static const int explicitScopeTag = 0;
+
+//
+// Builds the signature under which resolvedCallsCache remembers the
+// function chosen for 'call': where the call is resolved from, the
+// module it is in (which decides whether private symbols are visible),
+// whether it is a method call without parentheses and, for each actual,
+// its name, its type, its qualifier and constness and, for params and
+// types, the actual itself.
+//
+static void buildCallSignature(CallExpr*      call,
+                               CallInfo&      info,
+                               CallSignature& sig) {
+  if (info.scope) {
+    sig.push_back(info.scope);
+    sig.push_back(&explicitScopeTag);
+  } else {
+    sig.push_back(getVisibilityRoot(getVisibilityBlock(call)));
+    sig.push_back(NULL);
+  }
+
+  sig.push_back(call->getModule());
+  sig.push_back(call->methodTag ? gMethodToken : NULL);
+
+  for (int i = 0; i < info.actuals.n; i++) {
+    Symbol*  actual = info.actuals.v[i];
+    intptr_t qual   = 2 * actual->qual + (actual->isConstant() ? 1 : 0);
+
+    sig.push_back(info.actualNames.v[i]);
+    sig.push_back(actual->type);
+    sig.push_back(reinterpret_cast<const void*>(qual));
+
+    if (actual->isParameter())
+      sig.push_back(actual);
+    else if (actual->hasFlag(FLAG_TYPE_VARIABLE))
+      sig.push_back(actual->type->symbol);
+    else
+      sig.push_back(NULL);
+  }
+}
+
 // Ensure 'parent' is the block before which we want to do the capturing.
 static void verifyTaskFnCall(BlockStmt* parent, CallExpr* call) {
   if (call->isNamed("coforall_fn") || call->isNamed("on_fn")) {
@@ -4278,10 +4410,42 @@ FnSymbol* resolveNormalCall(CallExpr* call, bool checkonly) {
     buildVisibleFunctionMap();
   }
 
-  if (!call->isResolved()) {
+  //
+  // Calls that look the same from the same place resolve the same way,
+  // so remember the choice unless something may be printed or undone.
+  //
+  bool explainThisCall = (explainCallLine && explainCallMatch(call)) ||
+                         call->id == explainCallID;
+  bool useCache = !checkonly && tryStack.n == 0 && !explainThisCall &&
+                  !call->isResolved() && !call->partialTag;
+
+  CallSignature        signature;
+  FnSymbol*            cachedFn        = NULL;
+  ResolutionCandidate* cachedCandidate = NULL;
+
+  if (useCache) {
+    buildCallSignature(call, info, signature);
+
+    if (FnSymbol* fn = checkCache(resolvedCallsCache, info.name, signature)) {
+      cachedCandidate = new ResolutionCandidate(fn);
+
+      if (cachedCandidate->computeAlignment(info)) {
+        cachedFn = fn;
+      } else {
+        // The signature missed something that matters for this call;
+        // forget the entry and resolve the call from scratch.
+        delete cachedCandidate;
+        cachedCandidate = NULL;
+        removeCache(resolvedCallsCache, info.name, signature);
+      }
+    }
+  }
+
+  if (cachedFn) {
+    visibleFns.add(cachedFn);
+  } else if (!call->isResolved()) {
     if (!info.scope) {
-      Vec<BlockStmt*> visited;
-      getVisibleFunctions(getVisibilityBlock(call), info.name, visibleFns, visited, call);
+      findVisibleFunctions(getVisibilityBlock(call), info.name, call, visibleFns);
     } else {
       if (VisibleFunctionBlock* vfb = visibleFunctionMap.get(info.scope)) {
         if (Vec<FnSymbol*>* fns = vfb->visibleFunctions.get(info.name)) {
@@ -4310,7 +4474,12 @@ FnSymbol* resolveNormalCall(CallExpr* call, bool checkonly) {
   }
 
   Vec<ResolutionCandidate*> candidates;
-  gatherCandidates(candidates, visibleFns, info);
+
+  if (cachedCandidate) {
+    candidates.add(cachedCandidate);
+  } else {
+    gatherCandidates(candidates, visibleFns, info);
+  }
 
   if ((explainCallLine && explainCallMatch(info.call)) ||
       call->id == explainCallID)
@@ -4359,6 +4528,8 @@ FnSymbol* resolveNormalCall(CallExpr* call, bool checkonly) {
   if (bestRef && bestValue) {
     valueCall = call->copy();
     call->insertAfter(valueCall);
+  } else if (useCache && !cachedFn && best) {
+    addCache(resolvedCallsCache, info.name, signature, best->fn);
   }
 
   if (best && best->fn) {
@@ -5304,10 +5475,13 @@ insertFormalTemps(FnSymbol* fn) {
 // behavior will result by applying "in" intents to them.
 static void addLocalCopiesAndWritebacks(FnSymbol* fn, SymbolMap& formals2vars)
 {
-  // Enumerate the formals that have local temps.
-  form_Map(SymbolMapElem, e, formals2vars) {
-    ArgSymbol* formal = toArgSymbol(e->key); // Get the formal.
-    Symbol*    tmp    = e->value; // Get the temp.
+  // Enumerate the formals that have local temps, in id order.
+  std::vector<Symbol*> formals;
+  sortedSymbolMapKeys(formals2vars, formals);
+
+  for_vector(Symbol, key, formals) {
+    ArgSymbol* formal = toArgSymbol(key); // Get the formal.
+    Symbol*    tmp    = formals2vars.get(key); // Get the temp.
 
     SET_LINENO(formal);
 
@@ -5850,13 +6024,8 @@ static Expr* createFunctionAsValue(CallExpr *call) {
   const char*        flname = use->unresolved;
 
   Vec<FnSymbol*>     visibleFns;
-  Vec<BlockStmt*>    visited;
 
-  getVisibleFunctions(getVisibilityBlock(call),
-                      flname,
-                      visibleFns,
-                      visited,
-                      call);
+  findVisibleFunctions(getVisibilityBlock(call), flname, call, visibleFns);
 
   if (visibleFns.n > 1) {
     USR_FATAL(call, "%s: can not capture overloaded functions as values",
@@ -9022,6 +9191,7 @@ void resolve() {
   freeCache(genericsCache);
   freeCache(coercionsCache);
   freeCache(promotionsCache);
+  freeCache(resolvedCallsCache);
   freeCache(capturedValues);
 
   Vec<VisibleFunctionBlock*> vfbs;
@@ -9036,6 +9206,7 @@ void resolve() {
   }
   visibleFunctionMap.clear();
   visibilityBlockCache.clear();
+  visibleFunctionsCache.clear();
   clearPartialCopyFnMap();
 
   forv_Vec(BlockStmt, stmt, gBlockStmts) {
@@ -9176,6 +9347,10 @@ static void filterVirtualChildren()
   }
 }
 
+static bool compareFnSymbolIds(FnSymbol* a, FnSymbol* b) {
+  return a->id < b->id;
+}
+
 static void resolveDynamicDispatches() {
   inDynamicDispatchResolution = true;
   int num_types;
@@ -9200,15 +9375,26 @@ static void resolveDynamicDispatches() {
     buildVirtualMaps();
   } while (num_types != gTypeSymbols.n);
 
+  // Add the roots in order of their ids rather than in the order of
+  // virtualRootsMap, which depends on where the functions are in memory,
+  // so that the virtual method tables are the same from one compile to
+  // the next.
+  std::vector<FnSymbol*> roots;
+
   for (int i = 0; i < virtualRootsMap.n; i++) {
     if (virtualRootsMap.v[i].key) {
       for (int j = 0; j < virtualRootsMap.v[i].value->n; j++) {
-        FnSymbol* root = virtualRootsMap.v[i].value->v[j];
-        addVirtualMethodTableEntry(root->_this->type, root, true);
+        roots.push_back(virtualRootsMap.v[i].value->v[j]);
       }
     }
   }
 
+  std::sort(roots.begin(), roots.end(), compareFnSymbolIds);
+
+  for_vector(FnSymbol, root, roots) {
+    addVirtualMethodTableEntry(root->_this->type, root, true);
+  }
+
   Vec<Type*> ctq;
   ctq.add(dtObject);
   forv_Vec(Type, ct, ctq) {
@@ -531,6 +531,8 @@ FnSymbol* instantiateSignature(FnSymbol*  fn,
 
   FnSymbol* newFn = fn->partialCopy(&map);
 
+  resolveNumInstantiations++;
+
   addCache(genericsCache, root, newFn, &all_subs);
 
   newFn->removeFlag(FLAG_GENERIC);
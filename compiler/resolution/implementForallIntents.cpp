@@ -171,12 +171,17 @@ static void createShadowVars(DefExpr* defChplIter, SymbolMap& uses,
   shadowVars.reserve(maxVars);
   reduceGVars.reserve(maxVars);
 
-  form_Map(SymbolMapElem, e, uses) {
+  // visit the variables in id order, so that the shadow variables and
+  // the leader's extra formals do not depend on memory layout
+  std::vector<Symbol*> keys;
+  sortedSymbolMapKeys(uses, keys);
+
+  for_vector(Symbol, ovar, keys) {
+    SymbolMapElem* e = uses.get_record(ovar);
     if (e->value == markPruned)
       continue;
 
     totOuterVars++;
-    Symbol* ovar = e->key;
     // If ovar is a reference, e.g. an index variable of
     // a 'var' iterator, we do not want to force
     // that ref type onto 'svar'. Otherwise the generated
@@ -263,7 +268,7 @@ static void createShadowVars(DefExpr* defChplIter, SymbolMap& uses,
 
       if (pruneit) {
         e->value = markPruned;  // our loops ignore such case explicitly
-        continue; // form_Map(uses)
+        continue; // for_vector(keys)
       }
     }  // if !isReduce
 
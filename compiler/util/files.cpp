@@ -50,6 +50,7 @@
 
 char               executableFilename[FILENAME_MAX + 1] = "a.out";
 char               saveCDir[FILENAME_MAX + 1]           = "";
+char               ccacheDir[FILENAME_MAX + 1]          = "";
 
 std::string ccflags;
 std::string ldflags;
@@ -626,6 +627,9 @@ void codegen_makefile(fileinfo* mainfile, const char** tmpbinname, bool skip_com
   fprintf(makefile.fptr, "COMP_GEN_SPECIALIZE = %i\n", specializeCCode);
   fprintf(makefile.fptr, "COMP_GEN_FLOAT_OPT = %i\n", ffloatOpt);
   
+  if (ccacheDir[0])
+    fprintf(makefile.fptr, "CHPL_CCACHE_DIR = %s\n", ccacheDir);
+
   fprintf(makefile.fptr, "COMP_GEN_USER_CFLAGS =");
 
   if (fLibraryCompile && (fLinkStyle==LS_DYNAMIC))
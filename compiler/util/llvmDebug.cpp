@@ -521,7 +521,7 @@ LLVM_DINAMESPACE debug_data::get_module_scope(ModuleSymbol* modSym)
 
 LLVM_DI_SUBROUTINE_TYPE debug_data::get_function_type(FnSymbol *function)
 {
-  const char *file_name = function->astloc.filename;
+  const char *file_name = function->astloc.filename();
   LLVM_DIFILE file = get_file(file_name);
   llvm::SmallVector<LLVM_METADATA_OPERAND_TYPE *,16> ret_arg_types;
 
@@ -547,7 +547,7 @@ LLVM_DISUBPROGRAM debug_data::construct_function(FnSymbol *function)
   const char *name = function->name;
   const char *cname = function->cname;
   ModuleSymbol* modSym = (ModuleSymbol*) function->defPoint->parentSymbol;
-  const char *file_name = function->astloc.filename;
+  const char *file_name = function->astloc.filename();
   int line_number = function->astloc.lineno;
   // Get the function using the cname since that is how it is
   // stored in the generated code. The name is just used within Chapel.
@@ -587,7 +587,7 @@ LLVM_DIGLOBALVARIABLE debug_data::construct_global_variable(VarSymbol *gVarSym)
   GenInfo *info = gGenInfo; 
   const char *name = gVarSym->name;
   const char *cname = gVarSym->cname;
-  const char *file_name = gVarSym->astloc.filename;
+  const char *file_name = gVarSym->astloc.filename();
   int line_number = gVarSym->astloc.lineno;
   
   LLVM_DIFILE file = get_file(file_name);
@@ -635,7 +635,7 @@ LLVM_DIGLOBALVARIABLE debug_data::get_global_variable(VarSymbol *gVarSym)
 LLVM_DIVARIABLE debug_data::construct_variable(VarSymbol *varSym)
 {
   const char *name = varSym->name;
-  const char *file_name = varSym->astloc.filename;
+  const char *file_name = varSym->astloc.filename();
   int line_number = varSym->astloc.lineno;
   FnSymbol *funcSym = NULL;
   if(isFnSymbol(varSym->defPoint->parentSymbol))
@@ -679,7 +679,7 @@ LLVM_DIVARIABLE debug_data::get_variable(VarSymbol *varSym)
 LLVM_DIVARIABLE debug_data::construct_formal_arg(ArgSymbol *argSym, unsigned ArgNo)
 {
   const char *name = argSym->name;
-  const char *file_name = argSym->astloc.filename;
+  const char *file_name = argSym->astloc.filename();
   int line_number = argSym->astloc.lineno;
   FnSymbol *funcSym = NULL;
   if(isFnSymbol(argSym->defPoint->parentSymbol))
@@ -245,11 +245,11 @@ printErrorHeader(BaseAST* ast) {
     linenum = ast->linenum();
   } else {
     have_ast_line = false;
-    if ( !err_print && currentAstLoc.filename && currentAstLoc.lineno > 0 ) {
+    if ( !err_print && currentAstLoc.filename() && currentAstLoc.lineno > 0 ) {
       // Use our best guess for the line number for user errors,
       // but don't do that for err_print (USR_PRINT) notes that don't
       // come with line numbers.
-      filename = cleanFilename(currentAstLoc.filename);
+      filename = cleanFilename(currentAstLoc.filename());
       linenum = currentAstLoc.lineno;
     } else {
       filename = NULL;
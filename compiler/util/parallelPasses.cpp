@@ -0,0 +1,201 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "parallelPasses.h"
+
+#include "driver.h"
+#include "expr.h"
+#include "misc.h"
+#include "stmt.h"
+#include "symbol.h"
+#include "TryStmt.h"
+#include "type.h"
+
+#include <pthread.h>
+
+bool parallelPassRunning = false;
+
+static pthread_mutex_t astLock;
+static bool            astLockInitialized = false;
+
+void lockAST() {
+  if (parallelPassRunning)
+    pthread_mutex_lock(&astLock);
+}
+
+void unlockAST() {
+  if (parallelPassRunning)
+    pthread_mutex_unlock(&astLock);
+}
+
+//
+// What a thread of a parallel pass keeps for itself: the ids it may
+// give to new AST nodes, and the nodes created by the function it is
+// working on.  The ids are only temporary; see forallFunctions().
+//
+static const int idBlockSize = 1024;
+
+static __thread int            threadNextId = 0;
+static __thread int            threadEndId  = 0;
+static __thread Vec<BaseAST*>* threadNewAsts = NULL;
+
+int workerAstId() {
+  if (threadNextId == threadEndId) {
+    lockAST();
+    threadNextId = reserveNodeIDs(idBlockSize);
+    unlockAST();
+
+    threadEndId = threadNextId + idBlockSize;
+  }
+
+  return threadNextId++;
+}
+
+void deferAstRegistration(BaseAST* ast) {
+  threadNewAsts->add(ast);
+}
+
+static void registerDeferredAst(BaseAST* ast) {
+#define register_ast(type)                              \
+  case E_##type:                                        \
+    g##type##s.add(static_cast<type*>(ast));            \
+    break
+
+  switch (ast->astTag) {
+    foreach_ast(register_ast);
+  }
+
+#undef register_ast
+}
+
+
+struct ParallelPass {
+  void           (*body)(FnSymbol* fn);
+  Vec<FnSymbol*> fns;
+  Vec<BaseAST*>* newAsts;     // the nodes created by the body for fns.v[i]
+  int            next;        // index of the next function to process
+};
+
+struct PassThread {
+  ParallelPass*  pass;
+  astlocT        astloc;      // currentAstLoc when the pass started
+  pthread_t      thread;
+
+  PassThread() : pass(NULL), astloc(0, NULL) { }
+};
+
+static void* runPassThread(void* arg) {
+  PassThread*   self = static_cast<PassThread*>(arg);
+  ParallelPass* pass = self->pass;
+
+  threadAstLocFilename = self->astloc.filename();
+  threadAstLocLineno   = self->astloc.lineno;
+
+  while (true) {
+    int i = __sync_fetch_and_add(&pass->next, 1);
+
+    if (i >= pass->fns.n)
+      break;
+
+    threadNewAsts = &pass->newAsts[i];
+    pass->body(pass->fns.v[i]);
+  }
+
+  return NULL;
+}
+
+void forallFunctions(void (*body)(FnSymbol* fn)) {
+  int nThreads = fCompilerThreads;
+
+  if (nThreads > gFnSymbols.n)
+    nThreads = gFnSymbols.n;
+
+  if (nThreads <= 1) {
+    forv_Vec(FnSymbol, fn, gFnSymbols) {
+      body(fn);
+    }
+
+    return;
+  }
+
+  if (!astLockInitialized) {
+    pthread_mutexattr_t attr;
+
+    // lockAST() may be held while e.g. a SymExpr is inserted
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&astLock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    astLockInitialized = true;
+  }
+
+  ParallelPass pass;
+
+  pass.body    = body;
+  pass.fns.copy(gFnSymbols);
+  pass.newAsts = new Vec<BaseAST*>[pass.fns.n];
+  pass.next    = 0;
+
+  int firstId = reserveNodeIDs(0);
+
+  // The compiler recurses deeply over large functions.
+  pthread_attr_t attr;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, 64 * 1024 * 1024);
+
+  PassThread* threads = new PassThread[nThreads];
+
+  parallelPassRunning = true;
+
+  for (int i = 0; i < nThreads; i++) {
+    threads[i].pass   = &pass;
+    threads[i].astloc = currentAstLoc;
+
+    if (pthread_create(&threads[i].thread, &attr, runPassThread, &threads[i]))
+      INT_FATAL("unable to start compiler thread");
+  }
+
+  for (int i = 0; i < nThreads; i++)
+    pthread_join(threads[i].thread, NULL);
+
+  parallelPassRunning = false;
+
+  pthread_attr_destroy(&attr);
+
+  //
+  // The threads took the functions, and blocks of ids, in whatever order
+  // they got to them.  Give the new nodes the ids, and the places in
+  // gSymExprs etc., that they would have had if the functions had been
+  // processed one at a time in order, so that the rest of the
+  // compilation (and the generated code) does not depend on it.
+  //
+  resetNodeIDs(firstId);
+
+  for (int i = 0; i < pass.fns.n; i++) {
+    forv_Vec(BaseAST, ast, pass.newAsts[i]) {
+      renumberNodeID(ast);
+      registerDeferredAst(ast);
+    }
+  }
+
+  delete [] pass.newAsts;
+  delete [] threads;
+}
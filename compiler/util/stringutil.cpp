@@ -24,62 +24,146 @@
 #include "stringutil.h"
 
 #include "misc.h"
+#include "parallelPasses.h"
 
 #include <algorithm>
 #include <functional>
 #include <inttypes.h>
+#include <pthread.h>
 #include <sstream>
 
-static ChainHashMap<const char*, StringHashFns, const char*> chapelStringsTable;
+//
+// The table of the canonical strings returned by astr().  Most calls to
+// astr() are for a string that is already in the table (an identifier
+// seen before, say), so the lookup works on the caller's text and a
+// copy is only made for a new string.
+//
+// The table uses open addressing with linear probing and doubles when
+// it is half full.  Each slot keeps the hash of its string so that
+// probing and growing rarely have to look at the string itself.
+//
+struct CanonicalString {
+  unsigned int hash;
+  const char*  str;
+};
+
+static CanonicalString* sStrings      = NULL;
+static unsigned int     sStringsSize  = 0;   // a power of 2
+static unsigned int     sStringsCount = 0;
+
+static unsigned int hashString(const char* s, size_t len) {
+  unsigned int h = 2166136261u;
+
+  for (size_t i = 0; i < len; i++)
+    h = (h ^ (unsigned char)s[i]) * 16777619u;
+
+  return h;
+}
+
+static void growStrings() {
+  CanonicalString* old     = sStrings;
+  unsigned int     oldSize = sStringsSize;
+
+  sStringsSize = (oldSize == 0) ? 1 << 14 : oldSize * 2;
+  sStrings     = (CanonicalString*)calloc(sStringsSize,
+                                          sizeof(CanonicalString));
+
+  for (unsigned int i = 0; i < oldSize; i++) {
+    if (old[i].str) {
+      unsigned int j = old[i].hash & (sStringsSize - 1);
+
+      while (sStrings[j].str)
+        j = (j + 1) & (sStringsSize - 1);
 
+      sStrings[j] = old[i];
+    }
+  }
+
+  free(old);
+}
+
+//
+// Return the canonical copy of the len characters at s, which need not
+// be NUL-terminated, adding a copy to the table if there is none yet.
+//
 static const char*
-canonicalize_string(const char *s) {
-  const char* ss = chapelStringsTable.get(s);
-  if (!ss) {
-    chapelStringsTable.put(s, s);
-    return s;
+findOrAddString(const char* s, size_t len) {
+  unsigned int h = hashString(s, len);
+  unsigned int i = 0;
+
+  if (2 * (sStringsCount + 1) > sStringsSize)
+    growStrings();
+
+  for (i = h & (sStringsSize - 1);
+       sStrings[i].str != NULL;
+       i = (i + 1) & (sStringsSize - 1)) {
+    const char* t = sStrings[i].str;
+
+    if (sStrings[i].hash == h && strncmp(t, s, len) == 0 && t[len] == '\0')
+      return t;
   }
-  return ss;
+
+  char* copy = (char*)malloc(len + 1);
+
+  memcpy(copy, s, len);
+  copy[len] = '\0';
+
+  sStrings[i].hash = h;
+  sStrings[i].str  = copy;
+  sStringsCount++;
+
+  return copy;
+}
+
+// The table is shared by the threads of a parallel pass.
+static pthread_mutex_t sStringsLock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char*
+canonicalize_string(const char* s, size_t len) {
+  if (!parallelPassRunning)
+    return findOrAddString(s, len);
+
+  pthread_mutex_lock(&sStringsLock);
+
+  const char* retval = findOrAddString(s, len);
+
+  pthread_mutex_unlock(&sStringsLock);
+
+  return retval;
 }
 
 const char*
 astr(const char* s1, const char* s2, const char* s3, const char* s4,
      const char* s5, const char* s6, const char* s7, const char* s8) {
-  int len;
-  len = strlen(s1);
-  if (s2)
-    len += strlen(s2);
-  if (s3)
-    len += strlen(s3);
-  if (s4)
-    len += strlen(s4);
-  if (s5)
-    len += strlen(s5);
-  if (s6)
-    len += strlen(s6);
-  if (s7)
-    len += strlen(s7);
-  if (s8)
-    len += strlen(s8);
-  char* s = (char*)malloc(len+1);
-  strcpy(s, s1);
-  if (s2)
-    strcat(s, s2);
-  if (s3)
-    strcat(s, s3);
-  if (s4)
-    strcat(s, s4);
-  if (s5)
-    strcat(s, s5);
-  if (s6)
-    strcat(s, s6);
-  if (s7)
-    strcat(s, s7);
-  if (s8)
-    strcat(s, s8);
-  const char* t = canonicalize_string(s);
-  if (s != t)
+  const char* parts[8] = { s1, s2, s3, s4, s5, s6, s7, s8 };
+  size_t      lens[8];
+  size_t      len      = 0;
+  char        buf[256];
+
+  for (int i = 0; i < 8; i++) {
+    lens[i]  = (parts[i] != NULL) ? strlen(parts[i]) : 0;
+    len     += lens[i];
+  }
+
+  if (len == lens[0])
+    return canonicalize_string(s1, len);
+
+  // Put the pieces together on the stack when they fit
+  char*       s   = (len < sizeof(buf)) ? buf : (char*)malloc(len + 1);
+  size_t      pos = 0;
+
+  for (int i = 0; i < 8; i++) {
+    if (lens[i] > 0) {
+      memcpy(s + pos, parts[i], lens[i]);
+      pos += lens[i];
+    }
+  }
+
+  const char* t = canonicalize_string(s, len);
+
+  if (s != buf)
     free(s);
+
   return t;
 }
 
@@ -97,22 +181,20 @@ istr(int i) {
 // note: e must be in s
 //
 const char* asubstr(const char* s, const char* e) {
-  char* ss = (char*)malloc(e-s+1);
-  strncpy(ss, s, e-s);
-  ss[e-s] = '\0';
-  const char* t = canonicalize_string(ss);
-  if (ss != t)
-    free(ss);
-  return t;
+  return canonicalize_string(s, e - s);
 }
 
 
 void deleteStrings() {
-  Vec<const char*> keys;
-  chapelStringsTable.get_keys(keys);
-  forv_Vec(const char, key, keys) {
-    free(const_cast<char*>(key));
+  for (unsigned int i = 0; i < sStringsSize; i++) {
+    free(const_cast<char*>(sStrings[i].str));
   }
+
+  free(sStrings);
+
+  sStrings      = NULL;
+  sStringsSize  = 0;
+  sStringsCount = 0;
 }
 
 
@@ -1114,6 +1114,24 @@ module ChapelArray {
 
       return _newArray(x);
     }
+
+    pragma "no doc"
+    // Build an array over this domain whose elements live in 'extData',
+    // which is owned (and eventually released) by 'storage'.
+    // Only supported for default rectangular domains.
+    proc buildArrayWithExternStorage(type eltType, extData: _ddata(eltType),
+                                     storage) {
+      if !isPODType(eltType) then
+        compilerError("arrays over external storage require a plain-old-data element type");
+      var x = _value.dsiBuildArrayWithExternStorage(eltType, extData, storage);
+      pragma "dont disable remote value forwarding"
+      proc help() {
+        _value.add_arr(x);
+      }
+      help();
+
+      return _newArray(x);
+    }
     /* Remove all indices from this domain, leaving it empty */
     proc clear() {
       _value.dsiClear();
@@ -0,0 +1,236 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// ChapelLoopStats.chpl
+//
+// Support for --instrument-loops.  With that flag, the compiler wraps
+// each forall and coforall statement in user code like this:
+//
+//   var s = chpl_loopStatsBegin();
+//   ...for each chunk a task gets (each task, for a coforall)...
+//     var start = chpl_loopStatsNow(), n = 0;
+//     for i in chunk { n += 1; body(i); }
+//     chpl_loopStatsChunk(s, n, start);
+//   chpl_loopStatsEnd(s, kind);
+//
+// and the results are kept by runtime/src/chpl-loop-stats.c.
+//
+// A forall over an iterator's standalone version cannot see its
+// chunks.  It calls chpl_loopStatsIter(s, id) in each iteration
+// instead, which counts the iteration for the thread running it, and
+// at the end the counts of the threads that ran the loop are its
+// chunks.  Their times are not known.
+//
+module ChapelLoopStats {
+
+  // Set by --instrument-loops.
+  config param CHPL_INSTRUMENT_LOOPS = false;
+
+  // chpl_loop_stats_kind_standalone in chpl-loop-stats.h
+  private param standaloneKind = 2;
+
+  //
+  // What one execution of a loop has seen so far.  The tasks running
+  // the chunks may be on other locales, so each adds its chunk in one
+  // on-statement, with atomic operations rather than a lock.
+  //
+  pragma "no doc"
+  class chpl_LoopStats {
+    var iters, chunks, maxChunk : atomic int;
+    var minChunk : atomic int;
+    var taskNs, maxTaskNs : atomic uint(64);
+    var minTaskNs : atomic uint(64);
+    var startNs : uint(64);
+    var id : uint(64);
+    var remote : atomic bool;   // standalone iterations ran on other locales
+  }
+
+  private inline proc atomicMin(ref a, x) {
+    var cur = a.read(memory_order_relaxed);
+    while x < cur && !a.compareExchangeWeak(cur, x, memory_order_relaxed) do
+      cur = a.read(memory_order_relaxed);
+  }
+
+  private inline proc atomicMax(ref a, x) {
+    var cur = a.read(memory_order_relaxed);
+    while x > cur && !a.compareExchangeWeak(cur, x, memory_order_relaxed) do
+      cur = a.read(memory_order_relaxed);
+  }
+
+  pragma "no doc"
+  proc chpl_loopStatsBegin() {
+    var s = new chpl_LoopStats();
+    s.minChunk.write(max(int), memory_order_relaxed);
+    s.minTaskNs.write(max(uint(64)), memory_order_relaxed);
+    s.startNs = chpl_now_ns();
+    s.id = chpl_loop_stats_new_id();
+    return s;
+  }
+
+  pragma "no doc"
+  inline proc chpl_loopStatsNow() return chpl_now_ns();
+
+  pragma "no doc"
+  proc chpl_loopStatsChunk(s : chpl_LoopStats, iters : int, startNs : uint(64)) {
+    const ns = chpl_now_ns() - startNs;
+
+    on s {
+      s.iters.add(iters, memory_order_relaxed);
+      s.chunks.add(1, memory_order_relaxed);
+      atomicMin(s.minChunk, iters);
+      atomicMax(s.maxChunk, iters);
+      s.taskNs.add(ns, memory_order_relaxed);
+      atomicMin(s.minTaskNs, ns);
+      atomicMax(s.maxTaskNs, ns);
+    }
+  }
+
+  //
+  // The id is passed separately so that counting an iteration does not
+  // read s, which may be on another locale.
+  //
+  pragma "no doc"
+  inline proc chpl_loopStatsIter(s : chpl_LoopStats, id : uint(64)) {
+    if chpl_loop_stats_iter(id) && (id >> 48) : int(32) != chpl_nodeID then
+      s.remote.write(true);
+  }
+
+  // Add this locale's thread counts for a standalone forall to s.
+  private proc loopStatsCollect(s : chpl_LoopStats) {
+    var site : chpl_loop_stats_site_t;
+
+    chpl_loop_stats_collect(s.id, site);
+    if site.chunks > 0 then on s {
+      s.iters.add(site.iters : int, memory_order_relaxed);
+      s.chunks.add(site.chunks : int, memory_order_relaxed);
+      atomicMin(s.minChunk, site.min_chunk : int);
+      atomicMax(s.maxChunk, site.max_chunk : int);
+    }
+  }
+
+  //
+  // The loop is done; add it to its site.  The imbalance is the
+  // longest time a task spent on a chunk over the mean time, or for a
+  // standalone forall, the most iterations a thread ran over the mean.
+  //
+  pragma "no doc"
+  proc chpl_loopStatsEnd(s : chpl_LoopStats, kind : int) {
+    var site : chpl_loop_stats_site_t;
+
+    if kind == standaloneKind {
+      if s.remote.read() then
+        coforall node in 0..#chpl_numNodes do
+          on __primitive("chpl_on_locale_num",
+                         chpl_buildLocaleID(node : int(32), c_sublocid_any)) do
+            loopStatsCollect(s);
+      else
+        loopStatsCollect(s);
+    }
+
+    const chunks = s.chunks.read(),
+          taskNs = s.taskNs.read(),
+          maxTaskNs = s.maxTaskNs.read();
+
+    site.kind = kind : int(32);
+    site.pad = 0;
+    site.calls = 1;
+    site.iters = s.iters.read() : uint(64);
+    site.chunks = chunks : uint(64);
+    site.min_chunk = s.minChunk.read() : uint(64);
+    site.max_chunk = s.maxChunk.read() : uint(64);
+    site.task_ns = taskNs;
+    site.min_task_ns = s.minTaskNs.read();
+    site.max_task_ns = maxTaskNs;
+    site.wall_ns = chpl_now_ns() - s.startNs;
+    site.imbal_sum = 0.0;
+    if kind == standaloneKind {
+      if site.iters > 0 then
+        site.imbal_sum = site.max_chunk : real * chunks / site.iters;
+      site.task_ns = 0;
+      site.min_task_ns = 0;
+      site.max_task_ns = 0;
+    } else if chunks > 0 && taskNs > 0 then
+      site.imbal_sum = maxTaskNs : real * chunks / taskNs;
+    site.imbal_max = site.imbal_sum;
+
+    chpl_loop_stats_record(site);
+    delete s;
+  }
+
+  //
+  // At exit, locale 0 adds the other locales' sites to its own, one at
+  // a time, and prints the result.  This relies on module-level records
+  // being destroyed at the end of the program, while the locales are
+  // still up.
+  //
+  pragma "no doc"
+  record _loopStatsReporter {
+    proc ~_loopStatsReporter() {
+      if !CHPL_INSTRUMENT_LOOPS then return;
+
+      for node in 1..chpl_numNodes-1 {
+        const loc = chpl_buildLocaleID(node, c_sublocid_any);
+        var n : int;
+
+        on __primitive("chpl_on_locale_num", loc) do
+          n = chpl_loop_stats_num_sites();
+
+        for i in 0..#n {
+          var site : chpl_loop_stats_site_t;
+
+          on __primitive("chpl_on_locale_num", loc) {
+            var localSite : chpl_loop_stats_site_t;
+
+            chpl_loop_stats_get_site(i, localSite);
+            site = localSite;
+          }
+
+          chpl_loop_stats_add_site(site);
+        }
+      }
+
+      chpl_loop_stats_report();
+    }
+  }
+
+  private var loopStatsReporter : _loopStatsReporter;
+
+  private extern var chpl_numNodes : int(32);
+  private extern var chpl_nodeID : int(32);
+
+  extern record chpl_loop_stats_site_t {
+    var kind, lineno, filename, pad : int(32);
+    var calls, iters, chunks, min_chunk, max_chunk : uint(64);
+    var task_ns, min_task_ns, max_task_ns, wall_ns : uint(64);
+    var imbal_sum, imbal_max : real;
+  }
+
+  private extern proc chpl_now_ns() : uint(64);
+  private extern proc chpl_loop_stats_new_id() : uint(64);
+  private extern proc chpl_loop_stats_iter(id : uint(64)) : bool;
+  private extern proc chpl_loop_stats_collect(id : uint(64), ref site : chpl_loop_stats_site_t);
+
+  pragma "insert line file info"
+  private extern proc chpl_loop_stats_record(ref site : chpl_loop_stats_site_t);
+
+  private extern proc chpl_loop_stats_num_sites() : int;
+  private extern proc chpl_loop_stats_get_site(i : int, ref site : chpl_loop_stats_site_t);
+  private extern proc chpl_loop_stats_add_site(ref site : chpl_loop_stats_site_t);
+  private extern proc chpl_loop_stats_report();
+}
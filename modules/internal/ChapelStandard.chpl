@@ -56,6 +56,7 @@ module ChapelStandard {
   use DefaultOpaque;
   use ChapelTaskID;
   use ChapelTaskTable;
+  use ChapelLoopStats;
   use MemTracking;
   use ChapelUtil;
   use ChapelDynDispHack;
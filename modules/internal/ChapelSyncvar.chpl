@@ -497,7 +497,11 @@ module ChapelSyncvar {
         var alignedLocalRet : aligned_t;
 
         chpl_rmem_consist_release();
+        const profStart = chpl_sync_prof_start();
+        const profWaited = profStart != 0 && qthread_feb_status(alignedValue) == 0;
         qthread_readFE(alignedLocalRet, alignedValue);
+        if profStart != 0 then
+          chpl_sync_prof_op(chpl_sync_prof_kind_waitFull, profStart, profWaited);
         chpl_rmem_consist_acquire();
 
         ret = alignedLocalRet : valType;
@@ -513,7 +517,11 @@ module ChapelSyncvar {
         var alignedLocalRet : aligned_t;
 
         chpl_rmem_consist_release();
+        const profStart = chpl_sync_prof_start();
+        const profWaited = profStart != 0 && qthread_feb_status(alignedValue) == 0;
         qthread_readFF(alignedLocalRet, alignedValue);
+        if profStart != 0 then
+          chpl_sync_prof_op(chpl_sync_prof_kind_waitFull, profStart, profWaited);
         chpl_rmem_consist_acquire();
 
         ret = alignedLocalRet : valType;
@@ -544,7 +552,11 @@ module ChapelSyncvar {
     proc writeEF(val : valType) {
       on this {
         chpl_rmem_consist_release();
+        const profStart = chpl_sync_prof_start();
+        const profWaited = profStart != 0 && qthread_feb_status(alignedValue) != 0;
         qthread_writeEF(alignedValue, val : aligned_t);
+        if profStart != 0 then
+          chpl_sync_prof_op(chpl_sync_prof_kind_waitEmpty, profStart, profWaited);
         chpl_rmem_consist_acquire();
       }
     }
@@ -552,7 +564,11 @@ module ChapelSyncvar {
     proc writeFF(val : valType) {
       on this {
         chpl_rmem_consist_release();
+        const profStart = chpl_sync_prof_start();
+        const profWaited = profStart != 0 && qthread_feb_status(alignedValue) == 0;
         qthread_writeFF(alignedValue, val : aligned_t);
+        if profStart != 0 then
+          chpl_sync_prof_op(chpl_sync_prof_kind_waitFull, profStart, profWaited);
         chpl_rmem_consist_acquire();
       }
     }
@@ -586,6 +602,48 @@ module ChapelSyncvar {
     }
   }
 
+  /************************************ | *************************************
+  *                                                                           *
+  * The sync profiler (see runtime/include/chpl-sync-profile.h) counts on     *
+  * each locale.  At exit, locale 0 adds the other locales' counts to its     *
+  * own, one site at a time, and prints the result.  This relies on           *
+  * module-level records being destroyed at the end of the program, while     *
+  * the locales are still up.                                                 *
+  *                                                                           *
+  ************************************* | ************************************/
+
+  pragma "no doc"
+  record _syncProfReporter {
+    proc ~_syncProfReporter() {
+      if chpl_sync_prof_on == 0 then return;
+
+      for node in 1..chpl_numNodes-1 {
+        const loc = chpl_buildLocaleID(node, c_sublocid_any);
+        var n : int;
+
+        on __primitive("chpl_on_locale_num", loc) do
+          n = chpl_sync_prof_num_sites();
+
+        for i in 0..#n {
+          var site : chpl_sync_prof_site_t;
+
+          on __primitive("chpl_on_locale_num", loc) {
+            var localSite : chpl_sync_prof_site_t;
+
+            chpl_sync_prof_get_site(i, localSite);
+            site = localSite;
+          }
+
+          chpl_sync_prof_add_site(site);
+        }
+      }
+
+      chpl_sync_prof_report();
+    }
+  }
+
+  private var syncProfReporter : _syncProfReporter;
+
   pragma "no doc"
   proc isSyncValue(x : sync) param  return true;
 
@@ -886,6 +944,34 @@ private module SyncVarRuntimeSupport {
                                    ref aux : chpl_single_aux_t) : bool;
 
 
+  //
+  // Sync profiler externs
+  //
+
+  extern var    chpl_sync_prof_on : c_int;
+  extern var    chpl_numNodes : int(32);
+
+  extern const  chpl_sync_prof_kind_waitFull  : c_int;
+  extern const  chpl_sync_prof_kind_waitEmpty : c_int;
+
+  extern proc   chpl_sync_prof_start() : uint(64);
+
+  pragma "insert line file info"
+  extern proc   chpl_sync_prof_op(kind    : c_int,
+                                  start   : uint(64),
+                                  waited  : bool);
+
+  extern record chpl_sync_prof_site_t {
+    var kind, lineno, filename, pad : int(32);
+    var ops, waits, wait_ns, transfers : uint(64);
+  }
+
+  extern proc   chpl_sync_prof_num_sites() : int;
+  extern proc   chpl_sync_prof_get_site(i : int, ref site : chpl_sync_prof_site_t);
+  extern proc   chpl_sync_prof_add_site(ref site : chpl_sync_prof_site_t);
+  extern proc   chpl_sync_prof_report();
+
+
   //
   // Native qthreads sync var helpers and externs
   //
@@ -602,6 +602,16 @@ module DefaultRectangular {
                                       stridable=stridable, dom=this);
     }
 
+    proc dsiBuildArrayWithExternStorage(type eltType, extData: _ddata(eltType),
+                                        storage: DefaultRectangularExternStorage) {
+      var arr = new DefaultRectangularArr(eltType=eltType, rank=rank,
+                                          idxType=idxType,
+                                          stridable=stridable, dom=this,
+                                          noinit_data=true);
+      arr.initializeWithExternStorage(extData, storage);
+      return arr;
+    }
+
     proc dsiBuildRectangularDom(param rank: int, type idxType, param stridable: bool,
                               ranges: rank*range(idxType,
                                                  BoundedRangeType.bounded,
@@ -745,6 +755,15 @@ module DefaultRectangular {
     }
   }
 
+  //
+  // Owner of element storage that was not allocated by DefaultRectangular
+  // (e.g. a mapped region of a file).  Subclasses override release() to
+  // free that storage; it is called once, when the array is destroyed.
+  //
+  class DefaultRectangularExternStorage {
+    proc release() { }
+  }
+
   class DefaultRectangularArr: BaseArr {
     type eltType;
     param rank : int;
@@ -785,6 +804,10 @@ module DefaultRectangular {
 
     var noinit_data: bool = false;
 
+    // If non-nil, 'data' is owned by this object rather than allocated
+    // by the array.  Only used for arrays of plain-old-data.
+    var externStorage: DefaultRectangularExternStorage = nil;
+
     // 'dataAllocRange' is used by the array-vector operations (e.g. push_back,
     // pop_back, insert, remove) to allow growing or shrinking the data
     // buffer in a doubling/halving style.  If it is used, it will be the
@@ -814,6 +837,7 @@ module DefaultRectangular {
         }
       }
       writeln("noinit_data=", noinit_data);
+      writeln("externStorage=", externStorage != nil);
     }
 
     // can the compiler create this automatically?
@@ -842,6 +866,17 @@ module DefaultRectangular {
         return;
       }
 
+      // The elements need no destruction; just hand the storage back.
+      if externStorage != nil {
+        if !defRectSimpleDData {
+          _ddata_free(mData);
+        }
+        externStorage.release();
+        delete externStorage;
+        externStorage = nil;
+        return;
+      }
+
       if dom.dsiNumIndices > 0 {
         pragma "no copy" pragma "no auto destroy" var dr = dataChunk(0);
         pragma "no copy" pragma "no auto destroy" var dv = __primitive("deref", dr);
@@ -1247,15 +1282,7 @@ module DefaultRectangular {
     // we want to get rid of all initialize functions everywhere
     proc initialize() {
       if noinit_data == true then return;
-      for param dim in 1..rank {
-        off(dim) = dom.dsiDim(dim).alignedLow;
-        str(dim) = dom.dsiDim(dim).stride;
-      }
-      blk(rank) = 1:idxType;
-      for param dim in 1..(rank-1) by -1 do
-        blk(dim) = blk(dim+1) * dom.dsiDim(dim+1).length;
-      computeFactoredOffs();
-      var size = blk(1) * dom.dsiDim(1).length;
+      var size = initializeLayout();
 
       if defRectSimpleDData {
         data = _ddata_allocate(eltType, size);
@@ -1325,6 +1352,55 @@ module DefaultRectangular {
         dataAllocRange = dom.dsiDim(1);
     }
 
+    // Compute off, blk, str and factoredOffs for a row-major layout of
+    // dom and return the number of elements that layout needs.
+    proc initializeLayout() {
+      for param dim in 1..rank {
+        off(dim) = dom.dsiDim(dim).alignedLow;
+        str(dim) = dom.dsiDim(dim).stride;
+      }
+      blk(rank) = 1:idxType;
+      for param dim in 1..(rank-1) by -1 do
+        blk(dim) = blk(dim+1) * dom.dsiDim(dim+1).length;
+      computeFactoredOffs();
+      return blk(1) * dom.dsiDim(1).length;
+    }
+
+    // Like initialize(), but use 'extData' (owned by 'storage') for the
+    // elements instead of allocating them.  'extData' must hold
+    // dom.dsiNumIndices elements in row-major order.
+    proc initializeWithExternStorage(extData: _ddata(eltType),
+                                     storage: DefaultRectangularExternStorage) {
+      initializeLayout();
+
+      if defRectSimpleDData {
+        data = extData;
+      } else {
+        // external storage is always a single chunk
+        mdParDim = 1;
+        mdNumChunks = 1;
+        mdRLo = dom.dsiDim(mdParDim).alignedLow;
+        mdRHi = dom.dsiDim(mdParDim).alignedHigh;
+        mdRStr = abs(dom.dsiDim(mdParDim).stride):idxType;
+        mdRLen = dom.dsiDim(mdParDim).length;
+        mdBlk = 1;
+        mData = _ddata_allocate(_multiData(eltType=eltType,
+                                           idxType=idxType),
+                                mdNumChunks);
+        if stridable then
+          mData(0).pdr = dom.dsiDim(mdParDim).low..dom.dsiDim(mdParDim).high
+                         by dom.dsiDim(mdParDim).stride;
+        else
+          mData(0).pdr = dom.dsiDim(mdParDim).low..dom.dsiDim(mdParDim).high;
+        mData(0).data = extData;
+      }
+      externStorage = storage;
+
+      initShiftedData();
+      if rank == 1 && !stridable then
+        dataAllocRange = dom.dsiDim(1);
+    }
+
     inline proc mdInd2Chunk(ind)
       where !defRectSimpleDData {
       if stridable then
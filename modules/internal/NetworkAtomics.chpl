@@ -20,6 +20,15 @@
 pragma "atomic module"
 module NetworkAtomics {
 
+  // Sync profiler hooks; see runtime/include/chpl-sync-profile.h.
+  private extern const chpl_sync_prof_kind_atomicCAS : c_int;
+  private extern const chpl_sync_prof_kind_atomicTAS : c_int;
+  private extern const chpl_sync_prof_kind_atomicWait : c_int;
+  private extern proc chpl_sync_prof_start(): uint(64);
+  pragma "insert line file info"
+  private extern proc chpl_sync_prof_op(kind:c_int, start:uint(64),
+                                        waited:bool);
+
   // int(64)
   pragma "insert line file info"
   extern proc chpl_comm_atomic_get_int64(ref result:int(64),
@@ -97,7 +106,10 @@ module NetworkAtomics {
       var ret:bool(32);
       var te = expected;
       var td = desired;
+      const profStart = chpl_sync_prof_start();
       chpl_comm_atomic_cmpxchg_int64(te, td, this.locale.id:int(32), this._v, ret);
+      if profStart != 0 then
+        chpl_sync_prof_op(chpl_sync_prof_kind_atomicCAS, profStart, !ret);
       return ret;
     }
     inline proc compareExchangeWeak(expected:int(64), desired:int(64),
@@ -166,7 +178,15 @@ module NetworkAtomics {
 
     inline proc waitFor(val:int(64), order:memory_order = memory_order_seq_cst) {
       on this {
-        while (read(memory_order_relaxed) != val) do chpl_task_yield();
+        const profStart = chpl_sync_prof_start();
+        var profWaited = false;
+        while (read(memory_order_relaxed) != val) {
+          profWaited = true;
+          chpl_task_yield();
+        }
+        if profStart != 0 then
+          chpl_sync_prof_op(chpl_sync_prof_kind_atomicWait, profStart,
+                            profWaited);
         // After waiting for the value, do a thread fence
         // in order to guarantee e.g. an acquire barrier even
         // if the on statement is not included.
@@ -291,7 +311,10 @@ module NetworkAtomics {
       var ret:bool(32);
       var te = expected;
       var td = desired;
+      const profStart = chpl_sync_prof_start();
       chpl_comm_atomic_cmpxchg_int32(te, td, this.locale.id:int(32), this._v, ret);
+      if profStart != 0 then
+        chpl_sync_prof_op(chpl_sync_prof_kind_atomicCAS, profStart, !ret);
       return ret;
     }
     inline proc compareExchangeWeak(expected:int(32), desired:int(32),
@@ -360,7 +383,15 @@ module NetworkAtomics {
 
     inline proc waitFor(val:int(32), order:memory_order = memory_order_seq_cst) {
       on this {
-        while (read(memory_order_relaxed) != val) do chpl_task_yield();
+        const profStart = chpl_sync_prof_start();
+        var profWaited = false;
+        while (read(memory_order_relaxed) != val) {
+          profWaited = true;
+          chpl_task_yield();
+        }
+        if profStart != 0 then
+          chpl_sync_prof_op(chpl_sync_prof_kind_atomicWait, profStart,
+                            profWaited);
         atomic_thread_fence(order);
       }
     }
@@ -482,7 +513,10 @@ module NetworkAtomics {
       var ret:bool(32);
       var te = expected;
       var td = desired;
+      const profStart = chpl_sync_prof_start();
       chpl_comm_atomic_cmpxchg_uint64(te, td, this.locale.id:int(32), this._v, ret);
+      if profStart != 0 then
+        chpl_sync_prof_op(chpl_sync_prof_kind_atomicCAS, profStart, !ret);
       return ret;
     }
     inline proc compareExchangeWeak(expected:uint(64), desired:uint(64),
@@ -551,7 +585,15 @@ module NetworkAtomics {
 
     inline proc waitFor(val:uint(64), order:memory_order = memory_order_seq_cst) {
       on this {
-        while (read(memory_order_relaxed) != val) do chpl_task_yield();
+        const profStart = chpl_sync_prof_start();
+        var profWaited = false;
+        while (read(memory_order_relaxed) != val) {
+          profWaited = true;
+          chpl_task_yield();
+        }
+        if profStart != 0 then
+          chpl_sync_prof_op(chpl_sync_prof_kind_atomicWait, profStart,
+                            profWaited);
         atomic_thread_fence(order);
       }
     }
@@ -673,7 +715,10 @@ module NetworkAtomics {
       var ret:bool(32);
       var te = expected;
       var td = desired;
+      const profStart = chpl_sync_prof_start();
       chpl_comm_atomic_cmpxchg_uint32(te, td, this.locale.id:int(32), this._v, ret);
+      if profStart != 0 then
+        chpl_sync_prof_op(chpl_sync_prof_kind_atomicCAS, profStart, !ret);
       return ret;
     }
     inline proc compareExchangeWeak(expected:uint(32), desired:uint(32),
@@ -742,7 +787,15 @@ module NetworkAtomics {
 
     inline proc waitFor(val:uint(32), order:memory_order = memory_order_seq_cst) {
       on this {
-        while (read(memory_order_relaxed) != val) do chpl_task_yield();
+        const profStart = chpl_sync_prof_start();
+        var profWaited = false;
+        while (read(memory_order_relaxed) != val) {
+          profWaited = true;
+          chpl_task_yield();
+        }
+        if profStart != 0 then
+          chpl_sync_prof_op(chpl_sync_prof_kind_atomicWait, profStart,
+                            profWaited);
         atomic_thread_fence(order);
       }
     }
@@ -812,7 +865,10 @@ module NetworkAtomics {
       var ret:bool(32);
       var te = expected:int(64);
       var td = desired:int(64);
+      const profStart = chpl_sync_prof_start();
       chpl_comm_atomic_cmpxchg_int64(te, td, this.locale.id:int(32), this._v, ret);
+      if profStart != 0 then
+        chpl_sync_prof_op(chpl_sync_prof_kind_atomicCAS, profStart, !ret);
       return ret;
     }
 inline proc compareExchangeWeak(expected:bool, desired:bool,
@@ -825,7 +881,11 @@ inline proc compareExchangeWeak(expected:bool, desired:bool,
     }
 
     inline proc testAndSet():bool {
-      return this.exchange(true);
+      const profStart = chpl_sync_prof_start();
+      const ret = this.exchange(true);
+      if profStart != 0 then
+        chpl_sync_prof_op(chpl_sync_prof_kind_atomicTAS, profStart, ret);
+      return ret;
     }
     inline proc clear() {
       this.write(false);
@@ -833,7 +893,15 @@ inline proc compareExchangeWeak(expected:bool, desired:bool,
 
     inline proc waitFor(val:bool, order:memory_order = memory_order_seq_cst) {
       on this {
-        while (read(memory_order_relaxed) != val) do chpl_task_yield();
+        const profStart = chpl_sync_prof_start();
+        var profWaited = false;
+        while (read(memory_order_relaxed) != val) {
+          profWaited = true;
+          chpl_task_yield();
+        }
+        if profStart != 0 then
+          chpl_sync_prof_op(chpl_sync_prof_kind_atomicWait, profStart,
+                            profWaited);
         atomic_thread_fence(order);
       }
     }
@@ -933,7 +1001,10 @@ inline proc compareExchangeWeak(expected:bool, desired:bool,
       var ret:bool(32);
       var te = expected;
       var td = desired;
+      const profStart = chpl_sync_prof_start();
       chpl_comm_atomic_cmpxchg_real64(te, td, this.locale.id:int(32), this._v, ret);
+      if profStart != 0 then
+        chpl_sync_prof_op(chpl_sync_prof_kind_atomicCAS, profStart, !ret);
       return ret;
     }
     inline proc compareExchangeWeak(expected:real(64), desired:real(64),
@@ -991,7 +1062,15 @@ inline proc compareExchangeWeak(expected:bool, desired:bool,
 
     inline proc waitFor(val:real(64), order:memory_order = memory_order_seq_cst) {
       on this {
-        while (read(memory_order_relaxed) != val) do chpl_task_yield();
+        const profStart = chpl_sync_prof_start();
+        var profWaited = false;
+        while (read(memory_order_relaxed) != val) {
+          profWaited = true;
+          chpl_task_yield();
+        }
+        if profStart != 0 then
+          chpl_sync_prof_op(chpl_sync_prof_kind_atomicWait, profStart,
+                            profWaited);
         atomic_thread_fence(order);
       }
     }
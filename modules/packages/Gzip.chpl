@@ -0,0 +1,153 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+
+Read and write gzip-compressed data through ordinary channels
+
+This module provides a compression filter that can be put on top of any
+:record:`~IO.file`. Data written to channels on the returned file is
+compressed before it is written to the underlying file, and data read
+from channels on the returned file is decompressed from the underlying
+file. The underlying file can be a local file, a :mod:`Curl` or
+:mod:`HDFS` file, or anything else :mod:`IO` can open.
+
+Dependencies
+------------
+
+The Gzip module depends on zlib. To enable it, include ``gzip`` in
+``CHPL_AUX_FILESYS`` and rebuild Chapel, setting ``CHPL_AUXIO_INCLUDE``
+and ``CHPL_AUXIO_LIBS`` if zlib is not installed system-wide. See
+:ref:`readme-auxIO`. Without it, the functions in this module compile but
+return an ``ENOSYS`` error.
+
+Using Gzip Support in Chapel
+----------------------------
+
+.. code-block:: chapel
+
+  use Gzip;
+
+  // write compressed data
+  var f = open("data.gz", iomode.cw);
+  var gz = openGzip(f, iomode.cw);
+  var w = gz.writer();
+  w.writeln("Hello, compressed world");
+  w.close();
+  gz.close();
+  f.close();
+
+  // and read it back
+  var g = open("data.gz", iomode.r);
+  var r = openGzip(g, iomode.r).reader();
+  var line:string;
+  while r.readline(line) do
+    write(line);
+
+Files returned by :proc:`openGzip` are either read-only or write-only and
+are not seekable, so channels on them must start at offset 0 and only
+one channel should be used on each such file. The compressed stream is
+finished when the gzip file is closed, which must happen before the
+underlying file is closed.
+
+When compressing, passing ``threads=n`` for ``n > 1`` splits the data
+into ``blockSize`` blocks and compresses ``n`` of them at a time in
+parallel. Each block is written out as its own gzip member; standard
+tools such as ``gunzip`` and :proc:`openGzip` read the concatenated
+members as one stream. This uses more memory (about ``2*n*blockSize``
+bytes) and compresses slightly less well than ``threads=1``.
+
+ */
+module Gzip {
+
+use IO;
+
+private extern proc chpl_gzip_open(out file_out:qio_file_ptr_t,
+                                   underlying:qio_file_ptr_t,
+                                   writing:c_int, level:c_int,
+                                   block_size:int(64), nthreads:c_int,
+                                   const ref style:iostyle):syserr;
+
+private extern const GZIP_DEFAULT_BLOCK_SIZE:int;
+
+/* The default compression level, which trades speed for size in the
+   same way as ``gzip -6`` */
+const defaultCompressionLevel = -1;
+
+/* The default amount of data each thread compresses at a time when
+   compressing with more than one thread */
+const defaultBlockSize = GZIP_DEFAULT_BLOCK_SIZE;
+
+/*
+  Open a gzip compression filter on top of an existing file.
+
+  :arg error: optional argument to capture an error code. If this argument
+              is not provided and an error is encountered, this function
+              will halt with an error message.
+  :arg f: the file holding (or receiving) the compressed data
+  :arg mode: :enum:`~IO.iomode.r` to decompress data read from `f`,
+             or :enum:`~IO.iomode.cw` to compress data written to `f`
+  :arg level: the compression level, from 0 (no compression) to 9
+              (best compression)
+  :arg threads: when compressing, how many blocks to compress in parallel
+  :arg blockSize: when compressing with more than one thread, how much
+                  uncompressed data goes in each block
+  :arg style: the default I/O style for channels on the returned file
+  :returns: a file to read decompressed data from or write uncompressed
+            data to
+ */
+proc openGzip(out error:syserr, f:file, mode:iomode,
+              level:int = defaultCompressionLevel, threads:int = 1,
+              blockSize:int = defaultBlockSize,
+              style:iostyle = f._style):file {
+  var ret:file;
+  var writing:bool;
+
+  select mode {
+    when iomode.r do writing = false;
+    when iomode.cw do writing = true;
+    otherwise {
+      error = EINVAL:syserr;
+      return ret;
+    }
+  }
+
+  f.check();
+
+  on f.home {
+    ret.home = here;
+    error = chpl_gzip_open(ret._file_internal, f._file_internal,
+                           writing:c_int, level:c_int, blockSize,
+                           threads:c_int, style);
+  }
+
+  return ret;
+}
+
+pragma "no doc"
+proc openGzip(f:file, mode:iomode, level:int = defaultCompressionLevel,
+              threads:int = 1, blockSize:int = defaultBlockSize,
+              style:iostyle = f._style):file {
+  var err:syserr = ENOERR;
+  var ret = openGzip(err, f, mode, level, threads, blockSize, style);
+  if err then ioerror(err, "in openGzip", f.tryGetPath());
+  return ret;
+}
+
+}
@@ -0,0 +1,491 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+  Named, nestable timer regions.
+
+  This module times named regions of a program, in the spirit of the
+  compiler's own phase timing.  A region is delimited by a pair of
+  calls::
+
+    use RegionTimers;
+
+    regionBegin("step");
+    regionBegin("halo");
+    exchangeHalos();
+    regionEnd("halo");
+    compute();
+    regionEnd("step");
+
+  Regions nest.  Each task keeps its own stack of open regions, and a
+  region is recorded under its path, the names of the regions it is
+  nested in and its own name joined with ``/`` (``step/halo`` above).
+  A task started inside a region does not inherit it; regions begun
+  by that task are top level ones.  :proc:`regionEnd` must close the
+  innermost region open in the calling task.
+
+  For each path, each locale records how many times the region was
+  entered, the wall time spent in it, and the GETs, PUTs and remote
+  executions initiated on that locale while it was open.  The
+  communication counts are read from :mod:`CommDiagnostics`, so they
+  are only collected while counting is on (see
+  :proc:`~CommDiagnostics.startCommDiagnostics`), and they include
+  communication done by any task on the locale, not just the one that
+  opened the region.
+
+  :proc:`getRegionSummary` reduces the records of all the locales, and
+  :proc:`printRegionTimers` prints them.  Unless
+  :var:`printRegionTimersAtExit` is `false`, they are printed at
+  program exit if any regions were recorded.  The summary looks like
+  this, with one line per region path, indented by nesting depth::
+
+    region    calls     min(s)     avg(s)     max(s) imbal      gets      puts   on
+    step         20   1.041392   1.052117   1.073506  1.02         0         0    0
+      halo       20   0.212054   0.231420   0.262871  1.14     15360     15360    0
+
+  The times are the minimum, average and maximum over all locales of
+  the total time each locale spent in the region, and ``imbal`` is the
+  ratio of the maximum to the average.  The calls and communication
+  counts are totals over all locales.
+
+  Compiling with ``-sregionTimersOn=false`` turns
+  :proc:`regionBegin` and :proc:`regionEnd` into empty procedures,
+  so that regions can be left in code that is not being profiled.
+ */
+module RegionTimers
+{
+  use CommDiagnostics, Time;
+
+  /*
+    If this is `false`, regions are not recorded and cost nothing.
+    It defaults to `true`, but can be changed at compile time.
+   */
+  config param regionTimersOn = true;
+
+  /*
+    If this is `true` and any regions were recorded, the summary is
+    printed when the program exits.
+   */
+  config const printRegionTimersAtExit = true;
+
+  /*
+    The totals for one region path across all locales, as returned
+    by :proc:`getRegionSummary`.
+   */
+  record regionSummary {
+    /* the region path */
+    var path: string;
+    /* the number of times the region was entered, on all locales */
+    var calls: int;
+    /* the smallest time spent in the region by any locale, in seconds */
+    var minTime: real;
+    /* the average time spent in the region by a locale, in seconds */
+    var avgTime: real;
+    /* the largest time spent in the region by any locale, in seconds */
+    var maxTime: real;
+    /* GETs of any kind initiated while the region was open */
+    var gets: uint(64);
+    /* PUTs of any kind initiated while the region was open */
+    var puts: uint(64);
+    /* remote executions of any kind initiated while the region was open */
+    var executeOns: uint(64);
+
+    /*
+      The ratio of :var:`maxTime` to :var:`avgTime`; 1.0 means the
+      locales spent the same time in the region.
+     */
+    proc imbalance: real {
+      return if avgTime > 0.0 then maxTime / avgTime else 1.0;
+    }
+  }
+
+  private extern proc chpl_now_timevalue(): _timevalue;
+
+  private extern proc chpl_timevalue_seconds(t: _timevalue): int(64);
+
+  private extern proc chpl_timevalue_microseconds(t: _timevalue): int(64);
+
+  private extern proc chpl_task_getId(): chpl_taskID_t;
+
+  //
+  // What one shard of a locale has recorded for one region path.  The
+  // regions form a tree under the shard's root, so that opening a
+  // region finds it among its parent's children by name, and closing
+  // it updates it directly, without building or looking up its path.
+  //
+  pragma "no doc"
+  class regionNode {
+    var name: string;
+    var path: string;
+    var firstChild: regionNode;
+    var nextSibling: regionNode;
+    var calls: int;
+    var time: real;
+    var gets: uint(64);
+    var puts: uint(64);
+    var executeOns: uint(64);
+
+    proc ~regionNode() {
+      var c = firstChild;
+      while c != nil {
+        const next = c.nextSibling;
+        delete c;
+        c = next;
+      }
+    }
+  }
+
+  //
+  // An open region on a task's stack.
+  //
+  pragma "no doc"
+  record regionFrame {
+    var node: regionNode;
+    var start: real;
+    var gets: uint(64);
+    var puts: uint(64);
+    var executeOns: uint(64);
+  }
+
+  pragma "no doc"
+  class regionStack {
+    var D = {1..4};
+    var frames: [D] regionFrame;
+    var depth = 0;
+  }
+
+  //
+  // What the tasks of one shard of a locale have recorded.  The tasks'
+  // stacks are kept here too, indexed by task ID, because there is no
+  // task-local storage to put them in.  A task's entry is removed when
+  // its last region ends, so the table only holds tasks that are in a
+  // region.  Tasks are spread over the shards by ID, so that they
+  // seldom wait for each other's lock.
+  //
+  pragma "no doc"
+  class regionShard {
+    var lock: atomic bool;
+    var root = new regionNode();
+    var taskD: domain(chpl_taskID_t);
+    var stacks: [taskD] regionStack;
+
+    inline proc acquire() {
+      while lock.testAndSet() do chpl_task_yield();
+    }
+
+    inline proc release() {
+      lock.clear();
+    }
+
+    // The child of parent called name, added if it is new.
+    proc child(parent: regionNode, name: string) {
+      var c = parent.firstChild;
+      while c != nil && c.name != name do
+        c = c.nextSibling;
+      if c == nil {
+        c = new regionNode(name=name,
+                           path=if parent == root then name
+                                else parent.path + "/" + name,
+                           nextSibling=parent.firstChild);
+        parent.firstChild = c;
+      }
+      return c;
+    }
+
+    proc ~regionShard() {
+      for stk in stacks do
+        delete stk;
+      delete root;
+    }
+  }
+
+  private param numShards = 16;
+
+  pragma "no doc"
+  class regionTable {
+    var shards: [0..#numShards] regionShard;
+
+    proc ~regionTable() {
+      for shard in shards do
+        delete shard;
+    }
+  }
+
+  //
+  // One table per locale, each allocated on its locale.  At exit the
+  // summary is printed, and then the tables are freed.  This relies on
+  // module-level records being destroyed at the end of the program,
+  // while the locales are still up, and on a record's fields being
+  // destroyed after its destructor has run.
+  //
+  pragma "no doc"
+  record regionTables {
+    var tables: [LocaleSpace] regionTable;
+
+    proc ~regionTables() {
+      if !regionTimersOn then return;
+
+      if printRegionTimersAtExit {
+        var any = false;
+        for tbl in tables do
+          for shard in tbl.shards do
+            if shard.root.firstChild != nil then
+              any = true;
+        if any then
+          printSummary(summarize(tables));
+      }
+
+      coforall loc in Locales do on loc do
+        delete tables[here.id];
+    }
+  }
+
+  private var regions: regionTables;
+
+  private proc initTables() {
+    coforall i in LocaleSpace with (ref regions) do on Locales[i] {
+      const tbl = new regionTable();
+      for i in 0..#numShards do
+        tbl.shards[i] = new regionShard();
+      regions.tables[here.id] = tbl;
+    }
+  }
+
+  if regionTimersOn then
+    initTables();
+
+  private inline proc myShard(tid: chpl_taskID_t) {
+    return regions.tables[here.id].shards[(tid: int(64)) % numShards];
+  }
+
+  private inline proc nowSeconds(): real {
+    const t = chpl_now_timevalue();
+    return chpl_timevalue_seconds(t) + chpl_timevalue_microseconds(t) * 1.0e-6;
+  }
+
+  // Reading the counters is the first thing regionEnd() does and the
+  // last thing regionBegin() does, so the region's own bookkeeping is
+  // not counted against it.
+  private inline proc readCommCounts() {
+    const cd = getCommDiagnosticsHere();
+    return (cd.get + cd.get_nb,
+            cd.put + cd.put_nb,
+            cd.execute_on + cd.execute_on_fast + cd.execute_on_nb);
+  }
+
+  /*
+    Open the region `name`, nested in the innermost region open in the
+    calling task.
+
+    :arg name: the region name; it should not contain ``/``
+   */
+  proc regionBegin(name: string) {
+    if !regionTimersOn then return;
+
+    const tid = chpl_task_getId();
+    const shard = myShard(tid);
+
+    shard.acquire();
+    if !shard.taskD.member(tid) {
+      shard.taskD += tid;
+      shard.stacks[tid] = new regionStack();
+    }
+    const stk = shard.stacks[tid];
+    if stk.depth == stk.D.high then
+      stk.D = {1..stk.D.high * 2};
+    const parent = if stk.depth == 0 then shard.root
+                   else stk.frames[stk.depth].node;
+    stk.depth += 1;
+    ref f = stk.frames[stk.depth];
+    f.node = shard.child(parent, name);
+    shard.release();
+
+    (f.gets, f.puts, f.executeOns) = readCommCounts();
+    f.start = nowSeconds();
+  }
+
+  /*
+    Close the innermost region open in the calling task, and add the
+    time spent in it to the region's totals on this locale.
+
+    :arg name: the region name, which must match the one given to the
+               corresponding call to :proc:`regionBegin`
+   */
+  proc regionEnd(name: string) {
+    if !regionTimersOn then return;
+
+    const now = nowSeconds();
+    const (gets, puts, ons) = readCommCounts();
+    const tid = chpl_task_getId();
+    const shard = myShard(tid);
+
+    shard.acquire();
+    const stk = if shard.taskD.member(tid) then shard.stacks[tid] else nil;
+    if stk == nil || stk.frames[stk.depth].node.name != name {
+      shard.release();
+      halt("regionEnd(\"", name, "\") does not match the innermost ",
+           "region open in this task");
+    }
+    const f = stk.frames[stk.depth];
+    const c = f.node;
+    c.calls += 1;
+    c.time += now - f.start;
+    c.gets += gets - f.gets;
+    c.puts += puts - f.puts;
+    c.executeOns += ons - f.executeOns;
+    stk.depth -= 1;
+    if stk.depth == 0 {
+      shard.taskD -= tid;
+      delete stk;
+    }
+    shard.release();
+  }
+
+  // The regions nested in node, at any depth.
+  private iter descendants(node: regionNode): regionNode {
+    var c = node.firstChild;
+    while c != nil {
+      yield c;
+      for d in descendants(c) do
+        yield d;
+      c = c.nextSibling;
+    }
+  }
+
+  //
+  // Order paths so that each one is followed by the paths nested in
+  // it, with siblings in alphabetical order.
+  //
+  private proc pathLess(a: string, b: string): bool {
+    var i = 1;
+    while i <= a.length && i <= b.length && a[i] == b[i] do
+      i += 1;
+    if i > a.length then return i <= b.length;
+    if i > b.length then return false;
+    if a[i] == "/" then return true;
+    if b[i] == "/" then return false;
+    return a[i] < b[i];
+  }
+
+  /*
+    Reduce the regions recorded on all the locales.  The times for a
+    locale that never entered a region count as 0.
+
+    :returns: the totals for each region path, in nesting order
+    :rtype: `[] regionSummary`
+   */
+  proc getRegionSummary() {
+    return summarize(regions.tables);
+  }
+
+  private proc summarize(const ref tables) {
+    var pathD: domain(string);
+    var sums: [pathD] regionSummary;
+    var seen: [pathD] int;
+    var locTime: [pathD] real;       // the current locale's time
+    var touched: [pathD] bool;       // whether it entered the region
+
+    // With the timers off, no tables were made.
+    if regionTimersOn then
+      for i in LocaleSpace {
+        for shard in tables[i].shards {
+          shard.acquire();
+          for c in descendants(shard.root) {
+            if !pathD.member(c.path) {
+              pathD += c.path;
+              sums[c.path].path = c.path;
+              sums[c.path].minTime = max(real);
+            }
+            ref s = sums[c.path];
+            s.calls += c.calls;
+            s.gets += c.gets;
+            s.puts += c.puts;
+            s.executeOns += c.executeOns;
+            if !touched[c.path] {
+              touched[c.path] = true;
+              seen[c.path] += 1;
+            }
+            locTime[c.path] += c.time;
+          }
+          shard.release();
+        }
+
+        for (s, t, touch) in zip(sums, locTime, touched) do
+          if touch {
+            s.avgTime += t;
+            s.minTime = min(s.minTime, t);
+            s.maxTime = max(s.maxTime, t);
+            t = 0.0;
+            touch = false;
+          }
+      }
+
+    var S: [1..pathD.size] regionSummary;
+    var n = 0;
+    for path in pathD {
+      var s = sums[path];
+      s.avgTime /= numLocales;
+      if seen[path] < numLocales then
+        s.minTime = 0.0;
+      n += 1;
+      var i = n;
+      while i > 1 && pathLess(path, S[i-1].path) {
+        S[i] = S[i-1];
+        i -= 1;
+      }
+      S[i] = s;
+    }
+    return S;
+  }
+
+  /*
+    Print the summary returned by :proc:`getRegionSummary` to
+    ``stdout``.
+   */
+  proc printRegionTimers() {
+    printSummary(getRegionSummary());
+  }
+
+  private proc printSummary(S) {
+    var width = 6;
+    for s in S do
+      width = max(width, regionLabel(s.path).length);
+
+    writef("%-*s %8s %10s %10s %10s %5s %9s %9s %4s\n", width, "region",
+           "calls", "min(s)", "avg(s)", "max(s)", "imbal",
+           "gets", "puts", "on");
+    for s in S do
+      writef("%-*s %8i %10.6dr %10.6dr %10.6dr %5.2dr %9u %9u %4u\n",
+             width, regionLabel(s.path), s.calls,
+             s.minTime, s.avgTime, s.maxTime, s.imbalance,
+             s.gets, s.puts, s.executeOns);
+  }
+
+  // A path's last name, indented two spaces per enclosing region.
+  private proc regionLabel(path: string) {
+    var indent: string;
+    var last = 1;
+    for i in 1..path.length do
+      if path[i] == "/" {
+        indent += "  ";
+        last = i + 1;
+      }
+    return indent + path[last..];
+  }
+}
@@ -45,13 +45,23 @@ module VisualDebug
   */
   config const VisualDebugOn = DefaultVisualDebugOn;
 
+  /*
+    If this is `true`, the data files are written in the older text
+    format instead of the default compact binary format.  Writing text
+    is slower and disturbs the timing of the program more, but the
+    files can be read by people and by other tools.  :ref:`chplvis`
+    reads either format.
+  */
+  config const VisualDebugText = false;
+
   private extern proc chpl_now_time():real;
 
   //
   // Data Generation for the Visual Debug tool  (offline)
   //
 
-  private extern proc chpl_vdebug_start (rootname: c_string, time:real);
+  private extern proc chpl_vdebug_start (rootname: c_string, time:real,
+                                         text:c_int);
 
   private extern proc chpl_vdebug_stop ();
 
@@ -101,7 +111,8 @@ private proc VDebugTree (what: vis_op, name: string, time: real, tagno: int,
 
      /* Do the op at the root  */
      select what {
-         when vis_op.v_start    do chpl_vdebug_start (name.localize().c_str(), time);
+         when vis_op.v_start    do chpl_vdebug_start (name.localize().c_str(), time,
+                                                  VisualDebugText:c_int);
          when vis_op.v_stop     do chpl_vdebug_stop ();
          when vis_op.v_tag      do chpl_vdebug_tag (tagno);
          when vis_op.v_pause    do chpl_vdebug_pause (tagno);
@@ -137,6 +137,46 @@
   was executed on locale 0, and a remote get and a remote put were
   executed on locale 1.
 
+  **Per-Destination Counts and Histograms**
+
+  Along with the totals above, each locale keeps counts of the GETs,
+  PUTs and remote executions it initiates broken down by the locale
+  they target, and histograms of the sizes of the GETs and PUTs.
+  These are collected, reset, started and stopped along with the
+  totals.  :proc:`getCommMatrix` gathers the per-destination counts
+  from all the locales into a matrix indexed by (source, destination)
+  locale id::
+
+    resetCommDiagnostics();
+    startCommDiagnostics();
+    // ...
+    stopCommDiagnostics();
+    const M = getCommMatrix();
+    for (src, dst) in M.domain do
+      if M(src, dst).get > 0 then
+        writeln(src, " read ", M(src, dst).get_bytes, " bytes from ", dst);
+
+  The latency of blocking GETs, PUTs and remote executions can be
+  histogrammed too.  Timing every operation would slow the operations
+  down, so it is only done for a sample of them, and only after
+  sampling has been turned on with :proc:`setCommLatencySampling`::
+
+    setCommLatencySampling(16);  // time 1 in 16 blocking ops per thread
+    startCommDiagnostics();
+    // ...
+    stopCommDiagnostics();
+    writeln(getCommHistogram(commHistogram.getLatency));
+
+  Each histogram has :param:`commHistogramBins` bins.  Bin 0 counts
+  samples with the value 0 and bin `i` counts samples in the range
+  `[2**(i-1), 2**i)`.  Sizes are in bytes and latencies are in
+  nanoseconds.
+
+  The counters are kept separately by each thread and summed when they
+  are retrieved, so counting adds very little overhead to the
+  communication itself.  Counts retrieved while counting is still going
+  on may be slightly out of date.
+
   **Studying Communication During Module Initialization**
 
   It is hard for a programmer to determine exactly what happens during
@@ -222,6 +262,59 @@ module CommDiagnostics
    */
   type commDiagnostics = chpl_commDiagnostics;
 
+  /* Communication operation counts for one (source, destination) pair
+     of locales.  Like :type:`chpl_commDiagnostics`, this duplicates
+     the comm layer definition.
+   */
+  extern record chpl_commDiagnosticsDest {
+    /*
+      GETs of any kind from the destination
+     */
+    var get: uint(64);
+    /*
+      PUTs of any kind to the destination
+     */
+    var put: uint(64);
+    /*
+      remote executions of any kind on the destination
+     */
+    var execute_on: uint(64);
+    /*
+      bytes read by the GETs
+     */
+    var get_bytes: uint(64);
+    /*
+      bytes written by the PUTs
+     */
+    var put_bytes: uint(64);
+  };
+
+  /*
+    The Chapel record type inherits the comm layer definition of it.
+   */
+  type commDiagnosticsDest = chpl_commDiagnosticsDest;
+
+  /*
+    The histograms that can be retrieved with :proc:`getCommHistogram`.
+   */
+  enum commHistogram {
+    /* sizes of GETs, in bytes */
+    getSize = 0,
+    /* sizes of PUTs, in bytes */
+    putSize = 1,
+    /* sampled latencies of blocking GETs, in nanoseconds */
+    getLatency = 2,
+    /* sampled latencies of blocking PUTs, in nanoseconds */
+    putLatency = 3,
+    /* sampled latencies of blocking remote executions, in nanoseconds */
+    executeOnLatency = 4
+  };
+
+  /*
+    The number of bins in each histogram.
+   */
+  param commHistogramBins = 64;
+
   private extern proc chpl_startVerboseComm();
 
   private extern proc chpl_stopVerboseComm();
@@ -242,6 +335,14 @@ module CommDiagnostics
 
   private extern proc chpl_getCommDiagnosticsHere(out cd: commDiagnostics);
 
+  private extern proc chpl_getCommDiagnosticsDestHere(
+                        dests: c_ptr(commDiagnosticsDest));
+
+  private extern proc chpl_getCommDiagnosticsHistHere(which: c_int,
+                                                      bins: c_ptr(uint(64)));
+
+  private extern proc chpl_setCommDiagnosticsLatencySampleHere(every: c_int);
+
   /*
     Start on-the-fly reporting of communication initiated on any locale.
    */
@@ -331,6 +432,90 @@ module CommDiagnostics
     return cd;
   }
 
+  /*
+    Retrieve communication counts broken down by source and destination
+    locale for the whole program.
+
+    :returns: matrix whose (`i`, `j`) element counts the comm ops
+              initiated on locale `i` that targeted locale `j`
+    :rtype: `[0..#numLocales, 0..#numLocales] commDiagnosticsDest`
+   */
+  proc getCommMatrix() {
+    var M: [0..#numLocales, 0..#numLocales] commDiagnosticsDest;
+    for loc in Locales do on loc {
+      const row = getCommDiagnosticsDestHere();
+      M[loc.id, ..] = row;
+    }
+    return M;
+  }
+
+  /*
+    Retrieve communication counts broken down by destination locale for
+    this locale.
+
+    :returns: counts of comm ops initiated on this locale, indexed by
+              the id of the locale they targeted
+    :rtype: `[LocaleSpace] commDiagnosticsDest`
+   */
+  proc getCommDiagnosticsDestHere() {
+    var D: [LocaleSpace] commDiagnosticsDest;
+    chpl_getCommDiagnosticsDestHere(c_ptrTo(D));
+    return D;
+  }
+
+  /*
+    Retrieve a communication histogram for the whole program.
+
+    :arg which: the histogram to retrieve
+    :returns: matrix whose (`i`, `b`) element is bin `b` of the
+              histogram for locale `i`
+    :rtype: `[0..#numLocales, 0..#commHistogramBins] uint(64)`
+   */
+  proc getCommHistogram(which: commHistogram) {
+    var H: [0..#numLocales, 0..#commHistogramBins] uint(64);
+    for loc in Locales do on loc {
+      const bins = getCommHistogramHere(which);
+      H[loc.id, ..] = bins;
+    }
+    return H;
+  }
+
+  /*
+    Retrieve a communication histogram for this locale.
+
+    :arg which: the histogram to retrieve
+    :returns: the bins of the histogram
+    :rtype: `[0..#commHistogramBins] uint(64)`
+   */
+  proc getCommHistogramHere(which: commHistogram) {
+    var bins: [0..#commHistogramBins] uint(64);
+    chpl_getCommDiagnosticsHistHere(which:c_int, c_ptrTo(bins));
+    return bins;
+  }
+
+  /*
+    Set how often the latency of blocking communication operations is
+    measured, on all locales.
+
+    :arg every: time one in every `every` blocking GETs, PUTs and remote
+                executions done by each thread, or none if this is 0
+   */
+  proc setCommLatencySampling(every: int) {
+    for loc in Locales do on loc do
+      setCommLatencySamplingHere(every);
+  }
+
+  /*
+    Set how often the latency of blocking communication operations
+    initiated on this locale is measured.
+
+    :arg every: time one in every `every` blocking GETs, PUTs and remote
+                executions done by each thread, or none if this is 0
+   */
+  proc setCommLatencySamplingHere(every: int) {
+    chpl_setCommDiagnosticsLatencySampleHere(every:c_int);
+  }
+
   /*
     If this is set, on-the-fly reporting of communication operations
     will be turned on before any module initialization begins and
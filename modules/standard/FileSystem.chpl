@@ -345,27 +345,11 @@ proc copyFile(out error: syserr, src: string, dest: string) {
   var destFile = open(dest, iomode.cw);
   var srcChnl = srcFile.reader(kind=ionative, locking=false);
   var destChnl = destFile.writer(kind=ionative, locking=false);
-  // read in, write out.
-  var line: [0..1023] uint(8);
-  var numRead: int = 0;
-  while (srcChnl.readline(line, numRead=numRead, error=error)) {
-    // From mppf:
-    // If you want it to be faster, we can make it only buffer once (sharing
-    // the bytes read into memory between the two channels). To do that you'd
-    // do something like this (in a loop):
-
-    // srcReader.mark
-    // srcReader.advance( buffer size )
-    // srcReader.beginPeekBuffer to get the current buffer (qio_channel_begin_peek_buffer)
-    // dstWriter.putBuffer with the buffer we got (qio_channel_put_buffer)
-    // srcReader.endPeekBuffer
-
-    // Some of these routines don't exist with Chapel wrappers now
-
-    destChnl.write(line[0..#numRead]);
-  }
+  // Let the channels copy the data; when both are local files this
+  // happens in the kernel without going through user-space buffers.
+  destChnl.copyFrom(error=error, srcChnl);
   if error == EEOF then error = ENOERR;
-  destChnl.flush();
+  if error == ENOERR then destChnl.flush(error=error);
 
   srcFile.close();
   destFile.close();
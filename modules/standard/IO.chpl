@@ -1497,6 +1497,10 @@ extern type qbuffer_ptr_t;
 pragma "no doc"
 extern const QBUFFER_PTR_NULL:qbuffer_ptr_t;
 
+// the type for a mapped region returned by qio_file_mmap_region.
+pragma "no doc"
+extern type qbytes_ptr_t;
+
 pragma "no doc"
 extern type style_char_t = uint(8);
 
@@ -1661,6 +1665,8 @@ private extern proc qio_file_sync(f:qio_file_ptr_t):syserr;
 private extern proc qio_channel_end_offset_unlocked(ch:qio_channel_ptr_t):int(64);
 private extern proc qio_file_get_style(f:qio_file_ptr_t, ref style:iostyle);
 private extern proc qio_file_length(f:qio_file_ptr_t, ref len:int(64)):syserr;
+private extern proc qio_file_mmap_region(f:qio_file_ptr_t, start:int(64), len:int(64), copy_on_write:c_int, hints:c_int, ref bytes_out:qbytes_ptr_t, ref data_out:c_void_ptr):syserr;
+private extern proc qbytes_release(qb:qbytes_ptr_t);
 
 pragma "no prototype" // FIXME
 private extern proc qio_channel_create(ref ch:qio_channel_ptr_t, file:qio_file_ptr_t, hints:c_int, readable:c_int, writeable:c_int, start:int(64), end:int(64), const ref style:iostyle):syserr;
@@ -1688,6 +1694,7 @@ private extern proc qio_channel_str_style(ch:qio_channel_ptr_t):int(64);
 private extern proc qio_channel_style_element(ch:qio_channel_ptr_t, element:int(64)):int(64);
 
 private extern proc qio_channel_flush(threadsafe:c_int, ch:qio_channel_ptr_t):syserr;
+private extern proc qio_channel_copy(threadsafe:c_int, dst:qio_channel_ptr_t, src:qio_channel_ptr_t, len:int(64), ref amt_copied:int(64)):syserr;
 private extern proc qio_channel_close(threadsafe:c_int, ch:qio_channel_ptr_t):syserr;
 private extern proc qio_channel_isclosed(threadsafe:c_int, ch:qio_channel_ptr_t):bool;
 
@@ -2258,6 +2265,85 @@ proc file.length():int(64) {
   return len;
 }
 
+// Releases the mapping used by an array created with file.mmapArray.
+pragma "no doc"
+class _mmapArrayStorage: DefaultRectangularExternStorage {
+  var bytes:qbytes_ptr_t;
+  var mapped:bool;  // false for an empty region, which has no bytes
+  proc release() {
+    if mapped then qbytes_release(bytes);
+  }
+}
+
+/*
+
+Create an array whose elements are stored directly in a memory mapping of
+this file, rather than copied into the array through a channel. The pages of
+the file are read in on demand as the array is accessed, so computation can
+start right away and the file data is never held in memory twice.
+
+The elements are taken from the file, in row-major order over ``D``,
+starting at byte offset ``start``. The file must be long enough to hold
+``D.numIndices`` elements of ``eltType`` from that offset. The mapping stays
+valid until the array is destroyed, even if the file is closed first.
+
+By default the array is read-only, and writing to one of its elements is
+an error (that will typically crash the program). When ``copyOnWrite`` is
+set, elements may be modified, but modifications are private to the array
+and are never stored to the file.
+
+This function halts if there is an error creating the mapping.
+
+.. note::
+
+  Only plain files (not e.g. :proc:`openmem` files, pipes or files
+  opened through a :mod:`Curl` or :mod:`HDFS` URL) can be mapped, and the
+  array must be created on the locale where the file was opened.
+  If the array is later resized, its elements are copied into ordinary
+  memory.
+
+:arg eltType: the type of the array elements; this must be a plain-old-data
+              type whose in-memory representation matches the file contents
+:arg D: a local (non-distributed) rectangular domain for the array
+:arg start: the byte offset in the file of the first element
+:arg hints: optional hints about how the array will be accessed, which are
+            passed on to ``madvise``. :const:`IOHINT_SEQUENTIAL`,
+            :const:`IOHINT_RANDOM` and :const:`IOHINT_CACHED` are used.
+:arg copyOnWrite: whether or not the array elements can be modified
+:returns: an array over ``D`` backed by the file
+
+ */
+proc file.mmapArray(type eltType, D: domain, start:int(64) = 0,
+                    hints:iohints = IOHINT_NONE, copyOnWrite:bool = false) {
+  extern proc sizeof(type x): size_t;
+
+  if !isRectangularDom(D) then
+    compilerError("file.mmapArray requires a rectangular domain");
+
+  check();
+  if this.home != here then
+    halt("file.mmapArray must be called on the locale that opened the file");
+
+  const n = D.numIndices:int(64);
+  const eltSize = sizeof(eltType):int(64);
+  if eltSize > 0 && n > max(int(64)) / eltSize then
+    ioerror(EOVERFLOW:syserr, "in file.mmapArray: domain too large",
+            this.tryGetPath());
+
+  // An empty region maps nothing, so the array has no storage to release.
+  const len = n * eltSize;
+  var bytes:qbytes_ptr_t;
+  var data:c_void_ptr = c_nil;
+  var err = qio_file_mmap_region(_file_internal, start, len,
+                                 copyOnWrite:c_int, hints, bytes, data);
+  if err then ioerror(err, "in file.mmapArray", this.tryGetPath());
+
+  return D.buildArrayWithExternStorage(eltType,
+                                       __primitive("cast", _ddata(eltType),
+                                                   data),
+                                       new _mmapArrayStorage(bytes, len > 0));
+}
+
 // these strings are here (vs in _modestring)
 // in an attempt to avoid string copies, leaks,
 // and unnecessary allocations.
@@ -4722,6 +4808,51 @@ proc channel.flush() {
   if e then this._ch_ioerror(e, "in channel.flush");
 }
 
+/*
+
+  Copy data from a reading channel into this writing channel, moving both
+  channels past the copied data. If both channels are on local files, the
+  data is copied by the operating system without passing through either
+  channel's buffer (using ``copy_file_range`` on Linux).
+  Otherwise, it is read into `src`'s buffer once and shared with this
+  channel's buffer.
+
+  Both channels must be on the same locale.
+
+  :arg error: optional argument to capture an error code. If this argument
+              is not provided and an error is encountered, this function
+              will halt with an error message.
+  :arg src: the reading channel to copy from
+  :arg len: how many bytes to copy. If negative (the default), copy until
+            `src` reaches end-of-file.
+  :returns: the number of bytes copied
+
+*/
+proc channel.copyFrom(out error:syserr, src:channel, len:int(64) = -1):int(64) {
+  if !writing then compilerError("copyFrom on non-writing channel");
+  if src.writing then compilerError("copyFrom with a non-reading source channel");
+
+  var copied:int(64) = 0;
+  error = ENOERR;
+  if src.home != this.home {
+    error = EINVAL;
+    return 0;
+  }
+  on this.home {
+    error = qio_channel_copy((locking || src.locking):c_int, _channel_internal,
+                             src._channel_internal, len, copied);
+  }
+  return copied;
+}
+// documented in error= version
+pragma "no doc"
+proc channel.copyFrom(src:channel, len:int(64) = -1):int(64) {
+  var e:syserr = ENOERR;
+  var ret = this.copyFrom(error=e, src, len);
+  if e then this._ch_ioerror(e, "in channel.copyFrom");
+  return ret;
+}
+
 /* Assert that a channel has reached end-of-file.
    Halts with an error message if the receiving channel is not currently
    at EOF.
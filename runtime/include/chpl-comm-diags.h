@@ -0,0 +1,71 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _chpl_comm_diags_h_
+#define _chpl_comm_diags_h_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "chpl-comm.h"
+
+//
+// Support for counting comm ops in the comm layers.  The counts are
+// kept per thread and only summed when they are asked for, so that
+// counting does not serialize the threads doing communication.
+// Typical code, for a blocking op:
+//
+//    uint64_t diags_t0 = 0;
+//    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+//      diags_t0 = chpl_comm_diags_count(chpl_comm_diags_put, node, size);
+//    ... do the put ...
+//    if (diags_t0 != 0)
+//      chpl_comm_diags_latency(chpl_comm_diags_put, diags_t0);
+//
+
+typedef enum {
+  chpl_comm_diags_get,
+  chpl_comm_diags_get_nb,
+  chpl_comm_diags_put,
+  chpl_comm_diags_put_nb,
+  chpl_comm_diags_test_nb,
+  chpl_comm_diags_wait_nb,
+  chpl_comm_diags_try_nb,
+  chpl_comm_diags_execute_on,
+  chpl_comm_diags_execute_on_fast,
+  chpl_comm_diags_execute_on_nb,
+  chpl_comm_diags_num_kinds
+} chpl_comm_diags_kind_t;
+
+void chpl_comm_diags_init(void);
+
+//
+// Count an op of the given kind, targeting node and moving size bytes.
+// For blocking GETs, PUTs and execute_ons whose latency is being
+// sampled this returns the start time, to be passed to
+// chpl_comm_diags_latency() once the op is done.  Otherwise it
+// returns 0.
+//
+uint64_t chpl_comm_diags_count(chpl_comm_diags_kind_t kind,
+                               c_nodeid_t node, size_t size);
+
+void chpl_comm_diags_latency(chpl_comm_diags_kind_t kind, uint64_t start);
+
+#endif
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_comm_trace_h_
+#define _chpl_comm_trace_h_
+
+#include <stdint.h>
+
+//
+// Communication trace recorder.
+//
+// Setting CHPL_RT_COMM_TRACE=<base> when running a program records
+// every GET, PUT, strided GET and PUT, and executeOn that the comm
+// layer reports through the callbacks in chpl-comm-callbacks.h.  Each
+// locale writes its own operations to <base>-<node>.ctr, and
+// util/devel/commReplay.chpl can replay them.
+//
+// A trace file is a chpl_comm_trace_hdr_t followed by one
+// chpl_comm_trace_rec_t per operation, in the native byte order of
+// the machine that wrote it.  Each thread buffers its own records, so
+// the records are only in time order within a thread.
+//
+
+#define CHPL_COMM_TRACE_MAGIC   "ChplCTr"
+#define CHPL_COMM_TRACE_VERSION 1
+
+typedef struct {
+  char     magic[8];    // CHPL_COMM_TRACE_MAGIC, NUL terminated
+  int32_t  version;     // CHPL_COMM_TRACE_VERSION
+  int32_t  recSize;     // sizeof(chpl_comm_trace_rec_t)
+  int32_t  node;        // node that wrote the file
+  int32_t  numNodes;
+  int64_t  startSec;    // time of day the trace started
+  int64_t  startUsec;
+} chpl_comm_trace_hdr_t;
+
+typedef struct {
+  int64_t  time;        // nanoseconds since the trace started
+  int64_t  tid;         // task that did the operation
+  uint64_t size;        // bytes moved, or the executeOn argument size
+  uint64_t chunk;       // contiguous bytes per piece of a strided op,
+                        // otherwise the same as size
+  int32_t  node;        // the other node
+  uint16_t kind;        // a chpl_comm_cb_event_kind_t
+  uint16_t pad;
+} chpl_comm_trace_rec_t;
+
+void chpl_comm_trace_init(void);
+void chpl_comm_trace_exit(void);
+
+#endif
@@ -425,6 +425,37 @@ typedef struct _chpl_commDiagnostics {
   uint64_t execute_on_nb;
 } chpl_commDiagnostics;
 
+//
+// Counts of comm ops initiated on this node with a given target node.
+// GETs and PUTs include the blocking, non-blocking and strided forms,
+// and execute_ons include the fast and non-blocking forms.
+//
+typedef struct _chpl_commDiagnosticsDest {
+  uint64_t get;
+  uint64_t put;
+  uint64_t execute_on;
+  uint64_t get_bytes;
+  uint64_t put_bytes;
+} chpl_commDiagnosticsDest;
+
+//
+// Histograms kept along with the counts.  Bin 0 counts zero-valued
+// samples and bin i>0 counts samples in [2**(i-1), 2**i).  Sizes are
+// in bytes and latencies are in nanoseconds.  Latencies are only
+// measured for blocking ops, and only when sampling has been turned on
+// with chpl_setCommDiagnosticsLatencySampleHere().
+//
+#define CHPL_COMM_DIAGS_HIST_BINS 64
+
+typedef enum {
+  chpl_comm_diags_hist_get_size,
+  chpl_comm_diags_hist_put_size,
+  chpl_comm_diags_hist_get_latency,
+  chpl_comm_diags_hist_put_latency,
+  chpl_comm_diags_hist_execute_on_latency,
+  chpl_comm_diags_num_hists
+} chpl_comm_diags_hist_t;
+
 void chpl_startVerboseComm(void);
 void chpl_stopVerboseComm(void);
 void chpl_startVerboseCommHere(void);
@@ -440,6 +471,13 @@ void chpl_stopCommDiagnosticsHere(void);
 void chpl_gen_stopCommDiagnosticsHere(void);
 void chpl_resetCommDiagnosticsHere(void);
 void chpl_getCommDiagnosticsHere(chpl_commDiagnostics *cd);
+// dests must have room for chpl_numNodes entries
+void chpl_getCommDiagnosticsDestHere(chpl_commDiagnosticsDest *dests);
+// bins must have room for CHPL_COMM_DIAGS_HIST_BINS entries
+void chpl_getCommDiagnosticsHistHere(chpl_comm_diags_hist_t which,
+                                     uint64_t *bins);
+// time one in every 'every' blocking ops per thread; 0 turns it off
+void chpl_setCommDiagnosticsLatencySampleHere(int every);
 
 #else // LAUNCHER
 
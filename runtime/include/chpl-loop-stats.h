@@ -0,0 +1,104 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _chpl_loop_stats_h_
+#define _chpl_loop_stats_h_
+
+#include <stdint.h>
+
+#include "chpltypes.h"
+
+//
+// Loop statistics.
+//
+// When a program is compiled with --instrument-loops, each forall and
+// coforall statement in user code counts the iterations in each chunk
+// of work its iterator hands to a task and times the task's work on
+// that chunk (see modules/internal/ChapelLoopStats.chpl).  At the end
+// of each execution of the loop, the totals for that execution are
+// added to the loop's site here, on the locale that ran the loop.  At
+// exit the sites from all the locales are added up, and locale 0
+// prints them.
+//
+
+typedef enum {
+  chpl_loop_stats_kind_forall,
+  chpl_loop_stats_kind_coforall,
+  chpl_loop_stats_kind_standalone,
+  chpl_loop_stats_num_kinds
+} chpl_loop_stats_kind_t;
+
+//
+// The totals for one loop.  The Chapel side fills these in for each
+// execution and copies them between locales, so this must match
+// chpl_loop_stats_site_t in ChapelLoopStats.chpl.
+//
+typedef struct {
+  int32_t  kind;
+  int32_t  lineno;
+  int32_t  filename;
+  int32_t  pad;
+  uint64_t calls;        // executions of the loop
+  uint64_t iters;        // iterations, over all executions
+  uint64_t chunks;       // chunks handed to tasks
+  uint64_t min_chunk;    // fewest iterations in one chunk
+  uint64_t max_chunk;    // most iterations in one chunk
+  uint64_t task_ns;      // time tasks spent on chunks
+  uint64_t min_task_ns;  // shortest time spent on one chunk
+  uint64_t max_task_ns;  // longest time spent on one chunk
+  uint64_t wall_ns;      // time from the start to the end of the loop
+  double   imbal_sum;    // sum over executions of max / mean chunk time
+  double   imbal_max;    // largest max / mean chunk time
+} chpl_loop_stats_site_t;
+
+void chpl_loop_stats_init(void);
+
+//
+// Standalone foralls cannot see how their iterator divides the work,
+// so each thread counts the iterations it runs of the loop, and each
+// thread that ran some counts as a chunk.  chpl_loop_stats_new_id()
+// names an execution of a loop.  chpl_loop_stats_iter() counts one
+// iteration of it and returns true if this is the thread's first
+// since it last counted for another loop.  Once the loop is done,
+// chpl_loop_stats_collect() fills in the iters, chunks, min_chunk and
+// max_chunk of site from this locale's counts and forgets them.
+//
+uint64_t chpl_loop_stats_new_id(void);
+chpl_bool chpl_loop_stats_iter(uint64_t id);
+void chpl_loop_stats_collect(uint64_t id, chpl_loop_stats_site_t* site);
+
+//
+// Add one execution of a loop to its site on this locale.  The site's
+// kind and totals come from the caller; lineno and filename are those
+// of the loop.
+//
+void chpl_loop_stats_record(chpl_loop_stats_site_t* site,
+                            int32_t lineno, int32_t filename);
+
+//
+// For the report at exit: return how many sites this locale has,
+// fetch one of them, add one from another locale, and print them all.
+//
+int64_t chpl_loop_stats_num_sites(void);
+void chpl_loop_stats_get_site(int64_t i, chpl_loop_stats_site_t* site);
+void chpl_loop_stats_add_site(chpl_loop_stats_site_t* site);
+void chpl_loop_stats_report(void);
+
+#endif
@@ -57,6 +57,7 @@
   m(COMM_PER_LOC_INFO,    "comm layer per-locale information",        false), \
   m(COMM_PRV_OBJ_ARRAY,   "comm layer private objects array",         false), \
   m(COMM_PRV_BCAST_DATA,  "comm layer private broadcast data",        false), \
+  m(COMM_DIAGNOSTICS,     "comm layer diagnostics counters",          false), \
   m(GLOM_STRINGS_DATA,    "glom strings data",                        true ), \
   m(STR_COPY_DATA,        "string copy data",                         true ), \
   m(STR_COPY_REMOTE,      "remote string copy",                       true ), \
@@ -82,6 +83,10 @@
   m(OS_LAYER_TMP_DATA,    "OS layer temporary data",                  true ), \
   m(GMP,                  "gmp data",                                 true ), \
   m(GETS_PUTS_STRIDES,    "put_strd/get_strd array of strides",       true ), \
+  m(VDEBUG_BUFFER,        "visual debug event buffer",                false), \
+  m(TASK_PROFILE,         "task profiler data",                       false), \
+  m(STACK_PROFILE,        "stack profiler data",                      false), \
+  m(COMM_TRACE_BUFFER,    "comm trace record buffer",                 false), \
   m(NUM,                  "*** this must be the last entry ***",      true )
 
 
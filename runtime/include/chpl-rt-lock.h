@@ -0,0 +1,57 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_rt_lock_h_
+#define _chpl_rt_lock_h_
+
+#include <pthread.h>
+
+//
+// A lock for short critical sections inside the runtime, such as
+// linking a per-thread buffer onto a list.  It cannot be a sync
+// variable, since the sync profiler and memory tracking use these
+// themselves, and chpl_thread_mutex_t is only there when
+// CHPL_THREADS=pthreads.  Under that threading layer this is the same
+// pthread mutex; under the others it is still safe, because nothing
+// here is held across a task switch.
+//
+typedef pthread_mutex_t chpl_rt_lock_t;
+
+extern void chpl_internal_error(const char* message);
+
+static inline void chpl_rt_lock_init(chpl_rt_lock_t* lock) {
+  if (pthread_mutex_init(lock, NULL))
+    chpl_internal_error("pthread_mutex_init() failed");
+}
+
+static inline void chpl_rt_lock(chpl_rt_lock_t* lock) {
+  if (pthread_mutex_lock(lock))
+    chpl_internal_error("pthread_mutex_lock() failed");
+}
+
+static inline void chpl_rt_unlock(chpl_rt_lock_t* lock) {
+  if (pthread_mutex_unlock(lock))
+    chpl_internal_error("pthread_mutex_unlock() failed");
+}
+
+static inline void chpl_rt_lock_destroy(chpl_rt_lock_t* lock) {
+  (void) pthread_mutex_destroy(lock);
+}
+
+#endif
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_stack_profile_h_
+#define _chpl_stack_profile_h_
+
+//
+// Sampling stack profiler.
+//
+// Setting CHPL_RT_STACK_PROFILE=<base> when running a program turns
+// this on.  A SIGPROF interval timer interrupts the process
+// CHPL_RT_STACK_PROFILE_HZ times per CPU second (default 99), and each
+// interrupt records the stack of the running thread with libunwind.
+// At exit each locale maps the frames to Chapel functions and writes
+// the stacks in the "folded" format used by flame graph tools to
+// <base>-<node>.folded.  Room is made for the samples taken over
+// CHPL_RT_STACK_PROFILE_SECONDS CPU seconds (default 300) at the
+// chosen rate.
+//
+// This needs CHPL_UNWIND to be something other than "none".
+//
+
+void chpl_stack_prof_init(void);
+void chpl_stack_prof_exit(void);
+
+#endif
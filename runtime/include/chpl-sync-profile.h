@@ -0,0 +1,115 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _chpl_sync_profile_h_
+#define _chpl_sync_profile_h_
+
+#include <stdint.h>
+
+#include "chpltimers.h"
+#include "chpltypes.h"
+
+//
+// Sync variable and atomic contention profiler.
+//
+// Setting CHPL_RT_SYNC_PROFILE=<n> when running a program turns this
+// on.  For each source location it counts the sync and single
+// variable operations and the network atomic compare-exchanges,
+// test-and-sets and waitFor()s done there, how many of them had to
+// wait, and how long they waited.  For sync and single variables
+// implemented in the runtime it also counts how many times the
+// variable was locked by a different task than the last time.  At
+// exit the counts from all the locales are added up, and locale 0
+// prints the <n> sites with the most wait time.
+//
+// Sync locks taken without a location (readXX(), writeXF(), reset()
+// and the runtime's own uses) are not counted.
+//
+
+typedef enum {
+  chpl_sync_prof_kind_waitFull,   // readFE(), readFF(), writeFF()
+  chpl_sync_prof_kind_waitEmpty,  // writeEF()
+  chpl_sync_prof_kind_atomicCAS,  // network atomic compareExchange
+  chpl_sync_prof_kind_atomicTAS,  // network atomic testAndSet
+  chpl_sync_prof_kind_atomicWait, // network atomic waitFor
+  chpl_sync_prof_num_kinds
+} chpl_sync_prof_kind_t;
+
+//
+// The totals for one site.  The Chapel side copies these between
+// locales, so this must match chpl_sync_prof_site_t in
+// ChapelSyncvar.chpl.
+//
+typedef struct {
+  int32_t  kind;
+  int32_t  lineno;
+  int32_t  filename;
+  int32_t  pad;
+  uint64_t ops;
+  uint64_t waits;
+  uint64_t wait_ns;
+  uint64_t transfers;
+} chpl_sync_prof_site_t;
+
+//
+// Nonzero when profiling.  This is only set during runtime
+// initialization, so the tasking layers and modules can test it
+// without synchronization before doing any of the extra work.  It
+// stays set after the report starts; chpl_sync_prof_record() checks
+// separately whether recording has stopped.
+//
+extern int chpl_sync_prof_on;
+
+void chpl_sync_prof_init(void);
+
+//
+// Called by the tasking layers when a sync or single variable has
+// been locked.  wait_ns is the time from the start of the operation
+// until the lock was held with the variable in the wanted state.
+//
+void chpl_sync_prof_record(chpl_sync_prof_kind_t kind,
+                           int32_t lineno, int32_t filename,
+                           chpl_bool waited, uint64_t wait_ns,
+                           chpl_bool transfer);
+
+//
+// Called from module code, for the native qthreads sync variables and
+// the network atomics.  start_ns is from chpl_sync_prof_start(), taken
+// before the operation; waited means the variable was not ready, the
+// operation lost a race, or it had to poll.
+//
+static inline uint64_t chpl_sync_prof_start(void) {
+  return chpl_sync_prof_on ? chpl_now_ns() : 0;
+}
+
+void chpl_sync_prof_op(int32_t kind, uint64_t start_ns, chpl_bool waited,
+                       int32_t lineno, int32_t filename);
+
+//
+// For the report at exit: merge this locale's sites and return how
+// many there are, fetch one of them, add one from another locale,
+// and print the hottest sites.
+//
+int64_t chpl_sync_prof_num_sites(void);
+void chpl_sync_prof_get_site(int64_t i, chpl_sync_prof_site_t* site);
+void chpl_sync_prof_add_site(chpl_sync_prof_site_t* site);
+void chpl_sync_prof_report(void);
+
+#endif
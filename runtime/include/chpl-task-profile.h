@@ -0,0 +1,55 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _chpl_task_profile_h_
+#define _chpl_task_profile_h_
+
+#include <stdint.h>
+
+//
+// Built-in task profiler.
+//
+// Setting CHPL_RT_TASK_PROFILE=<base> when running a program turns
+// this on.  It uses the tasking callbacks to count, per task function,
+// how many tasks were spawned and ran, and how long they were blocked
+// on sync variables.  Run time and the wait to be started are only
+// measured for a sample of the tasks, and run time is extrapolated
+// from that.  At exit each locale writes a flat profile to
+// <base>-<node>.txt and a timeline of the sampled tasks in Chrome
+// trace event format to <base>-<node>.json.
+// CHPL_RT_TASK_PROFILE_SAMPLE=<n> samples one in every n tasks
+// (default 64).
+//
+
+//
+// Per-task profiler state, kept in the task private data.
+//
+typedef struct {
+  uint64_t begin_ns;
+  uint64_t block_start_ns;
+  uint64_t block_ns;
+  int32_t  fid_plus1;           // 0 until the begin callback has run
+  int32_t  sampled;
+} chpl_task_prof_taskPrvData_t;
+
+void chpl_task_prof_init(void);
+void chpl_task_prof_exit(void);
+
+#endif
@@ -119,10 +119,21 @@ extern "C" {
 //   hold a copy of the pointed-to data and duplicate it itself.
 //
 
+//
+//   The block and unblock events happen when the running task starts
+//   and stops waiting for a sync or single variable to change state.
+//   For them the fid is 0, the filename and lineno give the location
+//   of the wait, and callbacks run on the waiting task, so they can
+//   use its task private data.  They are only supported by the fifo
+//   and qthreads tasking layers.
+//
+
 typedef enum {
   chpl_task_cb_event_kind_create,
   chpl_task_cb_event_kind_begin,
   chpl_task_cb_event_kind_end,
+  chpl_task_cb_event_kind_block,
+  chpl_task_cb_event_kind_unblock,
   chpl_task_cb_num_event_kinds
 } chpl_task_cb_event_kind_t;
 
@@ -22,10 +22,13 @@
 
 // This header file provides chpl_comm_taskPrvData_t
 #include "chpl-comm-task-decls.h"
+// This one provides chpl_task_prof_taskPrvData_t
+#include "chpl-task-profile.h"
 
 // The type for task private data
 typedef struct {
   chpl_comm_taskPrvData_t comm_data;
+  chpl_task_prof_taskPrvData_t prof_data;
 } chpl_task_prvData_t;
 
 #endif
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Visual Debug binary record format
+//
+// This file is shared by the runtime (which writes the records) and
+// tools/chplvis (which reads them), so it must only use standard C.
+//
+// A binary data file starts with the same text line as a text data
+// file, but with version 1.3:
+//
+//   ChplVdebug: ver 1.3 nodes m nid n tid t seq s t1 t2 t3
+//
+// and is followed by binary records in the native byte order of the
+// machine that wrote them.  Every record starts with a
+// chpl_vdebug_rec_hdr_t and is a multiple of 8 bytes long.  Records
+// logged by different threads are written in blocks, so records are
+// only in time order within a thread; readers should sort them by time.
+//
+// See tools/chplvis/TextDataFormat.txt for what each record means.
+//
+
+#ifndef _chpl_visual_debug_format_h_
+#define _chpl_visual_debug_format_h_
+
+#include <stdint.h>
+
+#define CHPL_VDEBUG_BINARY_VER_MINOR 3
+
+typedef enum {
+  // string and table records, written by chpl_vdebug_rec_str_t
+  chpl_vdebug_rec_sizes = 1,  // index: Tablesize, lineno: FIDNsize
+  chpl_vdebug_rec_fname,      // index: fileno
+  chpl_vdebug_rec_fidname,    // index: fid, with lineno and fileno
+  chpl_vdebug_rec_tname,      // index: tag number
+  chpl_vdebug_rec_home,       // CHPL_HOME
+  chpl_vdebug_rec_dir,        // compile directory
+
+  // chpl_vdebug_rec_tag_t
+  chpl_vdebug_rec_end,
+  chpl_vdebug_rec_tag,
+  chpl_vdebug_rec_pause,
+
+  // chpl_vdebug_rec_tid_t
+  chpl_vdebug_rec_mark,
+  chpl_vdebug_rec_btask,
+  chpl_vdebug_rec_etask,
+
+  // chpl_vdebug_rec_task_t
+  chpl_vdebug_rec_task,
+
+  // chpl_vdebug_rec_comm_t
+  chpl_vdebug_rec_put,
+  chpl_vdebug_rec_get,
+  chpl_vdebug_rec_nb_put,
+  chpl_vdebug_rec_nb_get,
+  chpl_vdebug_rec_st_put,
+  chpl_vdebug_rec_st_get,
+
+  // chpl_vdebug_rec_fork_t
+  chpl_vdebug_rec_fork,
+  chpl_vdebug_rec_fork_nb,
+  chpl_vdebug_rec_fork_fast
+} chpl_vdebug_rec_kind_t;
+
+typedef struct {
+  uint16_t kind;       // a chpl_vdebug_rec_kind_t
+  uint16_t size;       // size of the whole record in bytes
+  int32_t  nid;        // node that logged the record
+  int64_t  time;       // time of day in microseconds
+} chpl_vdebug_rec_hdr_t;
+
+// The string follows the fixed part, is NUL terminated, and is
+// padded so that the record size is a multiple of 8.
+typedef struct {
+  chpl_vdebug_rec_hdr_t h;
+  int32_t  index;
+  int32_t  lineno;
+  int32_t  fileno;
+  int32_t  len;        // string length, not counting the NUL
+} chpl_vdebug_rec_str_t;
+
+typedef struct {
+  chpl_vdebug_rec_hdr_t h;
+  int64_t  utime;      // user time from rusage in microseconds
+  int64_t  stime;      // system time from rusage in microseconds
+  int64_t  tid;
+  int32_t  tagno;
+  int32_t  pad;
+} chpl_vdebug_rec_tag_t;
+
+typedef struct {
+  chpl_vdebug_rec_hdr_t h;
+  int64_t  tid;
+} chpl_vdebug_rec_tid_t;
+
+typedef struct {
+  chpl_vdebug_rec_hdr_t h;
+  int64_t  tid;
+  int64_t  parent;
+  int32_t  lineno;
+  int32_t  fileno;
+  int32_t  fid;
+  int32_t  is_on;
+} chpl_vdebug_rec_task_t;
+
+typedef struct {
+  chpl_vdebug_rec_hdr_t h;
+  int64_t  tid;
+  uint64_t addr;
+  uint64_t raddr;
+  int64_t  elemsize;
+  int64_t  len;
+  int32_t  rid;        // remote node id
+  int32_t  typeIndex;
+  int32_t  lineno;
+  int32_t  fileno;
+} chpl_vdebug_rec_comm_t;
+
+typedef struct {
+  chpl_vdebug_rec_hdr_t h;
+  int64_t  tid;
+  uint64_t arg;
+  int64_t  arg_size;
+  int32_t  rid;        // remote node id
+  int32_t  subloc;
+  int32_t  fid;
+  int32_t  pad;
+} chpl_vdebug_rec_fork_t;
+
+#endif
@@ -31,6 +31,7 @@
 
 extern int chpl_vdebug_fd;    // fd of output file, 0 => not gathering data
 extern int chpl_vdebug;       // Should we generate debug data
+extern int chpl_vdebug_text;  // Write text records rather than binary ones
 
 // Linux and MacOS don't do a single write.  We require a single write.
 extern int chpl_dprintf(int fd, const char * format, ...)
@@ -39,8 +40,8 @@ extern int chpl_dprintf(int fd, const char * format, ...)
 #endif
    ;
 
-//  start and open file if not NULL
-extern void chpl_vdebug_start(const char *, double now); 
+//  start and open file if not NULL, text selects the text format
+extern void chpl_vdebug_start(const char *, double now, int text);
 
 //  stop collecting data
 extern void chpl_vdebug_stop(void);
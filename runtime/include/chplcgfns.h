@@ -86,6 +86,10 @@ extern char* chpl_executionCommand;
 extern chpl_fn_p chpl_ftable[];
 extern chpl_fn_info chpl_finfo[];
 
+// The address of each function in chpl_funSymTable, or NULL for extern
+// functions and ones without generated code.
+extern chpl_fn_p chpl_funAddrTable[];
+
 extern void chpl__initStringLiterals(void);
 
 
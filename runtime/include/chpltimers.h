@@ -23,6 +23,7 @@
 #include "chpltypes.h"  // For _real64.
 
 #include <sys/time.h>   // For struct timeval.
+#include <time.h>       // For clock_gettime().
 
 typedef struct timeval _timevalue;
 
@@ -36,6 +37,16 @@ void chpl_timevalue_parts(_timevalue t, int32_t* seconds, int32_t* minutes, int3
 
 _real64 chpl_now_time(void);
 
+//
+// Nanoseconds on the monotonic clock, for timing intervals in the
+// runtime's diagnostics and profiling code.
+//
+static inline uint64_t chpl_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+}
+
 #endif // LAUNCHER
 
 #endif
@@ -100,6 +100,17 @@ extern "C" {
 // how large is an iobuf?
 extern size_t qbytes_iobuf_size;
 
+// how many released iobufs to keep per thread and in the global pool?
+extern size_t qbytes_iobuf_pool_thread_max;
+extern size_t qbytes_iobuf_pool_global_max;
+
+// read the pool configuration and enable iobuf pooling.
+void qbytes_iobuf_pool_init(void);
+// print pool hit rates to stderr.
+void qbytes_iobuf_pool_report(void);
+// report (if requested) and free all pooled iobufs.
+void qbytes_iobuf_pool_exit(void);
+
 struct qbytes_s;
 
 // a free function
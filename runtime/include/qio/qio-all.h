@@ -30,5 +30,6 @@
 #include "sys.h"
 #include "qio_plugin_hdfs.h"
 #include "qio_plugin_curl.h"
+#include "qio_plugin_gzip.h"
 #include "qio_popen.h"
 
@@ -207,10 +207,22 @@ typedef qio_fdflag_t fdflag_t;
 
 
 // make a re-entrant lock.
+//
+// The lock is biased toward the first task that acquires it. That task
+// (the bias owner) can lock and unlock it without using the sync
+// variable, which matters for channels only ever used by a single task
+// (e.g. stdout in a serial loop). The first time any other task needs
+// the lock, the bias is revoked for good - waiting for the bias owner to
+// leave its critical section if necessary - and from then on every task,
+// including the former bias owner, uses the sync variable.
 typedef struct {
   chpl_sync_aux_t sv;
   int64_t owner; // task ID of owner.
   uint64_t count; // how many times owner has locked.
+  int biased; // did owner lock without the sync variable?
+  atomic_int_least64_t bias_owner; // task ID of bias owner, or NULL_OWNER
+  atomic_bool bias_held; // is bias owner between lock and unlock?
+  atomic_bool bias_revoked; // once set, the bias is never used again
 } qio_lock_t;
 
 #define NULL_OWNER chpl_nullTaskID
@@ -225,11 +237,18 @@ void qio_unlock(qio_lock_t* x);
 static inline qioerr qio_lock_init(qio_lock_t* x) {
   x->owner = NULL_OWNER;
   x->count = 0;
+  x->biased = 0;
+  atomic_init_int_least64_t(&x->bias_owner, NULL_OWNER);
+  atomic_init_bool(&x->bias_held, false);
+  atomic_init_bool(&x->bias_revoked, false);
   chpl_sync_initAux(&x->sv);
   return 0;
 }
 
 static inline void qio_lock_destroy(qio_lock_t* x) {
+  atomic_destroy_int_least64_t(&x->bias_owner);
+  atomic_destroy_bool(&x->bias_held);
+  atomic_destroy_bool(&x->bias_revoked);
   chpl_sync_destroyAux(&x->sv);
 }
 
@@ -641,6 +660,18 @@ void qio_file_get_style(qio_file_t* f, qio_style_t* style)
 // Calls fflush on a FILE* first.
 qioerr qio_file_length(qio_file_t* f, int64_t *len_out);
 
+// Map len bytes of a file starting at byte offset start so that
+// they can be used directly (e.g. as array storage) without copying.
+// The mapping is read-only, or private and writeable if copy_on_write
+// is set (writes are then never stored to the file). The mapping is
+// advised according to hints. *data_out points to the byte at start;
+// the mapping stays valid until *bytes_out is released, even after
+// the file is closed. Returns EEOF if the region extends past the
+// end of the file. When len is 0, both outputs are set to NULL.
+qioerr qio_file_mmap_region(qio_file_t* f, int64_t start, int64_t len,
+                            int copy_on_write, qio_hint_t hints,
+                            qbytes_t** bytes_out, void** data_out);
+
 /* CHANNELS ..... */
 
 /* A Read and Write Buffered channels support:
@@ -1331,6 +1362,15 @@ qioerr qio_channel_put_bytes(const int threadsafe, qio_channel_t* ch, qbytes_t*
 
 qioerr qio_channel_put_buffer(const int threadsafe, qio_channel_t* ch, qbuffer_t* src, qbuffer_iter_t src_start, qbuffer_iter_t src_end);
 
+// Copies up to len bytes (or everything up to EOF if len < 0) from the
+// current position of src to the current position of dst, moving both
+// channels past the copied data. When both channels are on seekable
+// plain file descriptors the data is copied inside the kernel
+// (with copy_file_range); otherwise it is buffered once and
+// shared between the two channel buffers.
+// On return, amt_copied is the number of bytes copied.
+qioerr qio_channel_copy(const int threadsafe, qio_channel_t* dst, qio_channel_t* src, int64_t len, int64_t* amt_copied);
+
 
 static inline
 qioerr qio_channel_flush(const int threadsafe, qio_channel_t* ch)
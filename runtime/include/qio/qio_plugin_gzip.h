@@ -0,0 +1,58 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This defines a gzip compression filter as a QIO filesystem plugin.
+// A gzip file wraps another qio file: reading it inflates the data read
+// from the underlying file and writing it deflates the data before it
+// is written to the underlying file.
+#ifndef QIOPLUGIN_GZIP_H_
+#define QIOPLUGIN_GZIP_H_
+
+#include "sys_basic.h"
+#include "qio.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// the struct that holds all the functions for our FS
+extern qio_file_functions_t gzip_function_struct;
+extern const qio_file_functions_ptr_t gzip_function_struct_ptr;
+
+// The "fd" for a gzip file
+typedef struct gzip_file gzip_file;
+
+// Default amount of uncompressed data per independently compressed
+// block when compressing with more than one thread.
+#define GZIP_DEFAULT_BLOCK_SIZE (1024*1024)
+
+// Creates a gzip file on top of 'underlying' (which is retained until the
+// gzip file is closed). If 'writing' is set, the new file is write-only
+// and compresses with 'level' (-1 for the zlib default); otherwise it is
+// read-only and decompresses. When writing with nthreads > 1, the data
+// is split into block_size blocks that are compressed in parallel and
+// written out as consecutive gzip members.
+qioerr chpl_gzip_open(qio_file_t** file_out, qio_file_t* underlying,
+                      int writing, int level, int64_t block_size,
+                      int nthreads, const qio_style_t* style);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif
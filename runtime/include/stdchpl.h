@@ -51,11 +51,13 @@
 #include "chplmath.h"
 #include "chpl-init.h"
 #include "chpl-linefile-support.h"
+#include "chpl-loop-stats.h"
 #include "chpl-mem.h"
 #include "chplmemtrack.h"
 #include "chpl-prefetch.h"
 #include "chpl-privatization.h"
 #include "chpl-string.h"
+#include "chpl-sync-profile.h"
 #include "chplsys.h"
 #include "chpl-tasks.h"
 #include "chpltimers.h"
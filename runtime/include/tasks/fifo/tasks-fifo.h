@@ -84,6 +84,7 @@ typedef struct {
   chpl_thread_mutex_t lock;
   chpl_thread_condvar_t signal_full;  // wait for full; signal this when full
   chpl_thread_condvar_t signal_empty; // wait for empty; signal this when empty
+  chpl_taskID_t       prof_owner;   // last task to lock, if sync profiling
   //  threadlayer_sync_aux_t tl_aux;
 } chpl_sync_aux_t;
 
@@ -65,6 +65,7 @@ typedef struct {
     int       is_full;
     syncvar_t signal_full;
     syncvar_t signal_empty;
+    chpl_taskID_t prof_owner;   // last task to lock, if sync profiling
 } chpl_sync_aux_t;
 
 //
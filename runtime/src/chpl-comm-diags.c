@@ -0,0 +1,339 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Comm diagnostics counters
+//
+// Each thread counts the comm ops it initiates in its own
+// comm_diags_t, so counting needs no locking.  The structs are linked
+// together when they are created, and reads and resets walk the list.
+//
+// Only the owning thread ever writes a counter, so it is bumped with a
+// relaxed atomic load and store rather than a read-modify-write, and
+// readers on other threads see a well-defined (if slightly stale)
+// value.  A reset cannot zero another thread's counters without losing
+// a concurrent update, so instead it records each counter's current
+// value in the struct's baseline, and reads report the difference.
+// The baselines are only touched with the list lock held.
+//
+
+#include "chplrt.h"
+
+#include "chpl-atomics.h"
+#include "chpl-bitops.h"
+#include "chpl-comm.h"
+#include "chpl-comm-diags.h"
+#include "chpl-mem.h"
+#include "chpl-rt-lock.h"
+#include "chpl-thread-local-storage.h"
+#include "chpltimers.h"
+
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+  atomic_uint_least64_t get;
+  atomic_uint_least64_t put;
+  atomic_uint_least64_t execute_on;
+  atomic_uint_least64_t get_bytes;
+  atomic_uint_least64_t put_bytes;
+} comm_diags_dest_t;
+
+typedef struct comm_diags_s {
+  atomic_uint_least64_t counts[chpl_comm_diags_num_kinds];
+  atomic_uint_least64_t hists[chpl_comm_diags_num_hists]
+                             [CHPL_COMM_DIAGS_HIST_BINS];
+  comm_diags_dest_t* dests;           // chpl_numNodes entries
+  int latency_countdown[chpl_comm_diags_num_hists];
+
+  // values of the counters at the last reset
+  uint64_t base_counts[chpl_comm_diags_num_kinds];
+  uint64_t base_hists[chpl_comm_diags_num_hists][CHPL_COMM_DIAGS_HIST_BINS];
+  chpl_commDiagnosticsDest* base_dests;  // chpl_numNodes entries
+
+  struct comm_diags_s* next;
+} comm_diags_t;
+
+static chpl_rt_lock_t comm_diags_list_lock;
+static comm_diags_t* comm_diags_list;
+
+static int comm_diags_latency_every = 0;
+
+#ifdef CHPL_TLS
+static CHPL_TLS comm_diags_t* comm_diags_my;
+#else
+// With no CHPL_TLS there is a single comm_diags_t, and this serializes
+// the threads that count into it.
+static chpl_rt_lock_t comm_diags_shared_lock;
+#endif
+
+void chpl_comm_diags_init(void) {
+  chpl_rt_lock_init(&comm_diags_list_lock);
+#ifndef CHPL_TLS
+  chpl_rt_lock_init(&comm_diags_shared_lock);
+#endif
+}
+
+static inline uint64_t comm_diags_get(atomic_uint_least64_t* c) {
+  return atomic_load_explicit_uint_least64_t(c, memory_order_relaxed);
+}
+
+// Only call this from the thread that owns the counter.
+static inline void comm_diags_add(atomic_uint_least64_t* c, uint64_t v) {
+  atomic_store_explicit_uint_least64_t(c, comm_diags_get(c) + v,
+                                       memory_order_relaxed);
+}
+
+// Each latency histogram has its own countdown, so that a program
+// doing GETs and remote executions in lockstep still gets both sampled.
+static void comm_diags_set_countdowns(comm_diags_t* cd) {
+  int i;
+  for (i = 0; i < chpl_comm_diags_num_hists; i++)
+    cd->latency_countdown[i] = comm_diags_latency_every;
+}
+
+static chpl_comm_diags_hist_t comm_diags_latency_hist(
+                                chpl_comm_diags_kind_t kind) {
+  switch (kind) {
+  case chpl_comm_diags_get:
+    return chpl_comm_diags_hist_get_latency;
+  case chpl_comm_diags_put:
+    return chpl_comm_diags_hist_put_latency;
+  case chpl_comm_diags_execute_on:
+  case chpl_comm_diags_execute_on_fast:
+    return chpl_comm_diags_hist_execute_on_latency;
+  default:
+    return chpl_comm_diags_num_hists;
+  }
+}
+
+static comm_diags_t* comm_diags_new(void) {
+  comm_diags_t* cd;
+  int i, j;
+
+  cd = (comm_diags_t*) chpl_mem_allocManyZero(1, sizeof(comm_diags_t),
+                                              CHPL_RT_MD_COMM_DIAGNOSTICS,
+                                              0, 0);
+  cd->dests = (comm_diags_dest_t*)
+              chpl_mem_allocMany(chpl_numNodes, sizeof(comm_diags_dest_t),
+                                 CHPL_RT_MD_COMM_DIAGNOSTICS, 0, 0);
+  cd->base_dests = (chpl_commDiagnosticsDest*)
+                   chpl_mem_allocManyZero(chpl_numNodes,
+                                          sizeof(chpl_commDiagnosticsDest),
+                                          CHPL_RT_MD_COMM_DIAGNOSTICS, 0, 0);
+  for (i = 0; i < chpl_comm_diags_num_kinds; i++)
+    atomic_init_uint_least64_t(&cd->counts[i], 0);
+  for (i = 0; i < chpl_comm_diags_num_hists; i++)
+    for (j = 0; j < CHPL_COMM_DIAGS_HIST_BINS; j++)
+      atomic_init_uint_least64_t(&cd->hists[i][j], 0);
+  for (i = 0; i < chpl_numNodes; i++) {
+    atomic_init_uint_least64_t(&cd->dests[i].get, 0);
+    atomic_init_uint_least64_t(&cd->dests[i].put, 0);
+    atomic_init_uint_least64_t(&cd->dests[i].execute_on, 0);
+    atomic_init_uint_least64_t(&cd->dests[i].get_bytes, 0);
+    atomic_init_uint_least64_t(&cd->dests[i].put_bytes, 0);
+  }
+  comm_diags_set_countdowns(cd);
+
+  chpl_rt_lock(&comm_diags_list_lock);
+  cd->next = comm_diags_list;
+  comm_diags_list = cd;
+  chpl_rt_unlock(&comm_diags_list_lock);
+
+  return cd;
+}
+
+static inline comm_diags_t* comm_diags_acquire(void) {
+#ifdef CHPL_TLS
+  if (comm_diags_my == NULL)
+    comm_diags_my = comm_diags_new();
+  return comm_diags_my;
+#else
+  chpl_rt_lock(&comm_diags_shared_lock);
+  return (comm_diags_list != NULL) ? comm_diags_list : comm_diags_new();
+#endif
+}
+
+static inline void comm_diags_release(void) {
+#ifndef CHPL_TLS
+  chpl_rt_unlock(&comm_diags_shared_lock);
+#endif
+}
+
+static inline int comm_diags_bin(uint64_t v) {
+  int bin;
+
+  if (v == 0)
+    return 0;
+  bin = 64 - (int) chpl_bitops_clz_64(v);
+  return (bin < CHPL_COMM_DIAGS_HIST_BINS) ? bin : CHPL_COMM_DIAGS_HIST_BINS - 1;
+}
+
+uint64_t chpl_comm_diags_count(chpl_comm_diags_kind_t kind,
+                               c_nodeid_t node, size_t size) {
+  comm_diags_t* cd = comm_diags_acquire();
+  uint64_t start = 0;
+
+  comm_diags_add(&cd->counts[kind], 1);
+
+  switch (kind) {
+  case chpl_comm_diags_get:
+  case chpl_comm_diags_get_nb:
+    comm_diags_add(&cd->dests[node].get, 1);
+    comm_diags_add(&cd->dests[node].get_bytes, size);
+    comm_diags_add(&cd->hists[chpl_comm_diags_hist_get_size]
+                             [comm_diags_bin(size)], 1);
+    break;
+  case chpl_comm_diags_put:
+  case chpl_comm_diags_put_nb:
+    comm_diags_add(&cd->dests[node].put, 1);
+    comm_diags_add(&cd->dests[node].put_bytes, size);
+    comm_diags_add(&cd->hists[chpl_comm_diags_hist_put_size]
+                             [comm_diags_bin(size)], 1);
+    break;
+  case chpl_comm_diags_execute_on:
+  case chpl_comm_diags_execute_on_fast:
+  case chpl_comm_diags_execute_on_nb:
+    comm_diags_add(&cd->dests[node].execute_on, 1);
+    break;
+  default:
+    break;
+  }
+
+  if (comm_diags_latency_every > 0) {
+    chpl_comm_diags_hist_t which = comm_diags_latency_hist(kind);
+    if (which != chpl_comm_diags_num_hists
+        && --cd->latency_countdown[which] <= 0) {
+      cd->latency_countdown[which] = comm_diags_latency_every;
+      start = chpl_now_ns();
+    }
+  }
+
+  comm_diags_release();
+  return start;
+}
+
+void chpl_comm_diags_latency(chpl_comm_diags_kind_t kind, uint64_t start) {
+  uint64_t elapsed = chpl_now_ns() - start;
+  chpl_comm_diags_hist_t which = comm_diags_latency_hist(kind);
+  comm_diags_t* cd;
+
+  if (which == chpl_comm_diags_num_hists)
+    return;
+
+  cd = comm_diags_acquire();
+  comm_diags_add(&cd->hists[which][comm_diags_bin(elapsed)], 1);
+  comm_diags_release();
+}
+
+void chpl_resetCommDiagnosticsHere(void) {
+  comm_diags_t* cd;
+  int i, j;
+
+  chpl_rt_lock(&comm_diags_list_lock);
+  for (cd = comm_diags_list; cd != NULL; cd = cd->next) {
+    for (i = 0; i < chpl_comm_diags_num_kinds; i++)
+      cd->base_counts[i] = comm_diags_get(&cd->counts[i]);
+    for (i = 0; i < chpl_comm_diags_num_hists; i++)
+      for (j = 0; j < CHPL_COMM_DIAGS_HIST_BINS; j++)
+        cd->base_hists[i][j] = comm_diags_get(&cd->hists[i][j]);
+    for (i = 0; i < chpl_numNodes; i++) {
+      cd->base_dests[i].get        = comm_diags_get(&cd->dests[i].get);
+      cd->base_dests[i].put        = comm_diags_get(&cd->dests[i].put);
+      cd->base_dests[i].execute_on = comm_diags_get(&cd->dests[i].execute_on);
+      cd->base_dests[i].get_bytes  = comm_diags_get(&cd->dests[i].get_bytes);
+      cd->base_dests[i].put_bytes  = comm_diags_get(&cd->dests[i].put_bytes);
+    }
+  }
+  chpl_rt_unlock(&comm_diags_list_lock);
+}
+
+void chpl_getCommDiagnosticsHere(chpl_commDiagnostics* cd) {
+  uint64_t counts[chpl_comm_diags_num_kinds];
+  comm_diags_t* p;
+  int i;
+
+  memset(counts, 0, sizeof(counts));
+  chpl_rt_lock(&comm_diags_list_lock);
+  for (p = comm_diags_list; p != NULL; p = p->next) {
+    for (i = 0; i < chpl_comm_diags_num_kinds; i++)
+      counts[i] += comm_diags_get(&p->counts[i]) - p->base_counts[i];
+  }
+  chpl_rt_unlock(&comm_diags_list_lock);
+
+  cd->get             = counts[chpl_comm_diags_get];
+  cd->get_nb          = counts[chpl_comm_diags_get_nb];
+  cd->put             = counts[chpl_comm_diags_put];
+  cd->put_nb          = counts[chpl_comm_diags_put_nb];
+  cd->test_nb         = counts[chpl_comm_diags_test_nb];
+  cd->wait_nb         = counts[chpl_comm_diags_wait_nb];
+  cd->try_nb          = counts[chpl_comm_diags_try_nb];
+  cd->execute_on      = counts[chpl_comm_diags_execute_on];
+  cd->execute_on_fast = counts[chpl_comm_diags_execute_on_fast];
+  cd->execute_on_nb   = counts[chpl_comm_diags_execute_on_nb];
+}
+
+void chpl_getCommDiagnosticsDestHere(chpl_commDiagnosticsDest* dests) {
+  comm_diags_t* p;
+  int i;
+
+  memset(dests, 0, chpl_numNodes * sizeof(chpl_commDiagnosticsDest));
+  chpl_rt_lock(&comm_diags_list_lock);
+  for (p = comm_diags_list; p != NULL; p = p->next) {
+    for (i = 0; i < chpl_numNodes; i++) {
+      comm_diags_dest_t* d = &p->dests[i];
+      chpl_commDiagnosticsDest* b = &p->base_dests[i];
+      dests[i].get        += comm_diags_get(&d->get) - b->get;
+      dests[i].put        += comm_diags_get(&d->put) - b->put;
+      dests[i].execute_on += comm_diags_get(&d->execute_on) - b->execute_on;
+      dests[i].get_bytes  += comm_diags_get(&d->get_bytes) - b->get_bytes;
+      dests[i].put_bytes  += comm_diags_get(&d->put_bytes) - b->put_bytes;
+    }
+  }
+  chpl_rt_unlock(&comm_diags_list_lock);
+}
+
+void chpl_getCommDiagnosticsHistHere(chpl_comm_diags_hist_t which,
+                                     uint64_t* bins) {
+  comm_diags_t* p;
+  int i;
+
+  memset(bins, 0, CHPL_COMM_DIAGS_HIST_BINS * sizeof(uint64_t));
+  if (which < 0 || which >= chpl_comm_diags_num_hists)
+    return;
+
+  chpl_rt_lock(&comm_diags_list_lock);
+  for (p = comm_diags_list; p != NULL; p = p->next) {
+    for (i = 0; i < CHPL_COMM_DIAGS_HIST_BINS; i++)
+      bins[i] += comm_diags_get(&p->hists[which][i])
+                 - p->base_hists[which][i];
+  }
+  chpl_rt_unlock(&comm_diags_list_lock);
+}
+
+void chpl_setCommDiagnosticsLatencySampleHere(int every) {
+  comm_diags_t* p;
+
+  comm_diags_latency_every = (every > 0) ? every : 0;
+
+  chpl_rt_lock(&comm_diags_list_lock);
+  for (p = comm_diags_list; p != NULL; p = p->next)
+    comm_diags_set_countdowns(p);
+  chpl_rt_unlock(&comm_diags_list_lock);
+}
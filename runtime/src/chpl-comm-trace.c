@@ -0,0 +1,237 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Communication trace recorder
+//
+// See chpl-comm-trace.h for how to turn this on and what it writes.
+// The recorder is just a set of comm callbacks.  Like the VisualDebug
+// binary records, each thread appends its records to its own buffer,
+// which is written out with a single write() when it fills up and at
+// exit.  The buffers are linked together so that they can all be
+// flushed at exit; the per-buffer lock is only ever contended then.
+//
+
+#include "chplrt.h"
+
+#include "chpl-comm.h"
+#include "chpl-comm-callbacks.h"
+#include "chpl-comm-trace.h"
+#include "chpl-env.h"
+#include "chpl-mem.h"
+#include "chpl-rt-lock.h"
+#include "chpl-tasks.h"
+#include "chpl-thread-local-storage.h"
+#include "chpltimers.h"
+#include "error.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define COMM_TRACE_BUF_RECS 2048
+
+typedef struct comm_trace_buf_s {
+  chpl_rt_lock_t lock;
+  size_t len;
+  struct comm_trace_buf_s* next;
+  chpl_comm_trace_rec_t recs[COMM_TRACE_BUF_RECS];
+} comm_trace_buf_t;
+
+static int comm_trace_fd = -1;
+static uint64_t comm_trace_start_ns;
+static chpl_rt_lock_t comm_trace_bufs_lock;
+static comm_trace_buf_t* comm_trace_bufs;
+
+#ifdef CHPL_TLS
+static CHPL_TLS comm_trace_buf_t* comm_trace_my_buf;
+#endif
+
+static comm_trace_buf_t* comm_trace_buf_new(void) {
+  comm_trace_buf_t* buf;
+
+  buf = (comm_trace_buf_t*) chpl_mem_alloc(sizeof(comm_trace_buf_t),
+                                           CHPL_RT_MD_COMM_TRACE_BUFFER,
+                                           0, 0);
+  chpl_rt_lock_init(&buf->lock);
+  buf->len = 0;
+
+  chpl_rt_lock(&comm_trace_bufs_lock);
+  buf->next = comm_trace_bufs;
+  comm_trace_bufs = buf;
+  chpl_rt_unlock(&comm_trace_bufs_lock);
+
+  return buf;
+}
+
+// Return the buffer for this thread.  Without thread-local storage,
+// all threads share the first buffer.
+static comm_trace_buf_t* comm_trace_buf_mine(void) {
+#ifdef CHPL_TLS
+  if (comm_trace_my_buf == NULL)
+    comm_trace_my_buf = comm_trace_buf_new();
+  return comm_trace_my_buf;
+#else
+  comm_trace_buf_t* buf;
+  chpl_rt_lock(&comm_trace_bufs_lock);
+  buf = comm_trace_bufs;
+  chpl_rt_unlock(&comm_trace_bufs_lock);
+  return buf ? buf : comm_trace_buf_new();
+#endif
+}
+
+// Write out the buffer; call with its lock held.
+static void comm_trace_buf_flush(comm_trace_buf_t* buf) {
+  const char* data = (const char*) buf->recs;
+  size_t len = buf->len * sizeof(chpl_comm_trace_rec_t);
+  size_t off = 0;
+
+  while (off < len && comm_trace_fd >= 0) {
+    ssize_t wrv = write(comm_trace_fd, data + off, len - off);
+    if (wrv < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    off += wrv;
+  }
+  buf->len = 0;
+}
+
+static void comm_trace_record(const chpl_comm_cb_info_t* info) {
+  comm_trace_buf_t* buf;
+  chpl_comm_trace_rec_t* r;
+  uint64_t size, chunk;
+
+  if (comm_trace_fd < 0)
+    return;
+
+  switch (info->event_kind) {
+  case chpl_comm_cb_event_kind_put_strd:
+  case chpl_comm_cb_event_kind_get_strd:
+    {
+      const struct chpl_comm_info_comm_strd* s = &info->iu.comm_strd;
+      int32_t i;
+      chunk = s->count[0] * s->elemSize;
+      size = chunk;
+      for (i = 1; i <= s->stridelevels; i++)
+        size *= s->count[i];
+    }
+    break;
+  case chpl_comm_cb_event_kind_executeOn:
+  case chpl_comm_cb_event_kind_executeOn_nb:
+  case chpl_comm_cb_event_kind_executeOn_fast:
+    size = chunk = info->iu.executeOn.arg_size;
+    break;
+  default:
+    size = chunk = info->iu.comm.size;
+    break;
+  }
+
+  buf = comm_trace_buf_mine();
+  chpl_rt_lock(&buf->lock);
+  if (buf->len == COMM_TRACE_BUF_RECS)
+    comm_trace_buf_flush(buf);
+  r = &buf->recs[buf->len++];
+  r->time = chpl_now_ns() - comm_trace_start_ns;
+  r->tid = (int64_t) chpl_task_getId();
+  r->size = size;
+  r->chunk = chunk;
+  r->node = info->remoteNodeID;
+  r->kind = info->event_kind;
+  r->pad = 0;
+  chpl_rt_unlock(&buf->lock);
+}
+
+
+void chpl_comm_trace_init(void) {
+  const char* base;
+  char* fname;
+  size_t fname_len;
+  chpl_comm_trace_hdr_t hdr;
+  struct timeval tv;
+  int kind;
+
+  chpl_rt_lock_init(&comm_trace_bufs_lock);
+
+  base = chpl_get_rt_env("COMM_TRACE", NULL);
+  if (base == NULL || base[0] == '\0')
+    return;
+
+  fname_len = strlen(base) + 32;
+  fname = (char*) chpl_mem_alloc(fname_len, CHPL_RT_MD_COMM_TRACE_BUFFER,
+                                 0, 0);
+  snprintf(fname, fname_len, "%s-%d.ctr", base, (int) chpl_nodeID);
+  comm_trace_fd = open(fname, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  chpl_mem_free(fname, 0, 0);
+  if (comm_trace_fd < 0) {
+    chpl_warning("cannot open comm trace output file; not tracing", 0, 0);
+    return;
+  }
+
+  (void) gettimeofday(&tv, NULL);
+  comm_trace_start_ns = chpl_now_ns();
+
+  memset(&hdr, 0, sizeof(hdr));
+  strcpy(hdr.magic, CHPL_COMM_TRACE_MAGIC);
+  hdr.version = CHPL_COMM_TRACE_VERSION;
+  hdr.recSize = sizeof(chpl_comm_trace_rec_t);
+  hdr.node = chpl_nodeID;
+  hdr.numNodes = chpl_numNodes;
+  hdr.startSec = tv.tv_sec;
+  hdr.startUsec = tv.tv_usec;
+  if (write(comm_trace_fd, &hdr, sizeof(hdr)) != sizeof(hdr)) {
+    chpl_warning("cannot write comm trace output file; not tracing", 0, 0);
+    close(comm_trace_fd);
+    comm_trace_fd = -1;
+    return;
+  }
+
+  for (kind = 0; kind < chpl_comm_cb_num_event_kinds; kind++)
+    (void) chpl_comm_install_callback((chpl_comm_cb_event_kind_t) kind,
+                                      comm_trace_record);
+}
+
+
+void chpl_comm_trace_exit(void) {
+  comm_trace_buf_t* buf;
+  int kind;
+
+  if (comm_trace_fd < 0)
+    return;
+
+  for (kind = 0; kind < chpl_comm_cb_num_event_kinds; kind++)
+    (void) chpl_comm_uninstall_callback((chpl_comm_cb_event_kind_t) kind,
+                                        comm_trace_record);
+
+  chpl_rt_lock(&comm_trace_bufs_lock);
+  for (buf = comm_trace_bufs; buf != NULL; buf = buf->next) {
+    chpl_rt_lock(&buf->lock);
+    comm_trace_buf_flush(buf);
+    chpl_rt_unlock(&buf->lock);
+  }
+  close(comm_trace_fd);
+  comm_trace_fd = -1;
+  chpl_rt_unlock(&comm_trace_bufs_lock);
+  // The buffers are not freed, in case a callback is still running.
+}
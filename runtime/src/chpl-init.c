@@ -24,6 +24,8 @@
 #include "chplcast.h"
 #include "chplcgfns.h"
 #include "chpl-comm.h"
+#include "chpl-comm-diags.h"
+#include "chpl-comm-trace.h"
 #include "chplexit.h"
 #include "chplio.h"
 #include "chpl-init.h"
@@ -31,10 +33,15 @@
 #include "chplmemtrack.h"
 #include "chpl-privatization.h"
 #include "chpl-tasks.h"
+#include "chpl-stack-profile.h"
+#include "chpl-sync-profile.h"
+#include "chpl-task-profile.h"
 #include "chpl-linefile-support.h"
+#include "chpl-loop-stats.h"
 #include "chplsys.h"
 #include "config.h"
 #include "error.h"
+#include "qbuffer.h"
 
 #include <stdint.h>
 #include <string.h>
@@ -148,6 +155,8 @@ void chpl_rt_init(int argc, char* argv[]) {
   chpl_comm_init(&argc, &argv);
   chpl_mem_init();
   chpl_comm_post_mem_init();
+  chpl_comm_diags_init();
+  qbytes_iobuf_pool_init();
 
   chpl_comm_barrier("about to leave comm init code");
 
@@ -180,6 +189,11 @@ void chpl_rt_init(int argc, char* argv[]) {
   // Initialize the task management layer.
   //
   chpl_task_init();
+  chpl_task_prof_init();
+  chpl_stack_prof_init();
+  chpl_comm_trace_init();
+  chpl_sync_prof_init();
+  chpl_loop_stats_init();
 
   // Initialize privatization, needs to happen before hitting module init
   chpl_privatization_init();
@@ -0,0 +1,321 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+//
+// Loop statistics
+//
+// See chpl-loop-stats.h for what is recorded.  Sites are only added to
+// once per loop execution, so one list per locale under a lock is
+// enough.
+//
+// For standalone foralls, each thread counts the iterations it runs
+// of the loop it last saw without taking a lock.  When it moves on to
+// another loop, as it does for nested loops, it sets the count aside
+// in its list of parked counts, under the threads lock.  When a loop
+// is done its iterations have all run, so its counts can be collected
+// under that lock and no thread will add to them again.
+//
+
+#include "chplrt.h"
+
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-linefile-support.h"
+#include "chpl-loop-stats.h"
+#include "chpl-mem.h"
+#include "chpl-rt-lock.h"
+#include "chpl-thread-local-storage.h"
+#include "error.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static chpl_rt_lock_t loop_stats_lock;
+static chpl_loop_stats_site_t* loop_stats_sites;
+static int64_t loop_stats_num_sites;
+static int64_t loop_stats_max_sites;
+
+typedef struct {
+  uint64_t id;
+  uint64_t iters;
+} loop_stats_count_t;
+
+typedef struct loop_stats_thread_s {
+  loop_stats_count_t cur;              // the loop this thread is counting
+  loop_stats_count_t* parked;          // loops it has set aside
+  int64_t num_parked;
+  int64_t max_parked;
+  struct loop_stats_thread_s* next;
+} loop_stats_thread_t;
+
+static atomic_uint_least64_t loop_stats_next_id;
+static chpl_rt_lock_t loop_stats_threads_lock;
+static loop_stats_thread_t* loop_stats_threads;
+
+#ifdef CHPL_TLS
+static CHPL_TLS loop_stats_thread_t* loop_stats_my;
+#else
+static loop_stats_thread_t* loop_stats_my;
+#endif
+
+static const char* loop_stats_kind_names[chpl_loop_stats_num_kinds] = {
+  "forall",
+  "coforall",
+  "standalone"
+};
+
+void chpl_loop_stats_init(void) {
+  chpl_rt_lock_init(&loop_stats_lock);
+  chpl_rt_lock_init(&loop_stats_threads_lock);
+  atomic_init_uint_least64_t(&loop_stats_next_id, 1);
+}
+
+uint64_t chpl_loop_stats_new_id(void) {
+  uint64_t n = atomic_fetch_add_explicit_uint_least64_t(&loop_stats_next_id, 1,
+                                                        memory_order_relaxed);
+  return ((uint64_t) chpl_nodeID << 48) | n;
+}
+
+//
+// Set the thread's count for the loop it was counting aside, and start
+// counting for loop id.  Called with the threads lock held.
+//
+static void loop_stats_park(loop_stats_thread_t* t, uint64_t id) {
+  int64_t i;
+
+  if (t->cur.iters > 0) {
+    for (i = 0; i < t->num_parked; i++) {
+      if (t->parked[i].id == t->cur.id)
+        break;
+    }
+    if (i == t->num_parked) {
+      if (t->num_parked == t->max_parked) {
+        t->max_parked = (t->max_parked == 0) ? 4 : 2 * t->max_parked;
+        t->parked = (loop_stats_count_t*)
+                    chpl_realloc(t->parked,
+                                 t->max_parked * sizeof(t->parked[0]));
+        if (t->parked == NULL)
+          chpl_internal_error("out of memory for loop statistics");
+      }
+      t->parked[t->num_parked].id = t->cur.id;
+      t->parked[t->num_parked].iters = 0;
+      t->num_parked++;
+    }
+    t->parked[i].iters += t->cur.iters;
+  }
+  t->cur.id = id;
+  t->cur.iters = 0;
+}
+
+chpl_bool chpl_loop_stats_iter(uint64_t id) {
+  loop_stats_thread_t* t = loop_stats_my;
+  chpl_bool first;
+
+  // Without thread-local storage all threads share one count, which
+  // is only touched under the lock.
+#ifdef CHPL_TLS
+  if (t != NULL && t->cur.id == id) {
+    t->cur.iters++;
+    return false;
+  }
+#endif
+
+  chpl_rt_lock(&loop_stats_threads_lock);
+  if (t == NULL) {
+    t = (loop_stats_thread_t*) chpl_calloc(1, sizeof(*t));
+    if (t == NULL)
+      chpl_internal_error("out of memory for loop statistics");
+    t->next = loop_stats_threads;
+    loop_stats_threads = t;
+    loop_stats_my = t;
+  }
+  first = (t->cur.id != id);
+  if (first)
+    loop_stats_park(t, id);
+  t->cur.iters++;
+  chpl_rt_unlock(&loop_stats_threads_lock);
+  return first;
+}
+
+void chpl_loop_stats_collect(uint64_t id, chpl_loop_stats_site_t* site) {
+  loop_stats_thread_t* t;
+  uint64_t n;
+  int64_t i;
+
+  site->iters = 0;
+  site->chunks = 0;
+  site->min_chunk = UINT64_MAX;
+  site->max_chunk = 0;
+
+  chpl_rt_lock(&loop_stats_threads_lock);
+  for (t = loop_stats_threads; t != NULL; t = t->next) {
+    n = 0;
+    if (t->cur.id == id) {
+      n += t->cur.iters;
+      t->cur.iters = 0;
+    }
+    for (i = 0; i < t->num_parked; i++) {
+      if (t->parked[i].id == id) {
+        n += t->parked[i].iters;
+        t->parked[i] = t->parked[--t->num_parked];
+        break;
+      }
+    }
+    if (n > 0) {
+      site->iters += n;
+      site->chunks++;
+      if (n < site->min_chunk) site->min_chunk = n;
+      if (n > site->max_chunk) site->max_chunk = n;
+    }
+  }
+  chpl_rt_unlock(&loop_stats_threads_lock);
+}
+
+//
+// Find the site for a loop, adding it if it is new.  Called with the
+// lock held.
+//
+static chpl_loop_stats_site_t* loop_stats_find(int32_t kind, int32_t lineno,
+                                               int32_t filename) {
+  chpl_loop_stats_site_t* s;
+  int64_t i;
+
+  for (i = 0; i < loop_stats_num_sites; i++) {
+    s = &loop_stats_sites[i];
+    if (s->lineno == lineno && s->filename == filename && s->kind == kind)
+      return s;
+  }
+
+  if (loop_stats_num_sites == loop_stats_max_sites) {
+    loop_stats_max_sites = (loop_stats_max_sites == 0)
+                           ? 16 : 2 * loop_stats_max_sites;
+    loop_stats_sites = (chpl_loop_stats_site_t*)
+                       chpl_realloc(loop_stats_sites,
+                                    loop_stats_max_sites * sizeof(*s));
+    if (loop_stats_sites == NULL)
+      chpl_internal_error("out of memory for loop statistics");
+  }
+
+  s = &loop_stats_sites[loop_stats_num_sites++];
+  memset(s, 0, sizeof(*s));
+  s->kind = kind;
+  s->lineno = lineno;
+  s->filename = filename;
+  s->min_chunk = UINT64_MAX;
+  s->min_task_ns = UINT64_MAX;
+  return s;
+}
+
+static void loop_stats_add(chpl_loop_stats_site_t* site) {
+  chpl_loop_stats_site_t* s;
+
+  chpl_rt_lock(&loop_stats_lock);
+  s = loop_stats_find(site->kind, site->lineno, site->filename);
+  s->calls   += site->calls;
+  s->iters   += site->iters;
+  s->chunks  += site->chunks;
+  s->task_ns += site->task_ns;
+  s->wall_ns += site->wall_ns;
+  s->imbal_sum += site->imbal_sum;
+  if (site->chunks > 0) {
+    if (site->min_chunk < s->min_chunk)     s->min_chunk = site->min_chunk;
+    if (site->max_chunk > s->max_chunk)     s->max_chunk = site->max_chunk;
+    if (site->min_task_ns < s->min_task_ns) s->min_task_ns = site->min_task_ns;
+    if (site->max_task_ns > s->max_task_ns) s->max_task_ns = site->max_task_ns;
+  }
+  if (site->imbal_max > s->imbal_max)
+    s->imbal_max = site->imbal_max;
+  chpl_rt_unlock(&loop_stats_lock);
+}
+
+void chpl_loop_stats_record(chpl_loop_stats_site_t* site,
+                            int32_t lineno, int32_t filename) {
+  site->lineno = lineno;
+  site->filename = filename;
+  loop_stats_add(site);
+}
+
+int64_t chpl_loop_stats_num_sites(void) {
+  return loop_stats_num_sites;
+}
+
+void chpl_loop_stats_get_site(int64_t i, chpl_loop_stats_site_t* site) {
+  *site = loop_stats_sites[i];
+}
+
+void chpl_loop_stats_add_site(chpl_loop_stats_site_t* site) {
+  loop_stats_add(site);
+}
+
+static int loop_stats_cmp(const void* p1, const void* p2) {
+  const chpl_loop_stats_site_t* s1 = (const chpl_loop_stats_site_t*) p1;
+  const chpl_loop_stats_site_t* s2 = (const chpl_loop_stats_site_t*) p2;
+  if (s1->wall_ns != s2->wall_ns)
+    return (s1->wall_ns < s2->wall_ns) ? 1 : -1;
+  if (s1->filename != s2->filename)
+    return (s1->filename < s2->filename) ? -1 : 1;
+  if (s1->lineno != s2->lineno)
+    return (s1->lineno < s2->lineno) ? -1 : 1;
+  return s1->kind - s2->kind;
+}
+
+void chpl_loop_stats_report(void) {
+  int64_t i;
+
+  if (loop_stats_num_sites == 0)
+    return;
+
+  qsort(loop_stats_sites, loop_stats_num_sites, sizeof(loop_stats_sites[0]),
+        loop_stats_cmp);
+
+  printf("Loop statistics, %d locale(s), %lld loop(s), by total time:\n",
+         (int) chpl_numNodes, (long long) loop_stats_num_sites);
+  printf("%10s %8s %10s %7s %21s %29s %13s %10s  %s\n",
+         "kind", "calls", "iters/call", "chunks",
+         "chunk iters min/max", "chunk time(s) min/avg/max",
+         "imbal avg/max", "time(s)", "location");
+  for (i = 0; i < loop_stats_num_sites; i++) {
+    chpl_loop_stats_site_t* s = &loop_stats_sites[i];
+    double calls = (double) s->calls;
+
+    printf("%10s %8llu %10.1f %7.1f ",
+           loop_stats_kind_names[s->kind],
+           (unsigned long long) s->calls,
+           s->iters / calls, s->chunks / calls);
+    if (s->chunks > 0)
+      printf("%10llu %10llu ",
+             (unsigned long long) s->min_chunk,
+             (unsigned long long) s->max_chunk);
+    else
+      printf("%10s %10s ", "-", "-");
+    if (s->chunks > 0 && s->kind != chpl_loop_stats_kind_standalone)
+      printf("%9.6f %9.6f %9.6f ",
+             s->min_task_ns / 1e9, s->task_ns / 1e9 / s->chunks,
+             s->max_task_ns / 1e9);
+    else
+      printf("%9s %9s %9s ", "-", "-", "-");
+    printf("%6.2f %6.2f %10.6f  %s:%d\n",
+           s->imbal_sum / calls, s->imbal_max, s->wall_ns / 1e9,
+           chpl_lookupFilename(s->filename), (int) s->lineno);
+  }
+  fflush(stdout);
+}
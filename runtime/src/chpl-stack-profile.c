@@ -0,0 +1,427 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Sampling stack profiler
+//
+// See chpl-stack-profile.h for how to turn this on and what it writes.
+// The SIGPROF handler only records the instruction pointers of the
+// interrupted stack, into a preallocated pool, since very little can
+// be done safely in a signal handler.  Each sample takes a header word
+// holding its depth and then one word per frame, so the pool is sized
+// from the sampling rate, how long the program is expected to run, and
+// a typical stack depth.  Mapping them to Chapel functions
+// and folding identical stacks together is done at exit.  A frame is
+// mapped by asking libunwind for the start of the procedure containing
+// it and looking that up in chpl_funAddrTable, which the compiler
+// emits alongside the unwind symbol table.
+//
+
+#include "chplrt.h"
+
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-linefile-support.h"
+#include "chpl-mem.h"
+#include "chpl-stack-profile.h"
+#include "chplcgfns.h"
+#include "error.h"
+
+#ifdef CHPL_DO_UNWIND
+
+#include "chpl-atomics.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+// Necessary for instruct libunwind to use only the local unwind
+#define UNW_LOCAL_ONLY
+#include <libunwind.h>
+
+#define STACK_PROF_DEFAULT_HZ       99
+#define STACK_PROF_DEFAULT_SECONDS  300     // CPU seconds to make room for
+#define STACK_PROF_AVG_DEPTH        16
+#define STACK_PROF_MAX_DEPTH        64
+#define STACK_PROF_CACHE_SLOTS      (1 << 16)   // must be a power of 2
+#define STACK_PROF_MAX_NAME         256
+
+// A sample's header word holds its depth, and this bit once its frames
+// have been stored.  The frames follow, innermost first.
+#define STACK_PROF_DONE             ((uint64_t) 1 << 32)
+
+static int stack_prof_enabled = 0;
+static const char* stack_prof_base;
+static atomic_uint_least64_t* stack_prof_pool;
+static uint64_t stack_prof_pool_words;
+static atomic_uint_least64_t stack_prof_next_word;
+static atomic_uint_least64_t stack_prof_dropped;
+
+
+//
+// The signal handler.  It skips the frames of the handler itself and
+// the signal trampoline, and records the interrupted stack from there.
+//
+static void stack_prof_handler(int sig, siginfo_t* info, void* context) {
+  int saved_errno = errno;
+  uint64_t ips[STACK_PROF_MAX_DEPTH];
+  uint_least64_t i;
+  unw_context_t uc;
+  unw_cursor_t cursor;
+  unw_word_t ip;
+  int depth = 0;
+  int in_handler = 1;
+  int k;
+
+  if (unw_getcontext(&uc) == 0 && unw_init_local(&cursor, &uc) == 0) {
+    while (depth < STACK_PROF_MAX_DEPTH && unw_step(&cursor) > 0) {
+      // libunwind marks the frame reached by stepping through the
+      // signal trampoline, which is the interrupted one, so that frame
+      // is the first one recorded.
+      if (in_handler) {
+        if (unw_is_signal_frame(&cursor) <= 0)
+          continue;
+        in_handler = 0;
+      }
+      if (unw_get_reg(&cursor, UNW_REG_IP, &ip) == 0)
+        ips[depth++] = ip;
+    }
+  }
+
+  if (depth > 0) {
+    i = atomic_fetch_add_uint_least64_t(&stack_prof_next_word, depth + 1);
+    if (i + depth + 1 > stack_prof_pool_words) {
+      atomic_fetch_add_uint_least64_t(&stack_prof_dropped, 1);
+    } else {
+      atomic_store_explicit_uint_least64_t(&stack_prof_pool[i], depth,
+                                           memory_order_relaxed);
+      for (k = 0; k < depth; k++)
+        atomic_store_explicit_uint_least64_t(&stack_prof_pool[i + 1 + k],
+                                             ips[k], memory_order_relaxed);
+      atomic_store_explicit_uint_least64_t(&stack_prof_pool[i],
+                                           depth | STACK_PROF_DONE,
+                                           memory_order_release);
+    }
+  }
+  errno = saved_errno;
+}
+
+
+void chpl_stack_prof_init(void) {
+  struct sigaction sa;
+  struct itimerval itv;
+  const char* s;
+  long hz = STACK_PROF_DEFAULT_HZ;
+  long seconds = STACK_PROF_DEFAULT_SECONDS;
+
+  stack_prof_base = chpl_get_rt_env("STACK_PROFILE", NULL);
+  if (stack_prof_base == NULL || stack_prof_base[0] == '\0')
+    return;
+
+  if ((s = chpl_get_rt_env("STACK_PROFILE_HZ", NULL)) != NULL) {
+    long n = atol(s);
+    if (n < 1 || n > 1000000)
+      chpl_warning("CHPL_RT_STACK_PROFILE_HZ must be in 1..1000000; "
+                   "using the default", 0, 0);
+    else
+      hz = n;
+  }
+
+  if ((s = chpl_get_rt_env("STACK_PROFILE_SECONDS", NULL)) != NULL) {
+    long n = atol(s);
+    if (n < 1 || n > 100000000)
+      chpl_warning("CHPL_RT_STACK_PROFILE_SECONDS must be in 1..100000000; "
+                   "using the default", 0, 0);
+    else
+      seconds = n;
+  }
+
+  // The pool is zeroed, so that a header not yet written reads as 0.
+  stack_prof_pool_words =
+    (uint64_t) hz * seconds * (STACK_PROF_AVG_DEPTH + 1);
+  stack_prof_pool =
+    (atomic_uint_least64_t*)
+    chpl_mem_allocManyZero(stack_prof_pool_words,
+                           sizeof(atomic_uint_least64_t),
+                           CHPL_RT_MD_STACK_PROFILE, 0, 0);
+  atomic_init_uint_least64_t(&stack_prof_next_word, 0);
+  atomic_init_uint_least64_t(&stack_prof_dropped, 0);
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_sigaction = stack_prof_handler;
+  sa.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&sa.sa_mask);
+  if (sigaction(SIGPROF, &sa, NULL) != 0) {
+    chpl_warning("cannot install the SIGPROF handler; "
+                 "stack profiling is off", 0, 0);
+    chpl_mem_free(stack_prof_pool, 0, 0);
+    return;
+  }
+
+  // tv_usec must be below 1000000, so a 1 Hz period goes in tv_sec.
+  itv.it_interval.tv_sec = (1000000 / hz) / 1000000;
+  itv.it_interval.tv_usec = (1000000 / hz) % 1000000;
+  itv.it_value = itv.it_interval;
+  if (setitimer(ITIMER_PROF, &itv, NULL) != 0) {
+    chpl_warning("cannot start the profiling timer; "
+                 "stack profiling is off", 0, 0);
+    signal(SIGPROF, SIG_DFL);
+    chpl_mem_free(stack_prof_pool, 0, 0);
+    return;
+  }
+
+  stack_prof_enabled = 1;
+}
+
+
+//
+// Mapping instruction pointers to Chapel functions.
+//
+// stack_prof_fns holds the indices of the entries in chpl_funAddrTable,
+// sorted by address.  Lookups are cached, since the same instruction
+// pointers show up in many samples.
+//
+static int* stack_prof_fns;
+static int stack_prof_nfns;
+
+typedef struct {
+  uint64_t ip;
+  int fn;                       // index into chpl_funAddrTable, or -1
+} stack_prof_cache_t;
+
+static stack_prof_cache_t* stack_prof_cache;
+
+static int stack_prof_cmp_fn_addr(const void* p1, const void* p2) {
+  uintptr_t a1 = (uintptr_t) chpl_funAddrTable[*(const int*) p1];
+  uintptr_t a2 = (uintptr_t) chpl_funAddrTable[*(const int*) p2];
+  return (a1 < a2) ? -1 : (a1 > a2) ? 1 : 0;
+}
+
+static void stack_prof_setup_fns(void) {
+  int nfuns = chpl_sizeSymTable / 2;
+  int i;
+
+  // Functions without an address, such as extern ones, cannot be the
+  // target of a lookup.
+  stack_prof_fns = (int*) chpl_mem_allocMany(nfuns + 1, sizeof(int),
+                                             CHPL_RT_MD_STACK_PROFILE, 0, 0);
+  stack_prof_nfns = 0;
+  for (i = 0; i < nfuns; i++)
+    if (chpl_funAddrTable[i] != NULL)
+      stack_prof_fns[stack_prof_nfns++] = i;
+  qsort(stack_prof_fns, stack_prof_nfns, sizeof(int), stack_prof_cmp_fn_addr);
+
+  // An all-ones ip marks an empty slot; a zero-filled slot would
+  // look like a cached lookup of ip 0.
+  stack_prof_cache =
+    (stack_prof_cache_t*) chpl_mem_allocMany(STACK_PROF_CACHE_SLOTS,
+                                             sizeof(stack_prof_cache_t),
+                                             CHPL_RT_MD_STACK_PROFILE, 0, 0);
+  for (i = 0; i < STACK_PROF_CACHE_SLOTS; i++) {
+    stack_prof_cache[i].ip = ~(uint64_t) 0;
+    stack_prof_cache[i].fn = -1;
+  }
+}
+
+static int stack_prof_lookup(uint64_t ip) {
+  stack_prof_cache_t* c = &stack_prof_cache[(ip >> 2) &
+                                            (STACK_PROF_CACHE_SLOTS - 1)];
+  unw_proc_info_t pi;
+  int lo, hi;
+
+  if (c->ip == ip)
+    return c->fn;
+
+  c->ip = ip;
+  c->fn = -1;
+  if (unw_get_proc_info_by_ip(unw_local_addr_space, (unw_word_t) ip,
+                              &pi, NULL) != 0)
+    return -1;
+
+  lo = 0;
+  hi = stack_prof_nfns - 1;
+  while (lo <= hi) {
+    int mid = (lo + hi) / 2;
+    uintptr_t a = (uintptr_t) chpl_funAddrTable[stack_prof_fns[mid]];
+    if (a == (uintptr_t) pi.start_ip) {
+      c->fn = stack_prof_fns[mid];
+      break;
+    } else if (a < (uintptr_t) pi.start_ip) {
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return c->fn;
+}
+
+
+//
+// Folding.  Each stack becomes a line of frame names from the
+// outermost to the innermost, separated by ';'.  Frames that are not
+// in Chapel functions are left out, except that if the innermost
+// frames are not in Chapel code they are shown as one "[runtime]"
+// frame, so that time spent in the runtime and libraries is not lost.
+//
+static char* stack_prof_fold(const uint64_t* ips, int depth) {
+  char buf[STACK_PROF_MAX_DEPTH * STACK_PROF_MAX_NAME];
+  size_t len = 0;
+  int k;
+  char* str;
+
+  buf[0] = '\0';
+  for (k = depth - 1; k >= 0; k--) {
+    // All but the innermost frame hold return addresses, which may be
+    // just past the end of the calling function.
+    uint64_t ip = (k == 0) ? ips[k] : ips[k] - 1;
+    int fn = stack_prof_lookup(ip);
+    int n;
+
+    if (fn < 0) {
+      if (k == 0)
+        n = snprintf(buf + len, sizeof(buf) - len, "%s[runtime]",
+                     (len > 0) ? ";" : "");
+      else
+        continue;
+    } else {
+      n = snprintf(buf + len, sizeof(buf) - len, "%s%.*s (%s:%d)",
+                   (len > 0) ? ";" : "",
+                   STACK_PROF_MAX_NAME / 2, chpl_funSymTable[2 * fn + 1],
+                   chpl_lookupFilename(chpl_filenumSymTable[2 * fn]),
+                   chpl_filenumSymTable[2 * fn + 1]);
+    }
+    if (n < 0 || (size_t) n >= sizeof(buf) - len)
+      break;
+    len += n;
+  }
+
+  if (len == 0)
+    return NULL;
+
+  str = (char*) chpl_mem_alloc(len + 1, CHPL_RT_MD_STACK_PROFILE, 0, 0);
+  memcpy(str, buf, len + 1);
+  return str;
+}
+
+static int stack_prof_cmp_str(const void* p1, const void* p2) {
+  return strcmp(*(char* const*) p1, *(char* const*) p2);
+}
+
+
+void chpl_stack_prof_exit(void) {
+  struct itimerval itv;
+  uint64_t n, i, nstacks, dropped;
+  char** stacks;
+  char* fname;
+  size_t fname_len;
+  FILE* f;
+
+  if (!stack_prof_enabled)
+    return;
+  stack_prof_enabled = 0;
+
+  memset(&itv, 0, sizeof(itv));
+  setitimer(ITIMER_PROF, &itv, NULL);
+  signal(SIGPROF, SIG_IGN);
+
+  n = atomic_load_uint_least64_t(&stack_prof_next_word);
+  if (n > stack_prof_pool_words)
+    n = stack_prof_pool_words;
+  dropped = atomic_load_uint_least64_t(&stack_prof_dropped);
+
+  stack_prof_setup_fns();
+
+  // There are at most n / 2 samples, since each takes at least 2 words.
+  stacks = (char**) chpl_mem_allocMany(n / 2 + 1, sizeof(char*),
+                                       CHPL_RT_MD_STACK_PROFILE, 0, 0);
+  nstacks = 0;
+  for (i = 0; i < n; ) {
+    uint64_t ips[STACK_PROF_MAX_DEPTH];
+    uint64_t h = atomic_load_explicit_uint_least64_t(&stack_prof_pool[i],
+                                                     memory_order_acquire);
+    int depth = (int) (h & (STACK_PROF_DONE - 1));
+    int k;
+    char* str;
+
+    // A header of 0 is a sample still being stored; the ones after it
+    // cannot be found.
+    if (depth == 0)
+      break;
+    if (h & STACK_PROF_DONE) {
+      for (k = 0; k < depth; k++)
+        ips[k] = atomic_load_explicit_uint_least64_t(&stack_prof_pool[i + 1 + k],
+                                                     memory_order_relaxed);
+      if ((str = stack_prof_fold(ips, depth)) != NULL)
+        stacks[nstacks++] = str;
+    }
+    i += depth + 1;
+  }
+  qsort(stacks, nstacks, sizeof(char*), stack_prof_cmp_str);
+
+  fname_len = strlen(stack_prof_base) + 32;
+  fname = (char*) chpl_mem_alloc(fname_len, CHPL_RT_MD_STACK_PROFILE, 0, 0);
+  snprintf(fname, fname_len, "%s-%d.folded", stack_prof_base,
+           (int) chpl_nodeID);
+  if ((f = fopen(fname, "w")) == NULL) {
+    chpl_warning("cannot open stack profile output file", 0, 0);
+  } else {
+    for (i = 0; i < nstacks; ) {
+      uint64_t j = i + 1;
+      while (j < nstacks && strcmp(stacks[i], stacks[j]) == 0)
+        j++;
+      fprintf(f, "%s %llu\n", stacks[i], (unsigned long long) (j - i));
+      i = j;
+    }
+    fclose(f);
+  }
+
+  if (dropped > 0) {
+    char msg[128];
+    snprintf(msg, sizeof(msg),
+             "stack profile buffer was full; %llu samples dropped "
+             "(see CHPL_RT_STACK_PROFILE_SECONDS)",
+             (unsigned long long) dropped);
+    chpl_warning(msg, 0, 0);
+  }
+
+  for (i = 0; i < nstacks; i++)
+    chpl_mem_free(stacks[i], 0, 0);
+  chpl_mem_free(stacks, 0, 0);
+  chpl_mem_free(fname, 0, 0);
+  chpl_mem_free(stack_prof_cache, 0, 0);
+  chpl_mem_free(stack_prof_fns, 0, 0);
+  // The pool is not freed, in case a handler is still running.
+}
+
+#else // CHPL_DO_UNWIND
+
+void chpl_stack_prof_init(void) {
+  const char* base = chpl_get_rt_env("STACK_PROFILE", NULL);
+  if (base != NULL && base[0] != '\0')
+    chpl_warning("CHPL_RT_STACK_PROFILE needs CHPL_UNWIND to be set; "
+                 "stack profiling is off", 0, 0);
+}
+
+void chpl_stack_prof_exit(void) { }
+
+#endif // CHPL_DO_UNWIND
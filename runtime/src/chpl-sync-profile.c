@@ -0,0 +1,371 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+//
+// Sync variable and atomic contention profiler
+//
+// See chpl-sync-profile.h for how to turn this on and what it reports.
+// Each thread counts into its own hash table of sites, so recording
+// takes no locks.  The tables are merged when the report is made.
+//
+// Recording can still be going on in other threads then, and a thread
+// that adds a site may replace its table's site array.  So each
+// thread sets its busy flag before it checks sync_prof_recording, and
+// clears it when done with its table.  The merge clears
+// sync_prof_recording and then waits for each thread's busy flag to
+// be clear before reading its table.  Both sides use sequentially
+// consistent operations, so either the merge sees the flag or the
+// recording thread sees that recording has stopped.
+//
+// Memory is allocated with chpl_calloc() rather than chpl_mem_alloc(),
+// because with memory tracking on the latter takes a sync lock, and
+// we may be called with that lock held.
+//
+
+#include "chplrt.h"
+
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-linefile-support.h"
+#include "chpl-mem.h"
+#include "chpl-rt-lock.h"
+#include "chpl-sync-profile.h"
+#include "chpl-thread-local-storage.h"
+#include "error.h"
+
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SYNC_PROF_DEFAULT_TOP  20
+#define SYNC_PROF_INIT_SLOTS   64       // must be a power of 2
+
+typedef struct {
+  chpl_sync_prof_site_t* sites;        // ops == 0 marks an empty slot
+  int64_t num_slots;
+  int64_t num_sites;
+} sync_prof_table_t;
+
+typedef struct sync_prof_thread_s {
+  sync_prof_table_t tbl;
+  atomic_bool busy;                    // recording into tbl
+  struct sync_prof_thread_s* next;
+} sync_prof_thread_t;
+
+int chpl_sync_prof_on = 0;
+static atomic_bool sync_prof_recording;
+
+static int sync_prof_top = SYNC_PROF_DEFAULT_TOP;
+static int sync_prof_merged = 0;
+static sync_prof_table_t sync_prof_all;
+static chpl_sync_prof_site_t** sync_prof_order;
+
+static chpl_rt_lock_t sync_prof_threads_lock;
+static sync_prof_thread_t* sync_prof_threads;
+
+#ifdef CHPL_TLS
+static CHPL_TLS sync_prof_thread_t* sync_prof_my;
+#endif
+
+static const char* sync_prof_kind_names[chpl_sync_prof_num_kinds] = {
+  "sync wait full",
+  "sync wait empty",
+  "atomic CAS",
+  "atomic TAS",
+  "atomic waitFor"
+};
+
+static void* sync_prof_alloc(size_t n, size_t size) {
+  void* p = chpl_calloc(n, size);
+  if (p == NULL)
+    chpl_internal_error("out of memory in the sync profiler");
+  return p;
+}
+
+static void sync_prof_table_init(sync_prof_table_t* t, int64_t num_slots) {
+  t->sites = (chpl_sync_prof_site_t*)
+             sync_prof_alloc(num_slots, sizeof(chpl_sync_prof_site_t));
+  t->num_slots = num_slots;
+  t->num_sites = 0;
+}
+
+static inline uint64_t sync_prof_hash(int32_t kind, int32_t lineno,
+                                      int32_t filename) {
+  uint64_t h = ((uint64_t) (uint32_t) filename << 32) ^ (uint32_t) lineno;
+  h = (h ^ (uint64_t) kind) * 0x9E3779B97F4A7C15ULL;
+  return h ^ (h >> 29);
+}
+
+static chpl_sync_prof_site_t* sync_prof_slot(sync_prof_table_t* t,
+                                             int32_t kind, int32_t lineno,
+                                             int32_t filename) {
+  uint64_t mask = t->num_slots - 1;
+  uint64_t i = sync_prof_hash(kind, lineno, filename) & mask;
+
+  while (t->sites[i].ops != 0
+         && (t->sites[i].kind != kind
+             || t->sites[i].lineno != lineno
+             || t->sites[i].filename != filename))
+    i = (i + 1) & mask;
+  return &t->sites[i];
+}
+
+static void sync_prof_table_grow(sync_prof_table_t* t) {
+  sync_prof_table_t old = *t;
+  int64_t i;
+
+  sync_prof_table_init(t, old.num_slots * 2);
+  for (i = 0; i < old.num_slots; i++) {
+    if (old.sites[i].ops != 0) {
+      *sync_prof_slot(t, old.sites[i].kind, old.sites[i].lineno,
+                      old.sites[i].filename) = old.sites[i];
+      t->num_sites++;
+    }
+  }
+  chpl_free(old.sites);
+}
+
+//
+// Find the site, adding it if it is new.  A new site is returned with
+// its key filled in and ops still 0; the caller must make ops nonzero.
+//
+static chpl_sync_prof_site_t* sync_prof_find(sync_prof_table_t* t,
+                                             int32_t kind, int32_t lineno,
+                                             int32_t filename) {
+  chpl_sync_prof_site_t* s = sync_prof_slot(t, kind, lineno, filename);
+
+  if (s->ops == 0) {
+    if (2 * (t->num_sites + 1) > t->num_slots) {
+      sync_prof_table_grow(t);
+      s = sync_prof_slot(t, kind, lineno, filename);
+    }
+    s->kind = kind;
+    s->lineno = lineno;
+    s->filename = filename;
+    t->num_sites++;
+  }
+  return s;
+}
+
+#ifdef CHPL_TLS
+static sync_prof_thread_t* sync_prof_thread_new(void) {
+  sync_prof_thread_t* tp;
+
+  tp = (sync_prof_thread_t*) sync_prof_alloc(1, sizeof(*tp));
+  sync_prof_table_init(&tp->tbl, SYNC_PROF_INIT_SLOTS);
+  atomic_init_bool(&tp->busy, false);
+
+  chpl_rt_lock(&sync_prof_threads_lock);
+  tp->next = sync_prof_threads;
+  sync_prof_threads = tp;
+  chpl_rt_unlock(&sync_prof_threads_lock);
+
+  return tp;
+}
+#endif
+
+void chpl_sync_prof_init(void) {
+  const char* s;
+
+  if ((s = chpl_get_rt_env("SYNC_PROFILE", NULL)) == NULL || s[0] == '\0')
+    return;
+
+  sync_prof_top = atoi(s);
+  if (sync_prof_top < 1) {
+    chpl_warning("CHPL_RT_SYNC_PROFILE must be a number of sites to report; "
+                 "using 20", 0, 0);
+    sync_prof_top = SYNC_PROF_DEFAULT_TOP;
+  }
+
+#ifdef CHPL_TLS
+  chpl_rt_lock_init(&sync_prof_threads_lock);
+  atomic_init_bool(&sync_prof_recording, true);
+  chpl_sync_prof_on = 1;
+#else
+  chpl_warning("CHPL_RT_SYNC_PROFILE needs thread-local storage, which "
+               "this build does not have", 0, 0);
+#endif
+}
+
+void chpl_sync_prof_record(chpl_sync_prof_kind_t kind,
+                           int32_t lineno, int32_t filename,
+                           chpl_bool waited, uint64_t wait_ns,
+                           chpl_bool transfer) {
+#ifdef CHPL_TLS
+  sync_prof_thread_t* tp;
+  chpl_sync_prof_site_t* s;
+
+  if (!chpl_sync_prof_on
+      || !atomic_load_explicit_bool(&sync_prof_recording,
+                                    memory_order_relaxed))
+    return;
+
+  if (sync_prof_my == NULL)
+    sync_prof_my = sync_prof_thread_new();
+  tp = sync_prof_my;
+
+  atomic_store_bool(&tp->busy, true);
+  if (atomic_load_bool(&sync_prof_recording)) {
+    s = sync_prof_find(&tp->tbl, kind, lineno, filename);
+    s->ops++;
+    if (waited) {
+      s->waits++;
+      s->wait_ns += wait_ns;
+    }
+    if (transfer)
+      s->transfers++;
+  }
+  atomic_store_explicit_bool(&tp->busy, false, memory_order_release);
+#endif
+}
+
+void chpl_sync_prof_op(int32_t kind, uint64_t start_ns, chpl_bool waited,
+                       int32_t lineno, int32_t filename) {
+  if (start_ns == 0 || kind < 0 || kind >= chpl_sync_prof_num_kinds)
+    return;
+  chpl_sync_prof_record((chpl_sync_prof_kind_t) kind, lineno, filename,
+                        waited,
+                        waited ? chpl_now_ns() - start_ns : 0,
+                        false);
+}
+
+//
+// Stop recording and merge the threads' tables, once each thread is
+// done with any record it was in the middle of.  This is done once;
+// after that only sites added from other locales change the totals.
+//
+static void sync_prof_merge(void) {
+  sync_prof_thread_t* tp;
+  int64_t i;
+
+  if (sync_prof_merged)
+    return;
+  sync_prof_merged = 1;
+  atomic_store_bool(&sync_prof_recording, false);
+
+  sync_prof_table_init(&sync_prof_all, SYNC_PROF_INIT_SLOTS);
+  chpl_rt_lock(&sync_prof_threads_lock);
+  for (tp = sync_prof_threads; tp != NULL; tp = tp->next) {
+    while (atomic_load_bool(&tp->busy))
+      sched_yield();
+    for (i = 0; i < tp->tbl.num_slots; i++) {
+      if (tp->tbl.sites[i].ops != 0)
+        chpl_sync_prof_add_site(&tp->tbl.sites[i]);
+    }
+  }
+  chpl_rt_unlock(&sync_prof_threads_lock);
+}
+
+int64_t chpl_sync_prof_num_sites(void) {
+  int64_t i, n;
+
+  sync_prof_merge();
+
+  if (sync_prof_order == NULL) {
+    sync_prof_order = (chpl_sync_prof_site_t**)
+                      sync_prof_alloc(sync_prof_all.num_sites + 1,
+                                      sizeof(chpl_sync_prof_site_t*));
+    for (i = n = 0; i < sync_prof_all.num_slots; i++) {
+      if (sync_prof_all.sites[i].ops != 0)
+        sync_prof_order[n++] = &sync_prof_all.sites[i];
+    }
+  }
+  return sync_prof_all.num_sites;
+}
+
+// i must be less than what chpl_sync_prof_num_sites() returned, with
+// no sites added since.
+void chpl_sync_prof_get_site(int64_t i, chpl_sync_prof_site_t* site) {
+  *site = *sync_prof_order[i];
+}
+
+void chpl_sync_prof_add_site(chpl_sync_prof_site_t* site) {
+  chpl_sync_prof_site_t* s;
+
+  sync_prof_merge();
+  if (sync_prof_order != NULL) {
+    chpl_free(sync_prof_order);
+    sync_prof_order = NULL;
+  }
+  s = sync_prof_find(&sync_prof_all, site->kind, site->lineno,
+                     site->filename);
+  s->ops       += site->ops;
+  s->waits     += site->waits;
+  s->wait_ns   += site->wait_ns;
+  s->transfers += site->transfers;
+}
+
+static int sync_prof_cmp(const void* p1, const void* p2) {
+  const chpl_sync_prof_site_t* s1 = *(chpl_sync_prof_site_t* const*) p1;
+  const chpl_sync_prof_site_t* s2 = *(chpl_sync_prof_site_t* const*) p2;
+  if (s1->wait_ns != s2->wait_ns)
+    return (s1->wait_ns < s2->wait_ns) ? 1 : -1;
+  if (s1->waits != s2->waits)
+    return (s1->waits < s2->waits) ? 1 : -1;
+  if (s1->ops != s2->ops)
+    return (s1->ops < s2->ops) ? 1 : -1;
+  if (s1->filename != s2->filename)
+    return (s1->filename < s2->filename) ? -1 : 1;
+  if (s1->lineno != s2->lineno)
+    return (s1->lineno < s2->lineno) ? -1 : 1;
+  return s1->kind - s2->kind;
+}
+
+void chpl_sync_prof_report(void) {
+  chpl_sync_prof_site_t** order;
+  int64_t i, n;
+
+  sync_prof_merge();
+
+  // Sites from other locales may have been added since the order
+  // array was built, so build it again.
+  n = sync_prof_all.num_sites;
+  order = (chpl_sync_prof_site_t**)
+          sync_prof_alloc(n + 1, sizeof(chpl_sync_prof_site_t*));
+  for (i = n = 0; i < sync_prof_all.num_slots; i++) {
+    if (sync_prof_all.sites[i].ops != 0)
+      order[n++] = &sync_prof_all.sites[i];
+  }
+  qsort(order, n, sizeof(order[0]), sync_prof_cmp);
+
+  printf("Synchronization contention, %d locale(s), top %d of %lld site(s):\n",
+         (int) chpl_numNodes, sync_prof_top, (long long) n);
+  printf("%15s %12s %12s %12s %12s  %s\n",
+         "operation", "ops", "waits", "wait(s)", "transfers", "location");
+  for (i = 0; i < n && i < sync_prof_top; i++) {
+    chpl_sync_prof_site_t* s = order[i];
+    printf("%15s %12llu %12llu %12.6f %12llu  ",
+           sync_prof_kind_names[s->kind],
+           (unsigned long long) s->ops,
+           (unsigned long long) s->waits,
+           s->wait_ns / 1e9,
+           (unsigned long long) s->transfers);
+    if (s->lineno > 0)
+      printf("%s:%d\n", chpl_lookupFilename(s->filename), (int) s->lineno);
+    else
+      printf("<unknown>\n");
+  }
+  fflush(stdout);
+
+  chpl_free(order);
+}
@@ -0,0 +1,564 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+//
+// Built-in task profiler
+//
+// See chpl-task-profile.h for how to turn this on and what it writes.
+// Counts are kept per thread, in arrays indexed by task function, and
+// only summed at exit.  The times for a task are kept in its task
+// private data between its begin and end callbacks.  The extra work
+// done for sampled tasks (remembering when they were created, and
+// logging them for the timeline) is the only part that takes locks.
+//
+
+#include "chplrt.h"
+
+#include "chpl-comm.h"
+#include "chpl-linefile-support.h"
+#include "chpl-mem.h"
+#include "chpl-rt-lock.h"
+#include "chpl-task-profile.h"
+#include "chpl-tasks.h"
+#include "chpl-tasks-callbacks.h"
+#include "chpl-thread-local-storage.h"
+#include "chplcgfns.h"
+#include "chpltimers.h"
+#include "chpl-env.h"
+#include "error.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TASK_PROF_DEFAULT_SAMPLE 64
+#define TASK_PROF_QUEUE_SLOTS    4096   // must be a power of 2
+#define TASK_PROF_QUEUE_PROBES   16
+#define TASK_PROF_MAX_EVENTS     (1 << 20)
+
+typedef struct {
+  uint64_t spawns;
+  uint64_t begins;
+  uint64_t runs;
+  uint64_t timed_runs;          // sampled tasks, whose run time was taken
+  uint64_t run_ns;              // total run time of the timed runs
+  uint64_t blocks;
+  uint64_t block_ns;
+  uint64_t queue_samples;
+  uint64_t queue_ns;
+} task_prof_fn_t;
+
+typedef struct {
+  uint64_t id;
+  uint64_t begin_ns;
+  uint64_t end_ns;
+  uint64_t block_ns;
+  int32_t  fid_plus1;
+} task_prof_event_t;
+
+typedef struct task_prof_thread_s {
+  int index;
+  task_prof_fn_t* fns;          // task_prof_nfns + 1 entries
+  chpl_rt_lock_t events_lock;
+  task_prof_event_t* events;
+  size_t num_events;
+  size_t max_events;
+  struct task_prof_thread_s* next;
+} task_prof_thread_t;
+
+typedef struct {
+  uint64_t id_plus1;            // 0 for an empty slot
+  uint64_t create_ns;
+} task_prof_queue_slot_t;
+
+static int task_prof_enabled = 0;
+static int task_prof_written = 0;
+static const char* task_prof_base;
+static uint64_t task_prof_sample = TASK_PROF_DEFAULT_SAMPLE;
+static int task_prof_nfns;      // the last fns[] entry is for "other"
+static uint64_t task_prof_start_ns;
+static uint64_t task_prof_dropped_events;
+
+static chpl_rt_lock_t task_prof_threads_lock;
+static task_prof_thread_t* task_prof_threads;
+static int task_prof_num_threads;
+
+static chpl_rt_lock_t task_prof_queue_lock;
+static task_prof_queue_slot_t task_prof_queue[TASK_PROF_QUEUE_SLOTS];
+
+#ifdef CHPL_TLS
+static CHPL_TLS task_prof_thread_t* task_prof_my;
+#else
+// Without thread-local storage all threads share one set of counts,
+// and updates are done with this held.
+static chpl_rt_lock_t task_prof_shared_lock;
+#endif
+
+static task_prof_thread_t* task_prof_thread_new(void) {
+  task_prof_thread_t* tp;
+
+  tp = (task_prof_thread_t*) chpl_mem_allocManyZero(1, sizeof(*tp),
+                                                    CHPL_RT_MD_TASK_PROFILE,
+                                                    0, 0);
+  tp->fns = (task_prof_fn_t*) chpl_mem_allocManyZero(task_prof_nfns + 1,
+                                                     sizeof(task_prof_fn_t),
+                                                     CHPL_RT_MD_TASK_PROFILE,
+                                                     0, 0);
+  chpl_rt_lock_init(&tp->events_lock);
+
+  chpl_rt_lock(&task_prof_threads_lock);
+  tp->index = task_prof_num_threads++;
+  tp->next = task_prof_threads;
+  task_prof_threads = tp;
+  chpl_rt_unlock(&task_prof_threads_lock);
+
+  return tp;
+}
+
+static inline task_prof_thread_t* task_prof_acquire(void) {
+#ifdef CHPL_TLS
+  if (task_prof_my == NULL)
+    task_prof_my = task_prof_thread_new();
+  return task_prof_my;
+#else
+  chpl_rt_lock(&task_prof_shared_lock);
+  return (task_prof_threads != NULL) ? task_prof_threads
+                                     : task_prof_thread_new();
+#endif
+}
+
+static inline void task_prof_release(void) {
+#ifndef CHPL_TLS
+  chpl_rt_unlock(&task_prof_shared_lock);
+#endif
+}
+
+static inline int task_prof_fn_index(chpl_fn_int_t fid) {
+  return (fid >= 0 && fid < task_prof_nfns) ? fid : task_prof_nfns;
+}
+
+static inline int task_prof_is_sampled(uint64_t id) {
+  return id % task_prof_sample == 0;
+}
+
+//
+// Remember when sampled tasks were created, so their queue wait can be
+// measured when they begin.  If the table is too full the sample is
+// just dropped.
+//
+static void task_prof_queue_put(uint64_t id, uint64_t now) {
+  uint64_t h = (id / task_prof_sample) & (TASK_PROF_QUEUE_SLOTS - 1);
+  int i;
+
+  chpl_rt_lock(&task_prof_queue_lock);
+  for (i = 0; i < TASK_PROF_QUEUE_PROBES; i++) {
+    task_prof_queue_slot_t* slot =
+      &task_prof_queue[(h + i) & (TASK_PROF_QUEUE_SLOTS - 1)];
+    if (slot->id_plus1 == 0) {
+      slot->id_plus1 = id + 1;
+      slot->create_ns = now;
+      break;
+    }
+  }
+  chpl_rt_unlock(&task_prof_queue_lock);
+}
+
+static uint64_t task_prof_queue_take(uint64_t id) {
+  uint64_t h = (id / task_prof_sample) & (TASK_PROF_QUEUE_SLOTS - 1);
+  uint64_t create_ns = 0;
+  int i;
+
+  chpl_rt_lock(&task_prof_queue_lock);
+  for (i = 0; i < TASK_PROF_QUEUE_PROBES; i++) {
+    task_prof_queue_slot_t* slot =
+      &task_prof_queue[(h + i) & (TASK_PROF_QUEUE_SLOTS - 1)];
+    if (slot->id_plus1 == id + 1) {
+      create_ns = slot->create_ns;
+      slot->id_plus1 = 0;
+      break;
+    }
+  }
+  chpl_rt_unlock(&task_prof_queue_lock);
+
+  return create_ns;
+}
+
+//
+// The event array is grown with chpl_malloc() rather than
+// chpl_mem_realloc(), since with memory tracking on the latter takes a
+// sync lock, and we may be called while the task is waiting on one.
+// The new array is made without the events lock held; if another
+// thread filled the array while we did so, we go around again.
+//
+static void task_prof_log_event(task_prof_thread_t* tp,
+                                const task_prof_event_t* ev) {
+  task_prof_event_t* fresh = NULL;
+  size_t fresh_max = 0;
+
+  chpl_rt_lock(&tp->events_lock);
+  while (tp->num_events == tp->max_events) {
+    size_t new_max = (tp->max_events == 0) ? 1024 : 2 * tp->max_events;
+    task_prof_event_t* old;
+
+    if (new_max > TASK_PROF_MAX_EVENTS) {
+      task_prof_dropped_events++;
+      chpl_rt_unlock(&tp->events_lock);
+      chpl_free(fresh);
+      return;
+    }
+
+    if (fresh == NULL || fresh_max != new_max) {
+      chpl_rt_unlock(&tp->events_lock);
+      chpl_free(fresh);
+      fresh_max = new_max;
+      fresh = (task_prof_event_t*) chpl_malloc(fresh_max * sizeof(*fresh));
+      if (fresh == NULL)
+        chpl_internal_error("out of memory in the task profiler");
+      chpl_rt_lock(&tp->events_lock);
+      continue;
+    }
+
+    if (tp->num_events > 0)
+      memcpy(fresh, tp->events, tp->num_events * sizeof(*fresh));
+    old = tp->events;
+    tp->events = fresh;
+    tp->max_events = fresh_max;
+    fresh = old;
+  }
+  tp->events[tp->num_events++] = *ev;
+  chpl_rt_unlock(&tp->events_lock);
+
+  chpl_free(fresh);
+}
+
+static void task_prof_create(const chpl_task_cb_info_t* info) {
+  task_prof_thread_t* tp = task_prof_acquire();
+  tp->fns[task_prof_fn_index(info->iu.full.fid)].spawns++;
+  task_prof_release();
+
+  if (task_prof_is_sampled(info->iu.full.id))
+    task_prof_queue_put(info->iu.full.id, chpl_now_ns());
+}
+
+//
+// Each thread times the first task of each task function it runs and
+// every task_prof_sample'th one after that.  For the rest we just note
+// the task function, so that time blocked can be charged to it.  Queue
+// wait is sampled by task ID instead, since the creating thread has
+// to decide whether to remember the create time.
+//
+static void task_prof_begin(const chpl_task_cb_info_t* info) {
+  chpl_task_prof_taskPrvData_t* pd = &chpl_task_getPrvData()->prof_data;
+  int ix = task_prof_fn_index(info->iu.full.fid);
+  task_prof_thread_t* tp;
+  uint64_t now;
+
+  tp = task_prof_acquire();
+  pd->sampled = (tp->fns[ix].begins++ % task_prof_sample == 0);
+  task_prof_release();
+
+  pd->fid_plus1 = ix + 1;
+  pd->block_ns = 0;
+  if (!pd->sampled && !task_prof_is_sampled(info->iu.full.id))
+    return;
+
+  pd->begin_ns = now = chpl_now_ns();
+
+  if (task_prof_is_sampled(info->iu.full.id)) {
+    uint64_t create_ns = task_prof_queue_take(info->iu.full.id);
+    if (create_ns != 0 && create_ns <= now) {
+      tp = task_prof_acquire();
+      tp->fns[ix].queue_samples++;
+      tp->fns[ix].queue_ns += now - create_ns;
+      task_prof_release();
+    }
+  }
+}
+
+static void task_prof_end(const chpl_task_cb_info_t* info) {
+  chpl_task_prof_taskPrvData_t* pd = &chpl_task_getPrvData()->prof_data;
+  task_prof_thread_t* tp;
+  task_prof_fn_t* fn;
+  uint64_t now;
+
+  if (pd->fid_plus1 == 0)
+    return;
+
+  if (!pd->sampled) {
+    tp = task_prof_acquire();
+    tp->fns[pd->fid_plus1 - 1].runs++;
+    task_prof_release();
+    pd->fid_plus1 = 0;
+    return;
+  }
+
+  now = chpl_now_ns();
+  tp = task_prof_acquire();
+  fn = &tp->fns[pd->fid_plus1 - 1];
+  fn->runs++;
+  fn->timed_runs++;
+  fn->run_ns += now - pd->begin_ns;
+  task_prof_release();
+
+  {
+    task_prof_event_t ev;
+    ev.id = info->iu.full.id;
+    ev.begin_ns = pd->begin_ns;
+    ev.end_ns = now;
+    ev.block_ns = pd->block_ns;
+    ev.fid_plus1 = pd->fid_plus1;
+    task_prof_log_event(tp, &ev);
+  }
+
+  pd->fid_plus1 = 0;
+}
+
+static void task_prof_block(const chpl_task_cb_info_t* info) {
+  chpl_task_getPrvData()->prof_data.block_start_ns = chpl_now_ns();
+}
+
+static void task_prof_unblock(const chpl_task_cb_info_t* info) {
+  chpl_task_prof_taskPrvData_t* pd = &chpl_task_getPrvData()->prof_data;
+  uint64_t elapsed = chpl_now_ns() - pd->block_start_ns;
+  task_prof_thread_t* tp;
+  task_prof_fn_t* fn;
+
+  pd->block_ns += elapsed;
+
+  tp = task_prof_acquire();
+  fn = &tp->fns[(pd->fid_plus1 > 0) ? pd->fid_plus1 - 1 : task_prof_nfns];
+  fn->blocks++;
+  fn->block_ns += elapsed;
+  task_prof_release();
+}
+
+void chpl_task_prof_init(void) {
+  const char* s;
+
+  task_prof_base = chpl_get_rt_env("TASK_PROFILE", NULL);
+  if (task_prof_base == NULL || task_prof_base[0] == '\0')
+    return;
+
+  if ((s = chpl_get_rt_env("TASK_PROFILE_SAMPLE", NULL)) != NULL) {
+    long long n = atoll(s);
+    if (n < 1)
+      chpl_warning("CHPL_RT_TASK_PROFILE_SAMPLE must be at least 1; "
+                   "using the default", 0, 0);
+    else
+      task_prof_sample = (uint64_t) n;
+  }
+
+  for (task_prof_nfns = 0;
+       chpl_finfo[task_prof_nfns].name != NULL;
+       task_prof_nfns++)
+    ;
+
+  chpl_rt_lock_init(&task_prof_threads_lock);
+  chpl_rt_lock_init(&task_prof_queue_lock);
+#ifndef CHPL_TLS
+  chpl_rt_lock_init(&task_prof_shared_lock);
+#endif
+
+  task_prof_start_ns = chpl_now_ns();
+  task_prof_enabled = 1;
+
+  chpl_task_install_callback(chpl_task_cb_event_kind_create,
+                             chpl_task_cb_info_kind_full, task_prof_create);
+  chpl_task_install_callback(chpl_task_cb_event_kind_begin,
+                             chpl_task_cb_info_kind_full, task_prof_begin);
+  chpl_task_install_callback(chpl_task_cb_event_kind_end,
+                             chpl_task_cb_info_kind_full, task_prof_end);
+  chpl_task_install_callback(chpl_task_cb_event_kind_block,
+                             chpl_task_cb_info_kind_full, task_prof_block);
+  chpl_task_install_callback(chpl_task_cb_event_kind_unblock,
+                             chpl_task_cb_info_kind_full, task_prof_unblock);
+}
+
+static const char* task_prof_fn_name(int ix) {
+  return (ix < task_prof_nfns) ? chpl_finfo[ix].name : "<other>";
+}
+
+static void task_prof_json_string(FILE* f, const char* s) {
+  fputc('"', f);
+  for ( ; *s != '\0'; s++) {
+    if (*s == '"' || *s == '\\')
+      fprintf(f, "\\%c", *s);
+    else if ((unsigned char) *s < 0x20)
+      fprintf(f, "\\u%04x", (unsigned char) *s);
+    else
+      fputc(*s, f);
+  }
+  fputc('"', f);
+}
+
+static task_prof_fn_t* task_prof_sorted_fns;
+
+// Total run time of all the runs, estimated from the timed ones.
+static double task_prof_est_run_ns(const task_prof_fn_t* fn) {
+  if (fn->timed_runs == 0)
+    return 0.0;
+  return (double) fn->run_ns * fn->runs / fn->timed_runs;
+}
+
+static int task_prof_cmp_run_ns(const void* p1, const void* p2) {
+  const task_prof_fn_t* f1 = &task_prof_sorted_fns[*(const int*) p1];
+  const task_prof_fn_t* f2 = &task_prof_sorted_fns[*(const int*) p2];
+  double t1 = task_prof_est_run_ns(f1);
+  double t2 = task_prof_est_run_ns(f2);
+  if (t1 != t2)
+    return (t1 < t2) ? 1 : -1;
+  if (f1->spawns != f2->spawns)
+    return (f1->spawns < f2->spawns) ? 1 : -1;
+  return *(const int*) p1 - *(const int*) p2;
+}
+
+static void task_prof_write_flat(const char* fname, task_prof_fn_t* fns) {
+  FILE* f;
+  int* order;
+  int i, n;
+
+  if ((f = fopen(fname, "w")) == NULL) {
+    chpl_warning("cannot open task profile output file", 0, 0);
+    return;
+  }
+
+  order = (int*) chpl_mem_allocMany(task_prof_nfns + 1, sizeof(int),
+                                    CHPL_RT_MD_TASK_PROFILE, 0, 0);
+  for (i = n = 0; i <= task_prof_nfns; i++) {
+    if (fns[i].spawns != 0 || fns[i].runs != 0 || fns[i].blocks != 0)
+      order[n++] = i;
+  }
+  task_prof_sorted_fns = fns;
+  qsort(order, n, sizeof(int), task_prof_cmp_run_ns);
+
+  fprintf(f, "# Chapel task profile for locale %d of %d\n",
+          (int) chpl_nodeID, (int) chpl_numNodes);
+  fprintf(f, "# elapsed %.6f s, %d thread(s), run time and queue wait "
+          "sampled for 1 in %llu tasks\n",
+          (chpl_now_ns() - task_prof_start_ns) / 1e9,
+          task_prof_num_threads, (unsigned long long) task_prof_sample);
+  fprintf(f, "# %10s %10s %12s %12s %10s %12s %12s  %s\n",
+          "spawned", "ran", "run(s)", "avg-run(us)", "blocks", "blocked(s)",
+          "avg-wait(us)", "task function");
+
+  for (i = 0; i < n; i++) {
+    task_prof_fn_t* fn = &fns[order[i]];
+    fprintf(f, "  %10llu %10llu %12.6f %12.3f %10llu %12.6f %12.3f  %s",
+            (unsigned long long) fn->spawns,
+            (unsigned long long) fn->runs,
+            task_prof_est_run_ns(fn) / 1e9,
+            fn->timed_runs ? fn->run_ns / 1e3 / fn->timed_runs : 0.0,
+            (unsigned long long) fn->blocks,
+            fn->block_ns / 1e9,
+            fn->queue_samples ? fn->queue_ns / 1e3 / fn->queue_samples : 0.0,
+            task_prof_fn_name(order[i]));
+    if (order[i] < task_prof_nfns)
+      fprintf(f, " (%s:%d)",
+              chpl_lookupFilename(chpl_finfo[order[i]].fileno),
+              chpl_finfo[order[i]].lineno);
+    fprintf(f, "\n");
+  }
+
+  chpl_mem_free(order, 0, 0);
+  fclose(f);
+}
+
+static void task_prof_write_trace(const char* fname) {
+  FILE* f;
+  task_prof_thread_t* tp;
+  size_t i;
+  int first = 1;
+
+  if ((f = fopen(fname, "w")) == NULL) {
+    chpl_warning("cannot open task profile output file", 0, 0);
+    return;
+  }
+
+  fprintf(f, "{\"traceEvents\":[\n");
+  for (tp = task_prof_threads; tp != NULL; tp = tp->next) {
+    chpl_rt_lock(&tp->events_lock);
+    for (i = 0; i < tp->num_events; i++) {
+      task_prof_event_t* ev = &tp->events[i];
+      fprintf(f, "%s{\"name\":", first ? "" : ",\n");
+      task_prof_json_string(f, task_prof_fn_name(ev->fid_plus1 - 1));
+      fprintf(f, ",\"cat\":\"task\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+              "\"pid\":%d,\"tid\":%d,"
+              "\"args\":{\"id\":%llu,\"blocked_us\":%.3f}}",
+              (ev->begin_ns - task_prof_start_ns) / 1e3,
+              (ev->end_ns - ev->begin_ns) / 1e3,
+              (int) chpl_nodeID, tp->index,
+              (unsigned long long) ev->id,
+              ev->block_ns / 1e3);
+      first = 0;
+    }
+    chpl_rt_unlock(&tp->events_lock);
+  }
+  fprintf(f, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":"
+          "{\"sample\":%llu,\"dropped\":%llu}}\n",
+          (unsigned long long) task_prof_sample,
+          (unsigned long long) task_prof_dropped_events);
+
+  fclose(f);
+}
+
+void chpl_task_prof_exit(void) {
+  task_prof_fn_t* fns;
+  task_prof_thread_t* tp;
+  char* fname;
+  size_t fname_len;
+  int i;
+
+  if (!task_prof_enabled || task_prof_written)
+    return;
+  task_prof_written = 1;
+
+  fns = (task_prof_fn_t*) chpl_mem_allocManyZero(task_prof_nfns + 1,
+                                                 sizeof(task_prof_fn_t),
+                                                 CHPL_RT_MD_TASK_PROFILE,
+                                                 0, 0);
+  chpl_rt_lock(&task_prof_threads_lock);
+  for (tp = task_prof_threads; tp != NULL; tp = tp->next) {
+    for (i = 0; i <= task_prof_nfns; i++) {
+      fns[i].spawns        += tp->fns[i].spawns;
+      fns[i].begins        += tp->fns[i].begins;
+      fns[i].runs          += tp->fns[i].runs;
+      fns[i].timed_runs    += tp->fns[i].timed_runs;
+      fns[i].run_ns        += tp->fns[i].run_ns;
+      fns[i].blocks        += tp->fns[i].blocks;
+      fns[i].block_ns      += tp->fns[i].block_ns;
+      fns[i].queue_samples += tp->fns[i].queue_samples;
+      fns[i].queue_ns      += tp->fns[i].queue_ns;
+    }
+  }
+
+  fname_len = strlen(task_prof_base) + 32;
+  fname = (char*) chpl_mem_alloc(fname_len, CHPL_RT_MD_TASK_PROFILE, 0, 0);
+
+  snprintf(fname, fname_len, "%s-%d.txt", task_prof_base, (int) chpl_nodeID);
+  task_prof_write_flat(fname, fns);
+
+  snprintf(fname, fname_len, "%s-%d.json", task_prof_base, (int) chpl_nodeID);
+  task_prof_write_trace(fname);
+  chpl_rt_unlock(&task_prof_threads_lock);
+
+  chpl_mem_free(fname, 0, 0);
+  chpl_mem_free(fns, 0, 0);
+}
@@ -22,7 +22,11 @@
 //
 
 #include "chpl-visual-debug.h"
+#include "chpl-visual-debug-format.h"
 #include "chplrt.h"
+#include "chpl-rt-lock.h"
+#include "chpl-mem.h"
+#include "chpl-thread-local-storage.h"
 #include "chpl-comm.h"
 #include "chpl-tasks.h"
 #include "chpl-tasks-callbacks.h"
@@ -63,6 +67,7 @@ static void cb_comm_executeOn_fast(const chpl_comm_cb_info_t *info);
 
 int chpl_vdebug_fd = -1;
 int chpl_vdebug = 0;
+int chpl_vdebug_text = 0;
 
 int chpl_dprintf (int fd, const char * format, ...) {
   char buffer[2048]; 
@@ -81,6 +86,274 @@ int chpl_dprintf (int fd, const char * format, ...) {
   return -1;
 }
 
+// Binary records
+//
+// Unless the text format was asked for, events are logged as binary
+// records (see chpl-visual-debug-format.h).  Each thread appends its
+// records to its own buffer, which is written out with a single
+// write() when it fills up and when data collection stops.  A full
+// buffer is swapped out under the per-buffer lock and written after
+// the lock is released, so the lock is never held across a write().
+// The buffers are linked together so that chpl_vdebug_stop() can flush
+// the ones belonging to other threads; the per-buffer lock is only
+// ever contended then.  The data blocks are freed when they are
+// written; the (small) list entries stay for the threads to reuse.
+
+#define VDEBUG_BUF_SIZE (64*1024)
+
+typedef struct vdebug_buf_s {
+  chpl_rt_lock_t lock;
+  size_t len;
+  char* data;     // NULL until the thread next logs a record
+  struct vdebug_buf_s* next;
+} vdebug_buf_t;
+
+static chpl_rt_lock_t vdebug_bufs_lock;
+static vdebug_buf_t* vdebug_bufs;
+static int vdebug_bufs_inited = 0;
+
+#ifdef CHPL_TLS
+static CHPL_TLS vdebug_buf_t* vdebug_my_buf;
+#endif
+
+static vdebug_buf_t* vdebug_buf_new (void) {
+  vdebug_buf_t* buf;
+
+  buf = (vdebug_buf_t*) chpl_mem_alloc(sizeof(vdebug_buf_t),
+                                       CHPL_RT_MD_VDEBUG_BUFFER, 0, 0);
+  chpl_rt_lock_init(&buf->lock);
+  buf->len = 0;
+  buf->data = NULL;
+
+  chpl_rt_lock(&vdebug_bufs_lock);
+  buf->next = vdebug_bufs;
+  vdebug_bufs = buf;
+  chpl_rt_unlock(&vdebug_bufs_lock);
+
+  return buf;
+}
+
+// This thread's buffer, made on its first record.  If CHPL_TLS is not
+// available every thread logs into whichever buffer was made first.
+static vdebug_buf_t* vdebug_buf_mine (void) {
+#ifdef CHPL_TLS
+  if (vdebug_my_buf == NULL)
+    vdebug_my_buf = vdebug_buf_new();
+  return vdebug_my_buf;
+#else
+  vdebug_buf_t* buf;
+  chpl_rt_lock(&vdebug_bufs_lock);
+  buf = vdebug_bufs;
+  chpl_rt_unlock(&vdebug_bufs_lock);
+  return buf ? buf : vdebug_buf_new();
+#endif
+}
+
+// Take the data block out of the buffer; call with its lock held.
+static char* vdebug_buf_take (vdebug_buf_t* buf, size_t* len) {
+  char* data = buf->data;
+
+  *len = buf->len;
+  buf->data = NULL;
+  buf->len = 0;
+  return data;
+}
+
+// Write out (unless discard is set) and free a block taken from a buffer.
+static void vdebug_block_write (char* data, size_t len, int discard) {
+  size_t off = 0;
+
+  if (data == NULL)
+    return;
+  while (!discard && off < len && chpl_vdebug_fd >= 0) {
+    ssize_t wrv = write (chpl_vdebug_fd, data + off, len - off);
+    if (wrv < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    off += wrv;
+  }
+  chpl_mem_free(data, 0, 0);
+}
+
+// Flush (or with discard set, drop) the buffered records of all threads.
+static void vdebug_bufs_flush_all (int discard) {
+  vdebug_buf_t* buf;
+
+  // Buffers are only ever added at the head, so the list can be walked
+  // from a snapshot of the head without holding the list lock.
+  chpl_rt_lock(&vdebug_bufs_lock);
+  buf = vdebug_bufs;
+  chpl_rt_unlock(&vdebug_bufs_lock);
+
+  for ( ; buf != NULL; buf = buf->next) {
+    char* data;
+    size_t len;
+
+    chpl_rt_lock(&buf->lock);
+    data = vdebug_buf_take(buf, &len);
+    chpl_rt_unlock(&buf->lock);
+    vdebug_block_write(data, len, discard);
+  }
+}
+
+static inline int64_t vdebug_usec (struct timeval *tv) {
+  return (int64_t) tv->tv_sec * 1000000 + tv->tv_usec;
+}
+
+static inline void vdebug_rec_init (chpl_vdebug_rec_hdr_t *h, int kind,
+                                    size_t size, int nid) {
+  struct timeval tv;
+  (void) gettimeofday (&tv, NULL);
+  h->kind = kind;
+  h->size = size;
+  h->nid = nid;
+  h->time = vdebug_usec(&tv);
+}
+
+static void vdebug_put (const void *rec) {
+  size_t size = ((const chpl_vdebug_rec_hdr_t *) rec)->size;
+  vdebug_buf_t* buf;
+  char* full = NULL;
+  size_t full_len = 0;
+  char* fresh = NULL;
+
+  if (chpl_vdebug_fd < 0) return;
+
+  buf = vdebug_buf_mine();
+  for (;;) {
+    chpl_rt_lock(&buf->lock);
+    if (buf->data != NULL && buf->len + size > VDEBUG_BUF_SIZE)
+      full = vdebug_buf_take(buf, &full_len);
+    if (buf->data == NULL && fresh != NULL) {
+      buf->data = fresh;
+      fresh = NULL;
+    }
+    if (buf->data != NULL) {
+      memcpy(buf->data + buf->len, rec, size);
+      buf->len += size;
+      chpl_rt_unlock(&buf->lock);
+      break;
+    }
+    chpl_rt_unlock(&buf->lock);
+    // No block to log into; get one without holding the lock.
+    fresh = (char*) chpl_mem_alloc(VDEBUG_BUF_SIZE,
+                                   CHPL_RT_MD_VDEBUG_BUFFER, 0, 0);
+  }
+
+  if (fresh != NULL)
+    chpl_mem_free(fresh, 0, 0);
+  vdebug_block_write(full, full_len, 0);
+}
+
+static void vdebug_put_str (int kind, int index, int lineno, int fileno,
+                            const char *str) {
+  char rec[sizeof(chpl_vdebug_rec_str_t) + 1024];
+  chpl_vdebug_rec_str_t *sr = (chpl_vdebug_rec_str_t *) rec;
+  size_t len = strlen(str);
+  size_t size;
+
+  if (len > sizeof(rec) - sizeof(*sr) - 1)
+    len = sizeof(rec) - sizeof(*sr) - 1;
+  size = (sizeof(*sr) + len + 1 + 7) & ~(size_t) 7;
+
+  vdebug_rec_init(&sr->h, kind, size, chpl_nodeID);
+  sr->index = index;
+  sr->lineno = lineno;
+  sr->fileno = fileno;
+  sr->len = len;
+  memcpy(rec + sizeof(*sr), str, len);
+  memset(rec + sizeof(*sr) + len, 0, size - sizeof(*sr) - len);
+  vdebug_put(rec);
+}
+
+static void vdebug_put_tag (int kind, int tagno, chpl_taskID_t tid) {
+  chpl_vdebug_rec_tag_t rec;
+  struct rusage ru;
+
+  vdebug_rec_init(&rec.h, kind, sizeof(rec), chpl_nodeID);
+  if ( getrusage (RUSAGE_SELF, &ru) < 0) {
+    rec.utime = 0;
+    rec.stime = 0;
+  } else {
+    rec.utime = vdebug_usec(&ru.ru_utime);
+    rec.stime = vdebug_usec(&ru.ru_stime);
+  }
+  rec.tid = tid;
+  rec.tagno = tagno;
+  rec.pad = 0;
+  vdebug_put(&rec);
+}
+
+static void vdebug_put_tid (int kind, int nid, chpl_taskID_t tid) {
+  chpl_vdebug_rec_tid_t rec;
+
+  vdebug_rec_init(&rec.h, kind, sizeof(rec), nid);
+  rec.tid = tid;
+  vdebug_put(&rec);
+}
+
+static void vdebug_put_comm (int kind, const chpl_comm_cb_info_t *info) {
+  chpl_vdebug_rec_comm_t rec;
+  const struct chpl_comm_info_comm *cm = &info->iu.comm;
+
+  vdebug_rec_init(&rec.h, kind, sizeof(rec), info->localNodeID);
+  rec.tid = chpl_task_getId();
+  rec.addr = (uint64_t) (intptr_t) cm->addr;
+  rec.raddr = (uint64_t) (intptr_t) cm->raddr;
+  rec.elemsize = 1;
+  rec.len = cm->size;
+  rec.rid = info->remoteNodeID;
+  rec.typeIndex = cm->typeIndex;
+  rec.lineno = cm->lineno;
+  rec.fileno = cm->filename;
+  vdebug_put(&rec);
+}
+
+static void vdebug_put_comm_strd (int kind, const chpl_comm_cb_info_t *info) {
+  chpl_vdebug_rec_comm_t rec;
+  const struct chpl_comm_info_comm_strd *cm = &info->iu.comm_strd;
+
+  vdebug_rec_init(&rec.h, kind, sizeof(rec), info->localNodeID);
+  rec.tid = chpl_task_getId();
+  // Like the text records, addr is the local address.
+  if (kind == chpl_vdebug_rec_st_put) {
+    rec.addr = (uint64_t) (intptr_t) cm->srcaddr;
+    rec.raddr = (uint64_t) (intptr_t) cm->dstaddr;
+  } else {
+    rec.addr = (uint64_t) (intptr_t) cm->dstaddr;
+    rec.raddr = (uint64_t) (intptr_t) cm->srcaddr;
+  }
+  rec.elemsize = cm->elemSize;
+  // The number of elements moved, unlike the text record's length field.
+  rec.len = 1;
+  if (cm->count != NULL) {
+    int i;
+    for (i = 0; i <= cm->stridelevels; i++)
+      rec.len *= cm->count[i];
+  }
+  rec.rid = info->remoteNodeID;
+  rec.typeIndex = cm->typeIndex;
+  rec.lineno = cm->lineno;
+  rec.fileno = cm->filename;
+  vdebug_put(&rec);
+}
+
+static void vdebug_put_fork (int kind, const chpl_comm_cb_info_t *info) {
+  chpl_vdebug_rec_fork_t rec;
+  const struct chpl_comm_info_comm_executeOn *cm = &info->iu.executeOn;
+
+  vdebug_rec_init(&rec.h, kind, sizeof(rec), info->localNodeID);
+  rec.tid = chpl_task_getId();
+  rec.arg = (uint64_t) (intptr_t) cm->arg;
+  rec.arg_size = cm->arg_size;
+  rec.rid = info->remoteNodeID;
+  rec.subloc = cm->subloc;
+  rec.fid = cm->fid;
+  rec.pad = 0;
+  vdebug_put(&rec);
+}
+
 static int chpl_make_vdebug_file (const char *rootname) {
     char fname[MAXPATHLEN]; 
     struct stat sb;
@@ -114,12 +387,12 @@ static int chpl_make_vdebug_file (const char *rootname) {
 
 // Record>  ChplVdebug: ver # nid # tid # seq time.sec user.time system.time 
 //
-//  Ver # -- version number, currently 1.1
+//  Ver # -- version number, 1.2 for text and 1.3 for binary records
 //  nid # -- nodeID
 //  tid # -- taskID
 //  seq time.sec -- unique number for this run
 
-void chpl_vdebug_start (const char *fileroot, double now) {
+void chpl_vdebug_start (const char *fileroot, double now, int text) {
   const char * rootname;
   struct rusage ru;
   struct timeval tv;
@@ -133,6 +406,14 @@ void chpl_vdebug_start (const char *fileroot, double now) {
   // Close any open files.
   if (chpl_vdebug_fd >= 0)
     chpl_vdebug_stop ();
+
+  if (!vdebug_bufs_inited) {
+    chpl_rt_lock_init(&vdebug_bufs_lock);
+    vdebug_bufs_inited = 1;
+  }
+  // Drop anything logged by a callback that raced with the last stop.
+  vdebug_bufs_flush_all(1);
+  chpl_vdebug_text = text;
     
   // Initial call, open file and write initialization information
   
@@ -151,14 +432,38 @@ void chpl_vdebug_start (const char *fileroot, double now) {
     ru.ru_stime.tv_usec = 0;
   }
   chpl_dprintf (chpl_vdebug_fd,
-                "ChplVdebug: ver 1.2 nodes %d nid %d tid %d seq %.3lf %lld.%06ld %ld.%06ld %ld.%06ld \n",
+                "ChplVdebug: ver 1.%d nodes %d nid %d tid %d seq %.3lf %lld.%06ld %ld.%06ld %ld.%06ld \n",
+                text ? 2 : CHPL_VDEBUG_BINARY_VER_MINOR,
                 chpl_numNodes, chpl_nodeID, (int) startTask, now,
                 (long long) tv.tv_sec, (long) tv.tv_usec,
                 (long) ru.ru_utime.tv_sec, (long) ru.ru_utime.tv_usec,
                 (long) ru.ru_stime.tv_sec, (long) ru.ru_stime.tv_usec  );
 
   // Dump directory names, file names and function names
-  if (chpl_nodeID == 0) {
+  if (chpl_nodeID == 0 && !text) {
+    int ix;
+    int numFIDnames;
+
+    for (numFIDnames = 0; chpl_finfo[numFIDnames].name != NULL; numFIDnames++);
+    vdebug_put_str (chpl_vdebug_rec_home, 0, 0, 0, CHPL_HOME);
+    vdebug_put_str (chpl_vdebug_rec_dir, 0, 0, 0, chpl_compileDirectory);
+    vdebug_put_str (chpl_vdebug_rec_sizes, chpl_filenameTableSize,
+                    numFIDnames, 0, "");
+    for (ix = 0; ix < chpl_filenameTableSize ; ix++) {
+      if (chpl_filenameTable[ix][0] == 0) {
+        vdebug_put_str (chpl_vdebug_rec_fname, 0, 0, 0, "<unknown>");
+      } else if (chpl_filenameTable[ix][0] == '<' &&
+                 chpl_filenameTable[ix][1] == 'c') {
+        vdebug_put_str (chpl_vdebug_rec_fname, ix, 0, 0, "<command_line>");
+      } else {
+        vdebug_put_str (chpl_vdebug_rec_fname, ix, 0, 0,
+                        chpl_filenameTable[ix]);
+      }
+    }
+    for (ix = 0; ix < numFIDnames; ix++)
+      vdebug_put_str (chpl_vdebug_rec_fidname, ix, chpl_finfo[ix].lineno,
+                      chpl_finfo[ix].fileno, chpl_finfo[ix].name);
+  } else if (chpl_nodeID == 0) {
     int ix;
     int numFIDnames;
 
@@ -211,12 +516,18 @@ void chpl_vdebug_stop (void) {
       ru.ru_stime.tv_usec = 0;
     }
     // Generate the End record
-    chpl_dprintf (chpl_vdebug_fd, "End: %lld.%06ld %ld.%06ld %ld.%06ld %d %d\n",
-                  (long long) tv.tv_sec, (long) tv.tv_usec,
-                  (long) ru.ru_utime.tv_sec, (long) ru.ru_utime.tv_usec,
-                  (long) ru.ru_stime.tv_sec, (long) ru.ru_stime.tv_usec,
-                  chpl_nodeID, (int) stopTask);
+    if (chpl_vdebug_text) {
+      chpl_dprintf (chpl_vdebug_fd, "End: %lld.%06ld %ld.%06ld %ld.%06ld %d %d\n",
+                    (long long) tv.tv_sec, (long) tv.tv_usec,
+                    (long) ru.ru_utime.tv_sec, (long) ru.ru_utime.tv_usec,
+                    (long) ru.ru_stime.tv_sec, (long) ru.ru_stime.tv_usec,
+                    chpl_nodeID, (int) stopTask);
+    } else {
+      vdebug_put_tag (chpl_vdebug_rec_end, 0, stopTask);
+      vdebug_bufs_flush_all(0);
+    }
     close (chpl_vdebug_fd);
+    chpl_vdebug_fd = -1;
   }
 }
 
@@ -229,6 +540,10 @@ void chpl_vdebug_stop (void) {
 void chpl_vdebug_mark (void) {
   struct timeval tv;
   chpl_taskID_t tagTask = chpl_task_getId();
+  if (!chpl_vdebug_text) {
+    vdebug_put_tid (chpl_vdebug_rec_mark, chpl_nodeID, tagTask);
+    return;
+  }
   (void) gettimeofday (&tv, NULL);
   chpl_dprintf (chpl_vdebug_fd, "VdbMark: %lld.%06ld %d %lu\n",
                 (long long) tv.tv_sec, (long) tv.tv_usec, chpl_nodeID, (unsigned long)tagTask );
@@ -237,6 +552,10 @@ void chpl_vdebug_mark (void) {
 // Record>  tname: tag# tagname
 
 void chpl_vdebug_tagname (const char* tagname, int tagno) {
+  if (!chpl_vdebug_text) {
+    vdebug_put_str (chpl_vdebug_rec_tname, tagno, 0, 0, tagname);
+    return;
+  }
   chpl_dprintf (chpl_vdebug_fd, "tname: %d %s\n", tagno, tagname);
 }
 
@@ -248,6 +567,12 @@ void chpl_vdebug_tag (int tagno) {
   
   chpl_taskID_t tagTask = chpl_task_getId();
 
+  if (!chpl_vdebug_text) {
+    vdebug_put_tag (chpl_vdebug_rec_tag, tagno, tagTask);
+    chpl_vdebug = 1;
+    return;
+  }
+
   (void) gettimeofday (&tv, NULL);
   if ( getrusage (RUSAGE_SELF, &ru) < 0) {
     ru.ru_utime.tv_sec = 0;
@@ -270,7 +595,10 @@ void chpl_vdebug_pause (int tagno) {
   struct timeval tv;
   chpl_taskID_t pauseTask = chpl_task_getId();
 
-  if (chpl_vdebug_fd >=0 && chpl_vdebug == 1) {
+  if (chpl_vdebug_fd >=0 && chpl_vdebug == 1 && !chpl_vdebug_text) {
+    vdebug_put_tag (chpl_vdebug_rec_pause, tagno, pauseTask);
+    chpl_vdebug = 0;
+  } else if (chpl_vdebug_fd >=0 && chpl_vdebug == 1) {
     (void) gettimeofday (&tv, NULL);
     if ( getrusage (RUSAGE_SELF, &ru) < 0) {
       ru.ru_utime.tv_sec = 0;
@@ -298,6 +626,11 @@ void chpl_vdebug_pause (int tagno) {
 //
 
 void cb_comm_put_nb (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && !chpl_vdebug_text) {
+    vdebug_put_comm (chpl_vdebug_rec_nb_put, info);
+    return;
+  }
+
   if (chpl_vdebug) {
     struct timeval tv;
     const struct chpl_comm_info_comm *cm = &info->iu.comm;
@@ -318,6 +651,11 @@ void cb_comm_put_nb (const chpl_comm_cb_info_t *info) {
 // Note: dstNodeId is node requesting Get
 
 void cb_comm_get_nb (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && !chpl_vdebug_text) {
+    vdebug_put_comm (chpl_vdebug_rec_nb_get, info);
+    return;
+  }
+
   if (chpl_vdebug) {
     struct timeval tv;
     const struct chpl_comm_info_comm *cm = &info->iu.comm;
@@ -337,6 +675,11 @@ void cb_comm_get_nb (const chpl_comm_cb_info_t *info) {
 
 
 void cb_comm_put (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && !chpl_vdebug_text) {
+    vdebug_put_comm (chpl_vdebug_rec_put, info);
+    return;
+  }
+
   if (chpl_vdebug) {
     struct timeval tv;
     const struct chpl_comm_info_comm *cm = &info->iu.comm;
@@ -357,6 +700,11 @@ void cb_comm_put (const chpl_comm_cb_info_t *info) {
 // Note:  dstNodeId is for the node making the request
 
 void cb_comm_get (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && !chpl_vdebug_text) {
+    vdebug_put_comm (chpl_vdebug_rec_get, info);
+    return;
+  }
+
   if (chpl_vdebug) {
     struct timeval tv;
     const struct chpl_comm_info_comm *cm = &info->iu.comm;
@@ -375,6 +723,11 @@ void cb_comm_get (const chpl_comm_cb_info_t *info) {
 //                  typeIndex length lineNumber fileName
 
 void cb_comm_put_strd (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && !chpl_vdebug_text) {
+    vdebug_put_comm_strd (chpl_vdebug_rec_st_put, info);
+    return;
+  }
+
     if (chpl_vdebug) {
     struct timeval tv;
     const struct chpl_comm_info_comm_strd *cm = &info->iu.comm_strd;
@@ -397,6 +750,11 @@ void cb_comm_put_strd (const chpl_comm_cb_info_t *info) {
 // Note:  dstNode is node making request for get
 
 void cb_comm_get_strd (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && !chpl_vdebug_text) {
+    vdebug_put_comm_strd (chpl_vdebug_rec_st_get, info);
+    return;
+  }
+
   if (chpl_vdebug) {
     struct timeval tv;
     const struct chpl_comm_info_comm_strd *cm = &info->iu.comm_strd;
@@ -417,6 +775,11 @@ void cb_comm_get_strd (const chpl_comm_cb_info_t *info) {
 void cb_comm_executeOn (const chpl_comm_cb_info_t *info) {
 
   // Visual Debug Support
+  if (chpl_vdebug && !chpl_vdebug_text) {
+    vdebug_put_fork (chpl_vdebug_rec_fork, info);
+    return;
+  }
+
   if (chpl_vdebug) {
     const struct chpl_comm_info_comm_executeOn *cm = &info->iu.executeOn;
     chpl_taskID_t executeOnTask = chpl_task_getId();
@@ -434,6 +797,11 @@ void cb_comm_executeOn (const chpl_comm_cb_info_t *info) {
 
 
 void  cb_comm_executeOn_nb (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && !chpl_vdebug_text) {
+    vdebug_put_fork (chpl_vdebug_rec_fork_nb, info);
+    return;
+  }
+
   if (chpl_vdebug) {
     const struct chpl_comm_info_comm_executeOn *cm = &info->iu.executeOn;
     chpl_taskID_t executeOnTask = chpl_task_getId();
@@ -449,6 +817,11 @@ void  cb_comm_executeOn_nb (const chpl_comm_cb_info_t *info) {
 // Record>  f_fork: time.sec nodeId forkNodeId subLoc funcId arg argSize forkTaskId
 
 void cb_comm_executeOn_fast (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug && !chpl_vdebug_text) {
+    vdebug_put_fork (chpl_vdebug_rec_fork_fast, info);
+    return;
+  }
+
   if (chpl_vdebug) {
     const struct chpl_comm_info_comm_executeOn *cm = &info->iu.executeOn;
     chpl_taskID_t executeOnTask = chpl_task_getId();
@@ -568,6 +941,18 @@ void cb_task_create (const chpl_task_cb_info_t *info) {
     //printf ("taskCB: event: %d, node %d proc %s task id: %llu, new task id: %llu\n",
     //         (int)info->event_kind, (int)info->nodeID,
     //        (info->iu.full.is_executeOn ? "O" : "L"), taskId, info->iu.full.id);
+    if (!chpl_vdebug_text) {
+      chpl_vdebug_rec_task_t rec;
+      vdebug_rec_init(&rec.h, chpl_vdebug_rec_task, sizeof(rec), info->nodeID);
+      rec.tid = info->iu.full.id;
+      rec.parent = taskId;
+      rec.lineno = info->iu.full.lineno;
+      rec.fileno = info->iu.full.filename;
+      rec.fid = info->iu.full.fid;
+      rec.is_on = info->iu.full.is_executeOn;
+      vdebug_put(&rec);
+      return;
+    }
     (void)gettimeofday(&tv, NULL);
     chpl_dprintf (chpl_vdebug_fd, "task: %lld.%06ld %lld %ld %lu %s %ld %d %d\n",
                   (long long) tv.tv_sec, (long) tv.tv_usec,
@@ -586,6 +971,10 @@ void cb_task_begin (const chpl_task_cb_info_t *info) {
   struct timeval tv;
   if (!chpl_vdebug) return;
   if (chpl_vdebug_fd >= 0) {
+    if (!chpl_vdebug_text) {
+      vdebug_put_tid (chpl_vdebug_rec_btask, info->nodeID, info->iu.full.id);
+      return;
+    }
     (void)gettimeofday(&tv, NULL);
     chpl_dprintf (chpl_vdebug_fd, "Btask: %lld.%06ld %lld %lu\n",
                   (long long) tv.tv_sec, (long) tv.tv_usec,
@@ -600,6 +989,10 @@ void cb_task_end (const chpl_task_cb_info_t *info) {
   struct timeval tv;
   if (!chpl_vdebug) return;
   if (chpl_vdebug_fd >= 0) {
+    if (!chpl_vdebug_text) {
+      vdebug_put_tid (chpl_vdebug_rec_etask, info->nodeID, info->iu.id_only.id);
+      return;
+    }
     (void)gettimeofday(&tv, NULL);
     chpl_dprintf (chpl_vdebug_fd, "Etask: %lld.%06ld %lld %lu\n",
                   (long long) tv.tv_sec, (long) tv.tv_usec,
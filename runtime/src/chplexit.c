@@ -21,10 +21,14 @@
 
 #include "chpl_rt_utils_static.h"
 #include "chpl-comm.h"
+#include "chpl-comm-trace.h"
 #include "chplexit.h"
 #include "chpl-mem.h"
+#include "chpl-stack-profile.h"
+#include "chpl-task-profile.h"
 #include "chplmemtrack.h"
 #include "gdb.h"
+#include "qbuffer.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -37,9 +41,13 @@ static void chpl_exit_common(int status, int all) {
   if (status != 0) {
     gdbShouldBreakHere();
   }
+  chpl_task_prof_exit();
+  chpl_stack_prof_exit();
+  chpl_comm_trace_exit();
   chpl_comm_pre_task_exit(all);
   if (all) {
     chpl_task_exit();
+    qbytes_iobuf_pool_exit();
     chpl_reportMemInfo();
   }
   chpl_mem_exit();
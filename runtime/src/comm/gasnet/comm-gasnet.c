@@ -26,6 +26,7 @@
 #include "chpl-comm.h"
 #include "chpl-comm-callbacks.h"
 #include "chpl-comm-callbacks-internal.h"
+#include "chpl-comm-diags.h"
 #include "chpl-mem.h"
 #include "chplsys.h"
 #include "chpl-tasks.h"
@@ -48,8 +49,6 @@
 #include <assert.h>
 #include <time.h>
 
-static chpl_sync_aux_t chpl_comm_diagnostics_sync;
-static chpl_commDiagnostics chpl_comm_commDiagnostics;
 static int chpl_comm_no_debug_private = 0;
 static gasnet_seginfo_t* seginfo_table = NULL;
 
@@ -626,11 +625,8 @@ chpl_comm_nb_handle_t chpl_comm_put_nb(void *addr, c_nodeid_t node, void* raddr,
 
   ret = gasnet_put_nb_bulk(node, raddr, addr, size);
 
-  if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-    chpl_sync_lock(&chpl_comm_diagnostics_sync);
-    chpl_comm_commDiagnostics.put_nb++;
-    chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-  }
+  if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+    (void) chpl_comm_diags_count(chpl_comm_diags_put_nb, node, size);
 
   return (chpl_comm_nb_handle_t) ret;
 }
@@ -664,11 +660,8 @@ chpl_comm_nb_handle_t chpl_comm_get_nb(void* addr, c_nodeid_t node, void* raddr,
 
   ret = gasnet_get_nb_bulk(addr, node, raddr, size);
 
-  if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-    chpl_sync_lock(&chpl_comm_diagnostics_sync);
-    chpl_comm_commDiagnostics.get_nb++;
-    chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-  }
+  if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+    (void) chpl_comm_diags_count(chpl_comm_diags_get_nb, node, size);
 
   return (chpl_comm_nb_handle_t) ret;
 }
@@ -888,15 +881,11 @@ void chpl_comm_post_task_init(void) {
     sched_yield();
   }
 
-  // clear diags
-  memset(&chpl_comm_commDiagnostics, 0, sizeof(chpl_commDiagnostics));
-
   // Initialize the caching layer, if it is active.
   chpl_cache_init();
 }
 
 void chpl_comm_rollcall(void) {
-  chpl_sync_initAux(&chpl_comm_diagnostics_sync);
   chpl_msg(2, "executing on node %d of %d node(s): %s\n", chpl_nodeID, 
            chpl_numNodes, chpl_nodeName());
 }
@@ -1085,6 +1074,7 @@ void  chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
                     size_t size, int32_t typeIndex,
                     int ln, int32_t fn) {
   int remote_in_segment;
+  uint64_t diags_t0 = 0;
 
   if (chpl_nodeID == node) {
     memmove(raddr, addr, size);
@@ -1100,11 +1090,8 @@ void  chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
     if (chpl_verbose_comm && !chpl_comm_no_debug_private)
       printf("%d: %s:%d: remote put to %d\n", chpl_nodeID,
              chpl_lookupFilename(fn), ln, node);
-    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-      chpl_sync_lock(&chpl_comm_diagnostics_sync);
-      chpl_comm_commDiagnostics.put++;
-      chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-    }
+    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+      diags_t0 = chpl_comm_diags_count(chpl_comm_diags_put, node, size);
 
     // Handle remote address not in remote segment.
 #ifdef GASNET_SEGMENT_EVERYTHING
@@ -1157,6 +1144,9 @@ void  chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
         wait_done_obj(&done);
       }
     }
+
+    if (diags_t0 != 0)
+      chpl_comm_diags_latency(chpl_comm_diags_put, diags_t0);
   }
 }
 
@@ -1167,6 +1157,7 @@ void  chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
                     size_t size, int32_t typeIndex,
                     int ln, int32_t fn) {
   int remote_in_segment;
+  uint64_t diags_t0 = 0;
 
   if (chpl_nodeID == node) {
     memmove(addr, raddr, size);
@@ -1182,11 +1173,8 @@ void  chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
     if (chpl_verbose_comm && !chpl_comm_no_debug_private)
       printf("%d: %s:%d: remote get from %d\n", chpl_nodeID,
              chpl_lookupFilename(fn), ln, node);
-    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-      chpl_sync_lock(&chpl_comm_diagnostics_sync);
-      chpl_comm_commDiagnostics.get++;
-      chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-    }
+    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+      diags_t0 = chpl_comm_diags_count(chpl_comm_diags_get, node, size);
 
     // Handle remote address not in remote segment.
 
@@ -1284,6 +1272,9 @@ void  chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
         chpl_mem_free(local_buf, 0, 0);
       }
     }
+
+    if (diags_t0 != 0)
+      chpl_comm_diags_latency(chpl_comm_diags_get, diags_t0);
   }
 }
 
@@ -1299,6 +1290,7 @@ void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode_i
   int i;
   const size_t strlvls = (size_t)stridelevels;
   const gasnet_node_t srcnode = (gasnet_node_t)srcnode_id;
+  uint64_t diags_t0 = 0;
 
   size_t dststr[strlvls];
   size_t srcstr[strlvls];
@@ -1349,13 +1341,16 @@ void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode_i
     printf("%d: %s:%d: remote get from %d\n", chpl_nodeID,
            chpl_lookupFilename(fn), ln, srcnode);
   if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-    chpl_sync_lock(&chpl_comm_diagnostics_sync);
-    chpl_comm_commDiagnostics.get++;
-    chpl_sync_unlock(&chpl_comm_diagnostics_sync);
+    size_t bytes = cnt[0];
+    for (i=1; i<=strlvls; i++) bytes *= cnt[i];
+    diags_t0 = chpl_comm_diags_count(chpl_comm_diags_get, srcnode_id, bytes);
   }
 
   // TODO -- handle strided get for non-registered memory
   gasnet_gets_bulk(dstaddr, dststr, srcnode, srcaddr, srcstr, cnt, strlvls); 
+
+  if (diags_t0 != 0)
+    chpl_comm_diags_latency(chpl_comm_diags_get, diags_t0);
 }
 
 // See the comment for chpl_comm_gets().
@@ -1366,6 +1361,7 @@ void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_i
   int i;
   const size_t strlvls = (size_t)stridelevels;
   const gasnet_node_t dstnode = (gasnet_node_t)dstnode_id;
+  uint64_t diags_t0 = 0;
 
   size_t dststr[strlvls];
   size_t srcstr[strlvls];
@@ -1414,12 +1410,15 @@ void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_i
     printf("%d: %s:%d: remote get from %d\n", chpl_nodeID,
            chpl_lookupFilename(fn), ln, dstnode);
   if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-    chpl_sync_lock(&chpl_comm_diagnostics_sync);
-    chpl_comm_commDiagnostics.put++;
-    chpl_sync_unlock(&chpl_comm_diagnostics_sync);
+    size_t bytes = cnt[0];
+    for (i=1; i<=strlvls; i++) bytes *= cnt[i];
+    diags_t0 = chpl_comm_diags_count(chpl_comm_diags_put, dstnode_id, bytes);
   }
   // TODO -- handle strided put for non-registered memory
   gasnet_puts_bulk(dstnode, dstaddr, dststr, srcaddr, srcstr, cnt, strlvls); 
+
+  if (diags_t0 != 0)
+    chpl_comm_diags_latency(chpl_comm_diags_put, diags_t0);
 }
 
 static inline
@@ -1541,6 +1540,7 @@ void  chpl_comm_execute_on(c_nodeid_t node, c_sublocid_t subloc,
                      chpl_fn_int_t fid,
                      chpl_comm_on_bundle_t *arg, size_t arg_size) {
   done_t  done;
+  uint64_t diags_t0 = 0;
 
   if (chpl_nodeID == node) {
     assert(0);
@@ -1556,14 +1556,15 @@ void  chpl_comm_execute_on(c_nodeid_t node, c_sublocid_t subloc,
 
     if (chpl_verbose_comm && !chpl_comm_no_debug_private)
       printf("%d: remote task created on %d\n", chpl_nodeID, node);
-    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-      chpl_sync_lock(&chpl_comm_diagnostics_sync);
-      chpl_comm_commDiagnostics.execute_on++;
-      chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-    }
+    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+      diags_t0 = chpl_comm_diags_count(chpl_comm_diags_execute_on, node,
+                                       arg_size);
 
     execute_on_common(node, subloc, fid, arg, arg_size,
                      /*fast*/ false, /*blocking*/ true);
+
+    if (diags_t0 != 0)
+      chpl_comm_diags_latency(chpl_comm_diags_execute_on, diags_t0);
   }
 }
 
@@ -1594,11 +1595,9 @@ void  chpl_comm_execute_on_nb(c_nodeid_t node, c_sublocid_t subloc,
 
     if (chpl_verbose_comm && !chpl_comm_no_debug_private)
       printf("%d: remote non-blocking task created on %d\n", chpl_nodeID, node);
-    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-      chpl_sync_lock(&chpl_comm_diagnostics_sync);
-      chpl_comm_commDiagnostics.execute_on_nb++;
-      chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-    }
+    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+      (void) chpl_comm_diags_count(chpl_comm_diags_execute_on_nb, node,
+                                   arg_size);
   
     execute_on_common(node, subloc, fid, arg, arg_size,
                       /*fast*/ false, /*blocking*/ false);
@@ -1610,6 +1609,7 @@ void  chpl_comm_execute_on_fast(c_nodeid_t node, c_sublocid_t subloc,
                           chpl_fn_int_t fid,
                           chpl_comm_on_bundle_t *arg, size_t arg_size) {
   done_t  done;
+  uint64_t diags_t0 = 0;
 
   if (chpl_nodeID == node) {
     assert(0);
@@ -1626,14 +1626,15 @@ void  chpl_comm_execute_on_fast(c_nodeid_t node, c_sublocid_t subloc,
     if (chpl_verbose_comm && !chpl_comm_no_debug_private)
       printf("%d: remote (no-fork) task created on %d\n",
              chpl_nodeID, node);
-    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private) {
-      chpl_sync_lock(&chpl_comm_diagnostics_sync);
-      chpl_comm_commDiagnostics.execute_on_fast++;
-      chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-    }
+    if (chpl_comm_diagnostics && !chpl_comm_no_debug_private)
+      diags_t0 = chpl_comm_diags_count(chpl_comm_diags_execute_on_fast, node,
+                                       arg_size);
 
   execute_on_common(node, subloc, fid, arg, arg_size,
                     /*fast*/ true, /*blocking*/ true);
+
+    if (diags_t0 != 0)
+      chpl_comm_diags_latency(chpl_comm_diags_execute_on_fast, diags_t0);
   }
 }
 
@@ -1691,18 +1692,6 @@ void chpl_stopCommDiagnosticsHere() {
   chpl_comm_diagnostics = 0;
 }
 
-void chpl_resetCommDiagnosticsHere() {
-  chpl_sync_lock(&chpl_comm_diagnostics_sync);
-  memset(&chpl_comm_commDiagnostics, 0, sizeof(chpl_commDiagnostics));
-  chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-}
-
-void chpl_getCommDiagnosticsHere(chpl_commDiagnostics *cd) {
-  chpl_sync_lock(&chpl_comm_diagnostics_sync);
-  chpl_memcpy(cd, &chpl_comm_commDiagnostics, sizeof(chpl_commDiagnostics));
-  chpl_sync_unlock(&chpl_comm_diagnostics_sync);
-}
-
 void chpl_comm_gasnet_help_register_global_var(int i, wide_ptr_t wide_addr) {
   if (chpl_nodeID == 0) {
     ((wide_ptr_t*)seginfo_table[0].addr)[i] = wide_addr;
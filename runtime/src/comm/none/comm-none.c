@@ -513,13 +513,8 @@ void chpl_stopVerboseComm() { }
 void chpl_startVerboseCommHere() { }
 void chpl_stopVerboseCommHere() { }
 
-void chpl_startCommDiagnostics() { }
-void chpl_stopCommDiagnostics() { }
-void chpl_startCommDiagnosticsHere() { }
-void chpl_stopCommDiagnosticsHere() { }
-
-void chpl_resetCommDiagnosticsHere() { }
-void chpl_getCommDiagnosticsHere(chpl_commDiagnostics *cd) {
-  memset(cd, 0, sizeof(chpl_commDiagnostics));
-}
+void chpl_startCommDiagnostics() { chpl_comm_diagnostics = 1; }
+void chpl_stopCommDiagnostics() { chpl_comm_diagnostics = 0; }
+void chpl_startCommDiagnosticsHere() { chpl_comm_diagnostics = 1; }
+void chpl_stopCommDiagnosticsHere() { chpl_comm_diagnostics = 0; }
 
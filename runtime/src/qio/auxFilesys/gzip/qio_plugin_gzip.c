@@ -0,0 +1,626 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#endif
+
+#include "qio_plugin_gzip.h"
+#include <pthread.h>
+#include <zlib.h>
+
+// how much compressed data to read or write at a time
+#define GZIP_CHUNK (64*1024)
+
+// windowBits for deflateInit2 to write a gzip header and trailer
+#define GZIP_WRITE_WBITS (15+16)
+// windowBits for inflateInit2 to accept a gzip or zlib header
+#define GZIP_READ_WBITS (15+32)
+
+// One independently compressed piece of the output when compressing
+// with more than one thread.
+typedef struct gzip_block {
+  unsigned char* in;
+  size_t in_len;
+  unsigned char* out;
+  size_t out_len;
+  size_t out_cap;
+  int level;
+  int zret;
+} gzip_block;
+
+struct gzip_file;
+
+typedef struct gzip_worker {
+  struct gzip_file* fl;
+  int idx;                  // compresses blocks[idx]
+  pthread_t thread;
+} gzip_worker;
+
+// Threads that compress blocks[1..] for as long as the file is open,
+// started once by chpl_gzip_open rather than on every flush.  Each
+// flush starts a new round, and the flushing thread compresses
+// blocks[0] itself.
+typedef struct gzip_pool {
+  pthread_mutex_t lock;
+  pthread_cond_t work_cv;   // a new round has started, or shutdown
+  pthread_cond_t done_cv;   // pending reached 0
+  uint64_t round;
+  int nblocks;              // blocks in this round
+  int pending;              // workers still compressing this round
+  int shutdown;
+  int nworkers;             // workers[0..nworkers-1] were started
+  gzip_worker* workers;
+} gzip_pool;
+
+struct gzip_file {
+  qio_file_t* underlying;
+  qio_channel_t* ch;        // channel on underlying
+  int writing;
+  int level;
+  int nthreads;
+  size_t block_size;
+
+  // streaming state, used for reading and for single-threaded writing
+  z_stream z;
+  int z_inited;
+  unsigned char* buf;       // compressed data buffer (GZIP_CHUNK bytes)
+  int underlying_eof;       // reading: nothing more to read from ch
+  int stream_end;           // reading: at end of the last gzip member
+
+  // block state, used for multi-threaded writing
+  gzip_block* blocks;       // nthreads blocks
+  gzip_pool* pool;
+  int nfull;                // blocks[0..nfull-1] are full
+  int wrote_any;            // have we written a gzip member yet?
+};
+
+#define to_gzip_file(f) ((gzip_file*)f)
+
+static
+qioerr gzip_zerr(int zret)
+{
+  switch (zret) {
+    case Z_OK:
+    case Z_STREAM_END:
+      return 0;
+    case Z_MEM_ERROR:
+      return QIO_ENOMEM;
+    case Z_DATA_ERROR:
+      QIO_RETURN_CONSTANT_ERROR(EFORMAT, "corrupt gzip data");
+    case Z_BUF_ERROR:
+      QIO_RETURN_CONSTANT_ERROR(EFORMAT, "truncated gzip data");
+    default:
+      QIO_RETURN_CONSTANT_ERROR(EINVAL, "zlib error");
+  }
+}
+
+static
+qioerr gzip_write_out(gzip_file* fl, const void* ptr, size_t len)
+{
+  if( len == 0 ) return 0;
+  return qio_channel_write_amt(false, fl->ch, ptr, len);
+}
+
+/*********** single-threaded (streaming) compression ***********/
+
+static
+qioerr gzip_deflate_stream(gzip_file* fl, int flush)
+{
+  qioerr err = 0;
+  int zret;
+
+  do {
+    fl->z.next_out = fl->buf;
+    fl->z.avail_out = GZIP_CHUNK;
+    zret = deflate(&fl->z, flush);
+    if( zret == Z_STREAM_ERROR ) return gzip_zerr(zret);
+    err = gzip_write_out(fl, fl->buf, GZIP_CHUNK - fl->z.avail_out);
+    if( err ) return err;
+  } while( fl->z.avail_out == 0 );
+
+  return 0;
+}
+
+/*********** multi-threaded (block) compression ***********/
+
+// The most a block of in_len bytes can compress to, including the gzip
+// header and trailer, as deflateBound() computes it for a stream set up
+// the way gzip_compress_block sets one up.
+static
+qioerr gzip_block_bound(int level, size_t in_len, size_t* bound_out)
+{
+  z_stream z;
+  int zret;
+
+  memset(&z, 0, sizeof(z_stream));
+  zret = deflateInit2(&z, level, Z_DEFLATED, GZIP_WRITE_WBITS, 8,
+                      Z_DEFAULT_STRATEGY);
+  if( zret != Z_OK ) return gzip_zerr(zret);
+
+  *bound_out = deflateBound(&z, in_len);
+  deflateEnd(&z);
+
+  return 0;
+}
+
+static
+void* gzip_compress_block(void* arg)
+{
+  gzip_block* b = (gzip_block*) arg;
+  z_stream z;
+  int zret;
+
+  memset(&z, 0, sizeof(z_stream));
+  zret = deflateInit2(&z, b->level, Z_DEFLATED, GZIP_WRITE_WBITS, 8,
+                      Z_DEFAULT_STRATEGY);
+  if( zret != Z_OK ) {
+    b->zret = zret;
+    return NULL;
+  }
+
+  z.next_in = b->in;
+  z.avail_in = b->in_len;
+  z.next_out = b->out;
+  z.avail_out = b->out_cap;
+  // out_cap is gzip_block_bound(), so this finishes in one call
+  zret = deflate(&z, Z_FINISH);
+  b->out_len = b->out_cap - z.avail_out;
+  b->zret = (zret == Z_STREAM_END) ? Z_OK : zret;
+  deflateEnd(&z);
+
+  return NULL;
+}
+
+static
+void* gzip_worker_main(void* arg)
+{
+  gzip_worker* w = (gzip_worker*) arg;
+  gzip_pool* pool = w->fl->pool;
+  uint64_t seen = 0;
+
+  pthread_mutex_lock(&pool->lock);
+  while( 1 ) {
+    while( ! pool->shutdown && pool->round == seen )
+      pthread_cond_wait(&pool->work_cv, &pool->lock);
+    if( pool->shutdown ) break;
+    seen = pool->round;
+    if( w->idx < pool->nblocks ) {
+      pthread_mutex_unlock(&pool->lock);
+      gzip_compress_block(&w->fl->blocks[w->idx]);
+      pthread_mutex_lock(&pool->lock);
+      if( --pool->pending == 0 ) pthread_cond_signal(&pool->done_cv);
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  return NULL;
+}
+
+static
+qioerr gzip_pool_start(gzip_file* fl)
+{
+  gzip_pool* pool;
+  int i;
+
+  pool = (gzip_pool*) qio_calloc(1, sizeof(gzip_pool));
+  if( ! pool ) return QIO_ENOMEM;
+  pool->workers = (gzip_worker*) qio_calloc(fl->nthreads - 1,
+                                            sizeof(gzip_worker));
+  if( ! pool->workers ) {
+    qio_free(pool);
+    return QIO_ENOMEM;
+  }
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->work_cv, NULL);
+  pthread_cond_init(&pool->done_cv, NULL);
+  fl->pool = pool;
+
+  // If a thread can't be started, gzip_flush_blocks compresses the
+  // blocks it would have handled itself.
+  for( i = 0; i < fl->nthreads - 1; i++ ) {
+    gzip_worker* w = &pool->workers[i];
+    w->fl = fl;
+    w->idx = i + 1;
+    if( pthread_create(&w->thread, NULL, gzip_worker_main, w) != 0 ) break;
+    pool->nworkers++;
+  }
+
+  return 0;
+}
+
+static
+void gzip_pool_stop(gzip_file* fl)
+{
+  gzip_pool* pool = fl->pool;
+  int i;
+
+  pthread_mutex_lock(&pool->lock);
+  pool->shutdown = 1;
+  pthread_cond_broadcast(&pool->work_cv);
+  pthread_mutex_unlock(&pool->lock);
+
+  for( i = 0; i < pool->nworkers; i++ )
+    pthread_join(pool->workers[i].thread, NULL);
+
+  pthread_cond_destroy(&pool->done_cv);
+  pthread_cond_destroy(&pool->work_cv);
+  pthread_mutex_destroy(&pool->lock);
+  qio_free(pool->workers);
+  qio_free(pool);
+  fl->pool = NULL;
+}
+
+// Compress blocks[0..n-1] in parallel and write them out in order.
+static
+qioerr gzip_flush_blocks(gzip_file* fl, int n)
+{
+  gzip_pool* pool = fl->pool;
+  int nstarted = (n - 1 < pool->nworkers) ? n - 1 : pool->nworkers;
+  qioerr err = 0;
+  int i;
+
+  if( nstarted > 0 ) {
+    pthread_mutex_lock(&pool->lock);
+    pool->nblocks = n;
+    pool->pending = nstarted;
+    pool->round++;
+    pthread_cond_broadcast(&pool->work_cv);
+    pthread_mutex_unlock(&pool->lock);
+  }
+
+  gzip_compress_block(&fl->blocks[0]);
+  for( i = nstarted + 1; i < n; i++ )
+    gzip_compress_block(&fl->blocks[i]);
+
+  if( nstarted > 0 ) {
+    pthread_mutex_lock(&pool->lock);
+    while( pool->pending > 0 )
+      pthread_cond_wait(&pool->done_cv, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+  }
+
+  for( i = 0; i < n; i++ ) {
+    gzip_block* b = &fl->blocks[i];
+    if( ! err ) err = gzip_zerr(b->zret);
+    if( ! err ) err = gzip_write_out(fl, b->out, b->out_len);
+    b->in_len = 0;
+    b->out_len = 0;
+  }
+
+  fl->nfull = 0;
+  fl->wrote_any = 1;
+
+  return err;
+}
+
+static
+qioerr gzip_add_to_blocks(gzip_file* fl, const unsigned char* ptr, size_t len)
+{
+  qioerr err = 0;
+
+  while( len > 0 ) {
+    gzip_block* b = &fl->blocks[fl->nfull];
+    size_t amt = fl->block_size - b->in_len;
+    if( amt > len ) amt = len;
+    memcpy(b->in + b->in_len, ptr, amt);
+    b->in_len += amt;
+    ptr += amt;
+    len -= amt;
+
+    if( b->in_len == fl->block_size ) {
+      fl->nfull++;
+      if( fl->nfull == fl->nthreads ) {
+        err = gzip_flush_blocks(fl, fl->nthreads);
+        if( err ) return err;
+      }
+    }
+  }
+
+  return err;
+}
+
+/*********** qio_file_functions_t ***********/
+
+static
+qioerr gzip_writev(void* file, const struct iovec* iov, int iovcnt, ssize_t* num_written_out, void* fs)
+{
+  gzip_file* fl = to_gzip_file(file);
+  ssize_t total = 0;
+  qioerr err = 0;
+  int i;
+
+  STARTING_SLOW_SYSCALL;
+
+  for( i = 0; i < iovcnt && ! err; i++ ) {
+    if( fl->blocks ) {
+      err = gzip_add_to_blocks(fl, (unsigned char*) iov[i].iov_base,
+                               iov[i].iov_len);
+    } else {
+      fl->z.next_in = (unsigned char*) iov[i].iov_base;
+      fl->z.avail_in = iov[i].iov_len;
+      err = gzip_deflate_stream(fl, Z_NO_FLUSH);
+    }
+    if( ! err ) total += iov[i].iov_len;
+  }
+
+  DONE_SLOW_SYSCALL;
+
+  *num_written_out = total;
+  return err;
+}
+
+// Make sure there is compressed input available, reading more from
+// the underlying channel if necessary.
+static
+qioerr gzip_fill(gzip_file* fl)
+{
+  ssize_t amt = 0;
+  qioerr err;
+
+  if( fl->z.avail_in > 0 || fl->underlying_eof ) return 0;
+
+  err = qio_channel_read(false, fl->ch, fl->buf, GZIP_CHUNK, &amt);
+  if( qio_err_to_int(err) == EEOF ) {
+    fl->underlying_eof = 1;
+    err = 0;
+  }
+  fl->z.next_in = fl->buf;
+  fl->z.avail_in = amt;
+  return err;
+}
+
+static
+qioerr gzip_readv(void* file, const struct iovec* iov, int iovcnt, ssize_t* num_read_out, void* fs)
+{
+  gzip_file* fl = to_gzip_file(file);
+  ssize_t total = 0;
+  qioerr err = 0;
+  int zret;
+  int i;
+
+  STARTING_SLOW_SYSCALL;
+
+  for( i = 0; i < iovcnt && ! err && ! fl->stream_end; i++ ) {
+    fl->z.next_out = (unsigned char*) iov[i].iov_base;
+    fl->z.avail_out = iov[i].iov_len;
+
+    while( fl->z.avail_out > 0 ) {
+      err = gzip_fill(fl);
+      if( err ) break;
+
+      zret = inflate(&fl->z, Z_NO_FLUSH);
+      // Z_BUF_ERROR means no progress was possible; with no more input
+      // that means the input ended in the middle of a gzip member.
+      if( zret == Z_STREAM_END ) {
+        // The input may hold several gzip members back to back
+        // (e.g. from multi-threaded compression); keep going if so.
+        err = gzip_fill(fl);
+        if( err ) break;
+        if( fl->z.avail_in == 0 && fl->underlying_eof ) {
+          fl->stream_end = 1;
+          break;
+        }
+        zret = inflateReset(&fl->z);
+      }
+      if( zret == Z_BUF_ERROR && ! fl->underlying_eof ) continue;
+      if( zret != Z_OK ) {
+        err = gzip_zerr(zret);
+        break;
+      }
+    }
+
+    total += iov[i].iov_len - fl->z.avail_out;
+  }
+
+  DONE_SLOW_SYSCALL;
+
+  *num_read_out = total;
+  if( ! err && total == 0 && sys_iov_total_bytes(iov, iovcnt) != 0 )
+    err = qio_int_to_err(EEOF);
+  return err;
+}
+
+static
+qioerr gzip_finish(gzip_file* fl)
+{
+  qioerr err = 0;
+
+  if( fl->blocks ) {
+    int n = fl->nfull;
+    // include the partially filled block, and always write at least
+    // one member so that the output is a valid gzip file.
+    if( fl->blocks[n].in_len > 0 || ! fl->wrote_any ) n++;
+    if( n > 0 ) err = gzip_flush_blocks(fl, n);
+  } else {
+    fl->z.next_in = NULL;
+    fl->z.avail_in = 0;
+    err = gzip_deflate_stream(fl, Z_FINISH);
+  }
+
+  return err;
+}
+
+static
+void gzip_free(gzip_file* fl)
+{
+  int i;
+
+  if( fl->z_inited ) {
+    if( fl->writing ) deflateEnd(&fl->z);
+    else inflateEnd(&fl->z);
+  }
+
+  if( fl->pool ) gzip_pool_stop(fl);
+
+  if( fl->blocks ) {
+    for( i = 0; i < fl->nthreads; i++ ) {
+      qio_free(fl->blocks[i].in);
+      qio_free(fl->blocks[i].out);
+    }
+    qio_free(fl->blocks);
+  }
+
+  if( fl->ch ) qio_channel_release(fl->ch);
+  if( fl->underlying ) qio_file_release(fl->underlying);
+  qio_free(fl->buf);
+  qio_free(fl);
+}
+
+static
+qioerr gzip_close(void* file, void* fs)
+{
+  gzip_file* fl = to_gzip_file(file);
+  qioerr err = 0;
+  qioerr newerr;
+
+  if( fl->writing ) err = gzip_finish(fl);
+
+  newerr = qio_channel_close(false, fl->ch);
+  if( ! err ) err = newerr;
+
+  gzip_free(fl);
+
+  return err;
+}
+
+static
+qioerr gzip_fsync(void* file, void* fs)
+{
+  gzip_file* fl = to_gzip_file(file);
+  qioerr err;
+
+  // Pushes out what has been compressed so far. Data still held in
+  // the compressor only reaches the underlying file on close.
+  err = qio_channel_flush(false, fl->ch);
+  if( err ) return err;
+
+  return qio_file_sync(fl->underlying);
+}
+
+static
+qioerr gzip_getpath(void* file, const char** string_out, void* fs)
+{
+  return qio_file_path(to_gzip_file(file)->underlying, string_out);
+}
+
+qio_file_functions_t gzip_function_struct = {
+    &gzip_writev,
+    &gzip_readv,
+    NULL,             // pwritev -- not seekable
+    NULL,             // preadv -- not seekable
+    &gzip_close,
+    NULL,             // open -- use chpl_gzip_open
+    NULL,             // seek -- not seekable
+    NULL,             // filelength -- not known in advance
+    &gzip_getpath,
+    &gzip_fsync,
+    NULL,
+    NULL,
+};
+
+const qio_file_functions_ptr_t gzip_function_struct_ptr = &gzip_function_struct;
+
+qioerr chpl_gzip_open(qio_file_t** file_out, qio_file_t* underlying,
+                      int writing, int level, int64_t block_size,
+                      int nthreads, const qio_style_t* style)
+{
+  gzip_file* fl;
+  qioerr err = 0;
+  int zret;
+  int flags;
+  int i;
+
+  *file_out = NULL;
+
+  if( level < Z_DEFAULT_COMPRESSION || level > Z_BEST_COMPRESSION )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid gzip compression level");
+  if( nthreads < 1 )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid number of gzip threads");
+  if( block_size <= 0 || block_size > UINT_MAX )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid gzip block size");
+
+  fl = (gzip_file*) qio_calloc(1, sizeof(gzip_file));
+  if( ! fl ) return QIO_ENOMEM;
+
+  fl->writing = writing;
+  fl->level = level;
+  fl->nthreads = writing ? nthreads : 1;
+  fl->block_size = block_size;
+
+  fl->buf = (unsigned char*) qio_malloc(GZIP_CHUNK);
+  if( ! fl->buf ) {
+    err = QIO_ENOMEM;
+    goto error;
+  }
+
+  if( writing && fl->nthreads > 1 ) {
+    fl->blocks = (gzip_block*) qio_calloc(fl->nthreads, sizeof(gzip_block));
+    if( ! fl->blocks ) {
+      err = QIO_ENOMEM;
+      goto error;
+    }
+    for( i = 0; i < fl->nthreads; i++ ) {
+      gzip_block* b = &fl->blocks[i];
+      b->level = level;
+      err = gzip_block_bound(level, block_size, &b->out_cap);
+      if( err ) goto error;
+      b->in = (unsigned char*) qio_malloc(block_size);
+      b->out = (unsigned char*) qio_malloc(b->out_cap);
+      if( ! b->in || ! b->out ) {
+        err = QIO_ENOMEM;
+        goto error;
+      }
+    }
+    err = gzip_pool_start(fl);
+    if( err ) goto error;
+  } else if( writing ) {
+    zret = deflateInit2(&fl->z, level, Z_DEFLATED, GZIP_WRITE_WBITS, 8,
+                        Z_DEFAULT_STRATEGY);
+    err = gzip_zerr(zret);
+    if( err ) goto error;
+    fl->z_inited = 1;
+  } else {
+    zret = inflateInit2(&fl->z, GZIP_READ_WBITS);
+    err = gzip_zerr(zret);
+    if( err ) goto error;
+    fl->z_inited = 1;
+  }
+
+  qio_file_retain(underlying);
+  fl->underlying = underlying;
+
+  err = qio_channel_create(&fl->ch, underlying, 0, ! writing, writing,
+                           0, INT64_MAX, NULL);
+  if( err ) goto error;
+
+  flags = writing ? QIO_FDFLAG_WRITEABLE : QIO_FDFLAG_READABLE;
+
+  err = qio_file_init_usr(file_out, fl, QIO_HINT_OWNED, flags, style,
+                          NULL, &gzip_function_struct);
+  if( err ) goto error;
+
+  return 0;
+
+error:
+  gzip_free(fl);
+  *file_out = NULL;
+  return err;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#endif
+
+#include "qio_plugin_gzip.h"
+
+qio_file_functions_t gzip_function_struct = {
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+};
+
+const qio_file_functions_ptr_t gzip_function_struct_ptr = &gzip_function_struct;
+
+qioerr chpl_gzip_open(qio_file_t** file_out, qio_file_t* underlying,
+                      int writing, int level, int64_t block_size,
+                      int nthreads, const qio_style_t* style)
+{
+  *file_out = NULL;
+  QIO_RETURN_CONSTANT_ERROR(ENOSYS, "No gzip support (CHPL_AUX_FILESYS does not include gzip)");
+}
@@ -21,6 +21,7 @@
 
 #ifndef CHPL_RT_UNIT_TEST
 #include "chplrt.h"
+#include "chpl-env.h"
 #endif
 
 #include "qbuffer.h"
@@ -29,6 +30,9 @@
 
 #include "sys.h"
 
+#include "chpl-thread-local-storage.h"
+#include "chpl-rt-lock.h"
+
 #include <limits.h>
 #include <sys/mman.h>
 
@@ -85,9 +89,258 @@ void qbytes_free_qio_free(qbytes_t* b) {
   qio_free(b->data);
   _qbytes_free_qbytes(b);
 }
+
+// iobuf pooling.
+//
+// Short-lived channels allocate and release several iobufs each, so
+// instead of handing released iobufs back to the allocator we keep
+// them on a small per-thread free list, with a bounded global list
+// for overflow (and for threads that have no thread-local storage).
+// The lists are threaded through the first bytes of the free buffers
+// themselves. Buffers are still zeroed when they are handed out again.
+//
+// The pool sizes are counts of iobufs and can be changed with
+// CHPL_RT_IOBUF_POOL_THREAD and CHPL_RT_IOBUF_POOL_GLOBAL; setting
+// both to 0 disables pooling. CHPL_RT_IOBUF_POOL_STATS=true prints
+// hit rates when the program exits.
+
+typedef struct qbytes_iobuf_pool_s {
+  void* head;
+  size_t count;
+  // links per-thread pools together so they can be drained at exit
+  struct qbytes_iobuf_pool_s* next_pool;
+} qbytes_iobuf_pool_t;
+
+size_t qbytes_iobuf_pool_thread_max = 16;
+size_t qbytes_iobuf_pool_global_max = 256;
+
+// pooling stays off until qbytes_iobuf_pool_init is called
+static int qbytes_iobuf_pool_enabled = 0;
+static int qbytes_iobuf_pool_stats = 0;
+
+static chpl_rt_lock_t qbytes_iobuf_pool_lock;
+static qbytes_iobuf_pool_t qbytes_iobuf_global_pool;
+// A copy of qbytes_iobuf_global_pool.count, written under the lock,
+// that can be read without it to skip taking the lock when the global
+// pool is obviously empty or full.
+static atomic_uint_least64_t qbytes_iobuf_global_count;
+static qbytes_iobuf_pool_t* qbytes_iobuf_thread_pools;
+
+static atomic_uint_least64_t qbytes_iobuf_pool_thread_hits;
+static atomic_uint_least64_t qbytes_iobuf_pool_global_hits;
+static atomic_uint_least64_t qbytes_iobuf_pool_misses;
+static atomic_uint_least64_t qbytes_iobuf_pool_discards;
+
+#ifdef CHPL_TLS
+static CHPL_TLS qbytes_iobuf_pool_t* qbytes_iobuf_my_pool;
+#endif
+
+static inline
+uint64_t qbytes_iobuf_global_count_peek(void)
+{
+  return atomic_load_explicit_uint_least64_t(&qbytes_iobuf_global_count,
+                                             memory_order_relaxed);
+}
+
+static inline
+void qbytes_iobuf_global_count_update(void)
+{
+  atomic_store_explicit_uint_least64_t(&qbytes_iobuf_global_count,
+                                       qbytes_iobuf_global_pool.count,
+                                       memory_order_relaxed);
+}
+
+static inline
+void qbytes_iobuf_pool_count(atomic_uint_least64_t* counter)
+{
+  if( qbytes_iobuf_pool_stats )
+    atomic_fetch_add_explicit_uint_least64_t(counter, 1, memory_order_relaxed);
+}
+
+static inline
+void* qbytes_iobuf_pool_pop(qbytes_iobuf_pool_t* pool)
+{
+  void* ret = pool->head;
+  if( ret ) {
+    pool->head = *(void**) ret;
+    pool->count--;
+  }
+  return ret;
+}
+
+static inline
+void qbytes_iobuf_pool_push(qbytes_iobuf_pool_t* pool, void* data)
+{
+  *(void**) data = pool->head;
+  pool->head = data;
+  pool->count++;
+}
+
+static
+qbytes_iobuf_pool_t* qbytes_iobuf_pool_mine(void)
+{
+#ifdef CHPL_TLS
+  qbytes_iobuf_pool_t* pool = qbytes_iobuf_my_pool;
+  if( pool == NULL && qbytes_iobuf_pool_thread_max > 0 ) {
+    pool = (qbytes_iobuf_pool_t*) qio_calloc(1, sizeof(qbytes_iobuf_pool_t));
+    if( ! pool ) return NULL;
+    chpl_rt_lock(&qbytes_iobuf_pool_lock);
+    pool->next_pool = qbytes_iobuf_thread_pools;
+    qbytes_iobuf_thread_pools = pool;
+    chpl_rt_unlock(&qbytes_iobuf_pool_lock);
+    qbytes_iobuf_my_pool = pool;
+  }
+  return pool;
+#else
+  return NULL;
+#endif
+}
+
+// Returns a pooled iobuf-sized buffer or NULL if the pool is empty.
+static
+void* qbytes_iobuf_pool_get(void)
+{
+  qbytes_iobuf_pool_t* pool;
+  void* data = NULL;
+
+  if( ! qbytes_iobuf_pool_enabled ) return NULL;
+
+  pool = qbytes_iobuf_pool_mine();
+  if( pool ) data = qbytes_iobuf_pool_pop(pool);
+  if( data ) {
+    qbytes_iobuf_pool_count(&qbytes_iobuf_pool_thread_hits);
+    return data;
+  }
+
+  if( qbytes_iobuf_global_count_peek() > 0 ) {
+    chpl_rt_lock(&qbytes_iobuf_pool_lock);
+    data = qbytes_iobuf_pool_pop(&qbytes_iobuf_global_pool);
+    qbytes_iobuf_global_count_update();
+    chpl_rt_unlock(&qbytes_iobuf_pool_lock);
+  }
+  if( data ) qbytes_iobuf_pool_count(&qbytes_iobuf_pool_global_hits);
+  else qbytes_iobuf_pool_count(&qbytes_iobuf_pool_misses);
+
+  return data;
+}
+
+// Returns true if the pool took ownership of data.
+static
+int qbytes_iobuf_pool_put(void* data)
+{
+  qbytes_iobuf_pool_t* pool;
+  int kept = 0;
+
+  if( ! qbytes_iobuf_pool_enabled ) return 0;
+
+  pool = qbytes_iobuf_pool_mine();
+  if( pool && pool->count < qbytes_iobuf_pool_thread_max ) {
+    qbytes_iobuf_pool_push(pool, data);
+    return 1;
+  }
+
+  if( qbytes_iobuf_global_count_peek() < qbytes_iobuf_pool_global_max ) {
+    chpl_rt_lock(&qbytes_iobuf_pool_lock);
+    if( qbytes_iobuf_global_pool.count < qbytes_iobuf_pool_global_max ) {
+      qbytes_iobuf_pool_push(&qbytes_iobuf_global_pool, data);
+      qbytes_iobuf_global_count_update();
+      kept = 1;
+    }
+    chpl_rt_unlock(&qbytes_iobuf_pool_lock);
+  }
+  if( ! kept ) qbytes_iobuf_pool_count(&qbytes_iobuf_pool_discards);
+
+  return kept;
+}
+
+static
+size_t qbytes_iobuf_pool_env(const char* name, size_t dflt)
+{
+#ifndef CHPL_RT_UNIT_TEST
+  const char* str = chpl_get_rt_env(name, NULL);
+  long long val;
+  if( str && sscanf(str, "%lld", &val) == 1 && val >= 0 )
+    return (size_t) val;
+#endif
+  return dflt;
+}
+
+void qbytes_iobuf_pool_init(void)
+{
+  chpl_rt_lock_init(&qbytes_iobuf_pool_lock);
+  atomic_init_uint_least64_t(&qbytes_iobuf_global_count, 0);
+  atomic_init_uint_least64_t(&qbytes_iobuf_pool_thread_hits, 0);
+  atomic_init_uint_least64_t(&qbytes_iobuf_pool_global_hits, 0);
+  atomic_init_uint_least64_t(&qbytes_iobuf_pool_misses, 0);
+  atomic_init_uint_least64_t(&qbytes_iobuf_pool_discards, 0);
+
+  qbytes_iobuf_pool_thread_max =
+    qbytes_iobuf_pool_env("IOBUF_POOL_THREAD", qbytes_iobuf_pool_thread_max);
+  qbytes_iobuf_pool_global_max =
+    qbytes_iobuf_pool_env("IOBUF_POOL_GLOBAL", qbytes_iobuf_pool_global_max);
+#ifndef CHPL_RT_UNIT_TEST
+  qbytes_iobuf_pool_stats = chpl_get_rt_env_bool("IOBUF_POOL_STATS", false);
+#endif
+
+  qbytes_iobuf_pool_enabled = (qbytes_iobuf_pool_thread_max > 0 ||
+                               qbytes_iobuf_pool_global_max > 0);
+}
+
+void qbytes_iobuf_pool_report(void)
+{
+  uint64_t thread_hits, global_hits, misses, discards, total;
+
+  thread_hits = atomic_load_uint_least64_t(&qbytes_iobuf_pool_thread_hits);
+  global_hits = atomic_load_uint_least64_t(&qbytes_iobuf_pool_global_hits);
+  misses = atomic_load_uint_least64_t(&qbytes_iobuf_pool_misses);
+  discards = atomic_load_uint_least64_t(&qbytes_iobuf_pool_discards);
+  total = thread_hits + global_hits + misses;
+
+  fprintf(stderr, "iobuf pool: %" PRIu64 " requests, "
+                  "%" PRIu64 " thread hits, %" PRIu64 " global hits, "
+                  "%" PRIu64 " misses (%.1f%% hit rate), "
+                  "%" PRIu64 " releases discarded\n",
+          total, thread_hits, global_hits, misses,
+          total ? 100.0 * (thread_hits + global_hits) / total : 0.0,
+          discards);
+}
+
+// Frees everything held in the pools. Only call this once no
+// other threads are using iobufs.
+void qbytes_iobuf_pool_exit(void)
+{
+  qbytes_iobuf_pool_t* pool;
+  void* data;
+
+  if( ! qbytes_iobuf_pool_enabled ) return;
+
+  if( qbytes_iobuf_pool_stats ) qbytes_iobuf_pool_report();
+
+  qbytes_iobuf_pool_enabled = 0;
+
+  chpl_rt_lock(&qbytes_iobuf_pool_lock);
+  while( (data = qbytes_iobuf_pool_pop(&qbytes_iobuf_global_pool)) )
+    qio_free(data);
+  qbytes_iobuf_global_count_update();
+  while( (pool = qbytes_iobuf_thread_pools) ) {
+    qbytes_iobuf_thread_pools = pool->next_pool;
+    while( (data = qbytes_iobuf_pool_pop(pool)) )
+      qio_free(data);
+    qio_free(pool);
+  }
+  chpl_rt_unlock(&qbytes_iobuf_pool_lock);
+#ifdef CHPL_TLS
+  qbytes_iobuf_my_pool = NULL;
+#endif
+}
+
 void qbytes_free_iobuf(qbytes_t* b) {
-  // iobuf is just something to be freed with free()
-  qbytes_free_qio_free(b);
+  // return the buffer to the pool if there is room, else free it
+  if( b->len == qbytes_iobuf_size && qbytes_iobuf_pool_put(b->data) ) {
+    _qbytes_free_qbytes(b);
+  } else {
+    qbytes_free_qio_free(b);
+  }
 }
 
 void debug_print_bytes(qbytes_t* b)
@@ -150,7 +403,8 @@ qioerr _qbytes_init_iobuf(qbytes_t* ret)
   
   // allocate 4K-aligned (or page size aligned)
   // multiple of 4K
-  data = qio_valloc(qbytes_iobuf_size);
+  data = qbytes_iobuf_pool_get();
+  if( !data ) data = qio_valloc(qbytes_iobuf_size);
   if( !data ) return QIO_ENOMEM;
   // We used to use posix_memalign, but that didn't work on an old Mac;
   // also, this should be page-aligned (vs iobuf_size aligned).
@@ -57,6 +57,10 @@
 
 #include <assert.h>
 
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
 // Default to using close-on-exec for systems that support it.
 #ifdef O_CLOEXEC
 #define QIO_OCLOEXEC O_CLOEXEC
@@ -93,6 +97,37 @@ ssize_t qio_initial_mmap_max = 8*1024*1024;
 bool qio_allow_default_mmap = true;
 
 #ifdef _chplrt_H_
+// Try to get the lock as its bias owner. Returns true on success.
+static inline
+int qio_lock_biased(qio_lock_t* x, int64_t id) {
+  int64_t bias;
+
+  if( atomic_load_explicit_bool(&x->bias_revoked, memory_order_relaxed) )
+    return 0;
+
+  bias = atomic_load_explicit_int_least64_t(&x->bias_owner,
+                                            memory_order_relaxed);
+  if( bias == NULL_OWNER ) {
+    // Nobody has the bias yet; try to take it.
+    if( ! atomic_compare_exchange_strong_int_least64_t(&x->bias_owner,
+                                                       NULL_OWNER, id) )
+      return 0;
+  } else if( bias != id ) {
+    return 0;
+  }
+
+  // Announce that we are entering the critical section, then check
+  // that the bias has not been revoked. A revoking task does the same
+  // in the opposite order, so at least one of us sees the other.
+  atomic_store_bool(&x->bias_held, true);
+  if( atomic_load_bool(&x->bias_revoked) ) {
+    atomic_store_explicit_bool(&x->bias_held, false, memory_order_release);
+    return 0;
+  }
+
+  return 1;
+}
+
 qioerr qio_lock(qio_lock_t* x) {
   // recursive mutex based on glibc pthreads implementation
   int64_t id = chpl_task_getId();
@@ -106,12 +141,30 @@ qioerr qio_lock(qio_lock_t* x) {
     return 0;
   }
 
+  if( qio_lock_biased(x, id) ) {
+    x->count = 1;
+    x->owner = id;
+    x->biased = 1;
+    return 0;
+  }
+
   // we have to get the mutex.
   chpl_sync_lock(&x->sv);
 
+  // The first task to get here revokes the bias, waiting for the bias
+  // owner (if any) to unlock. Later tasks see bias_revoked already set
+  // while holding the mutex, so the bias owner can't be inside.
+  if( ! atomic_load_explicit_bool(&x->bias_revoked, memory_order_relaxed) ) {
+    atomic_store_bool(&x->bias_revoked, true);
+    while( atomic_load_bool(&x->bias_held) ) {
+      chpl_task_yield();
+    }
+  }
+
   assert( x->owner == NULL_OWNER );
   x->count = 1;
   x->owner = id;
+  x->biased = 0;
 
   return 0;
 }
@@ -129,7 +182,12 @@ void qio_unlock(qio_lock_t* x) {
   }
 
   x->owner = NULL_OWNER;
-  chpl_sync_unlock(&x->sv);
+  if( x->biased ) {
+    x->biased = 0;
+    atomic_store_explicit_bool(&x->bias_held, false, memory_order_release);
+  } else {
+    chpl_sync_unlock(&x->sv);
+  }
 }
 #endif
 
@@ -1430,6 +1488,87 @@ qioerr qio_file_length(qio_file_t* f, int64_t *len_out)
   return err;
 }
 
+qioerr qio_file_mmap_region(qio_file_t* f, int64_t start, int64_t len,
+                            int copy_on_write, qio_hint_t hints,
+                            qbytes_t** bytes_out, void** data_out)
+{
+  struct stat stats;
+  long pagesize;
+  int64_t map_start;
+  int64_t skip;
+  int64_t map_len;
+  int prot = PROT_READ;
+  int flags = MAP_SHARED;
+  void* data;
+  qbytes_t* bytes;
+  qioerr err;
+
+  *bytes_out = NULL;
+  *data_out = NULL;
+
+  // Only plain file descriptors can be mapped.
+  if( f->buf || f->fsfns || f->fd == -1 ) {
+    QIO_RETURN_CONSTANT_ERROR(ENOSYS, "mmap requires a file descriptor");
+  }
+
+  if( start < 0 || len < 0 ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "negative offset or length for mmap");
+  }
+
+  if( ! (f->fdflags & QIO_FDFLAG_READABLE) ) {
+    QIO_RETURN_CONSTANT_ERROR(EBADF, "mmap requires a readable file");
+  }
+
+  // There is nothing to map (and mmap would fail with EINVAL).
+  if( len == 0 ) return 0;
+
+  // Don't map past the end of the file; touching those pages
+  // would cause SIGBUS rather than an error.  start + len could
+  // overflow, so compare len against what is left after start.
+  err = qio_int_to_err(sys_fstat(f->fd, &stats));
+  if( err ) return err;
+
+  if( start > stats.st_size || len > stats.st_size - start ) return QIO_EEOF;
+
+  // round start down to page size.
+  pagesize = sys_page_size();
+  map_start = (start / pagesize) * pagesize;
+  skip = start - map_start;
+  map_len = len + skip;
+
+  // This check is (only) important for 32-bit systems.
+  if( map_len > SSIZE_MAX ) QIO_RETURN_CONSTANT_ERROR(EOVERFLOW, "overflow in mmap");
+
+  if( copy_on_write ) {
+    // Writes go to private pages and are never stored to the file.
+    prot |= PROT_WRITE;
+    flags = MAP_PRIVATE;
+  }
+
+#ifdef MAP_POPULATE
+  if( hints & QIO_HINT_CACHED ) flags |= MAP_POPULATE;
+#endif
+
+  err = qio_int_to_err(sys_mmap(NULL, map_len, prot, flags, f->fd, map_start, &data));
+  if( err ) return err;
+
+  err = qio_madvise_for_hints(data, map_len, hints);
+  if( err ) {
+    sys_munmap(data, map_len);
+    return err;
+  }
+
+  err = qbytes_create_generic(&bytes, data, map_len, qbytes_free_munmap);
+  if( err ) {
+    sys_munmap(data, map_len);
+    return err;
+  }
+
+  *bytes_out = bytes;
+  *data_out = ((unsigned char*) data) + skip;
+  return 0;
+}
+
 /* CHANNELS ----------------------------- */
 static
 qioerr _qio_channel_init(qio_channel_t* ch, qio_chtype_t type)
@@ -3379,6 +3518,233 @@ qioerr qio_channel_put_buffer(const int threadsafe, qio_channel_t* ch, qbuffer_t
   return err;
 }
 
+// Copy len bytes from src_off in src_fd to dst_off in dst_fd inside the
+// kernel. Returns ENOSYS (with *num_copied = 0) if that is not possible
+// for these file descriptors, in which case the caller should copy the
+// data some other way.
+//
+// Only copy_file_range is used, since it takes both offsets explicitly.
+// sendfile writes at the file position of dst_fd, which other channels
+// on the same file share, so it is not used as a fallback.
+static
+qioerr _qio_copy_fd_range(fd_t src_fd, int64_t src_off, fd_t dst_fd, int64_t dst_off, int64_t len, int64_t* num_copied)
+{
+  int64_t copied = 0;
+  qioerr err = 0;
+
+  *num_copied = 0;
+
+#if defined(__linux__) && defined(SYS_copy_file_range)
+  {
+    // don't ask for more than a single call can transfer
+    const int64_t max_chunk = 1024*1024*1024;
+
+    STARTING_SLOW_SYSCALL;
+
+    while( copied < len ) {
+      int64_t amt = len - copied;
+      loff_t in_off = src_off + copied;
+      loff_t out_off = dst_off + copied;
+      ssize_t got;
+      int errcode = 0;
+
+      if( amt > max_chunk ) amt = max_chunk;
+
+      got = syscall(SYS_copy_file_range, src_fd, &in_off, dst_fd, &out_off,
+                    (size_t) amt, 0);
+      if( got < 0 ) {
+        errcode = errno;
+        if( errcode == EINTR ) continue;
+        // Older kernels don't have copy_file_range, and some refuse to
+        // copy between filesystems; the caller copies through the
+        // channel buffers instead.
+        if( copied == 0 &&
+            (errcode == ENOSYS || errcode == EXDEV || errcode == EINVAL ||
+             errcode == EOPNOTSUPP) )
+          errcode = ENOSYS;
+        err = qio_int_to_err(errcode);
+        break;
+      }
+
+      if( got == 0 ) break; // end of the source file
+
+      copied += got;
+    }
+
+    DONE_SLOW_SYSCALL;
+  }
+#else
+  err = qio_int_to_err(ENOSYS);
+#endif
+
+  *num_copied = copied;
+  return err;
+}
+
+// Can the data for a copy from src to dst go directly between the file
+// descriptors, bypassing both channel buffers?
+static
+int _qio_channel_can_copy_in_kernel(qio_channel_t* dst, qio_channel_t* src)
+{
+  qio_method_t src_method = (qio_method_t) (src->hints & QIO_METHODMASK);
+  qio_method_t dst_method = (qio_method_t) (dst->hints & QIO_METHODMASK);
+
+  // copy_file_range can't handle overlapping ranges in one file.
+  if( src->file == dst->file ) return 0;
+
+  if( src->file->fd < 0 || src->file->fsfns || src->file->buf ) return 0;
+  if( dst->file->fd < 0 || dst->file->fsfns || dst->file->buf ) return 0;
+
+  if( ! (src->file->fdflags & QIO_FDFLAG_SEEKABLE) ) return 0;
+  if( ! (dst->file->fdflags & QIO_FDFLAG_SEEKABLE) ) return 0;
+
+  if( src_method != QIO_METHOD_PREADPWRITE &&
+      src_method != QIO_METHOD_MMAP ) return 0;
+  if( dst_method != QIO_METHOD_PREADPWRITE ) return 0;
+
+  // Marks and partial bytes would have to be carried across the copy.
+  if( src->mark_cur != 0 || dst->mark_cur != 0 ) return 0;
+  if( src->bits_read_bytes != 0 || src->bit_buffer_bits != 0 ) return 0;
+  if( dst->bit_buffer_bits != 0 ) return 0;
+
+  return 1;
+}
+
+// Move a channel without marks to pos, discarding any buffered data.
+// A writing channel must already have been flushed.
+static
+void _qio_channel_reposition_unlocked(qio_channel_t* ch, int64_t pos)
+{
+  _qio_buffered_advance_cached(ch);
+
+  if( qbuffer_is_initialized(&ch->buf) ) {
+    qbuffer_trim_front(&ch->buf, qbuffer_len(&ch->buf));
+    qbuffer_reposition(&ch->buf, pos);
+  }
+
+  _set_right_mark_start(ch, pos);
+  ch->av_end = pos;
+}
+
+static
+qioerr _qio_channel_copy_unlocked(qio_channel_t* dst, qio_channel_t* src, int64_t len, int64_t* amt_copied)
+{
+  int64_t src_pos, dst_pos;
+  int64_t copied = 0;
+  qioerr err = 0;
+
+  *amt_copied = 0;
+
+  // The fast path: copy between the file descriptors in the kernel.
+  if( _qio_channel_can_copy_in_kernel(dst, src) ) {
+    // Anything already written to dst goes before the copied data.
+    err = _qio_channel_flush_unlocked(dst);
+    if( err ) return err;
+
+    src_pos = qio_channel_offset_unlocked(src);
+    dst_pos = qio_channel_offset_unlocked(dst);
+
+    if( len > src->end_pos - src_pos ) len = src->end_pos - src_pos;
+    if( len > dst->end_pos - dst_pos ) len = dst->end_pos - dst_pos;
+    if( len < 0 ) len = 0;
+
+    err = _qio_copy_fd_range(src->file->fd, src_pos, dst->file->fd, dst_pos,
+                             len, &copied);
+
+    if( copied > 0 || qio_err_to_int(err) != ENOSYS ) {
+      _qio_channel_reposition_unlocked(src, src_pos + copied);
+      _qio_channel_reposition_unlocked(dst, dst_pos + copied);
+      *amt_copied = copied;
+      return err;
+    }
+
+    // Otherwise, nothing was copied; use the buffered path.
+    err = 0;
+  }
+
+  // The buffered path: read into the src buffer and share that data
+  // with the dst buffer, so that the data is only buffered once.
+  while( copied < len ) {
+    qbuffer_iter_t start, end;
+    int64_t want = len - copied;
+    int64_t avail;
+    int eof = 0;
+
+    if( want > qio_mmap_chunk_iobufs * qbytes_iobuf_size )
+      want = qio_mmap_chunk_iobufs * qbytes_iobuf_size;
+
+    err = _qio_channel_require_unlocked(src, want, false);
+    if( qio_err_to_int(err) == EEOF ) {
+      eof = 1;
+      err = 0;
+    }
+    if( err ) break;
+
+    avail = src->av_end - _right_mark_start(src);
+    if( avail > want ) avail = want;
+    if( avail > src->end_pos - _right_mark_start(src) )
+      avail = src->end_pos - _right_mark_start(src);
+    if( avail > dst->end_pos - qio_channel_offset_unlocked(dst) )
+      avail = dst->end_pos - qio_channel_offset_unlocked(dst);
+    if( avail <= 0 ) break;
+
+    start = _right_mark_start_iter(src);
+    end = start;
+    qbuffer_iter_advance(&src->buf, &end, avail);
+
+    err = _qio_channel_put_buffer_unlocked(dst, &src->buf, start, end);
+    if( err ) break;
+
+    // Consume that data from src.
+    _add_right_mark_start(src, avail);
+    copied += avail;
+
+    err = _qio_buffered_behind(src, false);
+    if( err ) break;
+
+    if( eof ) break;
+  }
+
+  *amt_copied = copied;
+  return err;
+}
+
+qioerr qio_channel_copy(const int threadsafe, qio_channel_t* dst, qio_channel_t* src, int64_t len, int64_t* amt_copied)
+{
+  qioerr err;
+
+  *amt_copied = 0;
+
+  if( ! (src->flags & QIO_FDFLAG_READABLE) )
+    QIO_RETURN_CONSTANT_ERROR(EBADF, "not readable");
+  if( ! (dst->flags & QIO_FDFLAG_WRITEABLE) )
+    QIO_RETURN_CONSTANT_ERROR(EBADF, "not writeable");
+  if( src == dst )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "cannot copy a channel to itself");
+
+  if( len < 0 ) len = INT64_MAX;
+
+  if( threadsafe ) {
+    err = qio_lock(&src->lock);
+    if( err ) return err;
+    err = qio_lock(&dst->lock);
+    if( err ) {
+      qio_unlock(&src->lock);
+      return err;
+    }
+  }
+
+  err = _qio_channel_copy_unlocked(dst, src, len, amt_copied);
+  _qio_channel_set_error_unlocked(dst, err);
+
+  if( threadsafe ) {
+    qio_unlock(&dst->lock);
+    qio_unlock(&src->lock);
+  }
+
+  return err;
+}
+
 // you don't have to call end_peek_buffer if this returns an error
 qioerr qio_channel_begin_peek_buffer(const int threadsafe, qio_channel_t* ch, int64_t require, int writing, qbuffer_t** buf_out, qbuffer_iter_t* start_out, qbuffer_iter_t* end_out)
 {
@@ -28,6 +28,7 @@
 #include "chplexit.h"
 #include "chpl-locale-model.h"
 #include "chpl-mem.h"
+#include "chpl-sync-profile.h"
 #include "chpl-tasks.h"
 #include "chpl-tasks-callbacks-internal.h"
 #include "chplsys.h"
@@ -160,12 +161,54 @@ static void chpl_thread_sync_awaken(chpl_sync_aux_t *s);
 
 // Sync variables
 
+//
+// When profiling, take the lock with a trylock first so that waiting
+// for it can be seen.  Returns whether we had to wait.
+//
+static chpl_bool sync_prof_mutex_lock(chpl_sync_aux_t *s) {
+  if (pthread_mutex_trylock((pthread_mutex_t*) &s->lock) == 0)
+    return false;
+  chpl_thread_mutexLock(&s->lock);
+  return true;
+}
+
+//
+// Record a profiled lock, and note which task now owns the variable
+// so that the next one can tell if ownership moved.  The runtime takes
+// sync locks on threads that are not running a task yet (memory
+// tracking does, for one), so we can't use chpl_task_getId() here.
+//
+static void sync_prof_locked(chpl_sync_aux_t *s, chpl_sync_prof_kind_t kind,
+                             int32_t lineno, int32_t filename,
+                             chpl_bool waited, uint64_t start_ns) {
+  thread_private_data_t* tp =
+    (thread_private_data_t*) chpl_thread_getPrivateData();
+  chpl_taskID_t me = (tp != NULL && tp->ptask != NULL)
+                     ? tp->ptask->bundle.id : chpl_nullTaskID;
+  chpl_bool transfer = (s->prof_owner != chpl_nullTaskID
+                        && s->prof_owner != me);
+
+  s->prof_owner = me;
+  chpl_sync_prof_record(kind, lineno, filename, waited,
+                        waited ? chpl_now_ns() - start_ns : 0,
+                        transfer);
+}
+
 static void sync_wait_and_lock(chpl_sync_aux_t *s,
                                chpl_bool want_full,
                                int32_t lineno, int32_t filename) {
   chpl_bool suspend_using_cond;
-
-  chpl_thread_mutexLock(&s->lock);
+  chpl_bool did_block_callbacks = false;
+  chpl_bool prof_on = chpl_sync_prof_on;
+  chpl_bool prof_waited = false;
+  uint64_t prof_start_ns = 0;
+
+  if (prof_on) {
+    prof_start_ns = chpl_now_ns();
+    prof_waited = sync_prof_mutex_lock(s) || s->is_full != want_full;
+  }
+  else
+    chpl_thread_mutexLock(&s->lock);
 
   // If we're oversubscribing the hardware, we wait using conditionals
   // in order to ensure fairness and thus progress.  If we're not, we
@@ -173,50 +216,77 @@ static void sync_wait_and_lock(chpl_sync_aux_t *s,
   suspend_using_cond = (chpl_thread_getNumThreads() >=
                         chpl_getNumLogicalCpus(true));
 
-  while (s->is_full != want_full) {
-    if (!suspend_using_cond) {
-      chpl_thread_mutexUnlock(&s->lock);
-    }
-    if (set_block_loc(lineno, filename)) {
-      // all other tasks appear to be blocked
-      struct timeval deadline, now;
-      chpl_bool timed_out = false;
-      // default value so that always allows condition to be true if not
-      // using conditionals
-
-      gettimeofday(&deadline, NULL);
-      deadline.tv_sec += 1;
-      do {
-        if (suspend_using_cond)
-          timed_out = chpl_thread_sync_suspend(s, &deadline);
-        else
-          chpl_thread_yield();
+  // The block and unblock callbacks are run with the lock released, so
+  // the variable may change state while they run; go around again if
+  // it is no longer the way we want it afterward.
+  do {
+    while (s->is_full != want_full) {
+      if (!did_block_callbacks
+          && chpl_task_have_callbacks(chpl_task_cb_event_kind_block)) {
+        chpl_thread_mutexUnlock(&s->lock);
+        chpl_task_do_callbacks(chpl_task_cb_event_kind_block,
+                               0, filename, lineno, chpl_task_getId(), false);
+        did_block_callbacks = true;
+        chpl_thread_mutexLock(&s->lock);
+        continue;
+      }
+      if (!suspend_using_cond) {
+        chpl_thread_mutexUnlock(&s->lock);
+      }
+      if (set_block_loc(lineno, filename)) {
+        // all other tasks appear to be blocked
+        struct timeval deadline, now;
+        chpl_bool timed_out = false;
+        // default value so that always allows condition to be true if not
+        // using conditionals
+
+        gettimeofday(&deadline, NULL);
+        deadline.tv_sec += 1;
+        do {
+          if (suspend_using_cond)
+            timed_out = chpl_thread_sync_suspend(s, &deadline);
+          else
+            chpl_thread_yield();
         
-        if (s->is_full != want_full && !timed_out)
-          gettimeofday(&now, NULL);
-      } while (s->is_full != want_full
-               && !timed_out
-               && (now.tv_sec < deadline.tv_sec
-                   || (now.tv_sec == deadline.tv_sec
-                       && now.tv_usec < deadline.tv_usec)));
-      if (s->is_full != want_full)
-        check_for_deadlock();
-    }
-    else {
-      do {
-        if (suspend_using_cond)
-          (void) chpl_thread_sync_suspend(s, NULL);
-        else
-          chpl_thread_yield();
-      } while (s->is_full != want_full);
+          if (s->is_full != want_full && !timed_out)
+            gettimeofday(&now, NULL);
+        } while (s->is_full != want_full
+                 && !timed_out
+                 && (now.tv_sec < deadline.tv_sec
+                     || (now.tv_sec == deadline.tv_sec
+                         && now.tv_usec < deadline.tv_usec)));
+        if (s->is_full != want_full)
+          check_for_deadlock();
+      }
+      else {
+        do {
+          if (suspend_using_cond)
+            (void) chpl_thread_sync_suspend(s, NULL);
+          else
+            chpl_thread_yield();
+        } while (s->is_full != want_full);
+      }
+      unset_block_loc();
+      if (!suspend_using_cond)
+        chpl_thread_mutexLock(&s->lock);
     }
-    unset_block_loc();
-    if (!suspend_using_cond)
+
+    if (did_block_callbacks) {
+      chpl_thread_mutexUnlock(&s->lock);
+      chpl_task_do_callbacks(chpl_task_cb_event_kind_unblock,
+                             0, filename, lineno, chpl_task_getId(), false);
+      did_block_callbacks = false;
       chpl_thread_mutexLock(&s->lock);
-  }
+    }
+  } while (s->is_full != want_full);
 
   if (blockreport)
     progress_cnt++;
+
+  if (prof_on)
+    sync_prof_locked(s, want_full ? chpl_sync_prof_kind_waitFull
+                                  : chpl_sync_prof_kind_waitEmpty,
+                     lineno, filename, prof_waited, prof_start_ns);
 }
 
 void chpl_sync_lock(chpl_sync_aux_t *s) {
@@ -285,6 +355,7 @@ static void chpl_thread_condvar_init(chpl_thread_condvar_t* cv) {
 
 void chpl_sync_initAux(chpl_sync_aux_t *s) {
   s->is_full = false;
+  s->prof_owner = chpl_nullTaskID;
   chpl_thread_mutexInit(&s->lock);
   chpl_thread_condvar_init(&s->signal_full);
   chpl_thread_condvar_init(&s->signal_empty);
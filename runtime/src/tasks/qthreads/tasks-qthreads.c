@@ -43,6 +43,7 @@
 #include "chpl-locale-model.h"
 #include "chpl-mem.h"
 #include "chplsys.h"
+#include "chpl-sync-profile.h"
 #include "chpl-linefile-support.h"
 #include "chpl-tasks.h"
 #include "chpl-tasks-callbacks-internal.h"
@@ -198,13 +199,13 @@ void chpl_task_yield(void)
 }
 
 // Sync variables
-void chpl_sync_lock(chpl_sync_aux_t *s)
+
+// Returns whether the lock was contested.
+static inline chpl_bool sync_lock(chpl_sync_aux_t *s)
 {
     aligned_t l;
     chpl_bool uncontested_lock = true;
 
-    PROFILE_INCR(profile_sync_lock, 1);
-
     //
     // To prevent starvation due to never switching away from a task that is
     // spinning while doing readXX() on a sync variable, yield if this sync var
@@ -229,6 +230,33 @@ void chpl_sync_lock(chpl_sync_aux_t *s)
             qthread_yield();
         }
     }
+
+    return !uncontested_lock;
+}
+
+//
+// Record a profiled lock, and note which task now owns the variable
+// so that the next one can tell if ownership moved.
+//
+static void sync_prof_locked(chpl_sync_aux_t *s, chpl_sync_prof_kind_t kind,
+                             int32_t lineno, int32_t filename,
+                             chpl_bool waited, uint64_t start_ns)
+{
+    chpl_taskID_t me = chpl_task_getId();
+    chpl_bool transfer = (s->prof_owner != chpl_nullTaskID
+                          && s->prof_owner != me);
+
+    s->prof_owner = me;
+    chpl_sync_prof_record(kind, lineno, filename, waited,
+                          waited ? chpl_now_ns() - start_ns : 0,
+                          transfer);
+}
+
+void chpl_sync_lock(chpl_sync_aux_t *s)
+{
+    PROFILE_INCR(profile_sync_lock, 1);
+
+    (void) sync_lock(s);
 }
 
 void chpl_sync_unlock(chpl_sync_aux_t *s)
@@ -248,34 +276,94 @@ static inline void about_to_block(int32_t  lineno,
     data->lock_filename = filename;
 }
 
+//
+// Run the block or unblock callbacks, if there are any; call this
+// without the sync variable's lock held.  Returns whether it ran any.
+//
+static inline chpl_bool wrap_block_callbacks(
+                          chpl_task_cb_event_kind_t event_kind,
+                          int32_t lineno, int32_t filename)
+{
+    if (chpl_task_have_callbacks(event_kind)) {
+        chpl_qthread_tls_t * data = chpl_qthread_get_tasklocal();
+        chpl_taskID_t id = (data && data->bundle) ? data->bundle->id
+                                                  : chpl_nullTaskID;
+        chpl_task_do_callbacks(event_kind, 0, filename, lineno, id, false);
+        return true;
+    }
+    return false;
+}
+
 void chpl_sync_waitFullAndLock(chpl_sync_aux_t *s,
                                int32_t          lineno,
                                int32_t         filename)
 {
+    chpl_bool prof_on = chpl_sync_prof_on;
+    chpl_bool prof_waited;
+    chpl_bool blocked = false;
+    uint64_t prof_start_ns = prof_on ? chpl_now_ns() : 0;
+
     PROFILE_INCR(profile_sync_waitFullAndLock, 1);
 
     if (blockreport) { about_to_block(lineno, filename); }
-    chpl_sync_lock(s);
+    prof_waited = sync_lock(s);
     while (s->is_full == 0) {
+        prof_waited = true;
         chpl_sync_unlock(s);
+        if (!blocked) {
+            blocked = wrap_block_callbacks(chpl_task_cb_event_kind_block,
+                                           lineno, filename);
+        }
         qthread_syncvar_readFE(NULL, &(s->signal_full));
-        chpl_sync_lock(s);
+        (void) sync_lock(s);
+        if (blocked && s->is_full != 0) {
+            chpl_sync_unlock(s);
+            (void) wrap_block_callbacks(chpl_task_cb_event_kind_unblock,
+                                        lineno, filename);
+            blocked = false;
+            (void) sync_lock(s);
+        }
     }
+
+    if (prof_on)
+        sync_prof_locked(s, chpl_sync_prof_kind_waitFull, lineno, filename,
+                         prof_waited, prof_start_ns);
 }
 
 void chpl_sync_waitEmptyAndLock(chpl_sync_aux_t *s,
                                 int32_t          lineno,
                                 int32_t         filename)
 {
+    chpl_bool prof_on = chpl_sync_prof_on;
+    chpl_bool prof_waited;
+    chpl_bool blocked = false;
+    uint64_t prof_start_ns = prof_on ? chpl_now_ns() : 0;
+
     PROFILE_INCR(profile_sync_waitEmptyAndLock, 1);
 
     if (blockreport) { about_to_block(lineno, filename); }
-    chpl_sync_lock(s);
+    prof_waited = sync_lock(s);
     while (s->is_full != 0) {
+        prof_waited = true;
         chpl_sync_unlock(s);
+        if (!blocked) {
+            blocked = wrap_block_callbacks(chpl_task_cb_event_kind_block,
+                                           lineno, filename);
+        }
         qthread_syncvar_readFE(NULL, &(s->signal_empty));
-        chpl_sync_lock(s);
+        (void) sync_lock(s);
+        if (blocked && s->is_full == 0) {
+            chpl_sync_unlock(s);
+            (void) wrap_block_callbacks(chpl_task_cb_event_kind_unblock,
+                                        lineno, filename);
+            blocked = false;
+            (void) sync_lock(s);
+        }
     }
+
+    if (prof_on)
+        sync_prof_locked(s, chpl_sync_prof_kind_waitEmpty, lineno, filename,
+                         prof_waited, prof_start_ns);
 }
 
 void chpl_sync_markAndSignalFull(chpl_sync_aux_t *s)         // and unlock
@@ -311,6 +399,7 @@ void chpl_sync_initAux(chpl_sync_aux_t *s)
     s->lockers_in   = 0;
     s->lockers_out  = 0;
     s->is_full      = 0;
+    s->prof_owner   = chpl_nullTaskID;
     s->signal_empty = SYNCVAR_EMPTY_INITIALIZER;
     s->signal_full  = SYNCVAR_EMPTY_INITIALIZER;
 }
@@ -0,0 +1,77 @@
+// Check that a VisualDebug data file, in the text or the binary format,
+// holds what chplvis reads back: the header line, the file and function
+// tables, the tags, the tasks and the End record.
+
+use VisualDebug;
+use FileSystem;
+
+config const n = 8;
+config const reps = 500;    // enough tasks to fill several record buffers
+
+var A: [1..n] int;
+
+startVdebug("VDBfmt");
+tagVdebug("fill");
+for 1..reps do
+  coforall i in 1..n do A[i] += 1;
+tagVdebug("sum");
+var s = + reduce A;
+pauseVdebug();
+stopVdebug();
+
+writeln("sum: ", s);
+
+var header: string;
+var tables, tagNames, tags, pauses, tasks, ends, bad = 0;
+
+if VisualDebugText {
+  var r = open("VDBfmt/VDBfmt-0", iomode.r).reader();
+  r.readline(header);
+  var line: string;
+  while r.readline(line) {
+    if line.startsWith("Tablesize:") || line.startsWith("FIDNsize:") then
+      tables += 1;
+    else if line.startsWith("tname:") then tagNames += 1;
+    else if line.startsWith("Tag:") then tags += 1;
+    else if line.startsWith("Pause:") then pauses += 1;
+    else if line.startsWith("task:") then tasks += 1;
+    else if line.startsWith("End:") then ends += 1;
+  }
+  r.close();
+} else {
+  var f = open("VDBfmt/VDBfmt-0", iomode.r);
+  var r = f.reader(kind=iokind.native);
+  r.readline(header);
+  const len = f.length();
+  var kind, size: uint(16);
+  while r.offset() < len {
+    r.read(kind, size);
+    if size < 16 || size % 8 != 0 || r.offset() - 4 + size > len {
+      bad += 1;
+      break;
+    }
+    select kind {
+      when 1 do tables += 2;     // one record holds both table sizes
+      when 4 do tagNames += 1;
+      when 7 do ends += 1;
+      when 8 do tags += 1;
+      when 9 do pauses += 1;
+      when 13 do tasks += 1;
+      otherwise do if kind == 0 || kind > 22 then bad += 1;
+    }
+    r.advance(size - 4);
+  }
+  r.close();
+  f.close();
+}
+
+writeln("header: ", header.startsWith("ChplVdebug: ver 1."));
+writeln("table sizes: ", tables);
+writeln("tag names: ", tagNames);
+writeln("tags: ", tags);
+writeln("pauses: ", pauses);
+writeln("tasks: ", tasks >= n * reps);
+writeln("ends: ", ends);
+writeln("bad records: ", bad);
+
+rmTree("VDBfmt");
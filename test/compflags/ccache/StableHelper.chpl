@@ -0,0 +1,13 @@
+module StableHelper {
+  proc bump(x: int) {
+    return x + 1;
+  }
+
+  proc scale(x: real) {
+    return x * 1.5;
+  }
+
+  proc twice(t) {
+    return (t(1) * 2, t(2) * 2);
+  }
+}
@@ -0,0 +1,27 @@
+// Compiling an unchanged program again with --ccache-dir must reuse
+// every object file from the cache.
+
+use StableHelper;
+
+class Shape {
+  proc area() return 0.0;
+}
+
+class Square : Shape {
+  var side: real;
+  proc area() return side * side;
+}
+
+class Circle : Shape {
+  var r: real;
+  proc area() return 3.0 * r * r;
+}
+
+proc main() {
+  var shapes = [new Square(2.0): Shape, new Circle(1.0): Shape];
+  for s in shapes do writeln(s.area());
+  for s in shapes do delete s;
+  writeln(bump(41));
+  writeln(scale(2.0));
+  writeln(twice((1, 2)));
+}
@@ -0,0 +1,40 @@
+// Generated C must not depend on the number of compiler threads.
+// Tuples and records are scalar replaced, and the inner loop's
+// header computation is itself loop invariant.
+
+record R {
+  var a: int;
+  var b: real;
+}
+
+proc sum3(t: 3*int) {
+  var (x, y, z) = t;
+  return x + y + z;
+}
+
+proc swapped(r: R) {
+  var t = (r.b, r.a);
+  return new R(t(2), t(1));
+}
+
+proc nested(n: int, m: int, k: int) {
+  var total = 0;
+  for i in 1..n {
+    var j = 0;
+    while j < m * k {
+      total += i * j + m * k;
+      j += 1;
+    }
+  }
+  return total;
+}
+
+var total = 0;
+for i in 1..10 do
+  total += sum3((i, i+1, i+2));
+writeln(total);
+
+var r = new R(3, 4.5);
+writeln(swapped(r));
+
+writeln(nested(4, 3, 2));
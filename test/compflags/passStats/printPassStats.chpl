@@ -0,0 +1,2 @@
+// Compile with --print-pass-stats; the prediff checks the CSV file.
+writeln("hello");
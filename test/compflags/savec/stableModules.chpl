@@ -0,0 +1,17 @@
+// Editing the body of a function in one module must leave the generated
+// C of every other module unchanged.
+
+use StableHelper;
+
+record Pair {
+  var a: int;
+  var b: real;
+}
+
+proc main() {
+  var p = new Pair(1, 2.0);
+  writeln(p);
+  writeln(bump(41));
+  writeln(scale(p.b));
+  writeln(twice((1, 2)));
+}
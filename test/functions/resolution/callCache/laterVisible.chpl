@@ -0,0 +1,20 @@
+// A function that only becomes visible once a generic function is
+// instantiated: calls resolved before the instantiation must not keep
+// the earlier choice where the new function is the better match.
+
+proc f(x) { writeln("generic f"); }
+
+proc outer(type t) {
+  proc f(x: t) { writeln("nested f ", t:string); }
+  var y: t;
+  f(y);
+  f(1.5);
+}
+
+f(1);
+f(1.5);
+outer(int);
+f(1);
+outer(real);
+f(1.5);
+outer(int);
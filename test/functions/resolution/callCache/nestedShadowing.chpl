@@ -0,0 +1,31 @@
+// Calls from nested blocks that share a visibility root resolve the
+// same way; a block that defines its own f starts a new root whose
+// calls must not reuse the choice made outside it.
+
+proc f(x: int) { writeln("module f ", x); }
+
+proc test() {
+  f(1);
+  {
+    f(2);
+    {
+      proc f(x: int) { writeln("inner f ", x); }
+      f(3);
+      {
+        f(4);
+      }
+    }
+    f(5);
+  }
+  for i in 6..7 {
+    proc f(x: int) { writeln("loop f ", x); }
+    f(i);
+  }
+  if numLocales > 0 {
+    f(8);
+  }
+  f(9);
+}
+
+test();
+f(10);
@@ -0,0 +1,35 @@
+// The same call made from different modules, through a renamed use and
+// with an explicit module scope must each resolve on their own terms.
+
+module A {
+  private proc f(x: int) { writeln("A private f ", x); }
+  proc callF() { f(1); }
+  proc g(x: int) { writeln("A.g ", x); }
+}
+
+module B {
+  proc f(x: int) { writeln("B.f ", x); }
+  proc g(x: int) { writeln("B.g ", x); }
+}
+
+module Main {
+  use A, B;
+
+  proc main() {
+    callF();
+    f(2);
+    A.callF();
+    f(3);
+    A.g(4);
+    B.g(5);
+    {
+      use B only g as h;
+      h(6);
+    }
+    {
+      use A only g as h;
+      h(7);
+    }
+    A.g(8);
+  }
+}
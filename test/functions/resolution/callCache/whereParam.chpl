@@ -0,0 +1,29 @@
+// Where clauses that depend on param values: each param actual picks
+// its own overload even after an earlier call was resolved.
+
+proc sign(param p: int) where p > 0 { return "positive"; }
+proc sign(param p: int) where p == 0 { return "zero"; }
+proc sign(param p: int) where p < 0 { return "negative"; }
+
+record R {
+  param n: int;
+}
+
+proc R.kind() where n > 1 { return "many"; }
+proc R.kind() where n == 1 { return "one"; }
+
+proc twice(param p: int) { return sign(2 * p); }
+
+writeln(sign(1));
+writeln(sign(0));
+writeln(sign(1));
+writeln(sign(-3));
+writeln(twice(0));
+writeln(twice(-1));
+writeln(twice(1));
+
+var one: R(1);
+var three: R(3);
+writeln(one.kind());
+writeln(three.kind());
+writeln(one.kind());
@@ -0,0 +1,90 @@
+use IO;
+
+config const n = 100000;
+config const path = "copyFrom.txt";
+config const path2 = "copyFrom2.txt";
+
+proc check(f:file, expect:string) {
+  var r = f.reader();
+  var got:string;
+  r.readstring(got);
+  r.close();
+  if got != expect then
+    writeln("mismatch: expected ", expect.length, " bytes, got ", got.length);
+  else
+    writeln("ok ", got.length);
+}
+
+var data:string;
+for i in 1..n do data += (i % 10):string;
+
+{
+  var f = open(path, iomode.cw);
+  var w = f.writer();
+  w.write(data);
+  w.close();
+  f.close();
+}
+
+var src = open(path, iomode.r);
+
+// whole-file copy between two files
+{
+  var dst = open(path2, iomode.cwr);
+  var w = dst.writer();
+  var r = src.reader();
+  writeln(w.copyFrom(r));
+  r.close();
+  w.close();
+  check(dst, data);
+  dst.close();
+}
+
+// partial copies, after the source has been read from and the
+// destination has been written to
+{
+  var dst = open(path2, iomode.cwr);
+  var w = dst.writer();
+  var r = src.reader();
+  var prefix:string;
+  r.readstring(prefix, 10);
+  w.write("header");
+  writeln(w.copyFrom(r, 1000));
+  w.write("middle");
+  writeln(w.copyFrom(r, 5));
+  r.close();
+  w.close();
+  check(dst, "header" + data[11..1010] + "middle" + data[1011..1015]);
+  dst.close();
+}
+
+// copying into a memory file uses the buffered path
+{
+  var mem = openmem();
+  var w = mem.writer();
+  var r = src.reader();
+  writeln(w.copyFrom(r));
+  r.close();
+  w.close();
+  check(mem, data);
+  mem.close();
+}
+
+// as does copying from a memory file into a file
+{
+  var mem = openmem();
+  var mw = mem.writer();
+  mw.write(data);
+  mw.close();
+  var dst = open(path2, iomode.cwr);
+  var w = dst.writer();
+  var r = mem.reader();
+  writeln(w.copyFrom(r, n/2));
+  r.close();
+  w.close();
+  check(dst, data[1..n/2]);
+  dst.close();
+  mem.close();
+}
+
+src.close();
@@ -0,0 +1,59 @@
+use Gzip;
+
+config const n = 100000;
+config const fileName = "gzip-roundtrip.gz";
+
+proc writeCompressed(threads:int, blockSize:int) {
+  var f = open(fileName, iomode.cw);
+  var gz = openGzip(f, iomode.cw, threads=threads, blockSize=blockSize);
+  var w = gz.writer();
+  for i in 1..n do
+    w.writeln("line ", i);
+  w.close();
+  gz.close();
+  f.close();
+}
+
+proc checkCompressed() {
+  var f = open(fileName, iomode.r);
+  var compressedSize = f.length();
+  var gz = openGzip(f, iomode.r);
+  var r = gz.reader();
+  var word:string;
+  var i:int;
+  var count = 0;
+  while r.read(word, i) {
+    count += 1;
+    if word != "line" || i != count then
+      halt("mismatch at line ", count);
+  }
+  r.close();
+  gz.close();
+  f.close();
+  return (count, compressedSize);
+}
+
+for (threads, blockSize) in [(1, defaultBlockSize), (4, 4096), (3, 1000)] {
+  writeCompressed(threads, blockSize);
+  var (count, compressedSize) = checkCompressed();
+  writeln("threads=", threads, " read ", count, " lines; compressed: ",
+          compressedSize < 7*n);
+}
+
+// an empty stream is still a valid gzip file
+{
+  var f = open(fileName, iomode.cw);
+  var gz = openGzip(f, iomode.cw, threads=2);
+  gz.close();
+  f.close();
+  writeln("empty: ", checkCompressed()(1));
+}
+
+// only r and cw make sense for a compression filter
+{
+  var f = open(fileName, iomode.r);
+  var err:syserr;
+  var gz = openGzip(err, f, iomode.rw);
+  writeln("rw: ", err == EINVAL);
+  f.close();
+}
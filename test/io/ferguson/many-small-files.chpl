@@ -0,0 +1,37 @@
+/*
+   Open, write, and read back a small file many times.
+
+   Each open creates short-lived channels that allocate iobufs, so
+   this measures how well released iobufs are reused.
+   Run with CHPL_RT_IOBUF_POOL_STATS=true to see pool hit rates.
+*/
+use Time;
+
+config const n = 1000;
+config const printTimings = false;
+config const fileName = "many-small-files.txt";
+
+var t: Timer;
+var total = 0;
+
+t.start();
+for i in 1..n {
+  var f = open(fileName, iomode.cwr);
+  var w = f.writer();
+  w.writeln(i);
+  w.close();
+
+  var r = f.reader();
+  var got: int;
+  r.readln(got);
+  r.close();
+  f.close();
+
+  total += got;
+}
+t.stop();
+
+if printTimings then
+  writeln("open-write-read time: ", t.elapsed());
+
+writeln("read back ", n, " files, total ", total);
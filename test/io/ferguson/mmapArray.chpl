@@ -0,0 +1,44 @@
+config const fileName = "mmapArray.bin";
+
+const D = {1..3, 1..4};
+var A: [D] int;
+for (i,j) in D do A[i,j] = 10*i + j;
+
+var f = open(fileName, iomode.cwr);
+
+{
+  var w = f.writer(kind=ionative);
+  w.write(0:int); // skipped by the views below
+  w.write(A);
+  w.close();
+}
+
+{
+  var B = f.mmapArray(int, D, start=numBytes(int), hints=IOHINT_SEQUENTIAL);
+  writeln(B);
+  assert(B == A);
+  writeln(+ reduce B);
+}
+
+{
+  var C = f.mmapArray(int, {0..#12}, start=numBytes(int), copyOnWrite=true);
+  C[0] = 99;
+  writeln(C);
+}
+
+// an empty region maps nothing, even past the end of the file
+{
+  var E = f.mmapArray(int, {1..0}, start=1000);
+  writeln(E.numElements);
+}
+
+// the copy-on-write change must not reach the file
+{
+  var r = f.reader(kind=ionative, start=numBytes(int));
+  var B: [D] int;
+  r.read(B);
+  writeln(B);
+  assert(B == A);
+}
+
+f.close();
@@ -0,0 +1,6 @@
+// The byte length of the mapping doesn't fit in an int(64).
+config const fileName = "mmapArrayOverflow.bin";
+
+var f = open(fileName, iomode.cwr);
+var A = f.mmapArray(int, {0..#(max(int)/4)});
+writeln(A.numElements);
@@ -0,0 +1,7 @@
+// start + the byte length overflows an int(64); this is past the end
+// of the file rather than a wrapped-around offset.
+config const fileName = "mmapArrayPastEnd.bin";
+
+var f = open(fileName, iomode.cwr);
+var A = f.mmapArray(int, {0..#4}, start=max(int) - 8);
+writeln(A.numElements);
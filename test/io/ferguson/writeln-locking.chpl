@@ -0,0 +1,39 @@
+/*
+   Compare writeln throughput on a channel with locking=true
+   against one with locking=false when only one task writes.
+
+   A locking channel still locks around each call, but since only
+   this task ever uses it, the lock stays biased toward this task
+   and the two should be close.
+*/
+use Time;
+
+config const n = 10000;
+config const printTimings = false;
+config const fileName = "writeln-locking.txt";
+
+proc timeWriteln(param locking: bool) {
+  var f = open(fileName, iomode.cw);
+  var w = f.writer(locking=locking);
+  var t: Timer;
+
+  t.start();
+  for i in 1..n do
+    w.writeln(i);
+  w.flush();
+  t.stop();
+
+  w.close();
+  f.close();
+  return t.elapsed();
+}
+
+const lockingTime = timeWriteln(locking=true);
+const nonLockingTime = timeWriteln(locking=false);
+
+if printTimings {
+  writeln("locking=true: ", lockingTime);
+  writeln("locking=false: ", nonLockingTime);
+}
+
+writeln("wrote ", n, " lines to each channel");
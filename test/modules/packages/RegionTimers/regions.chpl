@@ -0,0 +1,23 @@
+use RegionTimers;
+
+config const n = 3;
+
+// Times are not deterministic, so only check the paths and counts.
+for i in 1..n {
+  regionBegin("step");
+  regionBegin("halo");
+  regionEnd("halo");
+  coforall t in 1..2 {
+    regionBegin("work");
+    regionBegin("inner");
+    regionEnd("inner");
+    regionEnd("work");
+  }
+  regionBegin("compute");
+  regionEnd("compute");
+  regionEnd("step");
+}
+
+for s in getRegionSummary() do
+  writeln(s.path, " ", s.calls, " ", s.minTime <= s.avgTime,
+          " ", s.avgTime <= s.maxTime);
@@ -0,0 +1,15 @@
+use RegionTimers;
+
+config const n = 3;
+
+// The summary is printed at exit, and the tables are freed after it.
+for i in 1..n {
+  regionBegin("step");
+  regionBegin("halo");
+  regionEnd("halo");
+  coforall t in 1..2 {
+    regionBegin("work");
+    regionEnd("work");
+  }
+  regionEnd("step");
+}
@@ -0,0 +1,58 @@
+use CommDiagnostics;
+
+// Check that the per-destination counts and the histograms agree with
+// the aggregate counts, whatever comm layer and number of locales.
+
+var A: [1..1000] int;
+
+setCommLatencySampling(1);
+resetCommDiagnostics();
+startCommDiagnostics();
+on Locales[numLocales-1] {
+  var B: [1..1000] int = 1;
+  A = B;
+  B = A;
+}
+stopCommDiagnostics();
+setCommLatencySampling(0);
+
+const D = getCommDiagnostics();
+const M = getCommMatrix();
+const getSize = getCommHistogram(commHistogram.getSize);
+const putSize = getCommHistogram(commHistogram.putSize);
+const getLat = getCommHistogram(commHistogram.getLatency);
+const putLat = getCommHistogram(commHistogram.putLatency);
+const onLat = getCommHistogram(commHistogram.executeOnLatency);
+
+writeln(M.domain == {0..#numLocales, 0..#numLocales});
+
+for src in LocaleSpace {
+  const gets = + reduce [dst in LocaleSpace] M[src, dst].get;
+  const puts = + reduce [dst in LocaleSpace] M[src, dst].put;
+  const ons = + reduce [dst in LocaleSpace] M[src, dst].execute_on;
+  const d = D[src];
+
+  if gets != d.get + d.get_nb then
+    writeln(src, ": get counts do not match");
+  if puts != d.put + d.put_nb then
+    writeln(src, ": put counts do not match");
+  if ons != d.execute_on + d.execute_on_fast + d.execute_on_nb then
+    writeln(src, ": execute_on counts do not match");
+  if M[src, src].get + M[src, src].put + M[src, src].execute_on != 0 then
+    writeln(src, ": counted comm with itself");
+  if (+ reduce getSize[src, ..]) != gets then
+    writeln(src, ": get size histogram does not match");
+  if (+ reduce putSize[src, ..]) != puts then
+    writeln(src, ": put size histogram does not match");
+  if (+ reduce getLat[src, ..]) != d.get then
+    writeln(src, ": get latency histogram does not match");
+  if (+ reduce putLat[src, ..]) != d.put then
+    writeln(src, ": put latency histogram does not match");
+  if (+ reduce onLat[src, ..]) != d.execute_on + d.execute_on_fast then
+    writeln(src, ": execute_on latency histogram does not match");
+}
+
+resetCommDiagnostics();
+const Z = getCommMatrix();
+writeln(+ reduce [e in Z] (e.get + e.put + e.execute_on));
+writeln(+ reduce getCommHistogram(commHistogram.getSize));
@@ -0,0 +1 @@
+fft-timecomp.chpl
\ No newline at end of file
@@ -0,0 +1 @@
+../../../release/examples/benchmarks/lulesh/lulesh.chpl
\ No newline at end of file
@@ -0,0 +1,23 @@
+// Do a fixed number of GETs and PUTs of a fixed size from locale 0 to
+// locale 1 with CHPL_RT_COMM_TRACE on.  The prediff replays the trace
+// with util/devel/commReplay.chpl and checks its totals.
+
+use CPtr;
+
+config const n = 10;
+config const nbytes = 1000;
+
+var remote: c_void_ptr;
+on Locales[1] do remote = c_malloc(uint(8), nbytes): c_void_ptr;
+const rbuf = remote: c_ptr(uint(8));
+var buf = c_malloc(uint(8), nbytes);
+
+for 1..n {
+  __primitive("chpl_comm_put", buf, 1, rbuf, nbytes: size_t);
+  __primitive("chpl_comm_get", buf, 1, rbuf, nbytes: size_t);
+}
+
+c_free(buf);
+on Locales[1] do c_free(rbuf);
+
+writeln("done");
@@ -0,0 +1,26 @@
+config const n = 1000;
+
+iter onlyStandalone(n: int) {
+  for i in 1..n do yield i;
+}
+
+iter onlyStandalone(param tag: iterKind, n: int)
+    where tag == iterKind.standalone {
+  forall i in 1..n do yield i;
+}
+
+var A: [1..n] int;
+
+for 1..3 do
+  forall i in 1..n do A[i] += i;
+
+forall (a, i) in zip(A, 1..n) do a += i;
+
+coforall t in 1..4 do A[t] += 1;
+
+forall i in onlyStandalone(n) do A[i] += 1;
+
+forall i in 0..3 do
+  forall j in 1..n/4 do A[i*n/4 + j] += 1;
+
+writeln(+ reduce A);
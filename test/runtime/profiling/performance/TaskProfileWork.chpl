@@ -0,0 +1,36 @@
+/*
+   Spawn many small tasks, some of which block on a sync variable.
+
+   taskSpawn runs this with the task profiler off and taskSpawnProfiled
+   with CHPL_RT_TASK_PROFILE set, so the ratio of their times is the
+   profiler's overhead on a task-heavy program.
+*/
+module TaskProfileWork {
+  use Time;
+
+  config const numTrials = 1000;
+  config const printTimings = false;
+
+  proc run() {
+    const numTasks = 4 * here.maxTaskPar;
+    var total: sync int = 0;
+    var t: Timer;
+
+    t.start();
+    for 1..numTrials {
+      coforall i in 1..numTasks do
+        total.writeEF(total.readFE() + i);
+      sync {
+        for 1..numTasks do
+          begin { }
+      }
+    }
+    t.stop();
+
+    if printTimings then
+      writeln("Elapsed time: ", t.elapsed());
+
+    writeln("total ok: ",
+            total.readFE() == numTrials * numTasks * (numTasks + 1) / 2);
+  }
+}
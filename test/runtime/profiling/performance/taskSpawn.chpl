@@ -0,0 +1,4 @@
+// The task profiler's baseline: TaskProfileWork without the profiler.
+use TaskProfileWork;
+
+run();
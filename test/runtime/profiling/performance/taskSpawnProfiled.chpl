@@ -0,0 +1,5 @@
+// TaskProfileWork with the task profiler on (see the .execenv), to
+// compare against taskSpawn.
+use TaskProfileWork;
+
+run();
@@ -0,0 +1,13 @@
+// Spend a second or so of CPU time in one function, so that the stack
+// profile written at exit has samples in it.
+
+config const n = 200000000;
+
+proc spin(n: int): int {
+  var x = 0;
+  for i in 1..n do
+    x = (x * 31 + i) % 1000003;
+  return x;
+}
+
+writeln(spin(n) >= 0);
@@ -0,0 +1,4 @@
+// A 1 Hz sampling rate is a one second timer period; the profiler must
+// start its timer without warning.
+
+writeln("done");
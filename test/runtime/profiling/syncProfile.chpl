@@ -0,0 +1,14 @@
+// Use a sync variable from a single task in a fixed pattern, so that the
+// contention profile has known operation counts and no transfers.
+
+config const n = 10;
+
+var s: sync int;
+var total = 0;
+
+for i in 1..n {
+  s.writeEF(i);
+  total += s.readFE();
+}
+
+writeln(total);
@@ -0,0 +1,16 @@
+// Spawn a known number of tasks from a coforall and a begin, so that the
+// task profile written at exit has fixed spawn and run counts.
+
+config const n = 8;
+
+var A: [1..n] int;
+
+coforall i in 1..n do
+  A[i] = i;
+
+sync {
+  for i in 1..3 do
+    begin A[i] += 1;
+}
+
+writeln(+ reduce A);
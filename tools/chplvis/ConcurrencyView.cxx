@@ -58,6 +58,9 @@ void ConcurrencyView::updateData (long loc, long tag)
   char tmp[2084];
   localeNum = loc;
   tagNum = tag;
+  // A locale's tasks are not loaded until they are first shown.  If
+  // they can't be loaded, loadDetail has said why and the view is empty.
+  (void)VisData.loadDetail(loc);
   curTag = VisData.getTagData(tagNum);
   snprintf(tmp, sizeof(tmp), "Concurrency for Locale %ld, tag %s, max %ld, max Clock %f",
            loc, curTag->name, curTag->locales[loc].maxConc,
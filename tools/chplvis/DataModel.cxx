@@ -33,8 +33,10 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 // C++ Libraries
+#include <algorithm>
 #include <set>
 
 #ifndef MAXPATHLEN
@@ -140,12 +142,12 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
   }
   fclose(data);
 
-  // Should make this more parameterized !!!!
-  if (VerMajor != 1 || VerMinor != 2) {
+  // Version 1.2 is the text format, 1.3 the binary one.
+  if (VerMajor != 1 || (VerMinor != 2 && VerMinor != CHPL_VDEBUG_BINARY_VER_MINOR)) {
     if (!fromArgv)
-      fl_alert("VisualDebug data files are not version 1.2.");
+      fl_alert("VisualDebug data files are not version 1.2 or 1.3.");
     else
-      printf("VisualDebug data files are not version 1.2.\n");
+      printf("VisualDebug data files are not version 1.2 or 1.3.\n");
     return 0;
   }
 
@@ -157,34 +159,96 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
 
   // Set the main task ID
   mainTID = tid;
+  mainTask = taskData();
   mainTask.taskRec = new E_task (0, 0, 0, tid, 0, 0, -1, -1);
 
+  // Remember the data set, so loadDetail() can load its events later.
+  free(dataBase);
+  dataBase = strndup(fullfilename, namesize);
+  dataSeq = seq;
+  dataFromArgv = fromArgv;
+  haveDetail.assign(nlocales, false);
+
+  // The index file is named after the data files, e.g. the index for
+  // dir/name-0 ... dir/name-n is dir/name.idx.
+  char idxName[namesize+5];
+  snprintf (idxName, sizeof(idxName), "%.*s.idx", namesize-1, fullfilename);
+
+  if (useIndex && LoadIndex(idxName, dataBase, nlocales, seq))
+    return 1;
+
   // Debug
   std::list<Event *>::iterator itr;
 
+  // Locale 0's file has the file and function name tables that the
+  // other files' records refer to, so it is loaded first.  The rest
+  // are loaded in parallel, each into its own list, and then merged.
+  std::vector<loadState> files(nlocales);
+  fileTbl = NULL;
+  fileTblSize = 0;
+  funcTbl = NULL;
+  funcTblSize = 0;
   for (int i = 0; i < nlocales; i++) {
     snprintf (fname, namesize+15, "%.*s%d", namesize, fullfilename, i);
-    if (!LoadFile(fname, i, seq)) {
+    files[i].fileName = strdup(fname);
+    files[i].rv = 0;
+    files[i].readTables = i == 0;
+  }
+
+  files[0].rv = LoadFile(files[0].fileName, 0, seq, files[0]);
+  if (files[0].rv && nlocales > 1) {
+    loadJob job;
+    job.dm = this;
+    job.files = &files;
+    job.seq = seq;
+    job.next = 1;
+    pthread_mutex_init(&job.lock, NULL);
+
+    long nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nthreads > nlocales - 1) nthreads = nlocales - 1;
+    if (nthreads < 1) nthreads = 1;
+    std::vector<pthread_t> threads(nthreads);
+    long started = 0;
+    for (long t = 1; t < nthreads; t++) {
+      if (pthread_create(&threads[t], NULL, loadFiles, &job) != 0)
+        break;
+      started = t;
+    }
+    (void)loadFiles(&job);
+    for (long t = 1; t <= started; t++)
+      pthread_join(threads[t], NULL);
+    pthread_mutex_destroy(&job.lock);
+  }
+
+  for (int i = 0; i < nlocales; i++) {
+    if (!files[i].rv) {
       if (!fromArgv)
-        fl_message ("Error processing data from %s", fname);
+        fl_message ("Error processing data from %s", files[i].fileName);
       else
-        fl_message ("Error processing data from %s\n", fname);
+        fl_message ("Error processing data from %s\n", files[i].fileName);
+      for (int j = 0; j < nlocales; j++) {
+        for (itr = files[j].events.begin(); itr != files[j].events.end(); itr++)
+          delete *itr;
+        free((void *)files[j].fileName);
+      }
       numLocales = -1;
       return 0;
     }
-    // Debug
-    /*
+  }
 
-    printf ("\nAfter file %s\n", fname);
-    itr = theEvents.begin();
-    while (itr != theEvents.end()) {
-      (*itr)->print();
-      itr++;
-    }
-    printf ("---------------\n");
-    */
+  mergeEvents(files);
+  for (int i = 0; i < nlocales; i++)
+    free((void *)files[i].fileName);
 
+  // Debug
+  /*
+  itr = theEvents.begin();
+  while (itr != theEvents.end()) {
+    (*itr)->print();
+    itr++;
   }
+  printf ("---------------\n");
+  */
 
   // Build data structures, taglist: comms/tag
 
@@ -205,12 +269,23 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
     delete [] taskTimeline;
   taskTimeline = new std::list<std::pair<Tl_Kind,long> >[numLocales];
 
+  if (utagList != NULL) {
+    for (unsigned int ix = 0; ix < name2tag.size(); ix++)
+      delete utagList[ix];
+    delete [] utagList;
+    utagList = NULL;
+  }
+  name2tag.clear();
+  uniqueTags = true;
+
   int cTagNo = TagStart;
   tagData *curTag = tagList[1];
 
   // printf ("number of events %ld\n", (long)theEvents.size());
   // int DebC = 0;
 
+  // The times, communication and function counts.  What needs the
+  // tasks is done by buildDetail() below.
   itr = theEvents.begin();
   while (itr != theEvents.end()) {
 
@@ -224,8 +299,6 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
     E_comm   *cp = NULL;
     E_fork   *fp = NULL;
     E_task   *tp = NULL;
-    E_begin_task *btp = NULL;
-    E_end_task   *etp = NULL;
 
     Event *ev = *itr;
     int curNodeId = ev->nodeId();
@@ -286,13 +359,6 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
           if (curTag->maxClock < curTag->locales[curNodeId].clockTime) {
             curTag->maxClock = curTag->locales[curNodeId].clockTime;
           }
-          { // Remove the task record that started the "end record"
-            std::map<long,taskData>::iterator it;
-            it = curTag->locales[curNodeId].tasks.find(gp->vdbTid());
-            if (it != curTag->locales[curNodeId].tasks.end()) {
-                curTag->locales[curNodeId].tasks.erase((*it).first);
-            }
-          }
         }
         break;
 
@@ -315,14 +381,6 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
           if (curTag->maxClock < curTag->locales[curNodeId].clockTime) {
             curTag->maxClock = curTag->locales[curNodeId].clockTime;
           }
-          // Remove last task to with Begin Rec but no End Rec
-          { // Remove the task record that started the "end record"
-            std::map<long,taskData>::iterator it;
-            it = curTag->locales[curNodeId].tasks.find(pp->vdbTid());
-            if (it != curTag->locales[curNodeId].tasks.end()) {
-                curTag->locales[curNodeId].tasks.erase((*it).first);
-            }
-          }
           // For 2nd time through loop, do the same thing for All
           curTag = tagList[0];
         }
@@ -347,13 +405,6 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
           if (curTag->maxClock < curTag->locales[curNodeId].clockTime) {
             curTag->maxClock = curTag->locales[curNodeId].clockTime;
           }
-          { // Remove the task record that started the "end record"
-            std::map<long,taskData>::iterator it;
-            it = curTag->locales[curNodeId].tasks.find(ep->vdbTid());
-            if (it != curTag->locales[curNodeId].tasks.end()) {
-                curTag->locales[curNodeId].tasks.erase((*it).first);
-            }
-          }
           // For 2nd time through loop, do the same thing for All
           curTag = tagList[0];
         }
@@ -374,7 +425,189 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
           // For 2nd time through loop, do the same thing for All
           curTag = tagList[0];
         }
+        break;
+
+      case Ev_fork:
+        fp = (E_fork *)ev;
+        for (int i = 0; i < 2; i++) {
+          if (++(curTag->comms[fp->srcId()][fp->dstId()].numComms) > curTag->maxComms)
+            curTag->maxComms = curTag->comms[fp->srcId()][fp->dstId()].numComms;
+          curTag->comms[fp->srcId()][fp->dstId()].commSize += fp->argSize();
+          if (curTag->comms[fp->srcId()][fp->dstId()].commSize > curTag->maxSize)
+            curTag->maxSize = curTag->comms[fp->srcId()][fp->dstId()].commSize;
+          curTag->comms[fp->srcId()][fp->dstId()].numForks++;
+          // For 2nd time through loop, do the same thing for All
+          curTag = tagList[0];
+        }
+
+        // function event
+        {
+          long thisId = fp->funcId();
+          if (thisId >= 0 && thisId < funcTblSize) {
+            funcTbl[thisId].noOnTasks++;
+          } else {
+            fprintf (stderr, "On Call data error, On call for function ID %ld\n.",
+                     thisId);
+          }
+        }
+        break;
+
+      case Ev_task:
+        tp = (E_task *)ev;
+        // function event
+        {
+          long thisId = tp->funcId();
+          if (thisId >= 0 && thisId < funcTblSize) {
+            funcTbl[thisId].noTasks++;
+          } else {
+            fprintf (stderr, "Task data error, On call for function ID %ld.\n",
+                     thisId);
+          }
+        }
+        break;
+
+      case Ev_begin_task:
+      case Ev_end_task:
+        break;
+
+      default:
+        // Shouldn't get here
+        assert(false);
+    }
+    // Move to next event record
+    itr++;
+  }
+
+  // The tasks, the timelines and the concurrency
+  buildDetail(theEvents, true);
+
+  // Go back and update task counts
+  // printf ("Updating task counts ..\n");
+  tagList[0]->locales[0].numTasks = 1;
+  for (int ix_l = 1; ix_l < nlocales; ix_l++) {
+    tagList[0]->locales[ix_l].numTasks = 0;
+  }
+  for (int ix_t = -1; ix_t < numTags; ix_t++) {
+    curTag = tagList[ix_t+2];
+    curTag->maxTasks = 0;
+    for (int ix_l = 0; ix_l < nlocales; ix_l++) {
+      curTag->locales[ix_l].numTasks = curTag->locales[ix_l].tasks.size()
+        + (ix_l == 0 ? 1 : 0 );
+      if (curTag->locales[ix_l].numTasks > curTag->maxTasks)
+        curTag->maxTasks = curTag->locales[ix_l].numTasks;
+      // Calculate total tasks.   Don't count "main" over and over.
+      tagList[0]->locales[ix_l].numTasks += curTag->locales[ix_l].numTasks - (ix_l == 0 ? 1 : 0);
+      if (tagList[0]->locales[ix_l].numTasks > tagList[0]->maxTasks)
+        tagList[0]->maxTasks = tagList[0]->locales[ix_l].numTasks;
+    }
+  }
+
+  // If duplicate tags, build unique tag information
+  mapTagNames();
+  buildUniqueTags();
+
+#if 0
+  // Debug print of full DB
+  printf ("Final Events DB.\n");
+  itr = theEvents.begin();
+  while (itr != theEvents.end()) {
+    (*itr)->print();
+    itr++;
+  }
+
+  // Timeline debug
+  printf ("\nTimeline for node 0.\n");
+  std::list<timelineEntry>::iterator tl_itr = taskTimeline[0].begin();
+  while (tl_itr != taskTimeline[0].end()) {
+    switch (tl_itr->first) {
+      case Tl_Tag: printf ("Tag: %ld\n", tl_itr->second); break;
+      case Tl_Begin: printf ("Begin: %ld\n", tl_itr->second); break;
+      case Tl_End: printf ("End: %ld\n", tl_itr->second); break;
+    }
+    tl_itr++;
+  }
+
 
+  // Debug print the finished function table  (need to add comm size?)
+  printf ("\nFunction table information.\n");
+  for (int ix = 0 ; ix < funcTblSize; ix++)
+    printf ("function '%s', %lu events, %ld tasks, %ld onCalls,"
+            " %ld gets, %ld puts, clock %lf, file %s, line %ld\n",
+            funcTbl[ix].name, funcTbl[ix].func_events.size(), funcTbl[ix].noTasks,
+            funcTbl[ix].noOnTasks, funcTbl[ix].noGets, funcTbl[ix].noPuts,
+            funcTbl[ix].clockTime,
+            fileTbl[funcTbl[ix].fileNo].name, funcTbl[ix].lineNo);
+#endif
+
+  startClock = theEvents.empty() ? 0 : (*theEvents.begin())->clock_time();
+  haveDetail.assign(nlocales, true);
+  if (useIndex)
+    WriteIndex(idxName, dataBase, seq);
+
+  return 1;
+}
+
+
+// Build the task data from events in merged order: the task maps, the
+// task times, the timelines and the per task communication lists.  The
+// events can be those of every locale, or of just the ones whose
+// detail is being loaded.  With summaries, also compute what in the
+// summaries depends on the tasks: concurrency, task clocks, function
+// times and communication counts, and the buckets.  End task records
+// for unknown tasks are removed from events.
+
+void DataModel::buildDetail (std::list<Event *> &events, bool summaries)
+{
+  std::vector<int> tagNo(numLocales, (int)TagStart); // current tag per locale
+  std::vector<bool> running(numLocales, false);
+  std::list<Event *>::iterator itr;
+
+  itr = events.begin();
+  while (itr != events.end()) {
+    E_tag    *gp = NULL;
+    E_comm   *cp = NULL;
+    E_fork   *fp = NULL;
+    E_task   *tp = NULL;
+    E_begin_task *btp = NULL;
+    E_end_task   *etp = NULL;
+
+    Event *ev = *itr;
+    int curNodeId = ev->nodeId();
+    int cTagNo = tagNo[curNodeId];
+    tagData *curTag = tagList[cTagNo+2];
+    long vdbTid;
+
+    switch (ev->Ekind()) {
+
+      case Ev_start:
+        running[curNodeId] = true;
+        break;
+
+      case Ev_tag:
+        gp = (E_tag *)ev;
+        // Remove the task record that started the tag record
+        if (running[curNodeId])
+          curTag->locales[curNodeId].tasks.erase(gp->vdbTid());
+        tagNo[curNodeId] = gp->tagNo();
+        running[curNodeId] = true;
+        break;
+
+      case Ev_pause:
+      case Ev_end:
+        // Remove the task record that started the pause or end record
+        if (ev->Ekind() == Ev_pause)
+          vdbTid = ((E_pause *)ev)->vdbTid();
+        else
+          vdbTid = ((E_end *)ev)->vdbTid();
+        curTag->locales[curNodeId].tasks.erase(vdbTid);
+        tagList[0]->locales[curNodeId].tasks.erase(vdbTid);
+        running[curNodeId] = false;
+        break;
+
+      case Ev_comm:
+        if (!summaries)
+          break;
+        cp = (E_comm *)ev;
         // function communication
         {
           taskData *task;
@@ -408,27 +641,11 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
 
       case Ev_fork:
         fp = (E_fork *)ev;
-        for (int i = 0; i < 2; i++) {
-          if (++(curTag->comms[fp->srcId()][fp->dstId()].numComms) > curTag->maxComms)
-            curTag->maxComms = curTag->comms[fp->srcId()][fp->dstId()].numComms;
-          curTag->comms[fp->srcId()][fp->dstId()].commSize += fp->argSize();
-          if (curTag->comms[fp->srcId()][fp->dstId()].commSize > curTag->maxSize)
-            curTag->maxSize = curTag->comms[fp->srcId()][fp->dstId()].commSize;
-          curTag->comms[fp->srcId()][fp->dstId()].numForks++;
-          // For 2nd time through loop, do the same thing for All
-          curTag = tagList[0];
-        }
-
         // function event
         {
           long thisId = fp->funcId();
-          if (thisId >= 0 && thisId < funcTblSize) {
+          if (thisId >= 0 && thisId < funcTblSize)
             funcTbl[thisId].func_events.push_back(ev);
-            funcTbl[thisId].noOnTasks++;
-          } else {
-            fprintf (stderr, "On Call data error, On call for function ID %ld\n.",
-                     thisId);
-          }
         }
         break;
 
@@ -456,13 +673,8 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
         // function event
         {
           long thisId = tp->funcId();
-          if (thisId >= 0 && thisId < funcTblSize) {
+          if (thisId >= 0 && thisId < funcTblSize)
             funcTbl[thisId].func_events.push_back(ev);
-            funcTbl[thisId].noTasks++;
-          } else {
-            fprintf (stderr, "Task data error, On call for function ID %ld.\n",
-                     thisId);
-          }
         }
         break;
 
@@ -470,9 +682,16 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
         btp = (E_begin_task *)ev;
         {
           std::map<long,taskData>::iterator it;
-          // Find task in task map
+          // Find task in task map, it may have been created before
+          // the current tag.
+          int tryTagNo = cTagNo;
           it = curTag->locales[curNodeId].tasks.find(btp->taskId());
-          if (it != curTag->locales[curNodeId].tasks.end()) {
+          while (it == tagList[tryTagNo+2]->locales[curNodeId].tasks.end()
+                 && tryTagNo > DataModel::TagStart) {
+            tryTagNo--;
+            it = tagList[tryTagNo+2]->locales[curNodeId].tasks.find(btp->taskId());
+          }
+          if (it != tagList[tryTagNo+2]->locales[curNodeId].tasks.end()) {
             // Update the begin record
             (*it).second.beginRec = btp;
             // Initialize the task time
@@ -497,18 +716,15 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
             while (tryTagNo > DataModel::TagALL) {
               it = tagList[tryTagNo+2]->locales[curNodeId].tasks.find(etp->taskId());
               if (it != tagList[tryTagNo+2]->locales[curNodeId].tasks.end()) {
-                it->second.endRec = etp;
-                it->second.endTagNo = cTagNo;
                 validEnd = true;
                 break;
               }
               tryTagNo--;
             }
             if (!validEnd) { // Erase this end record
-              itr = theEvents.erase(itr);
-              if (itr != theEvents.begin())
-                itr--;
-              break;
+              delete ev;
+              itr = events.erase(itr);
+              continue;
             }
           }
 
@@ -517,13 +733,26 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
           it->second.endRec = etp;
           it->second.endTagNo = cTagNo;
           // Set task times
-          taskTime = it->second.endRec->clock_time() - it->second.beginRec->clock_time();
+          if (it->second.beginRec != NULL)
+            taskTime = it->second.endRec->clock_time() - it->second.beginRec->clock_time();
+          else
+            taskTime = 0;
           it->second.taskClock = taskTime;
+          if (!summaries)
+            break;
           if (curTag->locales[curNodeId].maxTaskClock < taskTime)
             curTag->locales[curNodeId].maxTaskClock = taskTime;
           if (tagList[0]->locales[curNodeId].maxTaskClock < taskTime)
             tagList[0]->locales[curNodeId].maxTaskClock = taskTime;
-          funcTbl[it->second.taskRec->funcId()].clockTime += taskTime;
+          {
+            long thisId = -1;
+            if (it->second.taskRec)
+              thisId = it->second.taskRec->funcId();
+            if (thisId >= 0 && thisId < funcTblSize)
+              funcTbl[thisId].clockTime += taskTime;
+            else
+              funcTbl[funcTblSize].clockTime += taskTime;
+          }
         }
         break;
 
@@ -532,45 +761,34 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
         assert(false);
     }
     // Move to next event record
-    if (itr != theEvents.end())
-      itr++;
-  }
-
-  // Go back and update task counts
-  // printf ("Updating task counts ..\n");
-  tagList[0]->locales[0].numTasks = 1;
-  for (int ix_l = 1; ix_l < nlocales; ix_l++) {
-    tagList[0]->locales[ix_l].numTasks = 0;
-  }
-  for (int ix_t = -1; ix_t < numTags; ix_t++) {
-    curTag = tagList[ix_t+2];
-    curTag->maxTasks = 0;
-    for (int ix_l = 0; ix_l < nlocales; ix_l++) {
-      curTag->locales[ix_l].numTasks = curTag->locales[ix_l].tasks.size()
-        + (ix_l == 0 ? 1 : 0 );
-      if (curTag->locales[ix_l].numTasks > curTag->maxTasks)
-        curTag->maxTasks = curTag->locales[ix_l].numTasks;
-      // Calculate total tasks.   Don't count "main" over and over.
-      tagList[0]->locales[ix_l].numTasks += curTag->locales[ix_l].numTasks - (ix_l == 0 ? 1 : 0);
-      if (tagList[0]->locales[ix_l].numTasks > tagList[0]->maxTasks)
-        tagList[0]->maxTasks = tagList[0]->locales[ix_l].numTasks;
-    }
+    itr++;
   }
 
   // Build timeline and set concurrency rates
   // printf ("building timeline ..\n");
-  itr = theEvents.begin();
-  tagList[0]->maxConc = 1;
-  cTagNo = TagStart;
-  curTag = tagList[1];
-  curTag->locales[0].maxConc = 1;
-  curTag->maxConc = 1;
+
+  // Events for the buckets of each locale's current tag, which are
+  // filled in when the tag ends on that locale
+  std::vector< std::vector<bucketEvent> > pending(numLocales);
+  std::vector<double> spanStart(numLocales, 0);
+  std::vector<long> spanConc(numLocales, 0);
+
+  if (summaries) {
+    tagList[0]->maxConc = 1;
+    tagList[1]->locales[0].maxConc = 1;
+    tagList[1]->maxConc = 1;
+  }
+  tagNo.assign(numLocales, (int)TagStart);
+  running.assign(numLocales, false);
 
   // DebC = 0;
 
-  while (itr != theEvents.end()) {
+  itr = events.begin();
+  while (itr != events.end()) {
     Event *ev = *itr;
     int curNodeId = ev->nodeId();
+    int cTagNo = tagNo[curNodeId];
+    tagData *curTag = tagList[cTagNo+2];
     E_tag *tp;
     E_begin_task *btp;
     E_end_task *etp;
@@ -583,29 +801,43 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
       default: // Do nothing
         break;
 
+      case Ev_start:
+        if (summaries) {
+          running[curNodeId] = true;
+          spanStart[curNodeId] = ev->clock_time();
+          spanConc[curNodeId] = curTag->locales[curNodeId].runConc;
+        }
+        break;
+
+      case Ev_pause:
+      case Ev_end:
+        if (summaries && running[curNodeId]) {
+          fillBuckets(curTag->locales[curNodeId], spanStart[curNodeId],
+                      ev->clock_time(), spanConc[curNodeId],
+                      pending[curNodeId]);
+          running[curNodeId] = false;
+        }
+        break;
+
       case Ev_tag:
         tp = (E_tag *)ev;
-        if (curNodeId == 0) {
-          std::map<const char *, int>::iterator t_itr;
-          cTagNo++;
-          curTag = tagList[cTagNo+2];
-          // Check for duplicate tags, map the tag name
-          t_itr = name2tag.find(tp->tagName());
-          if (t_itr != name2tag.end()) {
-            // tag is duplicate
-            uniqueTags = false;
-          } else {
-            // new tag, set a new index for it
-            name2tag[tp->tagName()] = cTagNo;
-          }
-        }
-        assert(cTagNo == tp->tagNo());
+        if (summaries && running[curNodeId])
+          fillBuckets(curTag->locales[curNodeId], spanStart[curNodeId],
+                      ev->clock_time(), spanConc[curNodeId],
+                      pending[curNodeId]);
+        cTagNo = tagNo[curNodeId] = tp->tagNo();
+        curTag = tagList[cTagNo+2];
         taskTimeline[curNodeId].push_back(timelineEntry(Tl_Tag,cTagNo));
+        if (!summaries)
+          break;
         curTag->locales[curNodeId].runConc
           = tagList[cTagNo+1]->locales[curNodeId].runConc;
         curTag->locales[curNodeId].maxConc = curTag->locales[curNodeId].runConc;
         if (curTag->locales[curNodeId].maxConc > curTag->maxConc)
           curTag->maxConc = curTag->locales[curNodeId].maxConc;
+        running[curNodeId] = true;
+        spanStart[curNodeId] = ev->clock_time();
+        spanConc[curNodeId] = curTag->locales[curNodeId].runConc;
         break;
 
       case Ev_begin_task:
@@ -614,6 +846,8 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
             curTag->locales[curNodeId].tasks.end()) {
           // Found this task in the tag, it should be in the timeline
           taskTimeline[curNodeId].push_back(timelineEntry(Tl_Begin,btp->taskId()));
+          if (!summaries)
+            break;
           curTag->locales[curNodeId].runConc++;
           if (curTag->locales[curNodeId].runConc >
               curTag->locales[curNodeId].maxConc) {
@@ -628,6 +862,9 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
                 tagList[0]->maxConc = curTag->maxConc;
             }
           }
+          if (running[curNodeId])
+            pending[curNodeId].push_back(bucketEvent(ev->clock_time(), Bk_Begin,
+                                         curTag->locales[curNodeId].runConc));
         }
         break;
 
@@ -641,7 +878,12 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
                 && tl_itr->second == etp->taskId()) {
               // Found the begin record in the timeline, add the end record
               taskTimeline[curNodeId].push_back(timelineEntry(Tl_End,etp->taskId()));
+              if (!summaries)
+                break;
               curTag->locales[curNodeId].runConc--;
+              if (running[curNodeId])
+                pending[curNodeId].push_back(bucketEvent(ev->clock_time(), Bk_End,
+                                             curTag->locales[curNodeId].runConc));
               break;
             }
             tl_itr++;
@@ -663,13 +905,16 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
           } else
             printf ("per task forks, no task %ld, node %ld, clock %lf\n",
                     (long)fp->inTask(), (long)fp->nodeId(), fp->clock_time());
+          if (summaries && running[curNodeId])
+            pending[curNodeId].push_back(bucketEvent(ev->clock_time(), Bk_Comm, -1));
         }
         break;
 
       case Ev_comm:
         cp = (E_comm *)ev;
         {
-          taskData *theTask = getTaskData(cp->isGet() ? cp->dstId() : cp->srcId(), cp->inTask());
+          int taskNodeId = cp->isGet() ? cp->dstId() : cp->srcId();
+          taskData *theTask = getTaskData(taskNodeId, cp->inTask());
           if (theTask != NULL) {
             // Insert the event
             theTask->commList.push_back(ev);
@@ -684,6 +929,8 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
             cp->print();
             printf ("\n");
           }
+          if (summaries && running[taskNodeId])
+            pending[taskNodeId].push_back(bucketEvent(ev->clock_time(), Bk_Comm, -1));
         }
         break;
     }
@@ -691,108 +938,478 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
     // Move to next event record
     itr++;
   }
+}
 
-  // If duplicate tags, build unique tag information
-  if (!uniqueTags) {
-    int nextUtag;
-    int tTag;
-
-    //printf ("uniq tag no: %lu\n", name2tag.size());
+// Split the events of a tag on a locale, from start to end, into the
+// locale's buckets.  conc is the concurrency at the start.
 
-    // Allocate tage data
-    utagList = new tagData *[name2tag.size()];
-    for (unsigned int ix = 0; ix < name2tag.size(); ix++)
-      utagList[ix] = new tagData(numLocales);
-
-    // All and Start use tagData ... see getUTagData
-    // Now, aggrigate all duplicate tags, tag order is as first seen in tagList
-    nextUtag = 0;   // Should be tag 2 in tagList
-    for (int ix = 2; ix < numTags+2; ix++) {
-      tTag = name2tag[tagList[ix]->name];
-      if (tTag >= nextUtag) {
-        name2tag[tagList[ix]->name] = nextUtag;
-        tTag = nextUtag++;
-        utagList[tTag]->name = tagList[ix]->name;
+void DataModel::fillBuckets (localeData &loc, double start, double end,
+                             long conc, std::vector<bucketEvent> &events)
+{
+  loc.spanStart = start;
+  loc.spanEnd = end;
+  if (events.empty() && conc == 0)
+    return;
+
+  loc.buckets.assign(numBuckets, bucketData());
+  double width = (end - start) / numBuckets;
+  unsigned int ix = 0;
+  for (int b = 0; b < numBuckets; b++) {
+    bucketData &bd = loc.buckets[b];
+    bd.maxConc = conc;
+    // The last bucket takes whatever is left, in case of rounding
+    while (ix < events.size()
+           && (b == numBuckets-1 || events[ix].time < start + (b+1)*width)) {
+      switch (events[ix].kind) {
+        case Bk_Begin: bd.taskBegins++; break;
+        case Bk_End:   bd.taskEnds++;   break;
+        case Bk_Comm:  bd.numComms++;   break;
       }
-      // merge data from tagList[ix] int utagList[tTag]
-      for (int il = 0 ; il < numLocales; il ++ ) {
-        // Ignore "ref" and "run" fields
-        utagList[tTag]->locales[il].userCpu      += tagList[ix]->locales[il].userCpu;
-        utagList[tTag]->locales[il].sysCpu       += tagList[ix]->locales[il].sysCpu;
-        utagList[tTag]->locales[il].Cpu          += tagList[ix]->locales[il].Cpu;
-        utagList[tTag]->locales[il].clockTime    += tagList[ix]->locales[il].clockTime;
-        utagList[tTag]->locales[il].maxTaskClock += tagList[ix]->locales[il].maxTaskClock;
-        utagList[tTag]->locales[il].numTasks     += tagList[ix]->locales[il].numTasks;
-        if (utagList[tTag]->locales[il].maxConc  <  tagList[ix]->locales[il].maxConc)
-          utagList[tTag]->locales[il].maxConc = tagList[ix]->locales[il].maxConc;
-        // Update tag maxes
-        if (utagList[tTag]->locales[il].Cpu > utagList[tTag]->maxCpu)
-          utagList[tTag]->maxCpu = utagList[tTag]->locales[il].Cpu;
-        if (utagList[tTag]->locales[il].clockTime > utagList[tTag]->maxClock)
-          utagList[tTag]->maxClock = utagList[tTag]->locales[il].clockTime;
-        if (utagList[tTag]->locales[il].numTasks > utagList[tTag]->maxTasks)
-          utagList[tTag]->maxTasks = utagList[tTag]->locales[il].numTasks;
-        if (utagList[tTag]->locales[il].maxConc > utagList[tTag]->maxConc)
-          utagList[tTag]->maxConc = utagList[tTag]->locales[il].maxConc;
-        // Communication
-        for (int ic = 0; ic < numLocales; ic++ ) {
-          utagList[tTag]->comms[il][ic].numComms += tagList[ix]->comms[il][ic].numComms;
-          utagList[tTag]->comms[il][ic].numGets  += tagList[ix]->comms[il][ic].numGets;
-          utagList[tTag]->comms[il][ic].numPuts  += tagList[ix]->comms[il][ic].numPuts;
-          utagList[tTag]->comms[il][ic].numForks += tagList[ix]->comms[il][ic].numForks;
-          utagList[tTag]->comms[il][ic].commSize += tagList[ix]->comms[il][ic].commSize;
-          // Maxes
-          if (utagList[tTag]->comms[il][ic].numComms > utagList[tTag]->maxComms)
-            utagList[tTag]->maxComms = utagList[tTag]->comms[il][ic].numComms;
-          if (utagList[tTag]->comms[il][ic].commSize > utagList[tTag]->maxSize)
-            utagList[tTag]->maxSize = utagList[tTag]->comms[il][ic].commSize;
-        }
+      if (events[ix].conc >= 0) {
+        conc = events[ix].conc;
+        if (conc > bd.maxConc)
+          bd.maxConc = conc;
       }
+      ix++;
     }
   }
+  events.clear();
+}
 
-#if 0
-  // Debug print of full DB
-  printf ("Final Events DB.\n");
-  itr = theEvents.begin();
-  while (itr != theEvents.end()) {
-    (*itr)->print();
-    itr++;
+// Map each tag name to the first tag with that name, and note whether
+// any names repeat.
+
+void DataModel::mapTagNames ()
+{
+  for (int ix = 0; ix < numTags; ix++) {
+    const char *name = tagList[ix+2]->name;
+    if (name2tag.find(name) != name2tag.end())
+      uniqueTags = false;
+    else
+      name2tag[name] = ix;
   }
+}
 
-  // Timeline debug
-  printf ("\nTimeline for node 0.\n");
-  std::list<timelineEntry>::iterator tl_itr = taskTimeline[0].begin();
-  while (tl_itr != taskTimeline[0].end()) {
-    switch (tl_itr->first) {
-      case Tl_Tag: printf ("Tag: %ld\n", tl_itr->second); break;
-      case Tl_Begin: printf ("Begin: %ld\n", tl_itr->second); break;
-      case Tl_End: printf ("End: %ld\n", tl_itr->second); break;
+// If tag names repeat, build the merged data for each unique name.
+
+void DataModel::buildUniqueTags ()
+{
+  if (uniqueTags)
+    return;
+
+  int nextUtag;
+  int tTag;
+
+  //printf ("uniq tag no: %lu\n", name2tag.size());
+
+  // Allocate tage data
+  utagList = new tagData *[name2tag.size()];
+  for (unsigned int ix = 0; ix < name2tag.size(); ix++)
+    utagList[ix] = new tagData(numLocales);
+
+  // All and Start use tagData ... see getUTagData
+  // Now, aggrigate all duplicate tags, tag order is as first seen in tagList
+  nextUtag = 0;   // Should be tag 2 in tagList
+  for (int ix = 2; ix < numTags+2; ix++) {
+    tTag = name2tag[tagList[ix]->name];
+    if (tTag >= nextUtag) {
+      name2tag[tagList[ix]->name] = nextUtag;
+      tTag = nextUtag++;
+      utagList[tTag]->name = tagList[ix]->name;
+    }
+    // merge data from tagList[ix] int utagList[tTag]
+    for (int il = 0 ; il < numLocales; il ++ ) {
+      // Ignore "ref" and "run" fields
+      utagList[tTag]->locales[il].userCpu      += tagList[ix]->locales[il].userCpu;
+      utagList[tTag]->locales[il].sysCpu       += tagList[ix]->locales[il].sysCpu;
+      utagList[tTag]->locales[il].Cpu          += tagList[ix]->locales[il].Cpu;
+      utagList[tTag]->locales[il].clockTime    += tagList[ix]->locales[il].clockTime;
+      utagList[tTag]->locales[il].maxTaskClock += tagList[ix]->locales[il].maxTaskClock;
+      utagList[tTag]->locales[il].numTasks     += tagList[ix]->locales[il].numTasks;
+      if (utagList[tTag]->locales[il].maxConc  <  tagList[ix]->locales[il].maxConc)
+        utagList[tTag]->locales[il].maxConc = tagList[ix]->locales[il].maxConc;
+      // Update tag maxes
+      if (utagList[tTag]->locales[il].Cpu > utagList[tTag]->maxCpu)
+        utagList[tTag]->maxCpu = utagList[tTag]->locales[il].Cpu;
+      if (utagList[tTag]->locales[il].clockTime > utagList[tTag]->maxClock)
+        utagList[tTag]->maxClock = utagList[tTag]->locales[il].clockTime;
+      if (utagList[tTag]->locales[il].numTasks > utagList[tTag]->maxTasks)
+        utagList[tTag]->maxTasks = utagList[tTag]->locales[il].numTasks;
+      if (utagList[tTag]->locales[il].maxConc > utagList[tTag]->maxConc)
+        utagList[tTag]->maxConc = utagList[tTag]->locales[il].maxConc;
+      // Communication
+      for (int ic = 0; ic < numLocales; ic++ ) {
+        utagList[tTag]->comms[il][ic].numComms += tagList[ix]->comms[il][ic].numComms;
+        utagList[tTag]->comms[il][ic].numGets  += tagList[ix]->comms[il][ic].numGets;
+        utagList[tTag]->comms[il][ic].numPuts  += tagList[ix]->comms[il][ic].numPuts;
+        utagList[tTag]->comms[il][ic].numForks += tagList[ix]->comms[il][ic].numForks;
+        utagList[tTag]->comms[il][ic].commSize += tagList[ix]->comms[il][ic].commSize;
+        // Maxes
+        if (utagList[tTag]->comms[il][ic].numComms > utagList[tTag]->maxComms)
+          utagList[tTag]->maxComms = utagList[tTag]->comms[il][ic].numComms;
+        if (utagList[tTag]->comms[il][ic].commSize > utagList[tTag]->maxSize)
+          utagList[tTag]->maxSize = utagList[tTag]->comms[il][ic].commSize;
+      }
     }
-    tl_itr++;
   }
+}
 
+// The index file
+//
+// The index holds everything the graph, grid and profile views show:
+// the file and function tables and, for each tag, the per locale times,
+// task counts and concurrency, the buckets and the communication between
+// each pair of locales.  It is a text file:
+//
+//   ChplVisIndex: ver 2 nodes m tags t seq s start tv
+//   data: nid size mtime       one per data file, to tell if it changed
+//   home: CHPL_HOME
+//   dir: compile directory
+//   files: n
+//   file: fileno rel2Home name
+//   funcs: n
+//   func: fid fileno lineno onTasks tasks gets puts clock name
+//   tag: tagno maxCpu maxClock maxTasks maxConc maxComms maxSize name
+//   loc: nid userCpu sysCpu cpu clock maxTaskClock tasks maxConc
+//   bkt: nid start end begins ends comms maxConc ...
+//   comm: src dst comms gets puts forks size
+//   End
+//
+// There are n file and n+1 func lines, the last func being "Unknown".
+// The tags go from -2 (ALL) to t-1, and each is followed by one loc
+// line for each locale and a comm line for each pair of locales that
+// communicated.  A loc line is followed by a bkt line, with the four
+// counts of each of the numBuckets buckets, if the locale has buckets
+// for the tag.  Names are the rest of the line.
+
+static const int indexVersion = 2;
+
+// Read a line, without its newline.  Returns false at end of file.
+
+static bool readIndexLine (FILE *idx, char *line, int size)
+{
+  if (fgets(line, size, idx) != line)
+    return false;
+  int len = strlen(line);
+  if (len > 0 && line[len-1] == '\n')
+    line[len-1] = 0;
+  return true;
+}
 
-  // Debug print the finished function table  (need to add comm size?)
-  printf ("\nFunction table information.\n");
-  for (int ix = 0 ; ix < funcTblSize; ix++)
-    printf ("function '%s', %lu events, %ld tasks, %ld onCalls,"
-            " %ld gets, %ld puts, clock %lf, file %s, line %ld\n",
-            funcTbl[ix].name, funcTbl[ix].func_events.size(), funcTbl[ix].noTasks,
-            funcTbl[ix].noOnTasks, funcTbl[ix].noGets, funcTbl[ix].noPuts,
-            funcTbl[ix].clockTime,
-            fileTbl[funcTbl[ix].fileNo].name, funcTbl[ix].lineNo);
-#endif
+// Check the index header against the data files.  The index is only
+// used if every data file has the size and time it had when the index
+// was written.
+
+bool DataModel::indexIsCurrent (FILE *idx, const char *dataBase,
+                                int nlocales, double seq, int &ntags,
+                                double &start)
+{
+  char line[1024];
+  char fname[MAXPATHLEN];
+  struct stat sb;
+  int ver, inodes;
+  double iseq;
+
+  if (!readIndexLine(idx, line, sizeof(line))
+      || sscanf(line, "ChplVisIndex: ver %d nodes %d tags %d seq %lf start %lf",
+                &ver, &inodes, &ntags, &iseq, &start) != 5
+      || ver != indexVersion || inodes != nlocales || ntags < 0
+      || fabs(seq-iseq) > .01)
+    return false;
+
+  for (int i = 0; i < nlocales; i++) {
+    int nid;
+    long long size, mtime;
+    snprintf (fname, sizeof(fname), "%s%d", dataBase, i);
+    if (!readIndexLine(idx, line, sizeof(line))
+        || sscanf(line, "data: %d %lld %lld", &nid, &size, &mtime) != 3
+        || nid != i || stat(fname, &sb) < 0
+        || (long long)sb.st_size != size || (long long)sb.st_mtime != mtime)
+      return false;
+  }
+  return true;
+}
+
+// Read the summaries from the index instead of loading the events.
+// Returns 0, with nothing changed, if there is no current index.
 
+int DataModel::LoadIndex (const char *idxName, const char *dataBase,
+                          int nlocales, double seq)
+{
+  FILE *idx = fopen(idxName, "r");
+  if (!idx) return 0;
+
+  int newNumTags;
+  double newStartClock;
+  if (!indexIsCurrent(idx, dataBase, nlocales, seq, newNumTags,
+                      newStartClock)) {
+    fclose(idx);
+    return 0;
+  }
+
+  char line[4096];
+  int n, pos;
+  char *home = NULL;
+  char *cdir = NULL;
+  std::vector<filename> files;
+  std::vector<funcInfo> funcs;
+  std::vector<tagData *> tags;
+  bool ok = false;
+
+  do {
+    if (!readIndexLine(idx, line, sizeof(line))
+        || strncmp(line, "home: ", 6) != 0)
+      break;
+    home = strdup(line+6);
+    if (!readIndexLine(idx, line, sizeof(line))
+        || strncmp(line, "dir: ", 5) != 0)
+      break;
+    cdir = strdup(line+5);
+
+    // File and function tables
+    if (!readIndexLine(idx, line, sizeof(line))
+        || sscanf(line, "files: %d", &n) != 1 || n < 0)
+      break;
+    files.resize(n);
+    int ix;
+    for (ix = 0; ix < n; ix++) {
+      int fileno, rel2Home;
+      if (!readIndexLine(idx, line, sizeof(line))
+          || sscanf(line, "file: %d %d %n", &fileno, &rel2Home, &pos) != 2
+          || fileno != ix)
+        break;
+      files[ix].name = strdup(line+pos);
+      files[ix].rel2Home = rel2Home != 0;
+    }
+    if (ix < n)
+      break;
+
+    if (!readIndexLine(idx, line, sizeof(line))
+        || sscanf(line, "funcs: %d", &n) != 1 || n < 0)
+      break;
+    funcs.resize(n+1);
+    for (ix = 0; ix <= n; ix++) {
+      int fid;
+      funcInfo &f = funcs[ix];
+      if (!readIndexLine(idx, line, sizeof(line))
+          || sscanf(line, "func: %d %ld %ld %ld %ld %ld %ld %lf %n", &fid,
+                    &f.fileNo, &f.lineNo, &f.noOnTasks, &f.noTasks, &f.noGets,
+                    &f.noPuts, &f.clockTime, &pos) != 8
+          || fid != ix)
+        break;
+      f.name = strdup(line+pos);
+    }
+    if (ix <= n)
+      break;
+
+    // The tags, each followed by its locales and communication
+    tagData *tag = NULL;
+    int nlocs = 0;
+    while (readIndexLine(idx, line, sizeof(line))) {
+      if (strncmp(line, "tag: ", 5) == 0) {
+        int tagno;
+        if ((tag != NULL && nlocs != nlocales)
+            || (int)tags.size() == newNumTags+2)
+          break;
+        tag = new tagData(nlocales);
+        tags.push_back(tag);
+        nlocs = 0;
+        if (sscanf(line, "tag: %d %lf %lf %ld %ld %ld %ld %n", &tagno,
+                   &tag->maxCpu, &tag->maxClock, &tag->maxTasks, &tag->maxConc,
+                   &tag->maxComms, &tag->maxSize, &pos) != 7
+            || tagno != (int)tags.size() + TagALL - 1)
+          break;
+        tag->name = strDB.getString(line+pos);
+      } else if (strncmp(line, "loc: ", 5) == 0) {
+        int nid;
+        if (tag == NULL || nlocs == nlocales)
+          break;
+        localeData &loc = tag->locales[nlocs];
+        if (sscanf(line, "loc: %d %lf %lf %lf %lf %lf %ld %ld", &nid,
+                   &loc.userCpu, &loc.sysCpu, &loc.Cpu, &loc.clockTime,
+                   &loc.maxTaskClock, &loc.numTasks, &loc.maxConc) != 8
+            || nid != nlocs)
+          break;
+        nlocs++;
+      } else if (strncmp(line, "bkt: ", 5) == 0) {
+        int nid;
+        if (tag == NULL || nlocs == 0)
+          break;
+        localeData &loc = tag->locales[nlocs-1];
+        if (sscanf(line, "bkt: %d %lf %lf %n", &nid, &loc.spanStart,
+                   &loc.spanEnd, &pos) != 3
+            || nid != nlocs-1 || !loc.buckets.empty())
+          break;
+        loc.buckets.resize(numBuckets);
+        char *next = line+pos;
+        int ib;
+        for (ib = 0; ib < numBuckets; ib++) {
+          bucketData &bd = loc.buckets[ib];
+          if (sscanf(next, "%ld %ld %ld %ld %n", &bd.taskBegins, &bd.taskEnds,
+                     &bd.numComms, &bd.maxConc, &pos) != 4)
+            break;
+          next += pos;
+        }
+        if (ib < numBuckets || *next != 0)
+          break;
+      } else if (strncmp(line, "comm: ", 6) == 0) {
+        int src, dst;
+        commData cd;
+        if (tag == NULL
+            || sscanf(line, "comm: %d %d %ld %ld %ld %ld %ld", &src, &dst,
+                      &cd.numComms, &cd.numGets, &cd.numPuts, &cd.numForks,
+                      &cd.commSize) != 7
+            || src < 0 || src >= nlocales || dst < 0 || dst >= nlocales)
+          break;
+        tag->comms[src][dst] = cd;
+      } else {
+        ok = strcmp(line, "End") == 0 && nlocs == nlocales
+             && (int)tags.size() == newNumTags+2;
+        break;
+      }
+    }
+  } while (0);
+  fclose(idx);
+
+  if (!ok) {
+    free(home);
+    free(cdir);
+    for (unsigned int ix = 0; ix < files.size(); ix++)
+      free(files[ix].name);
+    for (unsigned int ix = 0; ix < funcs.size(); ix++)
+      free(funcs[ix].name);
+    for (unsigned int ix = 0; ix < tags.size(); ix++)
+      delete tags[ix];
+    return 0;
+  }
+
+  // Replace the current data with the summaries
+  if (tagList != NULL) {
+    for (int ix = 0; ix < numTags+2; ix++)
+      delete tagList[ix];
+    delete [] tagList;
+  }
+  if (utagList != NULL) {
+    for (unsigned int ix = 0; ix < name2tag.size(); ix++)
+      delete utagList[ix];
+    delete [] utagList;
+    utagList = NULL;
+  }
+  name2tag.clear();
+  uniqueTags = true;
+
+  numTags = newNumTags;
+  startClock = newStartClock;
+  tagList = new tagData *[numTags+2];
+  for (int ix = 0; ix < numTags+2; ix++)
+    tagList[ix] = tags[ix];
+
+  chpl_home = home;
+  dir = cdir;
+  fileTblSize = files.size();
+  fileTbl = new filename[fileTblSize];
+  for (int ix = 0; ix < fileTblSize; ix++)
+    fileTbl[ix] = files[ix];
+  funcTblSize = funcs.size() - 1;
+  funcTbl = new funcInfo[funcTblSize+1];
+  for (int ix = 0; ix <= funcTblSize; ix++)
+    funcTbl[ix] = funcs[ix];
+
+  if (taskTimeline != NULL)
+    delete [] taskTimeline;
+  taskTimeline = new std::list<std::pair<Tl_Kind,long> >[numLocales];
+
+  mapTagNames();
+  buildUniqueTags();
   return 1;
 }
 
+// Write the index for the data just loaded.  The index is only there
+// to make the next load faster, so failing to write it is not an error.
+
+void DataModel::WriteIndex (const char *idxName, const char *dataBase,
+                            double seq)
+{
+  char tmpName[MAXPATHLEN];
+  char fname[MAXPATHLEN];
+  struct stat sb;
+
+  snprintf (tmpName, sizeof(tmpName), "%s.tmp", idxName);
+  FILE *idx = fopen(tmpName, "w");
+  if (!idx) return;
+
+  fprintf (idx, "ChplVisIndex: ver %d nodes %d tags %d seq %.3lf start %.17g\n",
+           indexVersion, numLocales, numTags, seq, startClock);
+  for (int i = 0; i < numLocales; i++) {
+    snprintf (fname, sizeof(fname), "%s%d", dataBase, i);
+    if (stat(fname, &sb) < 0) {
+      fclose(idx);
+      unlink(tmpName);
+      return;
+    }
+    fprintf (idx, "data: %d %lld %lld\n", i, (long long)sb.st_size,
+             (long long)sb.st_mtime);
+  }
+  fprintf (idx, "home: %s\n", chpl_home ? chpl_home : "");
+  fprintf (idx, "dir: %s\n", dir ? dir : "");
+
+  fprintf (idx, "files: %d\n", fileTblSize);
+  for (int ix = 0; ix < fileTblSize; ix++)
+    fprintf (idx, "file: %d %d %s\n", ix, fileTbl[ix].rel2Home ? 1 : 0,
+             fileTbl[ix].name ? fileTbl[ix].name : "");
+  fprintf (idx, "funcs: %d\n", funcTblSize);
+  for (int ix = 0; ix <= funcTblSize; ix++) {
+    funcInfo &f = funcTbl[ix];
+    fprintf (idx, "func: %d %ld %ld %ld %ld %ld %ld %.17g %s\n", ix, f.fileNo,
+             f.lineNo, f.noOnTasks, f.noTasks, f.noGets, f.noPuts, f.clockTime,
+             f.name ? f.name : "");
+  }
+
+  for (int ix = 0; ix < numTags+2; ix++) {
+    tagData *tag = tagList[ix];
+    fprintf (idx, "tag: %d %.17g %.17g %ld %ld %ld %ld %s\n", ix+TagALL,
+             tag->maxCpu, tag->maxClock, tag->maxTasks, tag->maxConc,
+             tag->maxComms, tag->maxSize, tag->name ? tag->name : "");
+    for (int il = 0; il < numLocales; il++) {
+      localeData &loc = tag->locales[il];
+      fprintf (idx, "loc: %d %.17g %.17g %.17g %.17g %.17g %ld %ld\n", il,
+               loc.userCpu, loc.sysCpu, loc.Cpu, loc.clockTime,
+               loc.maxTaskClock, loc.numTasks, loc.maxConc);
+      if (loc.buckets.empty())
+        continue;
+      fprintf (idx, "bkt: %d %.17g %.17g", il, loc.spanStart, loc.spanEnd);
+      for (int ib = 0; ib < numBuckets; ib++)
+        fprintf (idx, " %ld %ld %ld %ld", loc.buckets[ib].taskBegins,
+                 loc.buckets[ib].taskEnds, loc.buckets[ib].numComms,
+                 loc.buckets[ib].maxConc);
+      fprintf (idx, "\n");
+    }
+    for (int il = 0; il < numLocales; il++) {
+      for (int ic = 0; ic < numLocales; ic++) {
+        commData &cd = tag->comms[il][ic];
+        if (cd.numComms == 0 && cd.commSize == 0)
+          continue;
+        fprintf (idx, "comm: %d %d %ld %ld %ld %ld %ld\n", il, ic,
+                 cd.numComms, cd.numGets, cd.numPuts, cd.numForks,
+                 cd.commSize);
+      }
+    }
+  }
+  fprintf (idx, "End\n");
+
+  bool failed = ferror(idx) != 0;
+  if (fclose(idx) != 0)
+    failed = true;
+  if (failed || rename(tmpName, idxName) < 0)
+    unlink(tmpName);
+}
 
 // Load the data in the current file
 
-int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
+int DataModel::LoadFile (const char *fileToOpen, int index, double seq,
+                          loadState &ls)
 {
-  FILE *data = fopen(fileToOpen, "r");
+  FILE *data = fopen(fileToOpen, "rb");
   char line[1024];
 
   int floc;        // Number of locales in the file
@@ -800,14 +1417,14 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
   double fseq;
   int vdbTid;
   int VerMajor, VerMinor;
-
-  int  nErrs = 0;
+  int rv;
 
   if (!data) return 0;
 
   //printf ("LoadFile %s\n", fileToOpen);
   if (fgets(line,1024,data) != line) {
     fprintf (stderr, "Error reading file %s.\n", fileToOpen);
+    fclose(data);
     return 0;
   }
 
@@ -829,32 +1446,102 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
 
   // Verify the data
 
-  if (floc != numLocales || findex != index || fabs(seq-fseq) > .01 || VerMinor != 2 ) {
+  if (floc != numLocales || findex != index || fabs(seq-fseq) > .01
+      || (VerMinor != 2 && VerMinor != CHPL_VDEBUG_BINARY_VER_MINOR)) {
     fprintf (stderr, "Data file %s does not match other data.\n", fileToOpen);
+    fclose(data);
     return 0;
   }
 
+  ls.fileName = fileToOpen;
+  ls.findex = findex;
+  ls.numTags = 0;
+  ls.nErrs = 0;
+
   // Task Ids of tasks know to be part of the VisualDebug workings.
-  int nid0vdbtask = 0;
-  std::set<int> vdbTids;
+  ls.nid0vdbtask = 0;
   if (findex != 0)
-    (void)vdbTids.insert(vdbTid);
+    (void)ls.vdbTids.insert(vdbTid);
 
   // Create a start event with starting user/sys times.
-  std::list<Event *>::iterator itr = theEvents.begin();
-
-  // Other initializations
-  numTags = 0;
+  ls.events.push_back(new E_start(e_sec, e_usec, findex, u_sec, u_usec,
+                                  s_sec, s_usec));
 
   // Now read the rest of the file
-  Event *newEvent = new E_start(e_sec, e_usec, findex, u_sec, u_usec, s_sec, s_usec);
-  if (itr == theEvents.end()) {
-    theEvents.push_front(newEvent);
-  } else {
-    // Move past existing start events
-    while ((*itr)->Ekind() == Ev_start) { itr++; }
-    theEvents.insert(itr,newEvent);
+  if (VerMinor == CHPL_VDEBUG_BINARY_VER_MINOR)
+    rv = LoadBinaryRecords(data, ls);
+  else
+    rv = LoadTextRecords(data, ls);
+  fclose(data);
+
+  // Remove any task or Btask records that are in the vdbTids db.
+  std::list<Event *>::iterator itr = ls.events.begin();
+  while (itr != ls.events.end()) {
+    bool doErase = false;
+    Event *ev = *itr;
+    // ev->print();
+    if (ev->nodeId() == findex) {
+      switch (ev->Ekind()) {
+        case Ev_task:
+          if (ls.vdbTids.find(((E_task *)ev)->taskId()) != ls.vdbTids.end()) {
+            doErase = true;
+          }
+          break;
+        case Ev_begin_task:
+          if (ls.vdbTids.find(((E_begin_task *)ev)->taskId()) != ls.vdbTids.end()) {
+            doErase = true;
+          }
+          break;
+        default:
+          break;
+      }
+      if (doErase) {
+        delete ev;
+        itr = ls.events.erase(itr);
+      } else
+        itr++;
+    } else {
+      itr++;
+    }
+  }
+
+  if (ls.nErrs) fprintf(stderr, "%d errors in data file '%s'.\n", ls.nErrs, fileToOpen);
+
+  //  if (ignoreFork > 0 || ignoreTask > 0) {
+  //    fprintf (stderr, "%s: Error in data filters: ignoreFork = %d, ignoreTask = %d\n",
+  //         fileToOpen, ignoreFork, ignoreTask);
+  //  }
+
+  return rv;
+}
+
+// Thread body for loading locale files: take the next file until
+// there are none left.
+
+void *DataModel::loadFiles (void *arg)
+{
+  loadJob *job = (loadJob *)arg;
+  std::vector<loadState> &files = *job->files;
+
+  while (1) {
+    pthread_mutex_lock(&job->lock);
+    int ix = job->next++;
+    pthread_mutex_unlock(&job->lock);
+    if (ix >= (int)files.size())
+      break;
+    files[ix].rv = job->dm->LoadFile(files[ix].fileName, ix, job->seq,
+                                     files[ix]);
   }
+  return NULL;
+}
+
+// Read the records of a version 1.2 (text) data file
+
+int DataModel::LoadTextRecords (FILE *data, loadState &ls)
+{
+  char line[1024];
+  const char *fileToOpen = ls.fileName;
+  int findex = ls.findex;
 
   while ( fgets(line, 1024, data) == line ) {
     // Common Data
@@ -891,6 +1578,10 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
     // Tags
     int tagId;
     int slen;
+    int vdbTid;
+
+    // User/System time variables
+    long u_sec, u_usec, s_sec, s_usec;
 
     int cvt;
 
@@ -903,13 +1594,16 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
                               || (strstr(line,"FID") == line)
                               || (strstr(line,"CHPL_HOME:") == line)
                               || (strstr(line,"DIR:") == line) )) {
+        // Already read, if only this locale's events are being loaded
+        if (!ls.readTables)
+          continue;
         switch (line[0]) {
         case 'T': // filename Table size
           if (sscanf(linedata, ": %d", &fileTblSize) != 1) {
             fl_alert("Data file content error");
             exit(1);
           } else {
-            fileTbl = new filename[fileTblSize];
+            setFileTblSize(fileTblSize);
           }
           break;
 
@@ -917,10 +1611,7 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
           if (sscanf(linedata, ": %d %511s", &nfileno, tmpname) != 2) {
             printf ("Bad filename record.\n");
           } else {
-            assert (0 <= nfileno && nfileno < fileTblSize);
-            fileTbl[nfileno].name = strdup(tmpname);
-            fileTbl[nfileno].rel2Home = strstr(tmpname,"$CHPL_HOME/")
-                                          == tmpname;
+            setFileName(nfileno, tmpname);
           }
           break;
 
@@ -929,19 +1620,15 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
             // FIDNsize record
             if (sscanf(linedata, ": %d", &funcTblSize) != 1)
               printf ("Bad FIDNsize record\n");
-            else {
-              funcTbl = new funcInfo[funcTblSize+1];
-              funcTbl[funcTblSize].name = strdup("Unknown");
-            }
+            else
+              setFuncTblSize(funcTblSize);
           } else {
             // FIDname record
             if (sscanf(linedata, ": %d %d %d %511s",
                        &ix, &nlineno, &nfileno, tmpname) != 4) {
               printf ("Bad FIDname data.\n");
             } else {
-              funcTbl[ix].name = strdup(tmpname);
-              funcTbl[ix].fileNo = nfileno;
-              funcTbl[ix].lineNo = nlineno;
+              setFuncName(ix, nlineno, nfileno, tmpname);
             }
           }
           break;
@@ -953,14 +1640,7 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
             int len = strlen(&linedata[nextCh])+nextCh-1;
             while (linedata[len] == '\n' || linedata[len] == ' ')
               linedata[len] = 0;
-            const char *tag = strDB.getString(&linedata[nextCh]);
-            if (tagNames.size() <= (unsigned)tagId) {
-              if (tagNames.size() == 0)
-                tagNames.resize(64);
-              else
-                tagNames.resize(2*tagNames.size());
-            }
-            tagNames[tagId] = tag;
+            setTagName(tagId, &linedata[nextCh]);
           }
           break;
 
@@ -986,22 +1666,22 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
       } else {
         if (sscanf (linedata, ": %ld.%ld%ln", &sec, &usec, &nextCh) != 2) {
           printf ("Can't read time from '%s'\n", line);
-          nErrs++;
+          ls.nErrs++;
           continue;
         }
       }
     } else {
-      nErrs++;
+      ls.nErrs++;
       continue;
     }
 
 
-    newEvent = NULL;
+    Event *newEvent = NULL;
 
     switch (line[0]) {
 
       case 0:  // Bug in output???
-        nErrs++;
+        ls.nErrs++;
         break;
 
       case 'V': // VdbMark ... mark the taskID as being a vdbTask
@@ -1009,10 +1689,7 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
                     &nid, &taskid) != 2) {
           fprintf (stderr, "Bad VdbMark Line\n");
         } else {
-          if (nid == 0)
-            nid0vdbtask = taskid;
-          else
-            (void)vdbTids.insert(taskid);
+          markVdbTask(ls, nid, taskid);
         }
         break;
 
@@ -1024,21 +1701,10 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
           fprintf (stderr, "Bad task line: %s\n", fileToOpen);
           fprintf (stderr, "nid = %d, taskid = %d, nbstr = '%s', nlineno = %d"
                    " nfileno = '%d'\n", nid, taskid, onstr, nlineno, nfileno);
-          nErrs++;
+          ls.nErrs++;
         } else {
-          // On tasks ('O' for the onstr) are not real children of VDebug tasks
-          if (onstr[0] != 'O' && (vdbTids.find(parentId) != vdbTids.end()
-                                  || (nid == 0 && parentId == nid0vdbtask))) {
-            // new task (taskid) is also a vdbtask
-            (void)vdbTids.insert(taskid);
-          } else {
-            if (nfileno < 0 || nfileno >= fileTblSize) nfileno = 0;
-            if (fid < 0) 
-              { fid = 0; }
-            newEvent = new E_task (sec, usec, nid, taskid, fid, onstr[0] == 'O',
-                                   nlineno, nfileno);
-          }
-
+          newEvent = newTask(ls, sec, usec, nid, taskid, parentId,
+                             onstr[0] == 'O', nlineno, nfileno, fid);
         }
         break;
 
@@ -1052,23 +1718,13 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
                     &nid, &rnid, &taskid, &locAddr, &remAddr, &eSize, & typeIx, &dlen,
                     &nlineno, &nfileno) != 10) {
           fprintf (stderr, "Bad comm line: %s\n  '%s'\n", fileToOpen, line);
-          nErrs++;
+          ls.nErrs++;
         } else {
-          if (vdbTids.find(taskid) != vdbTids.end()) {
-            // Ignore this comm as being part of the xxxVdebug system
-            break;
-          }
-          if (nfileno < 0 || nfileno >= fileTblSize) nfileno = 0;
           isGet = (line[0] == 'g' ? 1 :
                    line[0] == 'p' ? 0 :
                    line[3] == 'g' ? 1 : 0);
-          if (isGet)
-            newEvent = new E_comm (sec, usec, rnid, nid, eSize, dlen, isGet, taskid, nlineno,
-                                   nfileno);
-          else
-            newEvent = new E_comm (sec, usec, nid, rnid, eSize, dlen, isGet, taskid, nlineno,
-                                   nfileno);
-          //newEvent->print();
+          newEvent = newComm(ls, sec, usec, nid, rnid, taskid, eSize, dlen,
+                             isGet, nlineno, nfileno);
         }
         break;
 
@@ -1077,14 +1733,10 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
         if ((cvt = sscanf (&linedata[nextCh], "%d %d %*d %d 0x%*x %d %d",
                            &nid, &rnid, &fid, &dlen, &vdbTid)) != 5) {
           fprintf (stderr, "Bad fork line: (cvt %d) %s\n", cvt, fileToOpen);
-          nErrs++;
+          ls.nErrs++;
         } else {
-          if (vdbTids.find(vdbTid) != vdbTids.end()) {
-            break;
-          }
-          if (fid < 0) fid = 0;
-          newEvent = new E_fork(sec, usec, nid, rnid, dlen, line[1] == '_',
-                                vdbTid, fid);
+          newEvent = newFork(ls, sec, usec, nid, rnid, dlen, line[1] == '_',
+                             vdbTid, fid);
         }
         break;
 
@@ -1092,12 +1744,10 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
         if (sscanf (&linedata[nextCh], "%ld.%ld %ld.%ld %d %d %d",
                     &u_sec, &u_usec, &s_sec, &s_usec, &nid, &vdbTid, &tagId) != 7 ) {
           fprintf (stderr, "Bad 'End' line: %s\n", fileToOpen);
-          nErrs++;
+          ls.nErrs++;
         } else {
-          newEvent = new E_pause(sec, usec, nid, u_sec, u_usec,
-                                 s_sec, s_usec, tagId, vdbTid);
-          if (nid == 0)
-            nid0vdbtask = 0;
+          newEvent = newPause(ls, sec, usec, nid, u_sec, u_usec, s_sec, s_usec,
+                              tagId, vdbTid);
         }
         break;
 
@@ -1109,13 +1759,8 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
             != 7) {
           fprintf (stderr, "Bad 'Tag' line: %s\n", fileToOpen);
         } else {
-          newEvent = new E_tag(sec, usec, nid, u_sec, u_usec, s_sec, s_usec, tagId,
-                               tagNames[tagId], vdbTid);
-          if (tagId >= numTags)
-            numTags = tagId+1;
-          if (nid == 0) {
-            nid0vdbtask = 0;
-          }
+          newEvent = newTag(ls, sec, usec, nid, u_sec, u_usec, s_sec, s_usec,
+                            tagId, vdbTid);
         }
         break;
 
@@ -1125,7 +1770,7 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
           if (sscanf (&linedata[nextCh], "%ld.%ld %ld.%ld %d %d",
                       &u_sec, &u_usec, &s_sec, &s_usec, &nid, &vdbTid) != 6 ) {
             fprintf (stderr, "Bad 'End' line: %s\n", fileToOpen);
-            nErrs++;
+            ls.nErrs++;
           } else {
             newEvent = new E_end(sec, usec, nid, u_sec, u_usec, s_sec, s_usec, vdbTid);
           }
@@ -1135,13 +1780,9 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
           if (sscanf (&linedata[nextCh], "%d %d",
                       &nid, &taskid ) != 2) {
             fprintf (stderr, "Bad Etask line: %s\n", fileToOpen);
-            nErrs++;
+            ls.nErrs++;
           } else {
-            if (vdbTids.find(taskid) == vdbTids.end()) {
-              newEvent = new E_end_task(sec, usec, nid, taskid);
-            } else {
-              //printf ("end vdb tid: %d\n", taskid);
-            }
+            newEvent = newEndTask(ls, sec, usec, nid, taskid);
           }
         }
         break;
@@ -1150,11 +1791,9 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
         if (sscanf (&linedata[nextCh], "%d %d",
                     &nid, &taskid ) != 2) {
           fprintf (stderr, "Bad Etask line: %s\n", fileToOpen);
-          nErrs++;
+          ls.nErrs++;
         } else {
-          if (vdbTids.find(taskid) == vdbTids.end()) {
-            newEvent = new E_begin_task(sec, usec, nid, taskid);
-          }
+          newEvent = newBeginTask(ls, sec, usec, nid, taskid);
         }
         break;
 
@@ -1162,107 +1801,584 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
         /* Do nothing */ ;
     }
 
-    //  Add the newEvent to the list, group Starts, Tags, Resumes and Ends together.
-    if (newEvent) {
-      if (theEvents.empty()) {
-        theEvents.push_front (newEvent);
-      } else if (itr == theEvents.end()) {
-        theEvents.insert(itr, newEvent);
-      } else {
-        if (newEvent->Ekind() <= Ev_end) {
-          // Group together
-          while (itr != theEvents.end()
-                 && (*itr)->Ekind() != newEvent->Ekind())
-            itr++;
-          if (itr == theEvents.end() || (*itr)->Ekind() != newEvent->Ekind()) {
-            fprintf (stderr, "Internal error, event mismatch. file '%s'\n", fileToOpen); \
-            printf ("newEvent: "); newEvent->print();
-            if (itr != theEvents.end()) {
-               printf ("itr: "); (*itr)->print();
-            } else {
-               printf ("At end of list\n");
-            }
-          } else {
-            // More complicated ... move past proper kinds ...
-            E_tag *tp = NULL;
-            if (newEvent->Ekind() == Ev_start || newEvent->Ekind() == Ev_end) {
-              // Just find the end of the group
-              while (itr != theEvents.end() && (*itr)->Ekind() == newEvent->Ekind())
-                itr++;
-            } else {
-              // Need to move past them only if they have the same tag!
-              if (newEvent->Ekind() == Ev_tag) {
-                // Work with tags
-                tp = (E_tag *)newEvent;
-                while (itr != theEvents.end()
-                       && (*itr)->Ekind() == Ev_tag
-                       && ((E_tag *)(*itr))->tagNo() == tp->tagNo())
-                  itr++;
-              } else {
-                // Work with pauses
-                E_pause *rp = (E_pause *)newEvent;
-                while (itr != theEvents.end()
-                       && (*itr)->Ekind() == Ev_pause
-                       && ((E_pause *)(*itr))->tagId() == rp->tagId())
-                  itr++;
-              }
-            }
-            /*std::list<Event*>::iterator newElem = */ theEvents.insert (itr, newEvent);
-            //      if (tp != NULL && tp->nodeId() == 0) {
-            //        tagVec[tp->tagNo()-1] = newElem;
-            //      }
+    if (newEvent)
+      addEvent(ls, newEvent);
+  }
+
+  if ( !feof(data) ) return 0;
+
+  return 1;
+}
+
+// Read the records of a version 1.3 (binary) data file.  The records
+// of each thread were written in blocks, so the event records are
+// sorted by time before they are processed.
+
+static bool binRecTimeLess (const chpl_vdebug_rec_hdr_t *lh,
+                            const chpl_vdebug_rec_hdr_t *rh)
+{
+  return lh->time < rh->time;
+}
+
+// The smallest a record of the given kind can be, or 0 for a kind
+// this reader does not know.
+
+static size_t binRecMinSize (int kind)
+{
+  switch (kind) {
+    case chpl_vdebug_rec_sizes:
+    case chpl_vdebug_rec_fname:
+    case chpl_vdebug_rec_fidname:
+    case chpl_vdebug_rec_tname:
+    case chpl_vdebug_rec_home:
+    case chpl_vdebug_rec_dir:
+      return sizeof(chpl_vdebug_rec_str_t);
+
+    case chpl_vdebug_rec_end:
+    case chpl_vdebug_rec_tag:
+    case chpl_vdebug_rec_pause:
+      return sizeof(chpl_vdebug_rec_tag_t);
+
+    case chpl_vdebug_rec_mark:
+    case chpl_vdebug_rec_btask:
+    case chpl_vdebug_rec_etask:
+      return sizeof(chpl_vdebug_rec_tid_t);
+
+    case chpl_vdebug_rec_task:
+      return sizeof(chpl_vdebug_rec_task_t);
+
+    case chpl_vdebug_rec_put:
+    case chpl_vdebug_rec_get:
+    case chpl_vdebug_rec_nb_put:
+    case chpl_vdebug_rec_nb_get:
+    case chpl_vdebug_rec_st_put:
+    case chpl_vdebug_rec_st_get:
+      return sizeof(chpl_vdebug_rec_comm_t);
+
+    case chpl_vdebug_rec_fork:
+    case chpl_vdebug_rec_fork_nb:
+    case chpl_vdebug_rec_fork_fast:
+      return sizeof(chpl_vdebug_rec_fork_t);
+  }
+  return 0;
+}
+
+int DataModel::LoadBinaryRecords (FILE *data, loadState &ls)
+{
+  std::vector<char> buf;
+  std::vector<const chpl_vdebug_rec_hdr_t *> events;
+  char block[64*1024];
+  size_t got;
+
+  // Read the whole file
+  while ((got = fread(block, 1, sizeof(block), data)) > 0)
+    buf.insert(buf.end(), block, block + got);
+  if (ferror(data)) return 0;
+
+  // The records are 8 byte aligned in the file; keep them aligned here.
+  std::vector<int64_t> recs((buf.size() + 7) / 8);
+  if (buf.size() > 0)
+    memcpy(&recs[0], &buf[0], buf.size());
+  const char *base = (const char *) (recs.empty() ? NULL : &recs[0]);
+
+  // First pass: string tables, and collect the events
+  size_t off = 0;
+  while (off + sizeof(chpl_vdebug_rec_hdr_t) <= buf.size()) {
+    const chpl_vdebug_rec_hdr_t *h = (const chpl_vdebug_rec_hdr_t *) (base + off);
+    if (h->size < sizeof(chpl_vdebug_rec_hdr_t) || off + h->size > buf.size()) {
+      fprintf (stderr, "Bad record in %s at offset %ld.\n", ls.fileName, (long) off);
+      ls.nErrs++;
+      return 0;
+    }
+    off += h->size;
+
+    // Skip records that are too short for their kind, so that nothing
+    // below reads past the end of a record.
+    size_t minSize = binRecMinSize(h->kind);
+    if (minSize == 0 || h->size < minSize
+        || h->nid < 0 || h->nid >= numLocales) {
+      ls.nErrs++;
+      continue;
+    }
+
+    if (h->kind <= chpl_vdebug_rec_dir) {
+      const chpl_vdebug_rec_str_t *sr = (const chpl_vdebug_rec_str_t *) h;
+      char *str = (char *) (sr + 1);
+      // The string and its NUL must fit in what follows the fixed part
+      if (sr->len < 0 || (size_t) sr->len >= h->size - sizeof(*sr)
+          || str[sr->len] != 0) {
+        ls.nErrs++;
+        continue;
+      }
+      if (!ls.readTables && h->kind != chpl_vdebug_rec_tname)
+        continue;
+      // Table sizes and indices can be no bigger than the file
+      if (sr->index < 0 || sr->lineno < 0
+          || (size_t) sr->index > buf.size() || (size_t) sr->lineno > buf.size()
+          || (h->kind == chpl_vdebug_rec_fname && sr->index >= fileTblSize)) {
+        ls.nErrs++;
+        continue;
+      }
+      switch (h->kind) {
+        case chpl_vdebug_rec_sizes:
+          if (funcTbl != NULL) {
+            ls.nErrs++;
+            break;
           }
-        } else {
-          // Insert by time
-          while (itr != theEvents.end() &&
-                 (*itr)->Ekind() > Ev_end &&
-                 **itr < *newEvent)
-            itr++;
-          theEvents.insert (itr, newEvent);
-        }
+          setFileTblSize(sr->index);
+          setFuncTblSize(sr->lineno);
+          break;
+        case chpl_vdebug_rec_fname:
+          setFileName(sr->index, str);
+          break;
+        case chpl_vdebug_rec_fidname:
+          setFuncName(sr->index, sr->lineno, sr->fileno, str);
+          break;
+        case chpl_vdebug_rec_tname:
+          setTagName(sr->index, str);
+          break;
+        case chpl_vdebug_rec_home:
+          chpl_home = strdup(str);
+          break;
+        case chpl_vdebug_rec_dir:
+          dir = strdup(str);
+          break;
+        default:
+          ls.nErrs++;
       }
+    } else {
+      events.push_back(h);
     }
   }
 
-  // Remove any task or Btask records that are in the vdbTids db.
-  itr = theEvents.begin();
-  while (itr != theEvents.end()) {
-    bool doErase = false;
-    Event *ev = *itr;
-    // ev->print();
-    if (ev->nodeId() == findex) {
-      switch (ev->Ekind()) {
-        case Ev_task:
-          if (vdbTids.find(((E_task *)ev)->taskId()) != vdbTids.end()) {
-            doErase = true;
-          }
+  // Events index the function table; make sure there is one.
+  if (ls.readTables && funcTbl == NULL) {
+    fprintf (stderr, "No table sizes in %s.\n", ls.fileName);
+    ls.nErrs++;
+    setFileTblSize(0);
+    setFuncTblSize(0);
+  }
+
+  std::stable_sort(events.begin(), events.end(), binRecTimeLess);
+
+  // Second pass: the events, in time order
+  for (size_t ix = 0; ix < events.size(); ix++) {
+    const chpl_vdebug_rec_hdr_t *h = events[ix];
+    long sec = h->time / 1000000;
+    long usec = h->time % 1000000;
+    Event *newEvent = NULL;
+
+    switch (h->kind) {
+      case chpl_vdebug_rec_end:
+      case chpl_vdebug_rec_tag:
+      case chpl_vdebug_rec_pause: {
+        const chpl_vdebug_rec_tag_t *r = (const chpl_vdebug_rec_tag_t *) h;
+        if (r->tagno >= (int) events.size()) {
+          ls.nErrs++;
           break;
-        case Ev_begin_task:
-          if (vdbTids.find(((E_begin_task *)ev)->taskId()) != vdbTids.end()) {
-            doErase = true;
-          }
+        }
+        long u_sec = r->utime / 1000000, u_usec = r->utime % 1000000;
+        long s_sec = r->stime / 1000000, s_usec = r->stime % 1000000;
+        if (h->kind == chpl_vdebug_rec_end)
+          newEvent = new E_end(sec, usec, h->nid, u_sec, u_usec, s_sec, s_usec,
+                               r->tid);
+        else if (h->kind == chpl_vdebug_rec_tag)
+          newEvent = newTag(ls, sec, usec, h->nid, u_sec, u_usec, s_sec, s_usec,
+                            r->tagno, r->tid);
+        else
+          newEvent = newPause(ls, sec, usec, h->nid, u_sec, u_usec, s_sec,
+                              s_usec, r->tagno, r->tid);
+        break;
+      }
+
+      case chpl_vdebug_rec_mark:
+        markVdbTask(ls, h->nid, ((const chpl_vdebug_rec_tid_t *) h)->tid);
+        break;
+
+      case chpl_vdebug_rec_btask:
+        newEvent = newBeginTask(ls, sec, usec, h->nid,
+                                ((const chpl_vdebug_rec_tid_t *) h)->tid);
+        break;
+
+      case chpl_vdebug_rec_etask:
+        newEvent = newEndTask(ls, sec, usec, h->nid,
+                              ((const chpl_vdebug_rec_tid_t *) h)->tid);
+        break;
+
+      case chpl_vdebug_rec_task: {
+        const chpl_vdebug_rec_task_t *r = (const chpl_vdebug_rec_task_t *) h;
+        newEvent = newTask(ls, sec, usec, h->nid, r->tid, r->parent, r->is_on,
+                           r->lineno, r->fileno, r->fid);
+        break;
+      }
+
+      case chpl_vdebug_rec_put:
+      case chpl_vdebug_rec_get:
+      case chpl_vdebug_rec_nb_put:
+      case chpl_vdebug_rec_nb_get:
+      case chpl_vdebug_rec_st_put:
+      case chpl_vdebug_rec_st_get: {
+        const chpl_vdebug_rec_comm_t *r = (const chpl_vdebug_rec_comm_t *) h;
+        if (r->rid < 0 || r->rid >= numLocales) {
+          ls.nErrs++;
           break;
-        default:
+        }
+        bool isGet = h->kind == chpl_vdebug_rec_get
+                     || h->kind == chpl_vdebug_rec_nb_get
+                     || h->kind == chpl_vdebug_rec_st_get;
+        newEvent = newComm(ls, sec, usec, h->nid, r->rid, r->tid, r->elemsize,
+                           r->len, isGet, r->lineno, r->fileno);
+        break;
+      }
+
+      case chpl_vdebug_rec_fork:
+      case chpl_vdebug_rec_fork_nb:
+      case chpl_vdebug_rec_fork_fast: {
+        const chpl_vdebug_rec_fork_t *r = (const chpl_vdebug_rec_fork_t *) h;
+        if (r->rid < 0 || r->rid >= numLocales) {
+          ls.nErrs++;
           break;
+        }
+        newEvent = newFork(ls, sec, usec, h->nid, r->rid, r->arg_size,
+                           h->kind == chpl_vdebug_rec_fork_nb, r->tid, r->fid);
+        break;
       }
-      if (doErase)
-        itr = theEvents.erase(itr);
-      else
-        itr++;
-    } else {
-      itr++;
+
+      default:
+        ls.nErrs++;
     }
+
+    if (newEvent)
+      addEvent(ls, newEvent);
   }
 
-  if (nErrs) fprintf(stderr, "%d errors in data file '%s'.\n", nErrs, fileToOpen);
+  return 1;
+}
 
-  //  if (ignoreFork > 0 || ignoreTask > 0) {
-  //    fprintf (stderr, "%s: Error in data filters: ignoreFork = %d, ignoreTask = %d\n",
-  //         fileToOpen, ignoreFork, ignoreTask);
-  //  }
+// String tables, from locale 0's data file, except for tag names
 
-  if ( !feof(data) ) return 0;
+void DataModel::setFileTblSize (int size)
+{
+  fileTblSize = size;
+  fileTbl = new filename[fileTblSize];
+}
+
+void DataModel::setFileName (int fileno, const char *name)
+{
+  assert (0 <= fileno && fileno < fileTblSize);
+  fileTbl[fileno].name = strdup(name);
+  fileTbl[fileno].rel2Home = strstr(name,"$CHPL_HOME/") == name;
+}
+
+void DataModel::setFuncTblSize (int size)
+{
+  funcTblSize = size;
+  funcTbl = new funcInfo[funcTblSize+1];
+  funcTbl[funcTblSize].name = strdup("Unknown");
+}
+
+void DataModel::setFuncName (int fid, int lineno, int fileno, const char *name)
+{
+  if (fid < 0 || fid >= funcTblSize) {
+    printf ("Bad FIDname data.\n");
+    return;
+  }
+  funcTbl[fid].name = strdup(name);
+  funcTbl[fid].fileNo = fileno;
+  funcTbl[fid].lineNo = lineno;
+}
+
+// Tag names can be in any locale's file, so this can be called by
+// more than one loader thread.
+
+void DataModel::setTagName (int tagId, char *name)
+{
+  pthread_mutex_lock(&tableLock);
+  const char *tag = strDB.getString(name);
+  while (tagNames.size() <= (unsigned)tagId) {
+    if (tagNames.size() == 0)
+      tagNames.resize(64);
+    else
+      tagNames.resize(2*tagNames.size());
+  }
+  tagNames[tagId] = tag;
+  pthread_mutex_unlock(&tableLock);
+}
+
+// Records common to both formats.  These return the new event, or
+// NULL if the record is for a VisualDebug task and should be ignored.
+
+void DataModel::markVdbTask (loadState &ls, int nid, int taskid)
+{
+  if (nid == 0)
+    ls.nid0vdbtask = taskid;
+  else
+    (void)ls.vdbTids.insert(taskid);
+}
+
+Event *DataModel::newTask (loadState &ls, long sec, long usec, int nid,
+                           int taskid, int parentId, bool isOn,
+                           int nlineno, int nfileno, int fid)
+{
+  // On tasks are not real children of VDebug tasks
+  if (!isOn && (ls.vdbTids.find(parentId) != ls.vdbTids.end()
+                || (nid == 0 && parentId == ls.nid0vdbtask))) {
+    // new task (taskid) is also a vdbtask
+    (void)ls.vdbTids.insert(taskid);
+    return NULL;
+  }
+  if (nfileno < 0 || nfileno >= fileTblSize) nfileno = 0;
+  if (fid < 0)
+    { fid = 0; }
+  return new E_task (sec, usec, nid, taskid, fid, isOn, nlineno, nfileno);
+}
+
+Event *DataModel::newComm (loadState &ls, long sec, long usec, int nid,
+                           int rnid, int taskid, int eSize, int dlen,
+                           bool isGet, int nlineno, int nfileno)
+{
+  if (ls.vdbTids.find(taskid) != ls.vdbTids.end()) {
+    // Ignore this comm as being part of the xxxVdebug system
+    return NULL;
+  }
+  if (nfileno < 0 || nfileno >= fileTblSize) nfileno = 0;
+  if (isGet)
+    return new E_comm (sec, usec, rnid, nid, eSize, dlen, isGet, taskid, nlineno,
+                       nfileno);
+  else
+    return new E_comm (sec, usec, nid, rnid, eSize, dlen, isGet, taskid, nlineno,
+                       nfileno);
+}
+
+Event *DataModel::newFork (loadState &ls, long sec, long usec, int nid,
+                           int rnid, int dlen, bool isNb, int vdbTid, int fid)
+{
+  if (ls.vdbTids.find(vdbTid) != ls.vdbTids.end())
+    return NULL;
+  if (fid < 0) fid = 0;
+  return new E_fork(sec, usec, nid, rnid, dlen, isNb, vdbTid, fid);
+}
+
+Event *DataModel::newTag (loadState &ls, long sec, long usec, int nid,
+                          long u_sec, long u_usec, long s_sec, long s_usec,
+                          int tagId, int vdbTid)
+{
+  // The name is filled in by mergeEvents(), as it may be in a file
+  // that has not been read yet.
+  if (tagId < 0) {
+    fprintf (stderr, "Bad 'Tag' record: %s\n", ls.fileName);
+    ls.nErrs++;
+    return NULL;
+  }
+  if (tagId >= ls.numTags)
+    ls.numTags = tagId+1;
+  if (nid == 0)
+    ls.nid0vdbtask = 0;
+  return new E_tag(sec, usec, nid, u_sec, u_usec, s_sec, s_usec, tagId,
+                   NULL, vdbTid);
+}
+
+Event *DataModel::newPause (loadState &ls, long sec, long usec, int nid,
+                            long u_sec, long u_usec, long s_sec, long s_usec,
+                            int tagId, int vdbTid)
+{
+  if (nid == 0)
+    ls.nid0vdbtask = 0;
+  return new E_pause(sec, usec, nid, u_sec, u_usec, s_sec, s_usec, tagId,
+                     vdbTid);
+}
+
+Event *DataModel::newBeginTask (loadState &ls, long sec, long usec, int nid,
+                                int taskid)
+{
+  if (ls.vdbTids.find(taskid) != ls.vdbTids.end())
+    return NULL;
+  return new E_begin_task(sec, usec, nid, taskid);
+}
+
+Event *DataModel::newEndTask (loadState &ls, long sec, long usec, int nid,
+                              int taskid)
+{
+  if (ls.vdbTids.find(taskid) != ls.vdbTids.end()) {
+    //printf ("end vdb tid: %d\n", taskid);
+    return NULL;
+  }
+  return new E_end_task(sec, usec, nid, taskid);
+}
+
+//  Add the newEvent to the current file's list.
+
+void DataModel::addEvent (loadState &ls, Event *newEvent)
+{
+  ls.events.push_back(newEvent);
+}
+
+static bool eventTimeLess (Event *lh, Event *rh)
+{
+  return *lh < *rh;
+}
+
+//  Merge the files' event lists into theEvents, grouping Starts, Tags,
+//  Pauses and Ends together.  Locale 0's groups are the skeleton: each
+//  group event of another locale joins the next group of the same kind,
+//  and the other events between two groups are merged by time.
+
+void DataModel::mergeEvents (std::vector<loadState> &files)
+{
+  std::vector< std::vector<Event *> > groups;    // group events, by locale
+  std::vector< std::vector<Event *> > between;   // events after each group
+  std::vector< std::vector<size_t> > runEnds;    // end of each locale's run
+  std::list<Event *>::iterator itr;
+
+  numTags = 0;
+  for (unsigned int fx = 0; fx < files.size(); fx++) {
+    loadState &ls = files[fx];
+    int cur = -1;
+    if (ls.numTags > numTags)
+      numTags = ls.numTags;
+
+    for (itr = ls.events.begin(); itr != ls.events.end(); itr++) {
+      Event *ev = *itr;
+      int kind = ev->Ekind();
+
+      if (kind == Ev_tag) {
+        E_tag *tp = (E_tag *)ev;
+        if ((unsigned)tp->tagNo() >= tagNames.size()) {
+          fprintf (stderr, "Bad 'Tag' record: %s\n", ls.fileName);
+          delete ev;
+          continue;
+        }
+        tp->setTagName(tagNames[tp->tagNo()]);
+      }
+
+      if (kind > Ev_end) {
+        if (cur < 0) {
+          fprintf (stderr, "Internal error, event before start. file '%s'\n",
+                   ls.fileName);
+          delete ev;
+        } else {
+          between[cur].push_back(ev);
+        }
+      } else if (fx == 0) {
+        groups.push_back(std::vector<Event *>(1, ev));
+        between.push_back(std::vector<Event *>());
+        cur++;
+      } else {
+        unsigned int gx = cur + 1;
+        while (gx < groups.size() && groups[gx][0]->Ekind() != kind)
+          gx++;
+        if (gx == groups.size()) {
+          fprintf (stderr, "Internal error, event mismatch. file '%s'\n",
+                   ls.fileName);
+          printf ("newEvent: "); ev->print();
+          delete ev;
+        } else {
+          groups[gx].push_back(ev);
+          cur = gx;
+        }
+      }
+    }
+    ls.events.clear();
+    if (fx == 0)
+      runEnds.resize(groups.size());
+    for (unsigned int gx = 0; gx < groups.size(); gx++)
+      runEnds[gx].push_back(between[gx].size());
+  }
+
+  for (unsigned int gx = 0; gx < groups.size(); gx++) {
+    std::vector<Event *> &evs = between[gx];
+    std::vector<size_t> &ends = runEnds[gx];
+
+    // Each locale's run should already be in time order.
+    size_t begin = 0;
+    for (unsigned int rx = 0; rx < ends.size(); rx++) {
+      for (size_t ix = begin + 1; ix < ends[rx]; ix++) {
+        if (eventTimeLess(evs[ix], evs[ix-1])) {
+          std::stable_sort(evs.begin() + begin, evs.begin() + ends[rx],
+                           eventTimeLess);
+          break;
+        }
+      }
+      begin = ends[rx];
+    }
+
+    // Merge pairs of adjacent runs until there is one.  Ties keep the
+    // lower numbered locale first.
+    while (ends.size() > 1) {
+      std::vector<size_t> merged;
+      begin = 0;
+      for (unsigned int rx = 0; rx < ends.size(); rx += 2) {
+        if (rx + 1 < ends.size()) {
+          std::inplace_merge(evs.begin() + begin, evs.begin() + ends[rx],
+                             evs.begin() + ends[rx+1], eventTimeLess);
+          merged.push_back(ends[rx+1]);
+        } else {
+          merged.push_back(ends[rx]);
+        }
+        begin = merged.back();
+      }
+      ends.swap(merged);
+    }
+
+    theEvents.insert(theEvents.end(), groups[gx].begin(), groups[gx].end());
+    theEvents.insert(theEvents.end(), evs.begin(), evs.end());
+  }
+}
+
+// Load the events of one locale of a data set whose summaries came from
+// the index, and build that locale's task data.  The summaries are not
+// changed, so the tag and function data the views point to stay where
+// they are.
+
+int DataModel::loadDetail (long locale)
+{
+  if (locale < 0 || locale >= numLocales)
+    return 0;
+  if (haveDetail[locale])
+    return 1;
+  if (dataBase == NULL)
+    return 0;
+
+  char fname[strlen(dataBase)+25];
+  snprintf (fname, sizeof(fname), "%s%ld", dataBase, locale);
+
+  loadState ls;
+  ls.readTables = false;
+  bool ok = LoadFile(fname, locale, dataSeq, ls) != 0;
+
+  // Put the events between each pair of group events in time order and
+  // name the tags, as mergeEvents() does for a full load.
+  std::vector<Event *> evs(ls.events.begin(), ls.events.end());
+  ls.events.clear();
+  size_t run = 0;
+  for (size_t ix = 0; ok && ix <= evs.size(); ix++) {
+    if (ix < evs.size() && evs[ix]->Ekind() > Ev_end)
+      continue;
+    std::stable_sort(evs.begin() + run, evs.begin() + ix, eventTimeLess);
+    run = ix + 1;
+    if (ix < evs.size() && evs[ix]->Ekind() == Ev_tag) {
+      E_tag *tp = (E_tag *)evs[ix];
+      if (tp->tagNo() < 0 || tp->tagNo() >= numTags)
+        ok = false;
+      else
+        tp->setTagName(tagList[tp->tagNo()+2]->name);
+    }
+  }
+  if (!ok || evs.empty() || evs[0]->Ekind() != Ev_start) {
+    if (!dataFromArgv)
+      fl_message ("The data in %s changed after it was opened.", fname);
+    else
+      printf ("The data in %s changed after it was opened.\n", fname);
+    for (size_t ix = 0; ix < evs.size(); ix++)
+      delete evs[ix];
+    return 0;
+  }
+
+  std::list<Event *> events(evs.begin(), evs.end());
+  buildDetail(events, false);
+  theEvents.splice(theEvents.end(), events);
 
+  haveDetail[locale] = true;
   return 1;
 }
 
@@ -21,10 +21,15 @@
 #define DATAMODEL_H
 
 #include "Event.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
 #include <list>
 #include <vector>
 #include <map>
+#include <set>
 #include "StringCache.h"
+#include "chpl-visual-debug-format.h"
 
 // This class builds a list of events 
 //   Start, Stop, Pause, and Tag events are grouped together 
@@ -34,9 +39,18 @@
 // This is the class that reads the files as generated by runtime/src/chpl-visual-debug.c
 // in the Chapel runtime.
 //
-// Initially the data files are in ascii.  To turn these into binary data files,
-// both this class and runtime/src/chpl-visual-debug.c need to be modified to
-// write (chpl-visual-debug.c) and read (this class) in binary.
+// The data files are either text (version 1.2, see TextDataFormat.txt) or
+// binary (version 1.3, see runtime/include/chpl-visual-debug-format.h).
+// Both are turned into the same events.
+//
+// After the events of a data set have been loaded, the per tag and per
+// locale summaries are saved in an index file next to the data files.
+// The summaries include how the activity of each tag on each locale is
+// spread over its time, in a fixed number of buckets.  When a data set
+// with an up to date index is opened again, only the summaries are
+// read.  The events of a locale, which the concurrency view and the
+// task communication lists need, are loaded by loadDetail() the first
+// time that locale is shown.
 
 // Support Structs used by DataModel
 
@@ -64,6 +78,16 @@ struct taskData {
   taskData() : taskRec(NULL), beginRec(NULL), endRec(NULL), endTagNo(-2) {};
 };
 
+// Activity in one slice of a tag's time on a locale
+struct bucketData {
+  long taskBegins;
+  long taskEnds;
+  long numComms;
+  long maxConc;
+
+  bucketData() : taskBegins(0), taskEnds(0), numComms(0), maxConc(0) {};
+};
+
 // Used to track a locale,  each tag has an array of locales
 struct localeData {
   double userCpu;
@@ -78,11 +102,18 @@ struct localeData {
   long    runConc;
   long    maxConc;
 
+  // The tag's time on this locale, split into DataModel::numBuckets
+  // equal buckets.  Empty if nothing ran on the locale in the tag.
+  double spanStart;
+  double spanEnd;
+  std::vector<bucketData> buckets;
+
   std::map<long,taskData> tasks;
 
   localeData() : userCpu(0), sysCpu(0), Cpu(0), refUserCpu(0), refSysCpu(0),
                  clockTime(0), refTime(0), maxTaskClock(0), // minTaskClock(1E10),
-                 numTasks(0), runConc(0), maxConc(0) {};
+                 numTasks(0), runConc(0), maxConc(0), spanStart(0),
+                 spanEnd(0) {};
 };
 
 // File names, rel2Home says the names starts with $CHPL_HOME
@@ -144,6 +175,9 @@ class DataModel {
   
   std::vector<const char *> tagNames;
 
+  // Guards strDB and tagNames while locale files are loaded in parallel
+  pthread_mutex_t tableLock;
+
   typedef std::list<Event*>::iterator evItr;
 
   int numLocales;
@@ -159,10 +193,92 @@ class DataModel {
 
   std::list < Event* > theEvents;
   std::list < Event* >::iterator curEvent;
+  double startClock;
+
+  // Summary-first loading: the data files' names without the locale
+  // number, which locales' events have been loaded, and whether
+  // LoadData may use the index file
+  char *dataBase;
+  double dataSeq;
+  bool dataFromArgv;
+  std::vector<bool> haveDetail;
+  bool useIndex;
+
+  // An event that goes in a bucket, with the concurrency after it or
+  // -1 if it doesn't change the concurrency
+  enum Bk_Kind { Bk_Begin, Bk_End, Bk_Comm };
+  struct bucketEvent {
+    double time;
+    Bk_Kind kind;
+    long conc;
+
+    bucketEvent(double t, Bk_Kind k, long c) : time(t), kind(k), conc(c) {};
+  };
   
+  // State kept while loading one locale's data file.  Each file is
+  // loaded into its own event list, and the lists are merged once all
+  // of the files have been read.
+  struct loadState {
+    const char *fileName;
+    int findex;
+    int nid0vdbtask;          // VisualDebug task on locale 0
+    std::set<int> vdbTids;    // Tasks known to be part of VisualDebug
+    std::list<Event *> events;
+    int numTags;
+    int nErrs;
+    int rv;                   // LoadFile's return value
+    bool readTables;          // read the file and function tables
+  };
+
+  // Work shared by the threads loading locale files 1 to n-1
+  struct loadJob {
+    DataModel *dm;
+    std::vector<loadState> *files;
+    double seq;
+    int next;                 // next file to be loaded
+    pthread_mutex_t lock;
+  };
+
   // Utility routines
   
-  int LoadFile (const char *filename, int index, double seq);
+  int LoadFile (const char *filename, int index, double seq, loadState &ls);
+  static void *loadFiles (void *job);
+  void mergeEvents (std::vector<loadState> &files);
+  void buildDetail (std::list<Event *> &events, bool summaries);
+  void fillBuckets (localeData &loc, double start, double end, long conc,
+                    std::vector<bucketEvent> &events);
+  void mapTagNames ();
+  void buildUniqueTags ();
+  bool indexIsCurrent (FILE *idx, const char *dataBase, int nlocales,
+                       double seq, int &ntags, double &start);
+  int LoadIndex (const char *idxName, const char *dataBase, int nlocales,
+                 double seq);
+  void WriteIndex (const char *idxName, const char *dataBase, double seq);
+  int LoadTextRecords (FILE *data, loadState &ls);
+  int LoadBinaryRecords (FILE *data, loadState &ls);
+
+  void setFileTblSize (int size);
+  void setFileName (int fileno, const char *name);
+  void setFuncTblSize (int size);
+  void setFuncName (int fid, int lineno, int fileno, const char *name);
+  void setTagName (int tagId, char *name);
+
+  void markVdbTask (loadState &ls, int nid, int taskid);
+  Event *newTask (loadState &ls, long sec, long usec, int nid, int taskid,
+                  int parentId, bool isOn, int nlineno, int nfileno, int fid);
+  Event *newComm (loadState &ls, long sec, long usec, int nid, int rnid,
+                  int taskid, int eSize, int dlen, bool isGet, int nlineno,
+                  int nfileno);
+  Event *newFork (loadState &ls, long sec, long usec, int nid, int rnid,
+                  int dlen, bool isNb, int vdbTid, int fid);
+  Event *newTag (loadState &ls, long sec, long usec, int nid, long u_sec,
+                 long u_usec, long s_sec, long s_usec, int tagId, int vdbTid);
+  Event *newPause (loadState &ls, long sec, long usec, int nid, long u_sec,
+                   long u_usec, long s_sec, long s_usec, int tagId, int vdbTid);
+  Event *newBeginTask (loadState &ls, long sec, long usec, int nid, int taskid);
+  Event *newEndTask (loadState &ls, long sec, long usec, int nid, int taskid);
+
+  void addEvent (loadState &ls, Event *newEvent);
   
   void newList ();
   
@@ -173,6 +289,10 @@ class DataModel {
   // Tags are numbered 0 to numTags-1
   
   static const int TagALL = -2, TagStart = -1;
+
+  // Number of buckets each tag's time on a locale is split into
+
+  static const int numBuckets = 16;
   
   // Tags and manipulation of them
   
@@ -241,8 +361,20 @@ class DataModel {
 
   taskData * getTaskData (long locale, long taskId, long tagNo = TagALL);
 
+  // The buckets of a tag on a locale, or NULL if nothing ran there.
+  // There are none for ALL or for merged tags.  Unlike the task data,
+  // these are there without loading the events.
+
+  const bucketData * getBuckets (int tagno, long locale) {
+    if (tagno < TagStart || tagno >= numTags || locale < 0
+        || locale >= numLocales)
+      return NULL;
+    localeData &loc = tagList[tagno-TagALL]->locales[locale];
+    return loc.buckets.empty() ? NULL : &loc.buckets[0];
+  }
+
   double start_clock() {
-    return (*theEvents.begin())->clock_time();
+    return startClock;
   }
 
   // File name access
@@ -285,10 +417,20 @@ class DataModel {
     numTags = 0;
     tagList = NULL;
     taskTimeline = NULL;
+    fileTbl = NULL;
+    fileTblSize = 0;
+    funcTbl = NULL;
+    funcTblSize = 0;
     curEvent = theEvents.begin();
     uniqueTags = true;
     utagList = NULL;
+    startClock = 0;
+    dataBase = NULL;
+    dataSeq = 0;
+    dataFromArgv = false;
+    useIndex = true;
     tagNames.resize(64);
+    pthread_mutex_init(&tableLock, NULL);
   }
   
   // Destructor for DataModel
@@ -305,6 +447,10 @@ class DataModel {
         delete utagList[ix];
       delete [] utagList;
     }
+    delete [] fileTbl;
+    delete [] funcTbl;
+    free(dataBase);
+    pthread_mutex_destroy(&tableLock);
   }
   
   //  LoadData loads data from a collection of files
@@ -313,6 +459,13 @@ class DataModel {
   //  Returns 1 if successful, 0 if not
   
   int LoadData (const char *filename, bool fromArgv);
+
+  //  Load the events of a locale if only the summaries of the current
+  //  data set were read from the index.  The locale's task data
+  //  (getTaskData and taskTimeline) is only valid after this has
+  //  returned 1.  The function events only include loaded locales.
+
+  int loadDetail (long locale);
   
   //  Number of locales found in loading files
   
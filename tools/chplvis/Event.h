@@ -43,6 +43,7 @@ class Event {  // Base class for events
   public:
     Event(long esec, long eusec, int id)
       : sec(esec), usec(eusec), nodeid(id) {};
+    virtual ~Event() {};
 
     long tsec () { return sec; }
     long tusec () { return usec; }
@@ -198,6 +199,7 @@ class E_tag : public Event {
 
      int tagNo() { return tag_num; }
      const char *tagName() { return tag_name; }
+     void setTagName(const char *name) { tag_name = name; }
 
      double cpu_time()  { return u_sec+s_sec + ((double)u_usec+s_usec)/1000000; }
      double user_time() { return u_sec+(double)u_usec/1000000; }
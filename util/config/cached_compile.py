@@ -0,0 +1,149 @@
+#!/usr/bin/env python
+
+"""
+Compile the generated C files that make up a program, reusing object
+files from earlier compilations when possible.  Used by the generated
+Makefile when chpl is given --ccache-dir.
+
+usage: cached_compile.py <cache dir> <header> <object>... -- <cc> [cflags]
+
+Each <object> is compiled from <object>.c, which must include <header>
+(chpl__header.h) and nothing else.  An object file is looked up in the
+cache directory under a hash of
+ - the C compiler command and its flags,
+ - the version of the C compiler,
+ - the header after preprocessing, so that changes to the generated
+   declarations or to the runtime headers are seen, and
+ - the text of the C file.
+The objects that are not found are compiled in parallel and added to
+the cache.
+"""
+
+import hashlib
+import multiprocessing
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+
+def run(command):
+    """Return the standard output of command, or None if it fails."""
+    try:
+        p = subprocess.Popen(command, stdout=subprocess.PIPE)
+        out, _ = p.communicate()
+    except OSError:
+        return None
+    return out if p.returncode == 0 else None
+
+
+def common_key(cc_command, header):
+    """
+    Return a hash of what every object depends on besides its own C
+    file, or None if the header could not be preprocessed.
+    """
+    text = run(cc_command + ['-E', header])
+    if text is None:
+        return None
+
+    # The generated files are in a new temporary directory each time,
+    # which the preprocessor mentions in its line markers.
+    gen_dir = os.path.dirname(os.path.abspath(header))
+    text = text.replace(gen_dir.encode(), b'<gen>')
+    command = ' '.join(cc_command).replace(gen_dir, '<gen>')
+
+    h = hashlib.sha1()
+    h.update(command.encode())
+    h.update(b'\0')
+    h.update(run([cc_command[0], '--version']) or b'')
+    h.update(b'\0')
+    h.update(text)
+    return h.hexdigest()
+
+
+def object_key(common, source):
+    h = hashlib.sha1(common.encode())
+    with open(source, 'rb') as f:
+        h.update(f.read())
+    return h.hexdigest()
+
+
+def add_to_cache(obj, cached):
+    """
+    Copy obj into the cache under a temporary name and rename it, so
+    that a concurrent compilation never sees a partial file.
+    """
+    cache_dir = os.path.dirname(cached)
+    try:
+        try:
+            os.makedirs(cache_dir)
+        except OSError:
+            if not os.path.isdir(cache_dir):
+                raise
+        fd, tmp = tempfile.mkstemp(dir=cache_dir)
+        os.close(fd)
+        shutil.copyfile(obj, tmp)
+        os.rename(tmp, cached)
+    except (IOError, OSError) as e:
+        sys.stderr.write('warning: could not add {0} to the cache: '
+                         '{1}\n'.format(obj, e))
+
+
+def compile_all(cc_command, jobs):
+    """
+    Compile each (object, cached) pair in jobs, a few at a time, adding
+    the objects to the cache.  Return the first nonzero exit status.
+    """
+    max_running = multiprocessing.cpu_count()
+    running = []
+    status = 0
+
+    while jobs or running:
+        while jobs and len(running) < max_running:
+            obj, cached = jobs.pop(0)
+            command = cc_command + ['-c', '-o', obj, obj + '.c']
+            running.append((subprocess.Popen(command), obj, cached))
+
+        p, obj, cached = running.pop(0)
+        if p.wait() != 0:
+            # Let the compilations already started finish, but start
+            # no more.
+            status = status or p.returncode
+            jobs = []
+        elif cached:
+            add_to_cache(obj, cached)
+
+    return status
+
+
+def main(argv):
+    if '--' not in argv or argv.index('--') < 3 or argv[-1] == '--':
+        sys.stderr.write('usage: {0} <cache dir> <header> <object>... '
+                         '-- <cc> [cflags]\n'.format(argv[0]))
+        return 2
+
+    sep = argv.index('--')
+    cache_dir, header = argv[1:3]
+    objects = argv[3:sep]
+    cc_command = argv[sep+1:]
+
+    common = common_key(cc_command, header)
+    if common is None:
+        # Compile everything and let the compiler report the problem.
+        return compile_all(cc_command, [(o, None) for o in objects])
+
+    jobs = []
+    for obj in objects:
+        key = object_key(common, obj + '.c')
+        cached = os.path.join(cache_dir, key[:2], key + '.o')
+        if os.path.isfile(cached):
+            shutil.copyfile(cached, obj)
+        else:
+            jobs.append((obj, cached))
+
+    return compile_all(cc_command, jobs)
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
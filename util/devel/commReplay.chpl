@@ -0,0 +1,246 @@
+/*
+ * Copyright 2004-2017 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Replay a communication trace.
+//
+// A program run with CHPL_RT_COMM_TRACE=<base> writes the GETs, PUTs,
+// strided GETs and PUTs, and executeOns done by each locale to
+// <base>-<node>.ctr (see runtime/include/chpl-comm-trace.h).  This
+// program does the same operations again, with the same sizes and the
+// same peers, so that the communication of a real application can be
+// timed without the application.  Build it like any Chapel program
+// and run it on as many locales as the traced program used:
+//
+//   chpl --fast -o commReplay $CHPL_HOME/util/devel/commReplay.chpl
+//   ./commReplay -nl 4 --trace=<base>
+//
+// By default each traced task is replayed by its own task, as fast as
+// it can go.  With --keepGaps, each operation waits until as much
+// time has passed since the start of the replay as had passed since
+// the start of the trace.  With --perTask=false, all of a locale's
+// operations are done in time order by one task.  --showLocales adds
+// each locale's replay time to the summary.
+//
+// The data moved is junk: GETs and PUTs go to and from a buffer on
+// each locale that is as large as the largest operation.  A strided
+// operation is replayed as one level of equal pieces with the same
+// total size.  Non-blocking GETs and PUTs are replayed as blocking
+// ones, and executeOns run an empty body, so their argument size is
+// not reproduced.
+//
+
+use Sort, Time;
+
+config const trace = "";
+config const keepGaps = false;
+config const perTask = true;
+config const showLocales = false;
+
+// Must match chpl_comm_cb_event_kind_t in chpl-comm-callbacks.h.
+param kPut = 0, kPutNb = 1, kPutStrd = 2,
+      kGet = 3, kGetNb = 4, kGetStrd = 5,
+      kOn = 6, kOnNb = 7, kOnFast = 8,
+      numKinds = 9;
+const kindNames: [0..#numKinds] string =
+  ["put", "put_nb", "put_strd", "get", "get_nb", "get_strd",
+   "executeOn", "executeOn_nb", "executeOn_fast"];
+
+// Must match chpl_comm_trace_hdr_t and chpl_comm_trace_rec_t.
+param traceVersion = 1, hdrSize = 40, recSize = 40;
+
+record traceRec {
+  var time: int(64);
+  var tid: int(64);
+  var size: uint(64);
+  var chunk: uint(64);
+  var node: int(32);
+  var kind: uint(16);
+}
+
+// Replay order: by task, then time, or just by time.
+record byTaskTime {
+  proc compare(a: traceRec, b: traceRec) {
+    if a.tid != b.tid then return if a.tid < b.tid then -1 else 1;
+    return if a.time < b.time then -1 else if a.time > b.time then 1 else 0;
+  }
+}
+
+record byTime {
+  proc key(r: traceRec) return r.time;
+}
+
+// The buffer each locale's operations are aimed at.  These are kept
+// as c_void_ptr because arrays of c_ptr cannot be copied.
+var remoteBufs: [LocaleSpace] c_void_ptr;
+
+// What one locale replayed.
+var counts: [LocaleSpace] [0..#numKinds] int;
+var bytes: [LocaleSpace] [0..#numKinds] uint(64);
+var elapsed: [LocaleSpace] real;
+
+proc main() {
+  if trace == "" then
+    halt("usage: commReplay --trace=<base> [--keepGaps] [--perTask=false]");
+
+  var maxSize: [LocaleSpace] uint(64);
+  coforall loc in Locales do on loc {
+    const recs = readTrace(here.id);
+    var m = 1: uint(64);
+    for r in recs do
+      m = max(m, r.size);
+    maxSize[here.id] = m;
+  }
+  const bufSize = max reduce maxSize;
+
+  coforall loc in Locales do on loc do
+    remoteBufs[here.id] = c_malloc(uint(8), bufSize): c_void_ptr;
+
+  coforall loc in Locales do on loc {
+    var recs = readTrace(here.id);
+    if perTask then sort(recs, comparator=new byTaskTime());
+               else sort(recs, comparator=new byTime());
+    replay(recs, bufSize);
+  }
+
+  report();
+
+  coforall loc in Locales do on loc do
+    c_free(remoteBufs[here.id]: c_ptr(uint(8)));
+}
+
+proc readTrace(node: int) {
+  const fname = trace + "-" + node + ".ctr";
+  var f = open(fname, iomode.r);
+  var r = f.reader(kind=ionative, locking=false);
+  const n = (f.length() - hdrSize) / recSize;
+
+  var magic: [0..#8] uint(8);
+  var version, rsize, tnode, tnodes: int(32);
+  var startSec, startUsec: int(64);
+  for m in magic do r.read(m);
+  r.read(version, rsize, tnode, tnodes, startSec, startUsec);
+  if magic[0] != ascii("C") || magic[4] != ascii("C") || magic[6] != ascii("r")
+     || version != traceVersion || rsize != recSize then
+    halt(fname, " is not a version ", traceVersion, " comm trace");
+  if tnode != node || tnodes != numLocales then
+    halt(fname, " was written by locale ", tnode, " of ", tnodes,
+         "; run with ", tnodes, " locales");
+
+  var recs: [0..#n] traceRec;
+  var pad: uint(16);
+  for rec in recs {
+    r.read(rec.time, rec.tid, rec.size, rec.chunk, rec.node, rec.kind, pad);
+    if rec.node < 0 || rec.node >= numLocales || rec.kind >= numKinds then
+      halt(fname, " has a bad record");
+  }
+  r.close();
+  f.close();
+  return recs;
+}
+
+proc replay(recs: [] traceRec, bufSize: uint(64)) {
+  const D = recs.domain;
+  const bufs = remoteBufs;
+
+  // Each run of records from one task is replayed by its own task.
+  var starts: [0..#D.size+1] int;
+  var nruns = 0;
+  for i in D do
+    if i == D.low || (perTask && recs[i].tid != recs[i-1].tid) {
+      starts[nruns] = i;
+      nruns += 1;
+    }
+  starts[nruns] = D.high + 1;
+
+  var myCounts: [0..#numKinds] int;
+  var myBytes: [0..#numKinds] uint(64);
+  for r in recs {
+    myCounts[r.kind] += 1;
+    myBytes[r.kind] += r.size;
+  }
+
+  const t0 = if D.size > 0 then min reduce recs.time else 0;
+  var t: Timer;
+  t.start();
+  sync {
+    coforall run in 0..#nruns {
+      var buf = c_malloc(uint(8), bufSize);
+      for i in starts[run]..starts[run+1]-1 {
+        const ref r = recs[i];
+        if keepGaps then
+          while t.elapsed(TimeUnits.microseconds) * 1000 < r.time - t0 do
+            chpl_task_yield();
+        doOp(r, buf, bufs[r.node]: c_ptr(uint(8)));
+      }
+      c_free(buf);
+    }
+  }
+  t.stop();
+
+  counts[here.id] = myCounts;
+  bytes[here.id] = myBytes;
+  elapsed[here.id] = t.elapsed();
+}
+
+proc doOp(r: traceRec, buf: c_ptr(uint(8)), rbuf: c_ptr(uint(8))) {
+  const node = r.node;
+  select r.kind {
+    when kGet, kGetNb do
+      __primitive("chpl_comm_get", buf, node, rbuf, r.size: size_t);
+    when kPut, kPutNb do
+      __primitive("chpl_comm_put", buf, node, rbuf, r.size: size_t);
+    when kGetStrd, kPutStrd {
+      const chunk = max(r.chunk, 1: uint(64));
+      var strides: [0..0] size_t = chunk: size_t;
+      var cnt: [0..1] size_t = [chunk: size_t, (r.size / chunk): size_t];
+      if r.kind == kGetStrd then
+        __primitive("chpl_comm_get_strd", buf[0], strides[0], node,
+                    rbuf[0], strides[0], cnt[0], 1: int(32));
+      else
+        __primitive("chpl_comm_put_strd", rbuf[0], strides[0], node,
+                    buf[0], strides[0], cnt[0], 1: int(32));
+    }
+    when kOn, kOnFast do
+      on Locales[node] do ;
+    when kOnNb do
+      begin on Locales[node] do ;
+  }
+}
+
+proc report() {
+  var total: [0..#numKinds] int;
+  var totalBytes: [0..#numKinds] uint(64);
+  for loc in LocaleSpace {
+    total += counts[loc];
+    totalBytes += bytes[loc];
+  }
+
+  writef("%-16s %12s %16s\n", "operation", "count", "bytes");
+  for k in 0..#numKinds do
+    if total[k] > 0 then
+      writef("%-16s %12i %16u\n", kindNames[k], total[k], totalBytes[k]);
+
+  const slowest = max reduce elapsed;
+  writef("replay time: %.6dr s (slowest locale)\n", slowest);
+  if showLocales then
+    for loc in LocaleSpace do
+      writef("  locale %i: %.6dr s, %i ops\n", loc, elapsed[loc],
+             + reduce counts[loc]);
+}
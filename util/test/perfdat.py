@@ -0,0 +1,101 @@
+"""
+Read the .dat files written by computePerfStats.
+
+A .dat file has a header line naming the performance keys
+
+    # Date<TAB>key1<TAB>key2...
+
+followed by one line per trial, each starting with the date of the run
+(%m/%d/%y).  A value that was not found is written as '-', and lines
+starting with '#' (e.g. timed out runs) are comments.  When a test is
+run with more than one trial, there are several lines with the same
+date; this module groups them so that each date has a list of trial
+values for each key.
+"""
+
+from __future__ import print_function, division
+import math
+import os
+import time
+
+
+class DatFile(object):
+    """The trials recorded in one .dat file, grouped by date."""
+
+    def __init__(self, path):
+        self.path = path
+        self.name = os.path.splitext(os.path.basename(path))[0]
+        self.keys = []
+        # date string -> list (one entry per key) of lists of trial values
+        self.trials = {}
+        self._read()
+
+    def _read(self):
+        with open(self.path, "r") as f:
+            for line in f:
+                fields = [s.strip() for s in line.rstrip("\n").split("\t")]
+                if not self.keys and fields[0].startswith("# Date"):
+                    self.keys = fields[1:]
+                    continue
+                if fields[0] == "" or fields[0].startswith("#"):
+                    continue
+                if not self.keys:
+                    continue
+                date = fields[0]
+                if date not in self.trials:
+                    self.trials[date] = [[] for k in self.keys]
+                for i, v in enumerate(fields[1:len(self.keys) + 1]):
+                    try:
+                        self.trials[date][i].append(float(v))
+                    except ValueError:
+                        pass
+
+    def dates(self):
+        """The dates with data, oldest first."""
+        return sorted(self.trials.keys(), key=parse_date)
+
+    def values(self, date, key):
+        """The trial values recorded for key on date."""
+        if date not in self.trials:
+            return []
+        return self.trials[date][self.keys.index(key)]
+
+
+class Stats(object):
+    """Summary of a set of trial values."""
+
+    def __init__(self, values):
+        self.trials = len(values)
+        self.mean = mean(values)
+        self.stddev = stddev(values)
+        self.min = min(values) if values else None
+        self.max = max(values) if values else None
+
+
+def parse_date(date):
+    return time.strptime(date, "%m/%d/%y")
+
+
+def mean(values):
+    if not values:
+        return None
+    return sum(values) / len(values)
+
+
+def stddev(values):
+    """The sample standard deviation, or 0.0 for fewer than two values."""
+    if len(values) < 2:
+        return 0.0
+    m = mean(values)
+    return math.sqrt(sum((v - m) ** 2 for v in values) / (len(values) - 1))
+
+
+def find_dat_files(perf_dir):
+    """The .dat files in perf_dir, not counting its subdirectories, which
+    hold the data for other performance descriptions."""
+    files = []
+    for f in sorted(os.listdir(perf_dir)):
+        path = os.path.join(perf_dir, f)
+        if f.endswith(".dat") and os.path.isfile(path):
+            files.append(path)
+    return files